@@ -1706,6 +1706,26 @@ AC_DEFUN([LC_HAVE_FILE_DENTRY], [
 	])
 ]) # LC_HAVE_FILE_DENTRY
 
+#
+# LC_HAVE_VFS_COPY_FILE_RANGE
+#
+# 4.5 adds vfs_copy_file_range
+#
+AC_DEFUN([LC_SRC_HAVE_VFS_COPY_FILE_RANGE], [
+	LB2_LINUX_TEST_SRC([vfs_copy_file_range], [
+		#include <linux/fs.h>
+	],[
+		vfs_copy_file_range(NULL, 0, NULL, 0, 0, 0);
+	])
+])
+AC_DEFUN([LC_HAVE_VFS_COPY_FILE_RANGE], [
+	LB2_MSG_LINUX_TEST_RESULT([if Linux kernel has 'vfs_copy_file_range'],
+	[vfs_copy_file_range], [
+		AC_DEFINE(HAVE_VFS_COPY_FILE_RANGE, 1,
+			[kernel has vfs_copy_file_range])
+	])
+]) # LC_HAVE_VFS_COPY_FILE_RANGE
+
 #
 # LC_HAVE_INODE_LOCK
 #
@@ -4153,6 +4173,7 @@ AC_DEFUN([LC_PROG_LINUX_SRC], [
 
 	# 4.5
 	LC_SRC_HAVE_FILE_DENTRY
+	LC_SRC_HAVE_VFS_COPY_FILE_RANGE
 
 	# 4.6
 	LC_SRC_HAVE_INODE_LOCK
@@ -4424,6 +4445,7 @@ AC_DEFUN([LC_PROG_LINUX_RESULTS], [
 
 	# 4.5
 	LC_HAVE_FILE_DENTRY
+	LC_HAVE_VFS_COPY_FILE_RANGE
 
 	# 4.5
 	LC_HAVE_INODE_LOCK
@@ -104,6 +104,16 @@ typedef void (*dt_cb_t)(struct lu_env *env, struct thandle *th,
 #define MAX_COMMIT_CB_STR_LEN	32
 
 #define DCB_TRANS_STOP		0x1
+/*
+ * Called once the data I/O submitted under the transaction completes, so
+ * that dt_trans_stop() does not have to wait for it. When there is nothing
+ * to wait for or the transaction failed, the callback is called from
+ * dt_trans_stop() with \a err 0, errors are returned by dt_trans_stop() as
+ * usual. Otherwise it is called later from the I/O completion with \a env
+ * and \a th NULL and \a err set to the I/O result. OSDs that cannot
+ * complete I/O in the background refuse the callback in dt_trans_cb_add().
+ */
+#define DCB_IO_DONE		0x2
 struct dt_txn_commit_cb {
 	struct list_head	dcb_linkage;
 	dt_cb_t			dcb_func;
@@ -1605,6 +1605,7 @@ enum lq_flag {
 			      * the same space avail */
 	LQ_RESET,	     /* zero current penalties */
 	LQ_SF_PROGRESS,      /* statfs op in progress */
+	LQ_LOAD_DIRTY,	     /* recalc load scales */
 };
 
 #ifdef HAVE_SERVER_SUPPORT
@@ -1648,6 +1649,8 @@ struct lu_tgt_qos {
 						       * every obj*/
 	__u64			 ltq_avail;	/* bytes/inode avail */
 	__u64			 ltq_weight;	/* net weighting */
+	__u32			 ltq_load_scale; /* weight scale for load,
+						  * in 1/256 */
 	time64_t		 ltq_used;	/* last used time, seconds */
 	bool			 ltq_usable:1;	/* usable for striping */
 };
@@ -1693,6 +1696,23 @@ static inline __u64 tgt_statfs_iavail(struct lu_tgt_desc *tgt)
 	return tgt->ltd_statfs.os_ffree;
 }
 
+/*
+ * Recent service time weighted by the number of requests in progress. The
+ * reported depth is a snapshot, so it is not allowed to fall below the
+ * concurrency implied by the request rate and service time (Little's law).
+ */
+static inline __u64 tgt_statfs_load(struct lu_tgt_desc *tgt)
+{
+	struct obd_statfs *statfs = &tgt->ltd_statfs;
+	__u64 depth;
+
+	depth = div_u64((__u64)statfs->os_load_rate * statfs->os_load_usec,
+			USEC_PER_SEC);
+	depth = max_t(__u64, depth, statfs->os_load_depth);
+
+	return statfs->os_load_usec * (depth + 1);
+}
+
 /* number of pointers at 2nd level */
 #define TGT_PTRS_PER_BLOCK	(PAGE_SIZE / sizeof(void *))
 /* number of pointers at 1st level - only need as many as max OST/MDT count */
@@ -1705,11 +1725,13 @@ struct lu_tgt_desc_idx {
 
 /* QoS data for LOD/LMV */
 #define QOS_THRESHOLD_MAX 256 /* should be power of two */
+#define QOS_LOAD_SCALE_MAX 256 /* ltq_load_scale of an unloaded tgt */
 struct lu_qos {
 	struct list_head	 lq_svr_list;	/* lu_svr_qos list */
 	struct rw_semaphore	 lq_rw_sem;
 	__u32			 lq_active_svr_count;
 	unsigned int		 lq_prio_free;   /* priority for free space */
+	unsigned int		 lq_prio_load;   /* priority for tgt load */
 	unsigned int		 lq_threshold_rr;/* priority for rr */
 #ifdef HAVE_SERVER_SUPPORT
 	struct lu_qos_rr	 lq_rr;          /* round robin qos data */
@@ -1764,6 +1786,7 @@ void lu_tgt_descs_fini(struct lu_tgt_descs *ltd);
 int ltd_add_tgt(struct lu_tgt_descs *ltd, struct lu_tgt_desc *tgt);
 void ltd_del_tgt(struct lu_tgt_descs *ltd, struct lu_tgt_desc *tgt);
 int ltd_qos_penalties_calc(struct lu_tgt_descs *ltd);
+void ltd_qos_load_update(struct lu_tgt_descs *ltd);
 int ltd_qos_update(struct lu_tgt_descs *ltd, struct lu_tgt_desc *tgt,
 		   __u64 *total_wt);
 
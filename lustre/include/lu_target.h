@@ -117,16 +117,23 @@ struct target_distribute_txn_data {
 	void			*tdtd_show_retrievers_cbdata;
 };
 
+struct tgt_grant_pool;
+struct cfs_percpt_lock;
+
 struct tg_grants_data {
 	/* grants: all values in bytes */
-	/* grant lock to protect all grant counters */
+	/* grant lock to protect the global grant counters */
 	spinlock_t		 tgd_grant_lock;
-	/* total amount of dirty data reported by clients in incoming obdo */
-	u64			 tgd_tot_dirty;
-	/* sum of filesystem space granted to clients for async writes */
+	/* sum of filesystem space granted to clients for async writes, also
+	 * includes space booked by the grant pools */
 	u64			 tgd_tot_granted;
-	/* grant used by I/Os in progress (between prepare and commit) */
-	u64			 tgd_tot_pending;
+	/* grant pools, exports are hashed to them by handle cookie. Each one
+	 * holds the dirty and pending grant counters of its exports and a
+	 * reservoir of ungranted space */
+	struct tgt_grant_pool	**tgd_pools;
+	/* locks protecting the grant pools and the grant counters of the
+	 * exports hashed to them */
+	struct cfs_percpt_lock	*tgd_pool_lock;
 	/* amount of available space in percentage that is never used for
 	 * grants, used on MDT to always keep space for metadata. */
 	u64			 tgd_reserved_pcnt;
@@ -175,7 +182,11 @@ struct lu_target {
 				 /* enforce recovery for local clients */
 				 lut_local_recovery:1,
 				 lut_cksum_t10pi_enforce:1,
-				 lut_no_create:1;
+				 lut_no_create:1,
+				 lut_is_mdt:1,
+				 /* reply to BRW writes from the I/O
+				  * completion, see tgt_brw_write() */
+				 lut_brw_async_commit:1;
 	/* checksum types supported on this node */
 	enum cksum_types	 lut_cksum_types_supported;
 	/** last_rcvd file */
@@ -212,6 +223,15 @@ struct lu_target {
 	/* target grants fields */
 	struct tg_grants_data	 lut_tgd;
 
+	/* target load reported in statfs, see tgt_load_update() */
+	atomic_t		 lut_load_depth;
+	__u32			 lut_load_usec;
+	/* requests counted since lut_load_start, rate of the last second */
+	spinlock_t		 lut_load_lock;
+	time64_t		 lut_load_start;
+	atomic_t		 lut_load_count;
+	__u32			 lut_load_rate;
+
 	/* target tunables */
 	const struct attribute	**lut_attrs;
 
@@ -249,6 +269,17 @@ struct tg_reply_data {
 
 extern struct lu_context_key tgt_session_key;
 
+/* BRW write replying once its data I/O completes, see tgt_brw_write() */
+struct tgt_brw_async {
+	struct dt_txn_commit_cb	 tba_cb;
+	struct lustre_handle	 tba_lockh;
+	/* the service thread and the I/O, the last one replies */
+	atomic_t		 tba_refs;
+	int			 tba_rc;
+	unsigned int		 tba_enabled:1,
+				 tba_armed:1;
+};
+
 struct tgt_session_info {
 	/*
 	 * The following members will be filled explicitly
@@ -307,6 +338,8 @@ struct tgt_session_info {
 	/* Sub request index in the batched RPC. */
 	__u32			 tsi_batch_idx;
 	struct tg_reply_data	*tsi_batch_trd;
+
+	struct tgt_brw_async	 tsi_brw_async;
 };
 
 static inline struct tgt_session_info *tgt_ses_info(const struct lu_env *env)
@@ -483,8 +516,10 @@ int tgt_extent_lock(const struct lu_env *env, struct ldlm_namespace *ns,
 void tgt_data_unlock(struct lustre_handle *lh, enum ldlm_mode mode);
 int tgt_brw_read(struct tgt_session_info *tsi);
 int tgt_brw_write(struct tgt_session_info *tsi);
+void tgt_brw_async_cb_add(const struct lu_env *env, struct thandle *th);
 int tgt_lseek(struct tgt_session_info *tsi);
 int tgt_hpreq_handler(struct ptlrpc_request *req);
+void tgt_load_statfs(struct lu_target *lut, struct obd_statfs *osfs);
 void tgt_register_lfsck_in_notify_local(int (*notify)(const struct lu_env *,
 						      struct dt_device *,
 						      struct lfsck_req_local *,
@@ -575,6 +610,8 @@ long tgt_grant_create(const struct lu_env *env, struct obd_export *exp,
 int tgt_statfs_internal(const struct lu_env *env, struct lu_target *lut,
 			struct obd_statfs *osfs, time64_t max_age,
 			int *from_cache);
+u64 tgt_grant_tot_dirty(struct tg_grants_data *tgd);
+u64 tgt_grant_tot_pending(struct tg_grants_data *tgd);
 ssize_t tot_dirty_show(struct kobject *kobj, struct attribute *attr,
 		       char *buf);
 ssize_t tot_granted_show(struct kobject *kobj, struct attribute *attr,
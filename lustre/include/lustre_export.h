@@ -529,6 +529,19 @@ static inline bool exp_connect_unaligned_dio(struct obd_export *exp)
 	return (exp_connect_flags2(exp) & OBD_CONNECT2_UNALIGNED_DIO);
 }
 
+static inline bool exp_connect_batch_getxattr(struct obd_export *exp)
+{
+	return (exp_connect_flags2(exp) & OBD_CONNECT2_BATCH_GETXATTR);
+}
+
+static inline bool imp_connect_sync_batch(struct obd_import *imp)
+{
+	struct obd_connect_data *ocd = &imp->imp_connect_data;
+
+	return (ocd->ocd_connect_flags & OBD_CONNECT_FLAGS2) &&
+		(ocd->ocd_connect_flags2 & OBD_CONNECT2_SYNC_BATCH);
+}
+
 enum {
 	/* archive_ids in array format */
 	KKUC_CT_DATA_ARRAY_MAGIC	= 0x092013cea,
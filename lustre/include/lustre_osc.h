@@ -156,6 +156,36 @@ struct osc_session {
 };
 
 #define OTI_PVEC_SIZE 256
+#if IS_ENABLED(CONFIG_LZ4_COMPRESS) && IS_ENABLED(CONFIG_LZ4_DECOMPRESS)
+#define HAVE_OSC_COMPR_CACHE 1
+#endif
+
+/**
+ * Per-OSC pool of LZ4 compressed clean pages evicted from the LRU.
+ * See osc_compr_cache.c.
+ */
+struct osc_compr_cache {
+	spinlock_t		occ_lock;
+	/* LRU of osc_compr_page, oldest first */
+	struct list_head	occ_lru;
+	/* memory budget, 0 disables the pool */
+	unsigned long		occ_max_bytes;
+	unsigned long		occ_bytes;
+	unsigned long		occ_npages;
+	/* serializes use of the compression workspace */
+	struct mutex		occ_wrk_mutex;
+	void			*occ_wrkmem;
+	void			*occ_buf;
+	/* statistics, protected by occ_lock */
+	__u64			occ_hits;
+	__u64			occ_misses;
+	__u64			occ_inserts;
+	__u64			occ_evictions;
+	__u64			occ_invalidations;
+	__u64			occ_incompressible;
+	ktime_t			occ_init;
+};
+
 struct osc_thread_info {
 	struct ldlm_res_id	oti_resname;
 	union ldlm_policy_data	oti_policy;
@@ -301,6 +331,13 @@ struct osc_object {
 	struct radix_tree_root	oo_tree;
 	unsigned long		oo_npages;
 
+	/**
+	 * Compressed copies of evicted pages, protected by occ_lock of
+	 * client_obd::cl_compr_cache.
+	 */
+	struct radix_tree_root	oo_compr_tree;
+	unsigned long		oo_compr_npages;
+
 	/* Protect osc_lock this osc_object has */
 	struct list_head	oo_ol_list;
 	spinlock_t		oo_ol_spin;
@@ -246,6 +246,7 @@ extern struct req_format RQF_MDS_REINT_SETATTR;
 extern struct req_format RQF_MDS_REINT_SETXATTR;
 extern struct req_format RQF_MDS_QUOTACTL;
 extern struct req_format RQF_QUOTA_DQACQ;
+extern struct req_format RQF_QUOTA_DQACQ_BATCH;
 extern struct req_format RQF_MDS_SWAP_LAYOUTS;
 extern struct req_format RQF_MDS_REINT_MIGRATE;
 extern struct req_format RQF_MDS_REINT_RESYNC;
@@ -269,6 +270,8 @@ extern struct req_format RQF_OST_PUNCH;
 extern struct req_format RQF_OST_FALLOCATE;
 extern struct req_format RQF_OST_SYNC;
 extern struct req_format RQF_OST_DESTROY;
+extern struct req_format RQF_OST_DESTROY_BATCH;
+extern struct req_format RQF_OST_SETATTR_BATCH;
 extern struct req_format RQF_OST_BRW_READ;
 extern struct req_format RQF_OST_BRW_WRITE;
 extern struct req_format RQF_OST_STATFS;
@@ -313,6 +316,7 @@ extern struct req_format RQF_LFSCK_QUERY;
 
 /* Batch UpdaTe req_format */
 extern struct req_format RQF_BUT_GETATTR;
+extern struct req_format RQF_BUT_GETXATTR;
 extern struct req_format RQF_MDS_BATCH;
 
 extern struct req_msg_field RMF_GENERIC_DATA;
@@ -361,6 +365,7 @@ extern struct req_msg_field RMF_OBD_QUOTACHECK;
 extern struct req_msg_field RMF_OBD_QUOTACTL;
 extern struct req_msg_field RMF_OBD_QUOTACTL_POOL;
 extern struct req_msg_field RMF_QUOTA_BODY;
+extern struct req_msg_field RMF_QUOTA_BATCH;
 extern struct req_msg_field RMF_STRING;
 extern struct req_msg_field RMF_SWAP_LAYOUTS;
 extern struct req_msg_field RMF_MDS_HSM_PROGRESS;
@@ -390,6 +395,7 @@ extern struct req_msg_field RMF_MGS_TARGET_INFO;
 extern struct req_msg_field RMF_MGS_SEND_PARAM;
 
 extern struct req_msg_field RMF_OST_BODY;
+extern struct req_msg_field RMF_OST_BODIES;
 extern struct req_msg_field RMF_OBD_IOOBJ;
 extern struct req_msg_field RMF_OBD_ID;
 extern struct req_msg_field RMF_FID;
@@ -399,6 +405,7 @@ extern struct req_msg_field RMF_RCS;
 extern struct req_msg_field RMF_FIEMAP_KEY;
 extern struct req_msg_field RMF_FIEMAP_VAL;
 extern struct req_msg_field RMF_OST_ID;
+extern struct req_msg_field RMF_OST_IDS;
 extern struct req_msg_field RMF_SHORT_IO;
 
 /* MGS config read message format */
@@ -695,6 +695,11 @@ static inline int mdo_statfs(const struct lu_env *env,
 
 struct dt_device;
 
+/* internal xattr name, LOD returns the size and blocks computed from the OST
+ * objects of a file in struct lustre_som_attrs, nothing is stored on disk
+ */
+#define XATTR_NAME_SOM_OST	"trusted.som.ost"
+
 void lustre_som_swab(struct lustre_som_attrs *attrs);
 int lustre_buf2hsm(void *buf, int rc, struct md_hsm *mh);
 void lustre_hsm2buf(void *buf, const struct md_hsm *mh);
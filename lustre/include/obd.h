@@ -360,6 +360,8 @@ struct client_obd {
 	/* ptlrpc work for writeback in ptlrpcd context */
 	void			*cl_writeback_work;
 	void			*cl_lru_work;
+	/* compressed tier for pages evicted from cl_lru_list */
+	struct osc_compr_cache	*cl_compr_cache;
 	struct mutex		  cl_quota_mutex;
 	/* quota IDs/types that have exceeded quota */
 	struct xarray		 cl_quota_exceeded_ids;
@@ -440,6 +442,10 @@ struct lmv_obd {
 	void			*lmv_cache;
 
 	__u32			lmv_qos_rr_index; /* next round-robin MDT idx */
+
+	/* read pages of striped directory from stripes in parallel */
+	struct workqueue_struct	*lmv_readdir_wq;
+	unsigned int		lmv_readdir_threads;
 };
 
 #define lmv_mdt_count	lmv_mdt_descs.ltd_lmv_desc.ld_tgt_count
@@ -461,6 +467,8 @@ struct niobuf_local {
 	__u16		lnb_guard_disk:1;
 	/* separate unlock for read path to allow shared access */
 	__u16		lnb_locked:1;
+	/* read path, page was found up to date in the server cache */
+	__u16		lnb_cached:1;
 };
 
 struct tgt_thread_big_cache {
@@ -887,6 +895,8 @@ enum md_cli_flags {
 	CLI_MIGRATE	= BIT(4),
 	CLI_DIRTY_DATA	= BIT(5),
 	CLI_NO_SLOT     = BIT(6),
+	/* read dir page from cache only, -EAGAIN if it's not cached */
+	CLI_READ_CACHED	= BIT(7),
 };
 
 enum md_op_code {
@@ -1002,6 +1012,7 @@ typedef int (*md_op_item_cb_t)(struct md_op_item *item, int rc);
 enum md_item_opcode {
 	MD_OP_NONE	= 0,
 	MD_OP_GETATTR	= 1,
+	MD_OP_GETXATTR	= 2,
 	MD_OP_MAX,
 };
 
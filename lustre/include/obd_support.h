@@ -556,6 +556,7 @@ extern bool obd_enable_health_write;
 #define OBD_FAIL_QUOTA_PREACQ            0xA06
 #define OBD_FAIL_QUOTA_RECALC            0xA07
 #define OBD_FAIL_QUOTA_GRANT             0xA08
+#define OBD_FAIL_QUOTA_DQACQ_BATCH_NET   0xA09
 
 #define OBD_FAIL_LPROC_REMOVE            0xB00
 
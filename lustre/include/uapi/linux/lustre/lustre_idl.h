@@ -875,6 +875,8 @@ struct ptlrpc_body_v2 {
 /* only ZFS servers require a change to support unaligned DIO, so this flag is
  * ignored for ldiskfs servers */
 #define OBD_CONNECT2_UNALIGNED_DIO	0x400000000ULL /* unaligned DIO */
+#define OBD_CONNECT2_BATCH_GETXATTR	0x800000000ULL /* getxattr in batch */
+#define OBD_CONNECT2_SYNC_BATCH	       0x1000000000ULL /* OST_*_BATCH RPCs */
 /* XXX README XXX README XXX README XXX README XXX README XXX README XXX
  * Please DO NOT add OBD_CONNECT flags before first ensuring that this value
  * is not in use by some other branch/patch.  Email adilger@whamcloud.com
@@ -944,7 +946,8 @@ struct ptlrpc_body_v2 {
 				OBD_CONNECT2_ENCRYPT_NAME | \
 				OBD_CONNECT2_ENCRYPT_FID2PATH | \
 				OBD_CONNECT2_DMV_IMP_INHERIT |\
-				OBD_CONNECT2_UNALIGNED_DIO)
+				OBD_CONNECT2_UNALIGNED_DIO | \
+				OBD_CONNECT2_BATCH_GETXATTR)
 
 #define OST_CONNECT_SUPPORTED  (OBD_CONNECT_SRVLOCK | OBD_CONNECT_GRANT | \
 				OBD_CONNECT_REQPORTAL | OBD_CONNECT_VERSION | \
@@ -969,7 +972,8 @@ struct ptlrpc_body_v2 {
 				OBD_CONNECT2_ENCRYPT | OBD_CONNECT2_LSEEK |\
 				OBD_CONNECT2_REP_MBITS |\
 				OBD_CONNECT2_REPLAY_CREATE |\
-				OBD_CONNECT2_UNALIGNED_DIO)
+				OBD_CONNECT2_UNALIGNED_DIO |\
+				OBD_CONNECT2_SYNC_BATCH)
 
 #define ECHO_CONNECT_SUPPORTED (OBD_CONNECT_FID | OBD_CONNECT_FLAGS2)
 #define ECHO_CONNECT_SUPPORTED2 OBD_CONNECT2_REP_MBITS
@@ -1103,6 +1107,8 @@ enum ost_cmd {
 	OST_LADVISE    = 21,
 	OST_FALLOCATE  = 22,
 	OST_SEEK       = 23,
+	OST_DESTROY_BATCH = 24,
+	OST_SETATTR_BATCH = 25,
 	OST_LAST_OPC /* must be < 33 to avoid MDS_GETATTR */
 };
 #define OST_FIRST_OPC  OST_REPLY
@@ -1599,6 +1605,9 @@ struct quota_body {
 /* qb_usage is the current qunit (in kbytes/inodes) when quota_body is used in
  * quota reply */
 #define qb_qunit	qb_usage
+/* qb_padding holds the per-ID status (wire errno) of each quota_body in the
+ * QUOTA_DQACQ_BATCH reply */
+#define qb_batch_rc	qb_padding
 
 #define QUOTA_DQACQ_FL_ACQ	0x1  /* acquire quota */
 #define QUOTA_DQACQ_FL_PREACQ	0x2  /* pre-acquire */
@@ -1691,10 +1700,14 @@ struct lquota_lvb {
 enum quota_cmd {
 	QUOTA_DQACQ	= 601,
 	QUOTA_DQREL	= 602,
+	QUOTA_DQACQ_BATCH = 603,
 	QUOTA_LAST_OPC
 };
 #define QUOTA_FIRST_OPC	QUOTA_DQACQ
 
+/* maximum number of quota_body packed in a QUOTA_DQACQ_BATCH request */
+#define QUOTA_DQACQ_BATCH_MAX	64
+
 /*
  *   MDS REQ RECORDS
  */
@@ -3626,6 +3639,7 @@ struct batch_update_reply {
  */
 enum batch_update_cmd {
 	BUT_GETATTR	= 1,
+	BUT_GETXATTR	= 2,
 	BUT_LAST_OPC,
 	BUT_FIRST_OPC	= BUT_GETATTR,
 };
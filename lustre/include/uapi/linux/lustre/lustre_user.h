@@ -293,10 +293,11 @@ struct obd_statfs {
 					/* used in QoS code to find preferred
 					 * OSTs */
 	__u32           os_granted;	/* space granted for MDS */
-	__u32           os_spare3;	/* Unused padding fields.  Remember */
-	__u32           os_spare4;	/* to fix lustre_swab_obd_statfs() */
-	__u32           os_spare5;
-	__u32           os_spare6;
+	__u32		os_load_usec;	/* recent request service time, usec */
+	__u32		os_load_depth;	/* requests in progress on target */
+	__u32		os_load_rate;	/* recent requests per second */
+	__u32           os_spare6;	/* Unused padding fields.  Remember */
+					/* to fix lustre_swab_obd_statfs() */
 	__u32           os_spare7;
 	__u32           os_spare8;
 	__u32           os_spare9;
@@ -2914,6 +2915,8 @@ enum lu_pcc_state_flags {
 	PCC_STATE_FL_ATTACHING		= 0x02,
 	/* The PCC copy is unlinked */
 	PCC_STATE_FL_UNLINKED		= 0x04,
+	/* The file is queued for attach into PCC by heat promotion */
+	PCC_STATE_FL_PROMOTING		= 0x08,
 };
 
 struct lu_pcc_state {
@@ -1139,6 +1139,216 @@ static inline bool lfsck_assistant_req_empty(struct lfsck_assistant_data *lad)
 	return empty;
 }
 
+/* Is \a fid one of the \a nr FIDs \a fids? */
+static inline bool lfsck_assistant_fid_in(const struct lu_fid **fids, int nr,
+					  const struct lu_fid *fid)
+{
+	int i;
+
+	if (fid == NULL || fid_is_zero(fid))
+		return false;
+
+	for (i = 0; i < nr; i++) {
+		if (lu_fid_eq(fids[i], fid))
+			return true;
+	}
+
+	return false;
+}
+
+/**
+ * Pick the next request that can be handled now.
+ *
+ * The requests stay in the lad_req_list until they have been handled,
+ * so the head of the list is always the oldest unfinished request, that
+ * is what the la_fill_pos() relies on. A request is skipped if an older
+ * request that is being handled or has been skipped refers to the same
+ * parent or the same child, such as the OST-object claimed by two layouts
+ * in the multiple-referenced case. So the requests for the same parent are
+ * always handled in order, and no two threads repair the same object.
+ *
+ * The caller holds lad_lock.
+ *
+ * \param[in] lad	pointer to the assistant data
+ *
+ * \retval		the request to be handled
+ * \retval		NULL if no request can be handled now
+ */
+static struct lfsck_assistant_req *
+lfsck_assistant_req_pick(struct lfsck_assistant_data *lad)
+{
+	const struct lu_fid **fids = lad->lad_pick_fids;
+	struct lfsck_assistant_req *lar;
+	int nr = 0;
+
+	list_for_each_entry(lar, &lad->lad_req_list, lar_list) {
+		if (!lar->lar_busy &&
+		    !lfsck_assistant_fid_in(fids, nr,
+					    &lar->lar_parent->lso_fid) &&
+		    !lfsck_assistant_fid_in(fids, nr, lar->lar_child)) {
+			lar->lar_busy = 1;
+			return lar;
+		}
+
+		/* Too many requests in the way, wait for some of them. */
+		if (nr + 2 > LFSCK_PICK_FIDS)
+			break;
+
+		fids[nr++] = &lar->lar_parent->lso_fid;
+		if (lar->lar_child != NULL && !fid_is_zero(lar->lar_child))
+			fids[nr++] = lar->lar_child;
+	}
+
+	return NULL;
+}
+
+static void lfsck_assistant_req_done(const struct lu_env *env,
+				     struct lfsck_component *com,
+				     struct lfsck_assistant_req *lar)
+{
+	struct lfsck_assistant_data *lad = com->lc_data;
+	struct lfsck_bookmark *bk = &com->lc_lfsck->li_bookmark_ram;
+	bool wakeup = false;
+	bool wakeup_workers;
+
+	spin_lock(&lad->lad_lock);
+	list_del_init(&lar->lar_list);
+	lad->lad_prefetched--;
+	lad->lad_req_gen++;
+	/* Wake up the main engine thread only when the list
+	 * is empty or half of the prefetched items have been
+	 * handled to avoid too frequent thread schedule. */
+	if (lad->lad_prefetched <= (bk->lb_async_windows / 2))
+		wakeup = true;
+	/* The finished request may unblock others for the same parent. */
+	wakeup_workers = lad->lad_idle_workers > 0;
+	spin_unlock(&lad->lad_lock);
+	if (wakeup)
+		wake_up(&com->lc_lfsck->li_thread.t_ctl_waitq);
+	if (wakeup_workers)
+		wake_up_all(&lad->lad_thread.t_ctl_waitq);
+
+	lad->lad_ops->la_req_fini(env, lar);
+}
+
+/* Wait for some request to be queued or finished. */
+static void lfsck_assistant_wait_req(struct lfsck_assistant_data *lad)
+{
+	__u64 gen;
+
+	spin_lock(&lad->lad_lock);
+	gen = lad->lad_req_gen;
+	lad->lad_idle_workers++;
+	spin_unlock(&lad->lad_lock);
+
+	wait_event_idle_timeout(lad->lad_thread.t_ctl_waitq,
+				READ_ONCE(lad->lad_req_gen) != gen ||
+				test_bit(LAD_EXIT, &lad->lad_flags) ||
+				test_bit(LAD_STOP_WORKERS, &lad->lad_flags),
+				cfs_time_seconds(1));
+
+	spin_lock(&lad->lad_lock);
+	lad->lad_idle_workers--;
+	spin_unlock(&lad->lad_lock);
+}
+
+/**
+ * The helper thread of the LFSCK assistant.
+ *
+ * It handles the first-stage scanning requests together with the
+ * assistant thread, until the assistant stops it via LAD_STOP_WORKERS
+ * before the post or exit.
+ *
+ * \param[in] args	pointer to the lfsck_thread_args
+ *
+ * \retval		0 for success
+ * \retval		negative error number on failure
+ */
+static int lfsck_assistant_worker(void *args)
+{
+	struct lfsck_thread_args	*lta = args;
+	struct lu_env			*env = &lta->lta_env;
+	struct lfsck_component		*com = lta->lta_com;
+	struct lfsck_bookmark		*bk  = &lta->lta_lfsck->li_bookmark_ram;
+	struct lfsck_assistant_data	*lad = com->lc_data;
+	struct lfsck_assistant_req	*lar;
+	int				 rc  = 0;
+
+	while (!test_bit(LAD_STOP_WORKERS, &lad->lad_flags) &&
+	       !test_bit(LAD_EXIT, &lad->lad_flags)) {
+		spin_lock(&lad->lad_lock);
+		lar = lfsck_assistant_req_pick(lad);
+		spin_unlock(&lad->lad_lock);
+		if (lar == NULL) {
+			lfsck_assistant_wait_req(lad);
+			continue;
+		}
+
+		rc = lad->lad_ops->la_handler_p1(env, com, lar);
+		lfsck_assistant_req_done(env, com, lar);
+		if (rc < 0 && bk->lb_param & LPF_FAILOUT) {
+			spin_lock(&lad->lad_lock);
+			if (lad->lad_worker_status == 0)
+				lad->lad_worker_status = rc;
+			spin_unlock(&lad->lad_lock);
+			wake_up_all(&lad->lad_thread.t_ctl_waitq);
+			break;
+		}
+	}
+
+	/* The lta still holds the component, so the lad is valid here. */
+	if (atomic_dec_and_test(&lad->lad_workers))
+		wake_up_all(&lad->lad_thread.t_ctl_waitq);
+	lfsck_thread_args_fini(lta);
+
+	return rc;
+}
+
+static void lfsck_assistant_start_workers(struct lfsck_component *com)
+{
+	struct lfsck_instance		*lfsck = com->lc_lfsck;
+	struct lfsck_assistant_data	*lad   = com->lc_data;
+	int				 i;
+
+	if (!lad->lad_ops->la_parallel_p1)
+		return;
+
+	clear_bit(LAD_STOP_WORKERS, &lad->lad_flags);
+	for (i = 1; i < lfsck->li_assistant_threads; i++) {
+		struct lfsck_thread_args *lta;
+		struct task_struct *task;
+
+		lta = lfsck_thread_args_init(lfsck, com, NULL);
+		if (IS_ERR(lta))
+			break;
+
+		atomic_inc(&lad->lad_workers);
+		task = kthread_run(lfsck_assistant_worker, lta, "%s_%02d",
+				   lad->lad_name, i);
+		if (IS_ERR(task)) {
+			atomic_dec(&lad->lad_workers);
+			lfsck_thread_args_fini(lta);
+			CDEBUG(D_LFSCK, "%s: cannot start %s LFSCK assistant "
+			       "helper %d: rc = %ld\n",
+			       lfsck_lfsck2name(lfsck), lad->lad_name, i,
+			       PTR_ERR(task));
+			break;
+		}
+	}
+
+	CDEBUG(D_LFSCK, "%s: %s LFSCK assistant runs with %d helper threads\n",
+	       lfsck_lfsck2name(lfsck), lad->lad_name,
+	       atomic_read(&lad->lad_workers));
+}
+
+static void lfsck_assistant_stop_workers(struct lfsck_assistant_data *lad)
+{
+	set_bit(LAD_STOP_WORKERS, &lad->lad_flags);
+	wake_up_all(&lad->lad_thread.t_ctl_waitq);
+	wait_event_idle(lad->lad_thread.t_ctl_waitq,
+			atomic_read(&lad->lad_workers) == 0);
+}
+
 /**
  * Query the LFSCK status from the instatnces on remote servers.
  *
@@ -1613,36 +1823,31 @@ int lfsck_assistant_engine(void *args)
 	spin_unlock(&lad->lad_lock);
 	wake_up(&mthread->t_ctl_waitq);
 
+	lfsck_assistant_start_workers(com);
+
 	while (1) {
 		while (!list_empty(&lad->lad_req_list)) {
-			bool wakeup = false;
-
 			if (unlikely(test_bit(LAD_EXIT, &lad->lad_flags) ||
 				     !thread_is_running(mthread)))
 				GOTO(cleanup, rc = lad->lad_post_result);
 
-			lar = list_first_entry(&lad->lad_req_list,
-					       struct lfsck_assistant_req,
-					       lar_list);
-			/* Only the lfsck_assistant_engine thread itself can
-			 * remove the "lar" from the head of the list, LFSCK
-			 * engine thread only inserts other new "lar" at the
-			 * end of the list. So it is safe to handle current
-			 * "lar" without the spin_lock. */
-			rc = lao->la_handler_p1(env, com, lar);
+			if (unlikely(lad->lad_worker_status < 0))
+				GOTO(cleanup, rc = lad->lad_worker_status);
+
+			/* The LFSCK engine thread only inserts new "lar" at
+			 * the end of the list, and the "lar" being handled
+			 * stays in the list until done. */
 			spin_lock(&lad->lad_lock);
-			list_del_init(&lar->lar_list);
-			lad->lad_prefetched--;
-			/* Wake up the main engine thread only when the list
-			 * is empty or half of the prefetched items have been
-			 * handled to avoid too frequent thread schedule. */
-			if (lad->lad_prefetched <= (bk->lb_async_windows / 2))
-				wakeup = true;
+			lar = lfsck_assistant_req_pick(lad);
 			spin_unlock(&lad->lad_lock);
-			if (wakeup)
-				wake_up(&mthread->t_ctl_waitq);
+			if (lar == NULL) {
+				/* The others are being handled by helpers. */
+				lfsck_assistant_wait_req(lad);
+				continue;
+			}
 
-			lao->la_req_fini(env, lar);
+			rc = lao->la_handler_p1(env, com, lar);
+			lfsck_assistant_req_done(env, com, lar);
 			if (rc < 0 && bk->lb_param & LPF_FAILOUT)
 				GOTO(cleanup, rc);
 		}
@@ -1669,6 +1874,9 @@ int lfsck_assistant_engine(void *args)
 			clear_bit(LAD_TO_POST, &lad->lad_flags);
 			LASSERT(lad->lad_post_result > 0);
 
+			/* The first-stage scanning is done. */
+			lfsck_assistant_stop_workers(lad);
+
 			/* Wakeup the master engine to go ahead. */
 			wake_up(&mthread->t_ctl_waitq);
 
@@ -1754,6 +1962,8 @@ p2_next:
 	}
 
 cleanup:
+	lfsck_assistant_stop_workers(lad);
+
 	/* Cleanup the unfinished requests. */
 	spin_lock(&lad->lad_lock);
 	if (rc < 0)
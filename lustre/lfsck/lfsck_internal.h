@@ -45,6 +45,10 @@
 #include <lustre_linkea.h>
 
 #define LFSCK_CHECKPOINT_INTERVAL	60
+#define LFSCK_ASSISTANT_THREADS_MAX	32
+/* Parent and child FIDs of the requests an assistant thread may skip over to
+ * pick the next request to handle. */
+#define LFSCK_PICK_FIDS			(LFSCK_ASSISTANT_THREADS_MAX * 4)
 
 enum lfsck_flags {
 	/* Finish the first cycle scanning. */
@@ -744,6 +748,10 @@ struct lfsck_instance {
 	/* The flags when the lFSCK stopped or paused. */
 	__u32			  li_flags;
 
+	/* How many threads handle the assistant requests for each
+	 * component that supports it, not stored on disk. */
+	__u32			  li_assistant_threads;
+
 	unsigned int		  li_oit_over:1, /* oit is finished. */
 				  li_drop_dryrun:1, /* Ever dryrun, not now. */
 				  li_master:1, /* Master instance or not. */
@@ -778,6 +786,11 @@ struct lfsck_thread_args {
 struct lfsck_assistant_req {
 	struct list_head		 lar_list;
 	struct lfsck_assistant_object	*lar_parent;
+	/* The object the request checks on behalf of the parent, such as
+	 * the OST-object or the name entry target, NULL if none. */
+	const struct lu_fid		*lar_child;
+	/* Being handled by some assistant thread, protected by lad_lock. */
+	unsigned int			 lar_busy:1;
 };
 
 struct lfsck_namespace_req {
@@ -822,6 +835,10 @@ struct lfsck_assistant_operations {
 	void (*la_sync_failures)(const struct lu_env *env,
 				 struct lfsck_component *com,
 				 struct lfsck_request *lr);
+
+	/* The la_handler_p1() can handle the requests for different
+	 * parents in parallel by several assistant threads. */
+	bool la_parallel_p1;
 };
 
 struct lfsck_assistant_data {
@@ -858,6 +875,22 @@ struct lfsck_assistant_data {
 	__u32					 lad_touch_gen;
 	int					 lad_prefetched;
 	int					 lad_assistant_status;
+
+	/* The helper threads of the assistant for the first-stage
+	 * scanning, see lfsck_assistant_worker(). */
+	atomic_t				 lad_workers;
+	/* How many assistant threads are waiting for new requests. */
+	int					 lad_idle_workers;
+	/* Changed each time a request is queued or finished. */
+	__u64					 lad_req_gen;
+	/* FIDs of the parents and children of the requests that are ahead
+	 * of the one being picked, see lfsck_assistant_req_pick(),
+	 * protected by lad_lock. */
+	const struct lu_fid			*lad_pick_fids[LFSCK_PICK_FIDS];
+	/* Serializes the parts of la_handler_p1() that cannot run in
+	 * parallel, used by the namespace assistant. */
+	struct mutex				 lad_p1_mutex;
+	int					 lad_worker_status;
 	int					 lad_post_result;
 	unsigned long				 lad_flags;
 	bool					 lad_advance_lock;
@@ -868,6 +901,7 @@ enum {
 	LAD_IN_DOUBLE_SCAN = 2,
 	LAD_EXIT = 3,
 	LAD_INCOMPLETE = 4,
+	LAD_STOP_WORKERS = 5,
 };
 
 #define LFSCK_TMPBUF_LEN	64
@@ -960,6 +994,10 @@ void lfsck_pos_fill(const struct lu_env *env, struct lfsck_instance *lfsck,
 bool __lfsck_set_speed(struct lfsck_instance *lfsck, __u32 limit);
 void lfsck_control_speed(struct lfsck_instance *lfsck);
 void lfsck_control_speed_by_self(struct lfsck_component *com);
+struct lfsck_thread_args *
+lfsck_thread_args_init(struct lfsck_instance *lfsck,
+		       struct lfsck_component *com,
+		       struct lfsck_start_param *lsp);
 void lfsck_thread_args_fini(struct lfsck_thread_args *lta);
 struct lfsck_assistant_data *
 lfsck_assistant_data_init(const struct lfsck_assistant_operations *lao,
@@ -1434,6 +1472,25 @@ static inline bool lfsck_phase2_next_ready(struct lfsck_assistant_data *lad)
 		list_empty(&lad->lad_ost_phase1_list));
 }
 
+/**
+ * Queue the request for the LFSCK assistant.
+ *
+ * The caller holds lad_lock.
+ *
+ * \retval		true if the assistant thread(s) need to be woken up
+ */
+static inline bool lfsck_assistant_req_add(struct lfsck_assistant_data *lad,
+					   struct lfsck_assistant_req *lar)
+{
+	bool wakeup = lad->lad_prefetched == 0 || lad->lad_idle_workers > 0;
+
+	list_add_tail(&lar->lar_list, &lad->lad_req_list);
+	lad->lad_prefetched++;
+	lad->lad_req_gen++;
+
+	return wakeup;
+}
+
 static inline void lfsck_lad_set_bitmap(const struct lu_env *env,
 					struct lfsck_component *com,
 					__u32 index)
@@ -197,6 +197,7 @@ lfsck_layout_assistant_req_init(struct lfsck_assistant_object *lso,
 
 	INIT_LIST_HEAD(&llr->llr_lar.lar_list);
 	llr->llr_lar.lar_parent = lfsck_assistant_object_get(lso);
+	llr->llr_lar.lar_child = lfsck_dto2fid(child);
 	llr->llr_child = child;
 	llr->llr_comp_id = comp_id;
 	llr->llr_ost_idx = ost_idx;
@@ -5737,11 +5738,7 @@ static int lfsck_layout_scan_stripes(const struct lu_env *env,
 			RETURN(lad->lad_assistant_status);
 		}
 
-		list_add_tail(&llr->llr_lar.lar_list, &lad->lad_req_list);
-		if (lad->lad_prefetched == 0)
-			wakeup = true;
-
-		lad->lad_prefetched++;
+		wakeup = lfsck_assistant_req_add(lad, &llr->llr_lar);
 		spin_unlock(&lad->lad_lock);
 		if (wakeup)
 			wake_up(&athread->t_ctl_waitq);
@@ -7034,6 +7031,7 @@ const struct lfsck_assistant_operations lfsck_layout_assistant_ops = {
 	.la_double_scan_result	= lfsck_layout_double_scan_result,
 	.la_req_fini		= lfsck_layout_assistant_req_fini,
 	.la_sync_failures	= lfsck_layout_assistant_sync_failures,
+	.la_parallel_p1		= true,
 };
 
 int lfsck_layout_setup(const struct lu_env *env, struct lfsck_instance *lfsck)
@@ -1922,7 +1922,7 @@ void lfsck_control_speed_by_self(struct lfsck_component *com)
 	}
 }
 
-static struct lfsck_thread_args *
+struct lfsck_thread_args *
 lfsck_thread_args_init(struct lfsck_instance *lfsck,
 		       struct lfsck_component *com,
 		       struct lfsck_start_param *lsp)
@@ -1982,6 +1982,8 @@ lfsck_assistant_data_init(const struct lfsck_assistant_operations *lao,
 		INIT_LIST_HEAD(&lad->lad_mdt_phase1_list);
 		INIT_LIST_HEAD(&lad->lad_mdt_phase2_list);
 		init_waitqueue_head(&lad->lad_thread.t_ctl_waitq);
+		atomic_set(&lad->lad_workers, 0);
+		mutex_init(&lad->lad_p1_mutex);
 		lad->lad_ops = lao;
 		lad->lad_name = name;
 	}
@@ -2534,6 +2536,7 @@ int lfsck_start_assistant(const struct lu_env *env, struct lfsck_component *com,
 	ENTRY;
 
 	lad->lad_assistant_status = 0;
+	lad->lad_worker_status = 0;
 	lad->lad_post_result = 0;
 	lad->lad_flags = 0;
 	lad->lad_advance_lock = false;
@@ -2872,6 +2875,60 @@ int lfsck_set_windows(struct dt_device *key, unsigned int val)
 }
 EXPORT_SYMBOL(lfsck_set_windows);
 
+int lfsck_get_assistant_threads(char *buf, struct dt_device *key)
+{
+	struct lu_env		env;
+	struct lfsck_instance  *lfsck;
+	int			rc;
+	ENTRY;
+
+	rc = lu_env_init(&env, LCT_MD_THREAD | LCT_DT_THREAD);
+	if (rc != 0)
+		RETURN(rc);
+
+	lfsck = lfsck_instance_find(key, true, false);
+	if (likely(lfsck != NULL)) {
+		rc = sprintf(buf, "%u\n", lfsck->li_assistant_threads);
+		lfsck_instance_put(&env, lfsck);
+	} else {
+		rc = -ENXIO;
+	}
+
+	lu_env_fini(&env);
+
+	RETURN(rc);
+}
+EXPORT_SYMBOL(lfsck_get_assistant_threads);
+
+int lfsck_set_assistant_threads(struct dt_device *key, unsigned int val)
+{
+	struct lu_env		env;
+	struct lfsck_instance  *lfsck;
+	int			rc;
+	ENTRY;
+
+	if (val < 1 || val > LFSCK_ASSISTANT_THREADS_MAX)
+		RETURN(-ERANGE);
+
+	rc = lu_env_init(&env, LCT_MD_THREAD | LCT_DT_THREAD);
+	if (rc != 0)
+		RETURN(rc);
+
+	lfsck = lfsck_instance_find(key, true, false);
+	if (likely(lfsck != NULL)) {
+		/* Takes effect when the LFSCK starts next time. */
+		lfsck->li_assistant_threads = val;
+		lfsck_instance_put(&env, lfsck);
+	} else {
+		rc = -ENXIO;
+	}
+
+	lu_env_fini(&env);
+
+	RETURN(rc);
+}
+EXPORT_SYMBOL(lfsck_set_assistant_threads);
+
 int lfsck_dump(struct seq_file *m, struct dt_device *key, enum lfsck_type type)
 {
 	struct lu_env		env;
@@ -3686,6 +3743,7 @@ int lfsck_register(const struct lu_env *env, struct dt_device *key,
 	atomic_set(&lfsck->li_ref, 1);
 	atomic_set(&lfsck->li_double_scan_count, 0);
 	init_waitqueue_head(&lfsck->li_thread.t_ctl_waitq);
+	lfsck->li_assistant_threads = 1;
 	lfsck->li_out_notify = notify;
 	lfsck->li_out_notify_data = notify_data;
 	lfsck->li_next = next;
@@ -74,6 +74,7 @@ lfsck_namespace_assistant_req_init(struct lfsck_instance *lfsck,
 	lnr->lnr_lar.lar_parent = lfsck_assistant_object_get(lso);
 	lnr->lnr_lmv = lfsck_lmv_get(lfsck->li_lmv);
 	lnr->lnr_fid = ent->lde_fid;
+	lnr->lnr_lar.lar_child = &lnr->lnr_fid;
 	lnr->lnr_dir_cookie = ent->lde_hash;
 	lnr->lnr_attr = ent->lde_attrs;
 	lnr->lnr_size = size;
@@ -4368,11 +4369,7 @@ static void lfsck_namespace_close_dir(const struct lu_env *env,
 		RETURN_EXIT;
 	}
 
-	list_add_tail(&lnr->lnr_lar.lar_list, &lad->lad_req_list);
-	if (lad->lad_prefetched == 0)
-		wakeup = true;
-
-	lad->lad_prefetched++;
+	wakeup = lfsck_assistant_req_add(lad, &lnr->lnr_lar);
 	spin_unlock(&lad->lad_lock);
 	if (wakeup)
 		wake_up(&lad->lad_thread.t_ctl_waitq);
@@ -4713,11 +4710,7 @@ static int lfsck_namespace_exec_dir(const struct lu_env *env,
 		return lad->lad_assistant_status;
 	}
 
-	list_add_tail(&lnr->lnr_lar.lar_list, &lad->lad_req_list);
-	if (lad->lad_prefetched == 0)
-		wakeup = true;
-
-	lad->lad_prefetched++;
+	wakeup = lfsck_assistant_req_add(lad, &lnr->lnr_lar);
 	spin_unlock(&lad->lad_lock);
 	if (wakeup)
 		wake_up(&lad->lad_thread.t_ctl_waitq);
@@ -5572,9 +5565,9 @@ log:
 	return rc;
 }
 
-static int lfsck_namespace_assistant_handler_p1(const struct lu_env *env,
-						struct lfsck_component *com,
-						struct lfsck_assistant_req *lar)
+static int lfsck_namespace_assistant_repair_p1(const struct lu_env *env,
+					       struct lfsck_component *com,
+					       struct lfsck_assistant_req *lar)
 {
 	struct lfsck_thread_info   *info     = lfsck_env_info(env);
 	struct lu_attr		   *la	     = &info->lti_la;
@@ -6096,6 +6089,138 @@ trace:
 	return rc;
 }
 
+/**
+ * Verify a name entry without repairing it.
+ *
+ * Most name entries are consistent: the target object exists, has the type
+ * claimed by the name entry and its linkEA references the name entry. Then
+ * nothing but the multiple-linked counter is updated, under lc_sem, so that
+ * can be verified by several assistant threads in parallel, including the
+ * linkEA RPCs to remote MDTs. Anything else is left to the full handler
+ * lfsck_namespace_assistant_repair_p1(), which runs serialized.
+ *
+ * \param[in] env	pointer to the thread context
+ * \param[in] com	pointer to the lfsck component
+ * \param[in] lnr	pointer to the namespace request
+ *
+ * \retval		1 if the name entry is consistent and accounted
+ * \retval		0 if it has to be handled by the full handler
+ */
+static int lfsck_namespace_assistant_check_p1(const struct lu_env *env,
+					      struct lfsck_component *com,
+					      struct lfsck_namespace_req *lnr)
+{
+	struct lfsck_thread_info	*info  = lfsck_env_info(env);
+	struct lu_attr			*la    = &info->lti_la;
+	struct lfsck_instance		*lfsck = com->lc_lfsck;
+	struct lfsck_namespace		*ns    = com->lc_file_ram;
+	struct lfsck_assistant_object	*lso   = lnr->lnr_lar.lar_parent;
+	struct linkea_data		 ldata = { NULL };
+	const struct lu_name		*cname;
+	struct lfsck_tgt_desc		*ltd;
+	struct dt_device		*dev;
+	struct dt_object		*obj;
+	int				 count;
+	int				 idx;
+	int				 rc = 0;
+
+	if (lso->lso_dead)
+		return 1;
+
+	if (lnr->lnr_attr & (LUDA_UPGRADE | LUDA_REPAIR) ||
+	    lnr->lnr_dir_cookie == MDS_DIR_END_OFF ||
+	    !fid_is_sane(&lnr->lnr_fid) ||
+	    fid_seq_is_dot(fid_seq(&lnr->lnr_fid)) ||
+	    name_is_dot_or_dotdot(lnr->lnr_name, lnr->lnr_namelen) ||
+	    (lnr->lnr_lmv != NULL && lnr->lnr_lmv->ll_lmv_master) ||
+	    !lfsck_is_valid_slave_name_entry(env, lnr->lnr_lmv,
+					     lnr->lnr_name, lnr->lnr_namelen))
+		return 0;
+
+	idx = lfsck_find_mdt_idx_by_fid(env, lfsck, &lnr->lnr_fid);
+	if (idx < 0)
+		return 0;
+
+	if (idx == lfsck_dev_idx(lfsck)) {
+		dev = lfsck->li_bottom;
+	} else {
+		ltd = lfsck_ltd2tgt(&lfsck->li_mdt_descs, idx);
+		if (unlikely(ltd == NULL))
+			return 0;
+
+		dev = ltd->ltd_tgt;
+	}
+
+	obj = lfsck_object_find_by_dev(env, dev, &lnr->lnr_fid);
+	if (IS_ERR(obj))
+		return 0;
+
+	if (dt_object_exists(obj) == 0)
+		GOTO(put, rc = 0);
+
+	if (lfsck_links_read(env, obj, &ldata) != 0)
+		GOTO(put, rc = 0);
+
+	count = ldata.ld_leh->leh_reccount;
+	cname = lfsck_name_get_const(env, lnr->lnr_name, lnr->lnr_namelen);
+	if (linkea_links_find(&ldata, cname, &lso->lso_fid) != 0 ||
+	    (count != 1 && S_ISDIR(lfsck_object_type(obj))) ||
+	    (lfsck_object_type(obj) & S_IFMT) != lnr->lnr_type)
+		GOTO(put, rc = 0);
+
+	la->la_nlink = 0;
+	if (count == 1 && S_ISREG(lfsck_object_type(obj)))
+		dt_attr_get(env, obj, la);
+
+	down_write(&com->lc_sem);
+	if (count > 1 || la->la_nlink > 1)
+		ns->ln_mul_linked_checked++;
+	up_write(&com->lc_sem);
+	rc = 1;
+
+	GOTO(put, rc);
+
+put:
+	lfsck_object_put(env, obj);
+
+	return rc;
+}
+
+/**
+ * Handle the name entry that is not verified by the quick check.
+ *
+ * The name entries that are consistent are checked in parallel, see
+ * lfsck_namespace_assistant_check_p1(). The others may be repaired by
+ * lfsck_namespace_assistant_repair_p1(), which updates the namespace
+ * LFSCK flags and counters, so only one assistant thread runs it at a
+ * time, under lad_p1_mutex.
+ *
+ * \param[in] env	pointer to the thread context
+ * \param[in] com	pointer to the lfsck component
+ * \param[in] lar	pointer to the namespace request
+ *
+ * \retval		0 for success
+ * \retval		negative error number on failure
+ */
+static int lfsck_namespace_assistant_handler_p1(const struct lu_env *env,
+						struct lfsck_component *com,
+						struct lfsck_assistant_req *lar)
+{
+	struct lfsck_namespace_req *lnr =
+		container_of(lar, struct lfsck_namespace_req, lnr_lar);
+	struct lfsck_assistant_data *lad = com->lc_data;
+	int rc;
+
+	if (lfsck_namespace_assistant_check_p1(env, com, lnr) > 0)
+		return 0;
+
+	mutex_lock(&lad->lad_p1_mutex);
+	rc = lfsck_namespace_assistant_repair_p1(env, com, lar);
+	mutex_unlock(&lad->lad_p1_mutex);
+
+	return rc;
+}
+
 /**
  * Handle one orphan under the backend /lost+found directory
  *
@@ -6886,6 +7011,7 @@ const struct lfsck_assistant_operations lfsck_namespace_assistant_ops = {
 	.la_double_scan_result	= lfsck_namespace_double_scan_result,
 	.la_req_fini		= lfsck_namespace_assistant_req_fini,
 	.la_sync_failures	= lfsck_namespace_assistant_sync_failures,
+	.la_parallel_p1		= true,
 };
 
 /**
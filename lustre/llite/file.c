@@ -861,6 +861,13 @@ int ll_file_open(struct inode *inode, struct file *file)
 	fd->fd_file = file;
 	if (S_ISDIR(inode->i_mode))
 		ll_authorize_statahead(inode, fd);
+#ifdef FMODE_NOWAIT
+	/* allow io_uring to issue inline IOCB_NOWAIT I/O instead of
+	 * punting every request to io-wq threads
+	 */
+	else if (S_ISREG(inode->i_mode))
+		file->f_mode |= FMODE_NOWAIT;
+#endif
 
 	ll_track_file_opens(inode);
 	if (is_root_inode(inode)) {
@@ -2074,6 +2081,15 @@ fini_io:
 	kms = attr->cat_kms;
 	/* if read beyond end-of-file, adjust read count */
 	if (kms > 0 && (iocb->ki_pos >= kms || read_end > kms)) {
+		int flags = iocb_ki_flags_get(file, iocb);
+
+		/* glimpse needs an RPC, let a blocking context redo buffered
+		 * reads. Direct I/O sends RPCs anyway, so it is exempt just
+		 * like in ll_file_read_iter().
+		 */
+		if (ll_iocb_nowait(flags) && !iocb_ki_flags_check(flags, DIRECT))
+			RETURN(-EAGAIN);
+
 		rc = ll_glimpse_size(inode);
 		if (rc != 0)
 			return rc;
@@ -2104,12 +2120,14 @@ static ssize_t ll_file_read_iter(struct kiocb *iocb, struct iov_iter *to)
 	struct lu_env *env;
 	struct vvp_io_args *args;
 	struct file *file = iocb->ki_filp;
+	struct ll_file_data *fd = file->private_data;
 	ssize_t result;
 	ssize_t rc2;
 	__u16 refcheck;
 	ktime_t kstart = ktime_get();
 	bool cached;
 	bool stale_data = false;
+	int flags;
 
 	ENTRY;
 
@@ -2142,7 +2160,14 @@ static ssize_t ll_file_read_iter(struct kiocb *iocb, struct iov_iter *to)
 	 * data.
 	 * TODO: for RO-PCC (readonly PCC), fall back to normal read
 	 * path: read data from data copy on OSTs.
+	 *
+	 * PCC I/O may wait for the PCC inode lock and the PCC backend, so
+	 * leave it to the blocking retry for IOCB_NOWAIT.
 	 */
+	flags = iocb_ki_flags_get(file, iocb);
+	if (ll_iocb_nowait(flags) && fd->fd_pcc_file.pccf_file)
+		GOTO(out, result = -EAGAIN);
+
 	result = pcc_file_read_iter(iocb, to, &cached);
 	if (cached)
 		GOTO(out, result);
@@ -2153,6 +2178,13 @@ static ssize_t ll_file_read_iter(struct kiocb *iocb, struct iov_iter *to)
 	if (result < 0 || iov_iter_count(to) == 0)
 		GOTO(out, result);
 
+	/* For IOCB_NOWAIT only the cached part can be returned, the caller
+	 * (e.g. io_uring) will retry the rest from a context that may block.
+	 * Direct I/O is lockless and async for such a kiocb, so let it go.
+	 */
+	if (ll_iocb_nowait(flags) && !iocb_ki_flags_check(flags, DIRECT))
+		GOTO(out, result = result ?: -EAGAIN);
+
 	args = ll_env_args(env);
 	args->u.normal.via_iter = to;
 	args->u.normal.via_iocb = iocb;
@@ -2227,8 +2259,12 @@ static ssize_t ll_do_tiny_write(struct kiocb *iocb, struct iov_iter *iter)
 	    (iocb->ki_pos & (PAGE_SIZE-1)) + count > PAGE_SIZE)
 		RETURN(0);
 
-	if (unlikely(lock_inode))
+	if (unlikely(lock_inode)) {
+		/* the inode lock may be held over a whole write */
+		if (ll_iocb_nowait(iocb_ki_flags_get(file, iocb)))
+			RETURN(-EAGAIN);
 		ll_inode_lock(inode);
+	}
 	result = __generic_file_write_iter(iocb, iter);
 
 	if (unlikely(lock_inode))
@@ -2306,6 +2342,10 @@ static ssize_t ll_file_write_iter(struct kiocb *iocb, struct iov_iter *from)
 	if (iov_iter_count(from) == 0)
 		GOTO(out, rc_normal = rc_tiny);
 
+	/* buffered write may wait for grant, page locks or DLM locks */
+	if (ll_iocb_nowait(flags) && !iocb_ki_flags_check(flags, DIRECT))
+		GOTO(out, rc_normal = rc_tiny > 0 ? rc_tiny : -EAGAIN);
+
 	env = cl_env_get(&refcheck);
 	if (IS_ERR(env))
 		RETURN(PTR_ERR(env));
@@ -3999,6 +4039,64 @@ out:
 	RETURN(rc);
 }
 
+/**
+ * Attach \a file into the RW-PCC dataset \a archive_id and close the write
+ * lease \a och with the MDS_PCC_ATTACH intent.
+ *
+ * \param rc2 [in]		error found by the caller before the attach, in
+ *				which case the lease is only closed
+ * \param lease_broken [out]	whether the lease was broken meanwhile
+ *
+ * \retval 0		success
+ * \retval <0		failure, the PCC copy is dropped
+ */
+static int ll_lease_close_pcc_attach(struct file *file,
+				     struct obd_client_handle *och,
+				     __u32 archive_id, int rc2,
+				     bool *lease_broken)
+{
+	struct inode *inode = file_inode(file);
+	struct pcc_param param = { .pa_archive_id = archive_id };
+	enum mds_op_bias bias = 0;
+	bool attached = false;
+	void *data = NULL;
+	int rc;
+
+	ENTRY;
+
+	if (rc2)
+		GOTO(out_lease_close, rc2);
+
+	rc2 = pcc_readwrite_attach(file, inode, archive_id);
+	if (rc2)
+		GOTO(out_lease_close, rc2);
+
+	attached = true;
+	/* Grab latest data version */
+	rc2 = ll_data_version(inode, &param.pa_data_version, LL_DV_WR_FLUSH);
+	if (rc2)
+		GOTO(out_lease_close, rc2);
+
+	data = &param;
+	bias = MDS_PCC_ATTACH;
+
+out_lease_close:
+	rc = ll_lease_close_intent(och, inode, lease_broken, bias, data);
+	if (rc < 0)
+		GOTO(out, rc);
+
+	rc = ll_lease_och_release(inode, file);
+	if (rc < 0)
+		GOTO(out, rc);
+
+	EXIT;
+out:
+	if (!rc)
+		rc = rc2;
+	return pcc_readwrite_attach_fini(file, inode, param.pa_layout_gen,
+					 *lease_broken, rc, attached);
+}
+
 static long ll_file_unlock_lease(struct file *file, struct ll_ioc_lease *ioc,
 				 void __user *uarg)
 {
@@ -4007,7 +4105,6 @@ static long ll_file_unlock_lease(struct file *file, struct ll_ioc_lease *ioc,
 	struct ll_inode_info *lli = ll_i2info(inode);
 	struct obd_client_handle *och = NULL;
 	struct split_param sp;
-	struct pcc_param param;
 	bool lease_broken = false;
 	fmode_t fmode = 0;
 	enum mds_op_bias bias = 0;
@@ -4015,7 +4112,6 @@ static long ll_file_unlock_lease(struct file *file, struct ll_ioc_lease *ioc,
 	struct file *layout_file = NULL;
 	void *data = NULL;
 	size_t data_size = 0;
-	bool attached = false;
 	long rc, rc2 = 0;
 
 	ENTRY;
@@ -4093,7 +4189,9 @@ static long ll_file_unlock_lease(struct file *file, struct ll_ioc_lease *ioc,
 		bias = MDS_CLOSE_LAYOUT_SPLIT;
 		break;
 	}
-	case LL_LEASE_PCC_ATTACH:
+	case LL_LEASE_PCC_ATTACH: {
+		__u32 archive_id = 0;
+
 		if (ioc->lil_count != 1)
 			RETURN(-EINVAL);
 
@@ -4101,23 +4199,15 @@ static long ll_file_unlock_lease(struct file *file, struct ll_ioc_lease *ioc,
 			RETURN(-EOPNOTSUPP);
 
 		uarg += sizeof(*ioc);
-		if (copy_from_user(&param.pa_archive_id, uarg, sizeof(__u32)))
-			GOTO(out_lease_close, rc2 = -EFAULT);
-
-		rc2 = pcc_readwrite_attach(file, inode, param.pa_archive_id);
-		if (rc2)
-			GOTO(out_lease_close, rc2);
-
-		attached = true;
-		/* Grab latest data version */
-		rc2 = ll_data_version(inode, &param.pa_data_version,
-				     LL_DV_WR_FLUSH);
-		if (rc2)
-			GOTO(out_lease_close, rc2);
+		if (copy_from_user(&archive_id, uarg, sizeof(__u32)))
+			rc2 = -EFAULT;
 
-		data = &param;
-		bias = MDS_PCC_ATTACH;
-		break;
+		rc = ll_lease_close_pcc_attach(file, och, archive_id, rc2,
+					       &lease_broken);
+		if (lease_broken)
+			fmode = 0;
+		GOTO(out, rc);
+	}
 	default:
 		/* without close intent */
 		break;
@@ -4143,15 +4233,6 @@ out:
 	if (layout_file)
 		fput(layout_file);
 
-	if (ioc->lil_flags == LL_LEASE_PCC_ATTACH) {
-		if (!rc)
-			rc = rc2;
-		rc = pcc_readwrite_attach_fini(file, inode,
-					       param.pa_layout_gen,
-					       lease_broken, rc,
-					       attached);
-	}
-
 	ll_layout_refresh(inode, &fd->fd_layout_version);
 
 	if (!rc)
@@ -4159,6 +4240,37 @@ out:
 	RETURN(rc);
 }
 
+/**
+ * Attach \a file into the RW-PCC dataset \a archive_id under a write lease,
+ * the same way as "lfs pcc attach" does with LL_LEASE_PCC_ATTACH, but from
+ * kernel context. Used for heat based promotion of files into PCC.
+ */
+int ll_file_pcc_attach(struct file *file, __u32 archive_id)
+{
+	struct inode *inode = file_inode(file);
+	struct ll_file_data *fd = file->private_data;
+	struct obd_client_handle *och;
+	bool lease_broken = false;
+	int rc;
+
+	ENTRY;
+
+	if (IS_ENCRYPTED(inode))
+		RETURN(-EOPNOTSUPP);
+
+	och = ll_lease_open(inode, file, FMODE_WRITE, 0);
+	if (IS_ERR(och))
+		RETURN(PTR_ERR(och));
+
+	rc = ll_lease_close_pcc_attach(file, och, archive_id, 0,
+				       &lease_broken);
+	if (!rc && lease_broken)
+		rc = -EBUSY;
+	ll_layout_refresh(inode, &fd->fd_layout_version);
+
+	RETURN(rc);
+}
+
 static long ll_file_set_lease(struct file *file, struct ll_ioc_lease *ioc,
 			      void __user *uarg)
 {
@@ -4242,6 +4354,23 @@ static void ll_heat_get(struct inode *inode, struct lu_heat *heat)
 	spin_unlock(&lli->lli_heat_lock);
 }
 
+/* Return the current value of one type of heat of \a inode */
+__u64 ll_file_heat_get(struct inode *inode, enum obd_heat_type type)
+{
+	struct ll_inode_info *lli = ll_i2info(inode);
+	struct ll_sb_info *sbi = ll_i2sbi(inode);
+	__u64 now = ktime_get_real_seconds();
+	__u64 heat;
+
+	spin_lock(&lli->lli_heat_lock);
+	heat = obd_heat_get(&lli->lli_heat_instances[type], now,
+			    sbi->ll_heat_decay_weight,
+			    sbi->ll_heat_period_second);
+	spin_unlock(&lli->lli_heat_lock);
+
+	return heat;
+}
+
 static int ll_heat_set(struct inode *inode, enum lu_heat_flag flags)
 {
 	struct ll_inode_info *lli = ll_i2info(inode);
@@ -297,6 +297,8 @@ struct ll_inode_info {
 			__u64			 lli_pcc_generation;
 			enum pcc_dataset_flags	 lli_pcc_dsflags;
 			struct pcc_inode	*lli_pcc_inode;
+			/* last try to promote the file into PCC by heat */
+			time64_t		 lli_pcc_promote_time;
 
 			struct mutex		 lli_group_mutex;
 			__u64			 lli_group_users;
@@ -362,6 +364,18 @@ struct ll_inode_info {
 #define ki_flag(name) O_ ## name
 #endif
 
+/* IOCB_NOWAIT (io_uring inline submission, RWF_NOWAIT) must not block on
+ * DLM locks or OST RPCs, so buffered I/O is only served from page cache.
+ */
+static inline bool ll_iocb_nowait(int flags)
+{
+#ifdef IOCB_NOWAIT
+	return iocb_ki_flags_check(flags, NOWAIT);
+#else
+	return false;
+#endif
+}
+
 static inline void ll_trunc_sem_init(struct ll_trunc_sem *sem)
 {
 	atomic_set(&sem->ll_trunc_readers, 0);
@@ -520,6 +534,9 @@ int ll_xattr_cache_get(struct inode *inode,
 		       size_t size,
 		       __u64 valid);
 
+int ll_xattr_cache_prefetch(struct inode *inode);
+int ll_xattr_cache_install(struct inode *inode, struct lookup_intent *it,
+			   struct req_capsule *pill);
 int ll_xattr_cache_insert(struct inode *inode,
 			  const char *name,
 			  char *buffer,
@@ -825,6 +842,7 @@ enum ll_sbi_flags {
 	LL_SBI_PARALLEL_DIO,		/* parallel (async) O_DIRECT RPCs */
 	LL_SBI_ENCRYPT_NAME,		/* name encryption */
 	LL_SBI_UNALIGNED_DIO,		/* unaligned DIO */
+	LL_SBI_SA_XATTR,		/* prefetch xattrs with statahead */
 	LL_SBI_NUM_FLAGS
 };
 
@@ -912,6 +930,7 @@ struct ll_sb_info {
 	atomic_t		  ll_sa_running; /* running statahead thread
 						  * count */
 	atomic_t		  ll_agl_total;  /* AGL thread started count */
+	atomic_t		  ll_sa_xattr_total; /* xattr caches prefetched */
 	atomic_t		  ll_sa_hit_total;  /* total hit count */
 	atomic_t		  ll_sa_miss_total; /* total miss count */
 	/* statahead thread count started for directory traversing pattern. */
@@ -1396,6 +1415,8 @@ int __ll_fid2path(struct inode *inode, struct getinfo_fid2path *gfout,
 		  size_t outsize, __u32 pathlen_orig);
 int ll_data_version(struct inode *inode, __u64 *data_version, int flags);
 int ll_hsm_release(struct inode *inode);
+int ll_file_pcc_attach(struct file *file, __u32 archive_id);
+__u64 ll_file_heat_get(struct inode *inode, enum obd_heat_type type);
 int ll_hsm_state_set(struct inode *inode, struct hsm_state_set *hss);
 void ll_io_set_mirror(struct cl_io *io, const struct file *file);
 
@@ -1751,6 +1772,9 @@ struct ll_statahead_info {
 	wait_queue_head_t	sai_waitq;	/* stat-ahead wait queue */
 	struct task_struct	*sai_task;	/* stat-ahead thread */
 	struct task_struct	*sai_agl_task;	/* AGL thread */
+	unsigned int		sai_agl_glimpse:1, /* AGL glimpses files */
+				sai_agl_xattr:1,   /* AGL prefetches xattrs */
+				sai_xattr_batch:1; /* getxattr batched too */
 	struct list_head	sai_entries;    /* completed entries */
 	struct list_head	sai_agls;	/* AGLs to be sent */
 	atomic_t		sai_cache_count; /* entry count in cache */
@@ -190,6 +190,7 @@ static struct ll_sb_info *ll_init_sbi(struct lustre_sb_info *lsi)
 	atomic_set(&sbi->ll_sa_wrong, 0);
 	atomic_set(&sbi->ll_sa_running, 0);
 	atomic_set(&sbi->ll_agl_total, 0);
+	atomic_set(&sbi->ll_sa_xattr_total, 0);
 	atomic_set(&sbi->ll_sa_hit_total, 0);
 	atomic_set(&sbi->ll_sa_miss_total, 0);
 	atomic_set(&sbi->ll_sa_list_total, 0);
@@ -362,7 +363,8 @@ static int client_common_fill_super(struct super_block *sb, char *md, char *dt)
 				   OBD_CONNECT2_ATOMIC_OPEN_LOCK |
 				   OBD_CONNECT2_BATCH_RPC |
 				   OBD_CONNECT2_DMV_IMP_INHERIT |
-				   OBD_CONNECT2_UNALIGNED_DIO;
+				   OBD_CONNECT2_UNALIGNED_DIO |
+				   OBD_CONNECT2_BATCH_GETXATTR;
 
 #ifdef HAVE_LRU_RESIZE_SUPPORT
 	if (test_bit(LL_SBI_LRU_RESIZE, sbi->ll_flags))
@@ -969,6 +971,9 @@ void ll_kill_super(struct super_block *sb)
 		while (atomic_read(&sbi->ll_sa_running) > 0)
 			schedule_timeout_uninterruptible(
 				cfs_time_seconds(1) >> 3);
+
+		/* PCC demotion holds inode references */
+		pcc_super_stop(&sbi->ll_pcc_super);
 	}
 
 	EXIT;
@@ -1021,6 +1026,7 @@ static const match_table_t ll_sbi_flags_name = {
 	{LL_SBI_PARALLEL_DIO,		"parallel_dio"},
 	{LL_SBI_ENCRYPT_NAME,		"name_encrypt"},
 	{LL_SBI_UNALIGNED_DIO,		"unaligned_dio"},
+	{LL_SBI_SA_XATTR,		"statahead_xattr"},
 };
 
 int ll_sbi_flags_seq_show(struct seq_file *m, void *v)
@@ -1278,6 +1284,7 @@ void ll_lli_init(struct ll_inode_info *lli)
 		lli->lli_pcc_inode = NULL;
 		lli->lli_pcc_dsflags = PCC_DATASET_INVALID;
 		lli->lli_pcc_generation = 0;
+		lli->lli_pcc_promote_time = 0;
 		mutex_init(&lli->lli_group_mutex);
 		lli->lli_group_users = 0;
 		lli->lli_group_gid = 0;
@@ -975,6 +975,40 @@ static ssize_t statahead_agl_store(struct kobject *kobj,
 }
 LUSTRE_RW_ATTR(statahead_agl);
 
+static ssize_t statahead_xattr_show(struct kobject *kobj,
+				    struct attribute *attr,
+				    char *buf)
+{
+	struct ll_sb_info *sbi = container_of(kobj, struct ll_sb_info,
+					      ll_kset.kobj);
+
+	return scnprintf(buf, PAGE_SIZE, "%u\n",
+			 test_bit(LL_SBI_SA_XATTR, sbi->ll_flags));
+}
+
+static ssize_t statahead_xattr_store(struct kobject *kobj,
+				     struct attribute *attr,
+				     const char *buffer,
+				     size_t count)
+{
+	struct ll_sb_info *sbi = container_of(kobj, struct ll_sb_info,
+					      ll_kset.kobj);
+	bool val;
+	int rc;
+
+	rc = kstrtobool(buffer, &val);
+	if (rc)
+		return rc;
+
+	if (val)
+		set_bit(LL_SBI_SA_XATTR, sbi->ll_flags);
+	else
+		clear_bit(LL_SBI_SA_XATTR, sbi->ll_flags);
+
+	return count;
+}
+LUSTRE_RW_ATTR(statahead_xattr);
+
 static int ll_statahead_stats_seq_show(struct seq_file *m, void *v)
 {
 	struct super_block *sb = m->private;
@@ -983,6 +1017,7 @@ static int ll_statahead_stats_seq_show(struct seq_file *m, void *v)
 	seq_printf(m, "statahead total: %u\n"
 		      "statahead wrong: %u\n"
 		      "agl total: %u\n"
+		      "xattr prefetch total: %u\n"
 		      "list_total: %u\n"
 		      "fname_total: %u\n"
 		      "hit_total: %u\n"
@@ -990,6 +1025,7 @@ static int ll_statahead_stats_seq_show(struct seq_file *m, void *v)
 		   atomic_read(&sbi->ll_sa_total),
 		   atomic_read(&sbi->ll_sa_wrong),
 		   atomic_read(&sbi->ll_agl_total),
+		   atomic_read(&sbi->ll_sa_xattr_total),
 		   atomic_read(&sbi->ll_sa_list_total),
 		   atomic_read(&sbi->ll_sa_fname_total),
 		   atomic_read(&sbi->ll_sa_hit_total),
@@ -1008,6 +1044,7 @@ static ssize_t ll_statahead_stats_seq_write(struct file *file,
 	atomic_set(&sbi->ll_sa_total, 0);
 	atomic_set(&sbi->ll_sa_wrong, 0);
 	atomic_set(&sbi->ll_agl_total, 0);
+	atomic_set(&sbi->ll_sa_xattr_total, 0);
 	atomic_set(&sbi->ll_sa_list_total, 0);
 	atomic_set(&sbi->ll_sa_fname_total, 0);
 	atomic_set(&sbi->ll_sa_hit_total, 0);
@@ -1747,6 +1784,37 @@ static ssize_t inode_cache_store(struct kobject *kobj,
 }
 LUSTRE_RW_ATTR(inode_cache);
 
+static ssize_t pcc_copy_threads_show(struct kobject *kobj,
+				     struct attribute *attr, char *buf)
+{
+	struct ll_sb_info *sbi = container_of(kobj, struct ll_sb_info,
+					      ll_kset.kobj);
+
+	return scnprintf(buf, PAGE_SIZE, "%u\n",
+			 sbi->ll_pcc_super.pccs_copy_threads);
+}
+
+static ssize_t pcc_copy_threads_store(struct kobject *kobj,
+				      struct attribute *attr,
+				      const char *buffer, size_t count)
+{
+	struct ll_sb_info *sbi = container_of(kobj, struct ll_sb_info,
+					      ll_kset.kobj);
+	unsigned int val;
+	int rc;
+
+	rc = kstrtouint(buffer, 0, &val);
+	if (rc)
+		return rc;
+
+	if (val == 0 || val > PCC_COPY_THREADS_MAX)
+		return -ERANGE;
+
+	sbi->ll_pcc_super.pccs_copy_threads = val;
+	return count;
+}
+LUSTRE_RW_ATTR(pcc_copy_threads);
+
 static int ll_unstable_stats_seq_show(struct seq_file *m, void *v)
 {
 	struct super_block	*sb    = m->private;
@@ -2059,6 +2127,7 @@ static struct attribute *llite_attrs[] = {
 	&lustre_attr_statahead_min.attr,
 	&lustre_attr_statahead_timeout.attr,
 	&lustre_attr_statahead_agl.attr,
+	&lustre_attr_statahead_xattr.attr,
 	&lustre_attr_lazystatfs.attr,
 	&lustre_attr_statfs_max_age.attr,
 	&lustre_attr_statfs_project.attr,
@@ -2076,6 +2145,7 @@ static struct attribute *llite_attrs[] = {
 	&lustre_attr_opencache_threshold_ms.attr,
 	&lustre_attr_opencache_max_ms.attr,
 	&lustre_attr_inode_cache.attr,
+	&lustre_attr_pcc_copy_threads.attr,
 #ifdef CONFIG_LL_ENCRYPTION
 	&lustre_attr_enable_filename_encryption.attr,
 #endif
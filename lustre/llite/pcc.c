@@ -107,11 +107,23 @@
 #include "pcc.h"
 #include <linux/namei.h>
 #include <linux/file.h>
+#include <linux/statfs.h>
 #include <lustre_compat.h>
 #include "llite_internal.h"
 
 struct kmem_cache *pcc_inode_slab;
 
+/* max number of concurrent background attaches for heat promotion */
+#define PCC_PROMOTE_MAX_ACTIVE		4
+/* do not retry a failed promotion of a file before this many seconds */
+#define PCC_PROMOTE_RETRY_INTERVAL	30
+/* interval to check the datasets for capacity pressure, in seconds */
+#define PCC_DEMOTE_INTERVAL		10
+/* max number of files to demote from a dataset in one round */
+#define PCC_DEMOTE_BATCH		16
+
+static void pcc_demote_work_handler(struct work_struct *work);
+
 int pcc_super_init(struct pcc_super *super)
 {
 	struct cred *cred;
@@ -126,6 +138,26 @@ int pcc_super_init(struct pcc_super *super)
 	INIT_LIST_HEAD(&super->pccs_datasets);
 	super->pccs_generation = 1;
 
+	super->pccs_wq = cfs_cpt_bind_workqueue("ll-pcc-wq", cfs_cpt_tab, 0,
+						CFS_CPT_ANY,
+						PCC_PROMOTE_MAX_ACTIVE);
+	if (IS_ERR(super->pccs_wq)) {
+		put_cred(super->pccs_cred);
+		return PTR_ERR(super->pccs_wq);
+	}
+	INIT_DELAYED_WORK(&super->pccs_demote_work, pcc_demote_work_handler);
+
+	super->pccs_copy_threads = PCC_COPY_THREADS_DEFAULT;
+	super->pccs_copy_wq = cfs_cpt_bind_workqueue("ll-pcc-copy",
+						     cfs_cpt_tab, 0,
+						     CFS_CPT_ANY,
+						     PCC_COPY_THREADS_MAX);
+	if (IS_ERR(super->pccs_copy_wq)) {
+		destroy_workqueue(super->pccs_wq);
+		put_cred(super->pccs_cred);
+		return PTR_ERR(super->pccs_copy_wq);
+	}
+
 	return 0;
 }
 
@@ -470,6 +502,30 @@ pcc_parse_value_pair(struct pcc_cmd *cmd, char *buffer)
 			return rc;
 		if (id > 0)
 			cmd->u.pccc_add.pccc_flags |= PCC_DATASET_ROPCC;
+	} else if (strcmp(key, "rw_promote") == 0) {
+		rc = kstrtoul(val, 10, &id);
+		if (rc)
+			return rc;
+		if (id > 0)
+			cmd->u.pccc_add.pccc_flags |= PCC_DATASET_RWPROMOTE;
+	} else if (strcmp(key, "tier") == 0) {
+		rc = kstrtoul(val, 10, &id);
+		if (rc)
+			return rc;
+		if (id > U32_MAX)
+			return -ERANGE;
+		cmd->u.pccc_add.pccc_tier = id;
+	} else if (strcmp(key, "heat_thresh") == 0) {
+		rc = kstrtoull(val, 10, &cmd->u.pccc_add.pccc_heat_thresh);
+		if (rc)
+			return rc;
+	} else if (strcmp(key, "max_usage") == 0) {
+		rc = kstrtoul(val, 10, &id);
+		if (rc)
+			return rc;
+		if (id > 100)
+			return -ERANGE;
+		cmd->u.pccc_add.pccc_max_usage = id;
 	} else {
 		return -EINVAL;
 	}
@@ -723,6 +779,11 @@ pcc_dataset_add(struct pcc_super *super, struct pcc_cmd *cmd)
 	dataset->pccd_rwid = cmd->u.pccc_add.pccc_rwid;
 	dataset->pccd_roid = cmd->u.pccc_add.pccc_roid;
 	dataset->pccd_flags = cmd->u.pccc_add.pccc_flags;
+	dataset->pccd_tier = cmd->u.pccc_add.pccc_tier;
+	dataset->pccd_heat_thresh = cmd->u.pccc_add.pccc_heat_thresh;
+	dataset->pccd_max_usage = cmd->u.pccc_add.pccc_max_usage;
+	spin_lock_init(&dataset->pccd_lru_lock);
+	INIT_LIST_HEAD(&dataset->pccd_lru);
 	atomic_set(&dataset->pccd_refcount, 1);
 
 	rc = pcc_dataset_rule_init(&dataset->pccd_rule, cmd);
@@ -742,13 +803,25 @@ pcc_dataset_add(struct pcc_super *super, struct pcc_cmd *cmd)
 			break;
 		}
 	}
-	if (!found)
-		list_add(&dataset->pccd_linkage, &super->pccs_datasets);
+	if (!found) {
+		/*
+		 * Keep the list sorted by tier so that faster tiers are tried
+		 * first, the last added one goes first within the same tier.
+		 */
+		list_for_each_entry(tmp, &super->pccs_datasets, pccd_linkage) {
+			if (tmp->pccd_tier >= dataset->pccd_tier)
+				break;
+		}
+		list_add_tail(&dataset->pccd_linkage, &tmp->pccd_linkage);
+	}
 	up_write(&super->pccs_rw_sem);
 
 	if (found) {
 		pcc_dataset_put(dataset);
 		rc = -EEXIST;
+	} else if (dataset->pccd_max_usage) {
+		mod_delayed_work(super->pccs_wq, &super->pccs_demote_work,
+				 cfs_time_seconds(PCC_DEMOTE_INTERVAL));
 	}
 
 	return rc;
@@ -818,10 +891,26 @@ pcc_dataset_del(struct pcc_super *super, char *pathname)
 static void
 pcc_dataset_dump(struct pcc_dataset *dataset, struct seq_file *m)
 {
+	struct pcc_dataset_stats *stats = &dataset->pccd_stats;
+
 	seq_printf(m, "%s:\n", dataset->pccd_pathname);
 	seq_printf(m, "  rwid: %u\n", dataset->pccd_rwid);
 	seq_printf(m, "  flags: %x\n", dataset->pccd_flags);
 	seq_printf(m, "  autocache: %s\n", dataset->pccd_rule.pmr_conds_str);
+	seq_printf(m, "  tier: %u\n", dataset->pccd_tier);
+	seq_printf(m, "  heat_thresh: %llu\n", dataset->pccd_heat_thresh);
+	seq_printf(m, "  max_usage: %u\n", dataset->pccd_max_usage);
+	seq_printf(m, "  cached_files: %lu\n", dataset->pccd_nr_cached);
+	seq_printf(m, "  read_hits: %lld\n",
+		   (s64)atomic64_read(&stats->pds_read_hits));
+	seq_printf(m, "  write_hits: %lld\n",
+		   (s64)atomic64_read(&stats->pds_write_hits));
+	seq_printf(m, "  attach: %lld\n",
+		   (s64)atomic64_read(&stats->pds_attach));
+	seq_printf(m, "  promote: %lld\n",
+		   (s64)atomic64_read(&stats->pds_promote));
+	seq_printf(m, "  demote: %lld\n",
+		   (s64)atomic64_read(&stats->pds_demote));
 }
 
 int
@@ -851,8 +940,19 @@ static void pcc_remove_datasets(struct pcc_super *super)
 	up_write(&super->pccs_rw_sem);
 }
 
+/* Stop background PCC work before the inodes of the client go away */
+void pcc_super_stop(struct pcc_super *super)
+{
+	super->pccs_stopping = true;
+	cancel_delayed_work_sync(&super->pccs_demote_work);
+	flush_workqueue(super->pccs_wq);
+}
+
 void pcc_super_fini(struct pcc_super *super)
 {
+	pcc_super_stop(super);
+	destroy_workqueue(super->pccs_wq);
+	destroy_workqueue(super->pccs_copy_wq);
 	pcc_remove_datasets(super);
 	put_cred(super->pccs_cred);
 }
@@ -991,12 +1091,63 @@ static void pcc_inode_init(struct pcc_inode *pcci, struct ll_inode_info *lli)
 	pcci->pcci_layout_gen = CL_LAYOUT_GEN_NONE;
 	atomic_set(&pcci->pcci_active_ios, 0);
 	init_waitqueue_head(&pcci->pcci_waitq);
+	pcci->pcci_dataset = NULL;
+	INIT_LIST_HEAD(&pcci->pcci_lru);
+}
+
+static void pcc_inode_dataset_set(struct pcc_inode *pcci,
+				  struct pcc_dataset *dataset)
+{
+	if (pcci->pcci_dataset == dataset)
+		return;
+
+	LASSERT(pcci->pcci_dataset == NULL);
+	atomic_inc(&dataset->pccd_refcount);
+	pcci->pcci_dataset = dataset;
+	pcci->pcci_atime = ktime_get_seconds();
+	spin_lock(&dataset->pccd_lru_lock);
+	list_add_tail(&pcci->pcci_lru, &dataset->pccd_lru);
+	dataset->pccd_nr_cached++;
+	spin_unlock(&dataset->pccd_lru_lock);
+	atomic64_inc(&dataset->pccd_stats.pds_attach);
+}
+
+static void pcc_inode_dataset_clear(struct pcc_inode *pcci)
+{
+	struct pcc_dataset *dataset = pcci->pcci_dataset;
+
+	if (!dataset)
+		return;
+
+	spin_lock(&dataset->pccd_lru_lock);
+	list_del_init(&pcci->pcci_lru);
+	dataset->pccd_nr_cached--;
+	spin_unlock(&dataset->pccd_lru_lock);
+	pcci->pcci_dataset = NULL;
+	pcc_dataset_put(dataset);
+}
+
+/* Move the PCC inode to the MRU end, at most once per second */
+static inline void pcc_inode_touch(struct pcc_inode *pcci)
+{
+	struct pcc_dataset *dataset = pcci->pcci_dataset;
+	time64_t now = ktime_get_seconds();
+
+	if (!dataset || pcci->pcci_atime == now)
+		return;
+
+	pcci->pcci_atime = now;
+	spin_lock(&dataset->pccd_lru_lock);
+	if (!list_empty(&pcci->pcci_lru))
+		list_move_tail(&pcci->pcci_lru, &dataset->pccd_lru);
+	spin_unlock(&dataset->pccd_lru_lock);
 }
 
 static void pcc_inode_fini(struct pcc_inode *pcci)
 {
 	struct ll_inode_info *lli = pcci->pcci_lli;
 
+	pcc_inode_dataset_clear(pcci);
 	path_put(&pcci->pcci_path);
 	pcci->pcci_type = LU_PCC_NONE;
 	OBD_SLAB_FREE_PTR(pcci, pcc_inode_slab);
@@ -1122,6 +1273,7 @@ static void pcc_inode_attach_init(struct pcc_dataset *dataset,
 	atomic_set(&pcci->pcci_refcount, 1);
 	pcci->pcci_type = type;
 	pcci->pcci_attr_valid = false;
+	pcc_inode_dataset_set(pcci, dataset);
 }
 
 static inline void pcc_inode_dsflags_set(struct ll_inode_info *lli,
@@ -1515,6 +1667,285 @@ out_unlock:
 	RETURN(rc);
 }
 
+/* Whether the usage of the file system backing \a dataset reaches \a limit% */
+static bool pcc_dataset_over_usage(struct pcc_dataset *dataset, __u32 limit)
+{
+	struct kstatfs kst;
+
+	if (limit == 0)
+		return false;
+
+	if (vfs_statfs(&dataset->pccd_path, &kst) || kst.f_blocks == 0)
+		return false;
+
+	return (kst.f_blocks - kst.f_bavail) * 100 >= (u64)limit * kst.f_blocks;
+}
+
+/*
+ * Find the fastest RW-PCC dataset which allows promotion, whose heat
+ * threshold is reached by the read heat of \a inode and which still has
+ * room for it. Return its rwid or 0.
+ */
+static __u32 pcc_promote_dataset_find(struct pcc_super *super,
+				      struct inode *inode)
+{
+	struct pcc_dataset *dataset;
+	struct pcc_dataset *tmp;
+	__u64 heat;
+	__u32 rwid;
+	bool over;
+	int skip = 0;
+	int n;
+
+	heat = ll_file_heat_get(inode, OBD_HEAT_READBYTE);
+	if (heat == 0)
+		return 0;
+
+	while (1) {
+		dataset = NULL;
+		n = 0;
+		down_read(&super->pccs_rw_sem);
+		list_for_each_entry(tmp, &super->pccs_datasets, pccd_linkage) {
+			if (!(tmp->pccd_flags & PCC_DATASET_RWPCC) ||
+			    !(tmp->pccd_flags & PCC_DATASET_RWPROMOTE) ||
+			    tmp->pccd_heat_thresh == 0 ||
+			    heat < tmp->pccd_heat_thresh)
+				continue;
+
+			if (n++ < skip)
+				continue;
+
+			atomic_inc(&tmp->pccd_refcount);
+			dataset = tmp;
+			break;
+		}
+		up_read(&super->pccs_rw_sem);
+
+		if (!dataset)
+			return 0;
+
+		/* statfs may block, do not hold pccs_rw_sem across it */
+		over = pcc_dataset_over_usage(dataset, dataset->pccd_max_usage);
+		rwid = dataset->pccd_rwid;
+		pcc_dataset_put(dataset);
+		if (!over)
+			return rwid;
+
+		skip++;
+	}
+}
+
+struct pcc_promote_work {
+	struct work_struct	ppw_work;
+	struct path		ppw_path;
+	__u32			ppw_rwid;
+};
+
+static void pcc_promote_work_handler(struct work_struct *work)
+{
+	struct pcc_promote_work *ppw;
+	struct pcc_dataset *dataset;
+	const struct cred *old_cred;
+	struct pcc_super *super;
+	struct inode *inode;
+	struct file *file;
+	struct cred *cred;
+	int rc;
+
+	ENTRY;
+
+	ppw = container_of(work, struct pcc_promote_work, ppw_work);
+	inode = d_inode(ppw->ppw_path.dentry);
+	super = ll_i2pccs(inode);
+	if (super->pccs_stopping)
+		GOTO(out, rc = -ESHUTDOWN);
+
+	/* Attach on behalf of the file owner, who also owns the PCC copy */
+	cred = prepare_creds();
+	if (!cred)
+		GOTO(out, rc = -ENOMEM);
+
+	cred->uid = cred->fsuid = inode->i_uid;
+	cred->gid = cred->fsgid = inode->i_gid;
+	old_cred = override_creds(cred);
+	file = dentry_open(&ppw->ppw_path, O_RDWR | O_LARGEFILE,
+			   current_cred());
+	if (IS_ERR(file)) {
+		rc = PTR_ERR(file);
+	} else {
+		rc = ll_file_pcc_attach(file, ppw->ppw_rwid);
+		fput(file);
+	}
+	revert_creds(old_cred);
+	put_cred(cred);
+
+	if (rc == 0) {
+		dataset = pcc_dataset_get(super, LU_PCC_READWRITE,
+					  ppw->ppw_rwid);
+		if (dataset) {
+			atomic64_inc(&dataset->pccd_stats.pds_promote);
+			pcc_dataset_put(dataset);
+		}
+	}
+out:
+	CDEBUG(D_CACHE, "%s: promote "DFID" into PCC rwid %u: rc = %d\n",
+	       ll_i2sbi(inode)->ll_fsname, PFID(ll_inode2fid(inode)),
+	       ppw->ppw_rwid, rc);
+
+	pcc_inode_lock(inode);
+	ll_i2info(inode)->lli_pcc_state &= ~PCC_STATE_FL_PROMOTING;
+	pcc_inode_unlock(inode);
+	path_put(&ppw->ppw_path);
+	OBD_FREE_PTR(ppw);
+	EXIT;
+}
+
+/*
+ * Promote a hot file into PCC in the background once the last user closes
+ * it. It cannot be done while the file is open as the attach needs an
+ * exclusive write lease.
+ */
+static void pcc_try_promote(struct inode *inode, struct file *file)
+{
+	struct ll_inode_info *lli = ll_i2info(inode);
+	struct pcc_super *super = ll_i2pccs(inode);
+	struct pcc_promote_work *ppw;
+	struct pcc_inode *pcci;
+	time64_t now = ktime_get_seconds();
+	bool last;
+	__u32 rwid;
+
+	if (super->pccs_stopping || !ll_sbi_has_file_heat(ll_i2sbi(inode)) ||
+	    IS_ENCRYPTED(inode) ||
+	    now < lli->lli_pcc_promote_time + PCC_PROMOTE_RETRY_INTERVAL)
+		return;
+
+	/* called before ll_md_close(), so this file is still counted */
+	mutex_lock(&lli->lli_och_mutex);
+	last = lli->lli_open_fd_read_count + lli->lli_open_fd_write_count +
+	       lli->lli_open_fd_exec_count <= 1;
+	mutex_unlock(&lli->lli_och_mutex);
+	if (!last)
+		return;
+
+	rwid = pcc_promote_dataset_find(super, inode);
+	if (rwid == 0)
+		return;
+
+	OBD_ALLOC_PTR(ppw);
+	if (ppw == NULL)
+		return;
+
+	pcc_inode_lock(inode);
+	pcci = ll_i2pcci(inode);
+	if (lli->lli_pcc_state &
+	    (PCC_STATE_FL_ATTACHING | PCC_STATE_FL_PROMOTING) ||
+	    (pcci && pcc_inode_has_layout(pcci))) {
+		pcc_inode_unlock(inode);
+		OBD_FREE_PTR(ppw);
+		return;
+	}
+	lli->lli_pcc_state |= PCC_STATE_FL_PROMOTING;
+	lli->lli_pcc_promote_time = now;
+	pcc_inode_unlock(inode);
+
+	INIT_WORK(&ppw->ppw_work, pcc_promote_work_handler);
+	ppw->ppw_path = file->f_path;
+	path_get(&ppw->ppw_path);
+	ppw->ppw_rwid = rwid;
+	queue_work(super->pccs_wq, &ppw->ppw_work);
+}
+
+struct pcc_demote_item {
+	struct inode		*pdi_inode;
+	struct pcc_dataset	*pdi_dataset;
+};
+
+/*
+ * Detach the least recently used files from the datasets which are above
+ * their max_usage, the data is restored into Lustre by the HSM copytool.
+ */
+static void pcc_demote_work_handler(struct work_struct *work)
+{
+	struct pcc_demote_item items[PCC_DEMOTE_BATCH];
+	struct pcc_dataset *dataset;
+	struct pcc_super *super;
+	struct pcc_inode *pcci;
+	struct inode *inode;
+	bool rearm = false;
+	int count = 0;
+	int skip = 0;
+	int i;
+
+	super = container_of(work, struct pcc_super, pccs_demote_work.work);
+	while (count < PCC_DEMOTE_BATCH) {
+		struct pcc_dataset *tmp;
+		bool over;
+		int n = 0;
+
+		dataset = NULL;
+		down_read(&super->pccs_rw_sem);
+		list_for_each_entry(tmp, &super->pccs_datasets, pccd_linkage) {
+			if (tmp->pccd_max_usage == 0 || n++ < skip)
+				continue;
+
+			atomic_inc(&tmp->pccd_refcount);
+			dataset = tmp;
+			break;
+		}
+		up_read(&super->pccs_rw_sem);
+
+		if (!dataset)
+			break;
+
+		rearm = true;
+		skip++;
+		/* statfs may block, do not hold pccs_rw_sem across it */
+		over = pcc_dataset_over_usage(dataset, dataset->pccd_max_usage);
+		if (over) {
+			spin_lock(&dataset->pccd_lru_lock);
+			list_for_each_entry(pcci, &dataset->pccd_lru, pcci_lru) {
+				if (count >= PCC_DEMOTE_BATCH)
+					break;
+
+				/* skip the files still opened in PCC */
+				if (pcci->pcci_type != LU_PCC_READWRITE ||
+				    atomic_read(&pcci->pcci_refcount) > 1)
+					continue;
+
+				inode = igrab(ll_info2i(pcci->pcci_lli));
+				if (inode == NULL)
+					continue;
+
+				atomic_inc(&dataset->pccd_refcount);
+				items[count].pdi_inode = inode;
+				items[count].pdi_dataset = dataset;
+				count++;
+			}
+			spin_unlock(&dataset->pccd_lru_lock);
+		}
+		pcc_dataset_put(dataset);
+	}
+
+	for (i = 0; i < count; i++) {
+		inode = items[i].pdi_inode;
+		dataset = items[i].pdi_dataset;
+		if (!super->pccs_stopping &&
+		    pcc_ioctl_detach(inode, PCC_DETACH_OPT_UNCACHE) == 0) {
+			atomic64_inc(&dataset->pccd_stats.pds_demote);
+			CDEBUG(D_CACHE, "demoted "DFID" from PCC \"%s\"\n",
+			       PFID(ll_inode2fid(inode)),
+			       dataset->pccd_pathname);
+		}
+		pcc_dataset_put(dataset);
+		iput(inode);
+	}
+
+	if (rearm && !super->pccs_stopping)
+		queue_delayed_work(super->pccs_wq, &super->pccs_demote_work,
+				   cfs_time_seconds(PCC_DEMOTE_INTERVAL));
+}
+
 void pcc_file_release(struct inode *inode, struct file *file)
 {
 	struct pcc_inode *pcci;
@@ -1529,8 +1960,11 @@ void pcc_file_release(struct inode *inode, struct file *file)
 
 	pccf = &fd->fd_pcc_file;
 	pcc_inode_lock(inode);
-	if (pccf->pccf_file == NULL)
-		goto out;
+	if (pccf->pccf_file == NULL) {
+		pcc_inode_unlock(inode);
+		pcc_try_promote(inode, file);
+		RETURN_EXIT;
+	}
 
 	pcci = ll_i2pcci(inode);
 	LASSERT(pcci);
@@ -1539,7 +1973,6 @@ void pcc_file_release(struct inode *inode, struct file *file)
 	pcc_inode_put(pcci);
 	fput(pccf->pccf_file);
 	pccf->pccf_file = NULL;
-out:
 	pcc_inode_unlock(inode);
 	RETURN_EXIT;
 }
@@ -1553,6 +1986,7 @@ static void pcc_io_init(struct inode *inode, enum pcc_io_type iot, bool *cached)
 	if (pcci && pcc_inode_has_layout(pcci)) {
 		LASSERT(atomic_read(&pcci->pcci_refcount) > 0);
 		atomic_inc(&pcci->pcci_active_ios);
+		pcc_inode_touch(pcci);
 		*cached = true;
 	} else {
 		*cached = false;
@@ -1620,6 +2054,7 @@ ssize_t pcc_file_read_iter(struct kiocb *iocb,
 	struct ll_file_data *fd = file->private_data;
 	struct pcc_file *pccf = &fd->fd_pcc_file;
 	struct inode *inode = file_inode(file);
+	struct pcc_dataset *dataset;
 	ssize_t result;
 
 	ENTRY;
@@ -1640,6 +2075,9 @@ ssize_t pcc_file_read_iter(struct kiocb *iocb,
 	 */
 	result = __pcc_file_read_iter(iocb, iter);
 	iocb->ki_filp = file;
+	dataset = ll_i2pcci(inode)->pcci_dataset;
+	if (result > 0 && dataset)
+		atomic64_inc(&dataset->pccd_stats.pds_read_hits);
 
 	pcc_io_fini(inode);
 	RETURN(result);
@@ -1687,6 +2125,7 @@ ssize_t pcc_file_write_iter(struct kiocb *iocb,
 	struct ll_file_data *fd = file->private_data;
 	struct pcc_file *pccf = &fd->fd_pcc_file;
 	struct inode *inode = file_inode(file);
+	struct pcc_dataset *dataset;
 	ssize_t result;
 
 	ENTRY;
@@ -1716,6 +2155,9 @@ ssize_t pcc_file_write_iter(struct kiocb *iocb,
 	 */
 	result = __pcc_file_write_iter(iocb, iter);
 	iocb->ki_filp = file;
+	dataset = ll_i2pcci(inode)->pcci_dataset;
+	if (result > 0 && dataset)
+		atomic64_inc(&dataset->pccd_stats.pds_write_hits);
 out:
 	pcc_io_fini(inode);
 	RETURN(result);
@@ -2380,42 +2822,216 @@ static int pcc_filp_write(struct file *filp, const void *buf, ssize_t count,
 	return 0;
 }
 
-static ssize_t pcc_copy_data(struct file *src, struct file *dst)
-{
-	ssize_t rc = 0;
-	ssize_t rc2;
-	loff_t pos, offset = 0;
-	size_t buf_len = 1048576;
-	void *buf;
-
-	ENTRY;
+/* size of the buffer for copying data with read/write */
+#define PCC_COPY_BUF_SIZE	(1 << 20)
+/* the unit of work when copying a file with several threads */
+#define PCC_COPY_CHUNK_SIZE	(16 << 20)
+
+struct pcc_copy_ctx {
+	struct file		*pcx_src;
+	struct file		*pcx_dst;
+	const struct cred	*pcx_cred;
+	/* copy [0, pcx_size) in parallel */
+	loff_t			 pcx_size;
+	/* start of the next chunk to copy */
+	atomic64_t		 pcx_next;
+	/* number of helpers still running */
+	atomic_t		 pcx_pending;
+	struct completion	 pcx_done;
+	/* first error hit by any of the threads */
+	int			 pcx_rc;
+	/* copy_file_range() works between the source and the target */
+	bool			 pcx_cfr;
+};
+
+struct pcc_copy_work {
+	struct work_struct	 pcw_work;
+	struct pcc_copy_ctx	*pcw_ctx;
+};
 
-	OBD_ALLOC_LARGE(buf, buf_len);
-	if (buf == NULL)
-		RETURN(-ENOMEM);
+/*
+ * Copy [\a start, \a end) from the Lustre file to the PCC copy. Return the
+ * number of bytes copied, which is less than requested only at EOF.
+ */
+static ssize_t pcc_copy_range(struct pcc_copy_ctx *ctx, void *buf,
+			      loff_t start, loff_t end)
+{
+	loff_t offset = start;
+	loff_t pos;
+	ssize_t rc;
 
-	while (1) {
+	while (offset < end) {
+		/* only the caller gets signals, not the workqueue helpers */
 		if (signal_pending(current))
-			GOTO(out_free, rc = -EINTR);
+			cmpxchg(&ctx->pcx_rc, 0, -EINTR);
 
+		rc = READ_ONCE(ctx->pcx_rc);
+		if (rc)
+			return rc;
+
+#ifdef HAVE_VFS_COPY_FILE_RANGE
+		if (READ_ONCE(ctx->pcx_cfr)) {
+			pos = offset;
+			rc = vfs_copy_file_range(ctx->pcx_src, pos,
+						 ctx->pcx_dst, pos,
+						 end - offset, 0);
+			if (rc > 0) {
+				offset += rc;
+				continue;
+			}
+			if (rc == 0)
+				break;
+			/* not supported between these file systems */
+			if (rc != -EXDEV && rc != -EOPNOTSUPP &&
+			    rc != -EINVAL)
+				return rc;
+			WRITE_ONCE(ctx->pcx_cfr, false);
+		}
+#endif
 		pos = offset;
-		rc2 = cfs_kernel_read(src, buf, buf_len, &pos);
-		if (rc2 < 0)
-			GOTO(out_free, rc = rc2);
-		else if (rc2 == 0)
+		rc = cfs_kernel_read(ctx->pcx_src, buf,
+				     min_t(loff_t, PCC_COPY_BUF_SIZE,
+					   end - offset), &pos);
+		if (rc <= 0) {
+			if (rc < 0)
+				return rc;
 			break;
+		}
 
 		pos = offset;
-		rc = pcc_filp_write(dst, buf, rc2, &pos);
+		offset += rc;
+		rc = pcc_filp_write(ctx->pcx_dst, buf, rc, &pos);
 		if (rc < 0)
-			GOTO(out_free, rc);
-		offset += rc2;
+			return rc;
 	}
 
-	rc = offset;
-out_free:
-	OBD_FREE_LARGE(buf, buf_len);
-	RETURN(rc);
+	return offset - start;
+}
+
+/* Copy chunks of the file until all of them are taken by some thread */
+static void pcc_copy_chunks(struct pcc_copy_ctx *ctx)
+{
+	const struct cred *old_cred;
+	loff_t start;
+	ssize_t rc = 0;
+	void *buf;
+
+	OBD_ALLOC_LARGE(buf, PCC_COPY_BUF_SIZE);
+	if (buf == NULL) {
+		cmpxchg(&ctx->pcx_rc, 0, -ENOMEM);
+		return;
+	}
+
+	old_cred = override_creds(ctx->pcx_cred);
+	while (READ_ONCE(ctx->pcx_rc) == 0) {
+		start = atomic64_add_return(PCC_COPY_CHUNK_SIZE,
+					    &ctx->pcx_next) -
+			PCC_COPY_CHUNK_SIZE;
+		if (start >= ctx->pcx_size)
+			break;
+
+		rc = pcc_copy_range(ctx, buf, start,
+				    min_t(loff_t, start + PCC_COPY_CHUNK_SIZE,
+					  ctx->pcx_size));
+		if (rc < 0) {
+			cmpxchg(&ctx->pcx_rc, 0, (int)rc);
+			break;
+		}
+	}
+	revert_creds(old_cred);
+	OBD_FREE_LARGE(buf, PCC_COPY_BUF_SIZE);
+}
+
+static void pcc_copy_work_handler(struct work_struct *work)
+{
+	struct pcc_copy_work *pcw;
+	struct pcc_copy_ctx *ctx;
+
+	pcw = container_of(work, struct pcc_copy_work, pcw_work);
+	ctx = pcw->pcw_ctx;
+	pcc_copy_chunks(ctx);
+	if (atomic_dec_and_test(&ctx->pcx_pending))
+		complete(&ctx->pcx_done);
+}
+
+/*
+ * Copy the whole Lustre file \a src into the PCC copy \a dst and return the
+ * size of the data copied.
+ *
+ * The file is split into PCC_COPY_CHUNK_SIZE chunks which are copied by the
+ * caller and up to pccs_copy_threads - 1 helpers on the PCC copy workqueue,
+ * with copy_file_range() if the kernel can do it between the two file
+ * systems, and with read/write otherwise.
+ */
+static ssize_t pcc_copy_data(struct file *src, struct file *dst)
+{
+	struct pcc_super *super = ll_i2pccs(file_inode(src));
+	struct pcc_copy_work *works = NULL;
+	struct pcc_copy_ctx ctx = { 0 };
+	unsigned int nr_helpers = 0;
+	unsigned int i;
+	loff_t size;
+	ssize_t rc;
+	void *buf;
+
+	ENTRY;
+
+	rc = ll_glimpse_size(file_inode(src));
+	if (rc)
+		RETURN(rc);
+
+	size = i_size_read(file_inode(src));
+
+	ctx.pcx_src = src;
+	ctx.pcx_dst = dst;
+	ctx.pcx_cred = current_cred();
+	ctx.pcx_size = size;
+	atomic64_set(&ctx.pcx_next, 0);
+	init_completion(&ctx.pcx_done);
+#ifdef HAVE_VFS_COPY_FILE_RANGE
+	ctx.pcx_cfr = true;
+#endif
+
+	if (size > PCC_COPY_CHUNK_SIZE && super->pccs_copy_threads > 1)
+		nr_helpers = min_t(loff_t, super->pccs_copy_threads - 1,
+				   (size - 1) / PCC_COPY_CHUNK_SIZE);
+	if (nr_helpers > 0) {
+		OBD_ALLOC_PTR_ARRAY(works, nr_helpers);
+		if (works == NULL)
+			nr_helpers = 0;
+	}
+
+	atomic_set(&ctx.pcx_pending, nr_helpers);
+	for (i = 0; i < nr_helpers; i++) {
+		INIT_WORK(&works[i].pcw_work, pcc_copy_work_handler);
+		works[i].pcw_ctx = &ctx;
+		queue_work(super->pccs_copy_wq, &works[i].pcw_work);
+	}
+
+	pcc_copy_chunks(&ctx);
+	if (nr_helpers > 0) {
+		if (wait_for_completion_interruptible(&ctx.pcx_done)) {
+			/* stop the helpers, they still use ctx on our stack */
+			cmpxchg(&ctx.pcx_rc, 0, -EINTR);
+			wait_for_completion(&ctx.pcx_done);
+		}
+		OBD_FREE_PTR_ARRAY(works, nr_helpers);
+	}
+	if (ctx.pcx_rc)
+		RETURN(ctx.pcx_rc);
+
+	/* Nobody can write the file under the lease, this is only in case */
+	OBD_ALLOC_LARGE(buf, PCC_COPY_BUF_SIZE);
+	if (buf == NULL)
+		RETURN(-ENOMEM);
+
+	ctx.pcx_cfr = false;
+	rc = pcc_copy_range(&ctx, buf, size, OFFSET_MAX);
+	OBD_FREE_LARGE(buf, PCC_COPY_BUF_SIZE);
+	if (rc < 0)
+		RETURN(rc);
+
+	RETURN(size + rc);
 }
 
 static int pcc_attach_allowed_check(struct inode *inode)
@@ -109,6 +109,19 @@ enum pcc_dataset_flags {
 	PCC_DATASET_ROPCC	= 0x20,
 	/* PCC backend provides caching services for both RW-PCC and RO-PCC */
 	PCC_DATASET_PCC_ALL	= PCC_DATASET_RWPCC | PCC_DATASET_ROPCC,
+	/* Allow heat based promotion into RW-PCC, disabled by default as
+	 * it releases the Lustre copy of the file
+	 */
+	PCC_DATASET_RWPROMOTE	= 0x40,
+};
+
+/* Per-dataset (i.e. per cache tier) statistics */
+struct pcc_dataset_stats {
+	atomic64_t		pds_read_hits;	/* reads served from PCC */
+	atomic64_t		pds_write_hits;	/* writes served from PCC */
+	atomic64_t		pds_attach;	/* files attached */
+	atomic64_t		pds_promote;	/* files attached by heat */
+	atomic64_t		pds_demote;	/* files detached for space */
 };
 
 struct pcc_dataset {
@@ -120,6 +133,18 @@ struct pcc_dataset {
 	struct path		pccd_path;	 /* Root path */
 	struct list_head	pccd_linkage;  /* Linked to pccs_datasets */
 	atomic_t		pccd_refcount; /* Reference count */
+	/* Cache tier, a lower value is faster and is tried first */
+	__u32			pccd_tier;
+	/* Promote files whose read byte heat reaches this, 0 disables */
+	__u64			pccd_heat_thresh;
+	/* Demote files when the backend is fuller than this %, 0: never */
+	__u32			pccd_max_usage;
+	/* Protect pccd_lru and pccd_nr_cached */
+	spinlock_t		pccd_lru_lock;
+	/* Attached PCC inodes, least recently used first */
+	struct list_head	pccd_lru;
+	unsigned long		pccd_nr_cached;
+	struct pcc_dataset_stats pccd_stats;
 };
 
 struct pcc_super {
@@ -135,8 +160,20 @@ struct pcc_super {
 	 * parameters for PCC.
 	 */
 	__u64			 pccs_generation;
+	/* Background attach for heat promotion */
+	struct workqueue_struct	*pccs_wq;
+	/* Periodic demotion of cold files from full datasets */
+	struct delayed_work	 pccs_demote_work;
+	bool			 pccs_stopping;
+	/* Helpers to copy the data of a file in parallel on attach */
+	struct workqueue_struct	*pccs_copy_wq;
+	/* Max number of threads copying one file, including the caller */
+	unsigned int		 pccs_copy_threads;
 };
 
+#define PCC_COPY_THREADS_DEFAULT	4
+#define PCC_COPY_THREADS_MAX		16
+
 struct pcc_inode {
 	struct ll_inode_info	*pcci_lli;
 	/* Cache path on local file system */
@@ -159,6 +196,12 @@ struct pcc_inode {
 	atomic_t		 pcci_active_ios;
 	/* Waitq - wait for PCC I/O completion. */
 	wait_queue_head_t	 pcci_waitq;
+	/* Dataset the file is cached in, holds a reference */
+	struct pcc_dataset	*pcci_dataset;
+	/* Linked to pccd_lru */
+	struct list_head	 pcci_lru;
+	/* Last time the PCC copy was used, for LRU demotion */
+	time64_t		 pcci_atime;
 };
 
 struct pcc_file {
@@ -207,6 +250,9 @@ struct pcc_cmd {
 			struct list_head	 pccc_conds;
 			char			*pccc_conds_str;
 			enum pcc_dataset_flags	 pccc_flags;
+			__u32			 pccc_tier;
+			__u64			 pccc_heat_thresh;
+			__u32			 pccc_max_usage;
 		} pccc_add;
 		struct pcc_cmd_del {
 			__u32			 pccc_pad;
@@ -220,6 +266,7 @@ struct pcc_create_attach {
 };
 
 int pcc_super_init(struct pcc_super *super);
+void pcc_super_stop(struct pcc_super *super);
 void pcc_super_fini(struct pcc_super *super);
 int pcc_cmd_handle(char *buffer, unsigned long count,
 		   struct pcc_super *super);
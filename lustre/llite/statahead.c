@@ -79,6 +79,25 @@ struct sa_entry {
 	struct qstr			 se_qstr;
 	/* entry fid */
 	struct lu_fid			 se_fid;
+	/* getxattr batched with the getattr of this entry */
+	struct sa_xattr			*se_xattr;
+};
+
+/*
+ * xattrs of a statahead entry fetched by a getxattr batched along with its
+ * getattr. The two may be replied in any order, even in different RPCs, so
+ * whichever of them finishes last fills the xattr cache of the inode.
+ */
+struct sa_xattr {
+	/* getattr and getxattr not finished yet */
+	atomic_t			 sx_pending;
+	/* inode instantiated by the getattr, NULL if it failed */
+	struct inode			*sx_inode;
+	/* replied getxattr, NULL if it failed */
+	struct md_op_item		*sx_item;
+	struct ll_statahead_info	*sx_sai;
+	/* to finish the getxattr out of ptlrpcd context */
+	struct work_struct		 sx_work;
 };
 
 static unsigned int sai_generation;
@@ -128,7 +147,9 @@ sa_unhash(struct ll_statahead_context *ctx, struct sa_entry *entry)
 static inline int agl_should_run(struct ll_statahead_info *sai,
 				 struct inode *inode)
 {
-	return inode && S_ISREG(inode->i_mode) && sai->sai_agl_task;
+	return inode && sai->sai_agl_task &&
+	       ((S_ISREG(inode->i_mode) && sai->sai_agl_glimpse) ||
+		sai->sai_agl_xattr);
 }
 
 static inline struct ll_inode_info *
@@ -445,6 +466,159 @@ sa_prep_data(struct inode *dir, struct inode *child, struct sa_entry *entry)
 	return item;
 }
 
+/* release the getxattr and fill the xattr cache of the inode with it */
+static void sa_xattr_fini(struct sa_xattr *sx)
+{
+	struct md_op_item *item = sx->sx_item;
+	struct inode *inode = sx->sx_inode;
+	int rc;
+
+	if (item) {
+		struct ptlrpc_request *req = item->mop_pill->rc_req;
+
+		if (inode && lu_fid_eq(ll_inode2fid(inode),
+				       &item->mop_data.op_fid1)) {
+			rc = ll_xattr_cache_install(inode, &item->mop_it,
+						    item->mop_pill);
+			if (rc > 0)
+				atomic_inc(&ll_i2sbi(inode)->ll_sa_xattr_total);
+			CDEBUG(D_READA, "install xattrs: inode = "DFID
+			       ", rc = %d\n", PFID(ll_inode2fid(inode)), rc);
+		}
+		ll_intent_release(&item->mop_it);
+		sa_fini_data(item);
+		ptlrpc_req_finished(req);
+	}
+
+	iput(inode);
+	OBD_FREE_PTR(sx);
+}
+
+/* one of the getattr and the getxattr of an entry is finished */
+static void sa_xattr_put(struct sa_xattr *sx)
+{
+	if (atomic_dec_and_test(&sx->sx_pending))
+		sa_xattr_fini(sx);
+}
+
+static void ll_statahead_xattr_work(struct work_struct *work)
+{
+	struct sa_xattr *sx = container_of(work, struct sa_xattr, sx_work);
+	struct ll_statahead_info *sai = sx->sx_sai;
+	struct ll_inode_info *lli = ll_i2info(sai->sai_dentry->d_inode);
+
+	/* @sx may be freed by this */
+	sa_xattr_put(sx);
+
+	spin_lock(&lli->lli_sa_lock);
+	sai->sai_replied++;
+	spin_unlock(&lli->lli_sa_lock);
+}
+
+/*
+ * Callback for the getxattr batched with a statahead getattr, this is called
+ * in ptlrpcd context. The xattrs are installed from the work queue, because
+ * the inode may not be instantiated yet and its last iput() may block.
+ */
+static int ll_statahead_xattr_interpret(struct md_op_item *item, int rc)
+{
+	struct sa_xattr *sx = (struct sa_xattr *)item->mop_cbdata;
+	struct lookup_intent *it = &item->mop_it;
+
+	ENTRY;
+
+	if (rc == 0 && it->it_status == 0 && it->it_lock_mode != 0) {
+		ptlrpc_request_addref(item->mop_pill->rc_req);
+		sx->sx_item = item;
+	} else {
+		CDEBUG(D_READA, "getxattr "DFID": rc = %d, status = %d\n",
+		       PFID(&item->mop_data.op_fid1), rc, it->it_status);
+		ll_intent_release(it);
+		sa_fini_data(item);
+	}
+
+	INIT_WORK(&sx->sx_work, ll_statahead_xattr_work);
+	schedule_work(&sx->sx_work);
+	RETURN(0);
+}
+
+/*
+ * prepare a getxattr to be batched with the getattr of @entry, so that the
+ * xattr cache of the inode is filled without an RPC of its own.
+ */
+static struct md_op_item *
+sa_prep_xattr_data(struct ll_statahead_info *sai, struct sa_entry *entry,
+		   const struct lu_fid *fid)
+{
+	struct ldlm_enqueue_info *einfo;
+	struct md_op_item *item;
+	struct sa_xattr *sx;
+
+	if (!sai->sai_xattr_batch || !sa_has_batch_handle(sai) ||
+	    fid_is_zero(fid))
+		return NULL;
+
+	OBD_ALLOC_PTR(sx);
+	if (!sx)
+		return NULL;
+
+	OBD_ALLOC_PTR(item);
+	if (!item) {
+		OBD_FREE_PTR(sx);
+		return NULL;
+	}
+
+	item->mop_opc = MD_OP_GETXATTR;
+	item->mop_it.it_op = IT_GETXATTR;
+	item->mop_data.op_fid1 = *fid;
+	item->mop_data.op_valid = OBD_MD_FLXATTR | OBD_MD_FLXATTRLS;
+	item->mop_cb = ll_statahead_xattr_interpret;
+	item->mop_cbdata = sx;
+
+	einfo = &item->mop_einfo;
+	einfo->ei_type = LDLM_IBITS;
+	einfo->ei_mode = it_to_lock_mode(&item->mop_it);
+	einfo->ei_cb_bl = ll_md_blocking_ast;
+	einfo->ei_cb_cp = ldlm_completion_ast;
+	einfo->ei_cb_gl = NULL;
+	einfo->ei_cbdata = NULL;
+	einfo->ei_req_slot = 1;
+
+	/* put by both the getattr and the getxattr */
+	atomic_set(&sx->sx_pending, 2);
+	sx->sx_sai = sai;
+	entry->se_xattr = sx;
+
+	return item;
+}
+
+/* the getattr of @entry was not sent, drop the getxattr prepared for it */
+static void sa_xattr_cancel(struct sa_entry *entry, struct md_op_item *item)
+{
+	OBD_FREE_PTR(entry->se_xattr);
+	entry->se_xattr = NULL;
+	sa_fini_data(item);
+}
+
+/* send the getxattr after the getattr of the entry in the same batch */
+static void sa_getxattr(struct ll_statahead_info *sai, struct inode *dir,
+			struct md_op_item *item)
+{
+	struct sa_xattr *sx = (struct sa_xattr *)item->mop_cbdata;
+	int rc;
+
+	rc = md_batch_add(ll_i2mdexp(dir), sai->sai_bh, item);
+	if (rc < 0) {
+		CDEBUG(D_READA, "cannot batch getxattr "DFID": rc = %d\n",
+		       PFID(&item->mop_data.op_fid1), rc);
+		sa_fini_data(item);
+		sa_xattr_put(sx);
+		return;
+	}
+
+	sai->sai_sent++;
+}
+
 /*
  * release resources used in async stat RPC, update entry state and wakeup if
  * scanner process it waiting on this entry.
@@ -658,6 +832,25 @@ static void ll_agl_trigger(struct inode *inode, struct ll_statahead_info *sai)
 		RETURN_EXIT;
 	}
 
+	/*
+	 * Fill the xattr cache before the user gets there, so that tools
+	 * like "ls -l --context" or backup software listing xattrs of each
+	 * entry do not wait for one RPC per file.
+	 */
+	if (sai->sai_agl_xattr) {
+		rc = ll_xattr_cache_prefetch(inode);
+		if (rc > 0)
+			atomic_inc(&ll_i2sbi(inode)->ll_sa_xattr_total);
+		CDEBUG(D_READA, "prefetch xattrs: inode = "DFID", rc = %d\n",
+		       PFID(&lli->lli_fid), rc);
+	}
+
+	if (!S_ISREG(inode->i_mode) || !sai->sai_agl_glimpse) {
+		lli->lli_agl_index = 0;
+		iput(inode);
+		RETURN_EXIT;
+	}
+
 	/*
 	 * In case of restore, the MDT has the right size and has already
 	 * sent it back without granting the layout lock, inode is up-to-date.
@@ -736,6 +929,15 @@ static void ll_statahead_interpret_fini(struct ll_inode_info *lli,
 	sa_fini_data(item);
 	if (req)
 		ptlrpc_req_finished(req);
+
+	if (entry->se_xattr) {
+		struct sa_xattr *sx = entry->se_xattr;
+
+		entry->se_xattr = NULL;
+		if (rc == 0 && entry->se_inode)
+			sx->sx_inode = igrab(entry->se_inode);
+		sa_xattr_put(sx);
+	}
 	sa_make_ready(sai, entry, rc);
 
 	spin_lock(&lli->lli_sa_lock);
@@ -937,6 +1139,8 @@ static inline int sa_getattr(struct ll_statahead_info *sai, struct inode *dir,
 /* async stat for file not found in dcache */
 static int sa_lookup(struct inode *dir, struct sa_entry *entry)
 {
+	struct ll_statahead_info *sai = entry->se_sai;
+	struct md_op_item *xitem;
 	struct md_op_item *item;
 	int rc;
 
@@ -946,9 +1150,15 @@ static int sa_lookup(struct inode *dir, struct sa_entry *entry)
 	if (IS_ERR(item))
 		RETURN(PTR_ERR(item));
 
-	rc = sa_getattr(entry->se_sai, dir, item);
-	if (rc < 0)
+	xitem = sa_prep_xattr_data(sai, entry, &entry->se_fid);
+	rc = sa_getattr(sai, dir, item);
+	if (rc < 0) {
 		sa_fini_data(item);
+		if (xitem)
+			sa_xattr_cancel(entry, xitem);
+	} else if (xitem) {
+		sa_getxattr(sai, dir, xitem);
+	}
 
 	RETURN(rc);
 }
@@ -966,6 +1176,8 @@ static int sa_revalidate(struct inode *dir, struct sa_entry *entry,
 	struct inode *inode = dentry->d_inode;
 	struct lookup_intent it = { .it_op = IT_GETATTR,
 				    .it_lock_handle = 0 };
+	struct ll_statahead_info *sai = entry->se_sai;
+	struct md_op_item *xitem;
 	struct md_op_item *item;
 	int rc;
 
@@ -991,11 +1203,16 @@ static int sa_revalidate(struct inode *dir, struct sa_entry *entry,
 		RETURN(1);
 	}
 
-	rc = sa_getattr(entry->se_sai, dir, item);
+	xitem = sa_prep_xattr_data(sai, entry, ll_inode2fid(inode));
+	rc = sa_getattr(sai, dir, item);
 	if (rc < 0) {
 		entry->se_inode = NULL;
 		iput(inode);
 		sa_fini_data(item);
+		if (xitem)
+			sa_xattr_cancel(entry, xitem);
+	} else if (xitem) {
+		sa_getxattr(sai, dir, xitem);
 	}
 
 	RETURN(rc);
@@ -2082,6 +2299,24 @@ sa_pattern_detect(struct inode *dir, struct dentry *dchild, int *first)
  *			to do it asynchronously.
  * \retval		negative number upon error
  */
+/*
+ * Prefetch xattrs of the entries within the batched statahead RPCs if the
+ * MDT supports it, otherwise with one getxattr per entry from the AGL thread.
+ */
+static void sa_xattr_init(struct ll_statahead_info *sai)
+{
+	struct ll_sb_info *sbi = ll_i2sbi(sai->sai_dentry->d_inode);
+
+	if (!test_bit(LL_SBI_SA_XATTR, sbi->ll_flags) ||
+	    !test_bit(LL_SBI_XATTR_CACHE, sbi->ll_flags))
+		return;
+
+	if (sbi->ll_sa_batch_max && exp_connect_batch_getxattr(sbi->ll_md_exp))
+		sai->sai_xattr_batch = 1;
+	else
+		sai->sai_agl_xattr = 1;
+}
+
 static int start_statahead_thread(struct inode *dir, struct dentry *dentry,
 				  bool agl)
 {
@@ -2170,7 +2405,10 @@ static int start_statahead_thread(struct inode *dir, struct dentry *dentry,
 		GOTO(out, rc);
 	}
 
-	if (test_bit(LL_SBI_AGL_ENABLED, sbi->ll_flags) && agl)
+	sai->sai_agl_glimpse = test_bit(LL_SBI_AGL_ENABLED, sbi->ll_flags) &&
+			       agl;
+	sa_xattr_init(sai);
+	if (sai->sai_agl_glimpse || sai->sai_agl_xattr)
 		ll_start_agl(parent, sai);
 
 	atomic_inc(&sbi->ll_sa_total);
@@ -2404,7 +2642,10 @@ int ll_ioctl_ahead(struct file *file, struct llapi_lu_ladvise2 *ladvise)
 		GOTO(out, rc);
 	}
 
-	if (test_bit(LL_SBI_AGL_ENABLED, sbi->ll_flags) && agl)
+	sai->sai_agl_glimpse = test_bit(LL_SBI_AGL_ENABLED, sbi->ll_flags) &&
+			       agl;
+	sa_xattr_init(sai);
+	if (sai->sai_agl_glimpse || sai->sai_agl_xattr)
 		ll_start_agl(dentry, sai);
 
 	atomic_inc(&sbi->ll_sa_total);
@@ -564,7 +564,7 @@ static int vvp_io_rw_lock(const struct lu_env *env, struct cl_io *io,
 
 	vvp_io_update_iov(env, vio, io);
 
-	if (io->u.ci_rw.crw_nonblock)
+	if (io->u.ci_rw.crw_nonblock || io->ci_iocb_nowait)
 		ast_flags |= CEF_NONBLOCK;
 	if (io->ci_lock_no_expand)
 		ast_flags |= CEF_LOCK_NO_EXPAND;
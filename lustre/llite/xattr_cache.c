@@ -420,21 +420,18 @@ out:
 }
 
 /**
- * Refill the xattr cache.
+ * Fill the xattr cache from a getxattr reply.
  *
- * Fetch and cache the whole of xattrs for @inode, thanks to the write lock
- * on lli_xattrs_list_rwsem obtained from ll_xattr_find_get_lock().
- * If successful, this write lock is kept.
+ * Parse the whole of xattrs for @inode from the IT_GETXATTR reply in @pill
+ * into the cache. The caller holds the write lock on lli_xattrs_list_rwsem.
+ * On error the cache is left empty.
  *
  * \retval 0       no error occured
  * \retval -EPROTO network protocol error
  * \retval -ENOMEM not enough memory for the cache
  */
-static int ll_xattr_cache_refill(struct inode *inode)
+static int ll_xattr_cache_fill(struct inode *inode, struct req_capsule *pill)
 {
-	struct lookup_intent oit = { .it_op = IT_GETXATTR };
-	struct ll_sb_info *sbi = ll_i2sbi(inode);
-	struct ptlrpc_request *req = NULL;
 	const char *xdata, *xval, *xtail, *xvtail;
 	struct ll_inode_info *lli = ll_i2info(inode);
 	struct mdt_body *body;
@@ -443,42 +440,22 @@ static int ll_xattr_cache_refill(struct inode *inode)
 
 	ENTRY;
 
-	CFS_FAIL_TIMEOUT(OBD_FAIL_LLITE_XATTR_PAUSE, cfs_fail_val ?: 2);
-
-	rc = ll_xattr_find_get_lock(inode, &oit, &req);
-	if (rc)
-		GOTO(err_req, rc);
-
-	/* Do we have the data at this point? */
-	if (ll_xattr_cache_filled(lli)) {
-		ll_stats_ops_tally(sbi, LPROC_LL_GETXATTR_HITS, 1);
-		ll_intent_drop_lock(&oit);
-		GOTO(err_req, rc = 0);
-	}
-
-	/* Matched but no cache? Cancelled on error by a parallel refill. */
-	if (unlikely(req == NULL)) {
-		CDEBUG(D_CACHE, "cancelled by a parallel getxattr\n");
-		ll_intent_drop_lock(&oit);
-		GOTO(err_unlock, rc = -EAGAIN);
-	}
-
-	body = req_capsule_server_get(&req->rq_pill, &RMF_MDT_BODY);
+	body = req_capsule_server_get(pill, &RMF_MDT_BODY);
 	if (body == NULL) {
 		CERROR("no MDT BODY in the refill xattr reply\n");
-		GOTO(err_cancel, rc = -EPROTO);
+		RETURN(-EPROTO);
 	}
 	/* do not need swab xattr data */
-	xdata = req_capsule_server_sized_get(&req->rq_pill, &RMF_EADATA,
-						body->mbo_eadatasize);
-	xval = req_capsule_server_sized_get(&req->rq_pill, &RMF_EAVALS,
-						body->mbo_aclsize);
-	xsizes = req_capsule_server_sized_get(&req->rq_pill, &RMF_EAVALS_LENS,
+	xdata = req_capsule_server_sized_get(pill, &RMF_EADATA,
+					     body->mbo_eadatasize);
+	xval = req_capsule_server_sized_get(pill, &RMF_EAVALS,
+					    body->mbo_aclsize);
+	xsizes = req_capsule_server_sized_get(pill, &RMF_EAVALS_LENS,
 					      body->mbo_max_mdsize *
 					      sizeof(__u32));
 	if (xdata == NULL || xval == NULL || xsizes == NULL) {
 		CERROR("wrong setxattr reply\n");
-		GOTO(err_cancel, rc = -EPROTO);
+		RETURN(-EPROTO);
 	}
 
 	xtail = xdata + body->mbo_eadatasize;
@@ -519,7 +496,7 @@ static int ll_xattr_cache_refill(struct inode *inode)
 		}
 		if (rc < 0) {
 			ll_xattr_cache_destroy_locked(lli);
-			GOTO(err_cancel, rc);
+			RETURN(rc);
 		}
 		xdata += strlen(xdata) + 1;
 		xval  += *xsizes;
@@ -531,11 +508,60 @@ static int ll_xattr_cache_refill(struct inode *inode)
 	else
 		set_bit(LLIF_XATTR_CACHE_FILLED, &lli->lli_flags);
 
+	RETURN(0);
+}
+
+/**
+ * Refill the xattr cache.
+ *
+ * Fetch and cache the whole of xattrs for @inode, thanks to the write lock
+ * on lli_xattrs_list_rwsem obtained from ll_xattr_find_get_lock().
+ * If successful, this write lock is kept.
+ *
+ * \retval 1       the cache was filled by this call
+ * \retval 0       the cache was already filled, e.g. by another thread
+ * \retval -EPROTO network protocol error
+ * \retval -ENOMEM not enough memory for the cache
+ */
+static int ll_xattr_cache_refill(struct inode *inode)
+{
+	struct lookup_intent oit = { .it_op = IT_GETXATTR };
+	struct ll_sb_info *sbi = ll_i2sbi(inode);
+	struct ptlrpc_request *req = NULL;
+	struct ll_inode_info *lli = ll_i2info(inode);
+	int rc = 0;
+
+	ENTRY;
+
+	CFS_FAIL_TIMEOUT(OBD_FAIL_LLITE_XATTR_PAUSE, cfs_fail_val ?: 2);
+
+	rc = ll_xattr_find_get_lock(inode, &oit, &req);
+	if (rc)
+		GOTO(err_req, rc);
+
+	/* Do we have the data at this point? */
+	if (ll_xattr_cache_filled(lli)) {
+		ll_stats_ops_tally(sbi, LPROC_LL_GETXATTR_HITS, 1);
+		ll_intent_drop_lock(&oit);
+		GOTO(err_req, rc = 0);
+	}
+
+	/* Matched but no cache? Cancelled on error by a parallel refill. */
+	if (unlikely(req == NULL)) {
+		CDEBUG(D_CACHE, "cancelled by a parallel getxattr\n");
+		ll_intent_drop_lock(&oit);
+		GOTO(err_unlock, rc = -EAGAIN);
+	}
+
+	rc = ll_xattr_cache_fill(inode, &req->rq_pill);
+	if (rc < 0)
+		GOTO(err_cancel, rc);
+
 	ll_set_lock_data(sbi->ll_md_exp, inode, &oit, NULL);
 	ll_intent_drop_lock(&oit);
 
 	ptlrpc_req_finished(req);
-	RETURN(0);
+	RETURN(1);
 
 err_cancel:
 	ldlm_lock_decref_and_cancel((struct lustre_handle *)
@@ -587,8 +613,9 @@ int ll_xattr_cache_get(struct inode *inode,
 	    !ll_xattr_cache_filled(lli)) {
 		up_read(&lli->lli_xattrs_list_rwsem);
 		rc = ll_xattr_cache_refill(inode);
-		if (rc)
+		if (rc < 0)
 			RETURN(rc);
+		rc = 0;
 		/* Turn the write lock obtained in ll_xattr_cache_refill()
 		 * into a read lock.
 		 */
@@ -642,6 +669,92 @@ out:
 	RETURN(rc);
 }
 
+/**
+ * Fill the xattr cache of @inode in advance, e.g. from statahead, so that
+ * the following getxattr/listxattr are served locally.
+ *
+ * \retval 1       the cache was filled by this call
+ * \retval 0       the cache is disabled or was already filled
+ * \retval < 0     from ll_xattr_cache_refill()
+ */
+int ll_xattr_cache_prefetch(struct inode *inode)
+{
+	struct ll_inode_info *lli = ll_i2info(inode);
+	int rc;
+
+	ENTRY;
+
+	if (!test_bit(LL_SBI_XATTR_CACHE, ll_i2sbi(inode)->ll_flags))
+		RETURN(0);
+
+	down_read(&lli->lli_xattrs_list_rwsem);
+	rc = ll_xattr_cache_filled(lli);
+	up_read(&lli->lli_xattrs_list_rwsem);
+	if (rc)
+		RETURN(0);
+
+	/* refill returns 0 if another thread filled the cache meanwhile */
+	rc = ll_xattr_cache_refill(inode);
+	if (rc < 0)
+		RETURN(rc);
+
+	up_write(&lli->lli_xattrs_list_rwsem);
+	RETURN(rc);
+}
+
+/**
+ * Install the xattrs fetched for @inode by an IT_GETXATTR intent sent by
+ * someone else, e.g. batched with the statahead getattr, into the cache.
+ *
+ * The lock in @it is attached to @inode on success and the reference taken
+ * on it by the enqueue is dropped in any case.
+ *
+ * \retval 1       the cache was filled by this call
+ * \retval 0       the cache is disabled or was already filled
+ * \retval < 0     from ll_xattr_cache_fill()
+ */
+int ll_xattr_cache_install(struct inode *inode, struct lookup_intent *it,
+			   struct req_capsule *pill)
+{
+	struct ll_inode_info *lli = ll_i2info(inode);
+	struct ll_sb_info *sbi = ll_i2sbi(inode);
+	int rc;
+
+	ENTRY;
+
+	if (!test_bit(LL_SBI_XATTR_CACHE, sbi->ll_flags)) {
+		ll_intent_drop_lock(it);
+		RETURN(0);
+	}
+
+	/* same lock order as ll_xattr_find_get_lock() */
+	mutex_lock(&lli->lli_xattrs_enq_lock);
+	down_write(&lli->lli_xattrs_list_rwsem);
+	mutex_unlock(&lli->lli_xattrs_enq_lock);
+
+	if (ll_xattr_cache_filled(lli)) {
+		ll_intent_drop_lock(it);
+		GOTO(out_unlock, rc = 0);
+	}
+
+	rc = ll_xattr_cache_fill(inode, pill);
+	if (rc < 0) {
+		/* do not let the lock be matched for the empty cache */
+		ldlm_lock_decref_and_cancel((struct lustre_handle *)
+					    &it->it_lock_handle,
+					    it->it_lock_mode);
+		it->it_lock_mode = 0;
+		GOTO(out_unlock, rc);
+	}
+
+	ll_set_lock_data(sbi->ll_md_exp, inode, it, NULL);
+	ll_intent_drop_lock(it);
+	rc = 1;
+out_unlock:
+	up_write(&lli->lli_xattrs_list_rwsem);
+	RETURN(rc);
+}
+
 /**
  * Insert an xattr value into the cache.
  *
@@ -37,6 +37,10 @@
 
 #define LMV_MAX_TGT_COUNT 128
 
+/* threads to read pages of striped directory from stripes in parallel */
+#define LMV_READDIR_THREADS_DEFAULT	8
+#define LMV_READDIR_THREADS_MAX		64
+
 #define LL_IT2STR(it)				        \
 	((it) ? ldlm_it2str((it)->it_op) : "0")
 
@@ -571,6 +571,32 @@ static void lmv_statfs_update(struct lmv_obd *lmv, struct lmv_tgt_desc *tgt,
 	tgt->ltd_statfs_age = ktime_get_seconds();
 	spin_unlock(&lmv->lmv_lock);
 	set_bit(LQ_DIRTY, &lmv->lmv_qos.lq_flags);
+	set_bit(LQ_LOAD_DIRTY, &lmv->lmv_qos.lq_flags);
+}
+
+/*
+ * Recalculate the MDT load scales once after their statfs data changed,
+ * rather than for each MDT statfs reply. lq_rw_sem serializes the updates
+ * of ltq_load_scale, lmv_lock keeps the statfs data stable meanwhile.
+ */
+static void lmv_qos_load_update(struct lmv_obd *lmv)
+{
+	if (!test_bit(LQ_LOAD_DIRTY, &lmv->lmv_qos.lq_flags))
+		return;
+
+	down_write(&lmv->lmv_qos.lq_rw_sem);
+	if (test_and_clear_bit(LQ_LOAD_DIRTY, &lmv->lmv_qos.lq_flags)) {
+		spin_lock(&lmv->lmv_lock);
+		ltd_qos_load_update(&lmv->lmv_mdt_descs);
+		spin_unlock(&lmv->lmv_lock);
+	}
+	up_write(&lmv->lmv_qos.lq_rw_sem);
+}
+
+/* MDT load would at least halve its weight, see ltd_qos_load_update() */
+static inline bool lmv_tgt_overloaded(struct lmv_tgt_desc *tgt)
+{
+	return tgt->ltd_qos.ltq_load_scale < QOS_LOAD_SCALE_MAX / 2;
 }
 
 static int lmv_fid2path(struct obd_export *exp, int len, void *karg,
@@ -1203,6 +1229,18 @@ static int lmv_setup(struct obd_device *obd, struct lustre_cfg *lcfg)
 		}
 	}
 
+	lmv->lmv_readdir_threads = LMV_READDIR_THREADS_DEFAULT;
+	lmv->lmv_readdir_wq = cfs_cpt_bind_workqueue("lmv-readdir",
+						     cfs_cpt_tab, 0,
+						     CFS_CPT_ANY,
+						     LMV_READDIR_THREADS_MAX);
+	if (IS_ERR(lmv->lmv_readdir_wq)) {
+		/* stripes will be read one by one */
+		CWARN("%s: cannot start readdir threads: rc = %ld\n",
+		      obd->obd_name, PTR_ERR(lmv->lmv_readdir_wq));
+		lmv->lmv_readdir_wq = NULL;
+	}
+
 	rc = lmv_tunables_init(obd);
 	if (rc)
 		CWARN("%s: error adding LMV sysfs/debugfs files: rc = %d\n",
@@ -1232,6 +1270,11 @@ static int lmv_cleanup(struct obd_device *obd)
 	fld_client_fini(&lmv->lmv_fld);
 	fld_client_debugfs_fini(&lmv->lmv_fld);
 
+	if (lmv->lmv_readdir_wq) {
+		destroy_workqueue(lmv->lmv_readdir_wq);
+		lmv->lmv_readdir_wq = NULL;
+	}
+
 	lprocfs_obd_cleanup(obd);
 	lprocfs_free_md_stats(obd);
 
@@ -1368,6 +1411,7 @@ static int lmv_statfs(const struct lu_env *env, struct obd_export *exp,
 			osfs->os_granted += temp->os_granted;
 		}
 	}
+	lmv_qos_load_update(lmv);
 	/* There is no stats from some MDTs, data incomplete */
 	if (err)
 		rc = err;
@@ -1591,11 +1635,13 @@ static struct lu_tgt_desc *lmv_locate_tgt_qos(struct lmv_obd *lmv,
 	 * average free space, while deep dirs prefer local until more full.
 	 *    depth=0 -> 160%, depth=3 -> 123%, depth=6 -> 100%,
 	 *    depth=9 -> 84%, depth=12 -> 73%, depth=15 -> 64%
+	 * An overloaded parent MDT is left regardless of its space.
 	 */
 	if (!lmv_op_default_rr_mkdir(op_data)) {
 		rand = total_avail * 16 /
 			(total_usable * (op_data->op_dir_depth + 10));
-		if (cur && cur->ltd_qos.ltq_avail >= rand) {
+		if (cur && cur->ltd_qos.ltq_avail >= rand &&
+		    !lmv_tgt_overloaded(cur)) {
 			tgt = cur;
 			GOTO(unlock, tgt);
 		}
@@ -1626,22 +1672,26 @@ unlock:
 static struct lu_tgt_desc *lmv_locate_tgt_rr(struct lmv_obd *lmv)
 {
 	struct lu_tgt_desc *tgt;
+	int size;
 	int i;
 	int index;
 
 	ENTRY;
 
 	spin_lock(&lmv->lmv_lock);
-	for (i = 0; i < lmv->lmv_mdt_descs.ltd_tgts_size; i++) {
-		index = (i + lmv->lmv_qos_rr_index) %
-			lmv->lmv_mdt_descs.ltd_tgts_size;
+	size = lmv->lmv_mdt_descs.ltd_tgts_size;
+	/* the first round skips overloaded MDTs, the second one takes any */
+	for (i = 0; i < 2 * size; i++) {
+		index = (i + lmv->lmv_qos_rr_index) % size;
 		tgt = lmv_tgt(lmv, index);
 		if (!tgt || !tgt->ltd_exp || !tgt->ltd_active ||
 		    (tgt->ltd_statfs.os_state & OS_STATFS_NOCREATE))
 			continue;
 
-		lmv->lmv_qos_rr_index = (tgt->ltd_index + 1) %
-					lmv->lmv_mdt_descs.ltd_tgts_size;
+		if (i < size && lmv_tgt_overloaded(tgt))
+			continue;
+
+		lmv->lmv_qos_rr_index = (tgt->ltd_index + 1) % size;
 		spin_unlock(&lmv->lmv_lock);
 
 		RETURN(tgt);
@@ -1974,12 +2024,15 @@ static struct lu_tgt_desc *lmv_locate_tgt_by_space(struct lmv_obd *lmv,
 {
 	struct lmv_tgt_desc *tmp = tgt;
 
+	/* pick up the statfs data refreshed asynchronously */
+	lmv_qos_load_update(lmv);
 	tgt = lmv_locate_tgt_qos(lmv, op_data);
 	if (tgt == ERR_PTR(-EAGAIN)) {
 		if (ltd_qos_is_balanced(&lmv->lmv_mdt_descs) &&
 		    !lmv_op_default_rr_mkdir(op_data) &&
 		    !lmv_op_user_qos_mkdir(op_data) &&
-		    !(tmp->ltd_statfs.os_state & OS_STATFS_NOCREATE))
+		    !(tmp->ltd_statfs.os_state & OS_STATFS_NOCREATE) &&
+		    !lmv_tgt_overloaded(tmp))
 			/* if not necessary, don't create remote directory. */
 			tgt = tmp;
 		else
@@ -2777,15 +2830,228 @@ static struct lu_dirent *stripe_dirent_get(struct lmv_dir_ctxt *ctxt,
 	return ent;
 }
 
-static struct lu_dirent *stripe_dirent_load(struct lmv_dir_ctxt *ctxt,
-					    struct stripe_dirent *stripe,
-					    int stripe_index)
+/*
+ * Read the page of stripe \a stripe_index containing \a hash, with
+ * \a op_data set to the stripe during the call.
+ */
+static int stripe_read_page(struct lmv_dir_ctxt *ctxt,
+			    struct md_op_data *op_data, int stripe_index,
+			    __u64 hash, struct page **ppage)
 {
-	struct md_op_data *op_data = ctxt->ldc_op_data;
 	struct lmv_oinfo *oinfo;
 	struct lu_fid fid = op_data->op_fid1;
 	struct inode *inode = op_data->op_data;
 	struct lmv_tgt_desc *tgt;
+	int rc;
+
+	oinfo = &op_data->op_lso1->lso_lsm.lsm_md_oinfo[stripe_index];
+	if (!oinfo->lmo_root)
+		return -ENOENT;
+
+	tgt = lmv_tgt(ctxt->ldc_lmv, oinfo->lmo_mds);
+	if (!tgt)
+		return -ENODEV;
+
+	/* op_data is shared by stripes, reset after use */
+	op_data->op_fid1 = oinfo->lmo_fid;
+	op_data->op_fid2 = oinfo->lmo_fid;
+	op_data->op_data = oinfo->lmo_root;
+
+	rc = md_read_page(tgt->ltd_exp, op_data, ctxt->ldc_mrinfo, hash, ppage);
+
+	op_data->op_fid1 = fid;
+	op_data->op_fid2 = fid;
+	op_data->op_data = inode;
+
+	return rc;
+}
+
+/* pages of different stripes to read from MDTs in parallel */
+struct lmv_readdir_batch {
+	struct lmv_dir_ctxt	*lrb_ctxt;
+	const struct cred	*lrb_cred;
+	/* stripe index and hash of each page */
+	int			*lrb_index;
+	__u64			*lrb_hash;
+	int			 lrb_count;
+	/* next page to read */
+	atomic_t		 lrb_next;
+	/* number of helpers still running */
+	atomic_t		 lrb_pending;
+	struct completion	 lrb_done;
+};
+
+struct lmv_readdir_work {
+	struct work_struct	 lrw_work;
+	struct lmv_readdir_batch *lrw_batch;
+};
+
+/*
+ * Read pages of the batch into the page cache of stripes until all are
+ * taken. Errors are ignored, the page will be read again by
+ * stripe_dirent_load() which reports them.
+ */
+static void lmv_readdir_batch_read(struct lmv_readdir_batch *batch)
+{
+	struct lmv_dir_ctxt *ctxt = batch->lrb_ctxt;
+	const struct cred *old_cred;
+	struct md_op_data *op_data;
+	struct page *page;
+	int i;
+
+	/* each thread needs its own op_data */
+	OBD_ALLOC_PTR(op_data);
+	if (!op_data)
+		return;
+
+	*op_data = *ctxt->ldc_op_data;
+	op_data->op_cli_flags &= ~CLI_READ_CACHED;
+
+	old_cred = override_creds(batch->lrb_cred);
+	while ((i = atomic_inc_return(&batch->lrb_next) - 1) <
+	       batch->lrb_count) {
+		if (stripe_read_page(ctxt, op_data, batch->lrb_index[i],
+				     batch->lrb_hash[i], &page))
+			continue;
+
+		kunmap(page);
+		put_page(page);
+	}
+	revert_creds(old_cred);
+
+	OBD_FREE_PTR(op_data);
+}
+
+static void lmv_readdir_work_handler(struct work_struct *work)
+{
+	struct lmv_readdir_work *lrw;
+	struct lmv_readdir_batch *batch;
+
+	lrw = container_of(work, struct lmv_readdir_work, lrw_work);
+	batch = lrw->lrw_batch;
+	lmv_readdir_batch_read(batch);
+	if (atomic_dec_and_test(&batch->lrb_pending))
+		complete(&batch->lrb_done);
+}
+
+/*
+ * Check whether the page of stripe \a stripe_index containing \a hash is
+ * cached, and add it to \a batch if not.
+ */
+static void lmv_readdir_batch_add(struct lmv_readdir_batch *batch,
+				  int stripe_index, __u64 hash)
+{
+	struct lmv_dir_ctxt *ctxt = batch->lrb_ctxt;
+	struct md_op_data *op_data = ctxt->ldc_op_data;
+	struct page *page;
+	int rc;
+
+	op_data->op_cli_flags |= CLI_READ_CACHED;
+	rc = stripe_read_page(ctxt, op_data, stripe_index, hash, &page);
+	op_data->op_cli_flags &= ~CLI_READ_CACHED;
+	if (!rc) {
+		kunmap(page);
+		put_page(page);
+		return;
+	}
+
+	if (rc != -EAGAIN)
+		return;
+
+	batch->lrb_index[batch->lrb_count] = stripe_index;
+	batch->lrb_hash[batch->lrb_count] = hash;
+	batch->lrb_count++;
+}
+
+/*
+ * Page of stripe \a stripe_index at \a hash is not cached, read it from MDT
+ * together with the pages of other stripes that will be needed soon.
+ *
+ * Stripes not loaded yet need their page at ldc_hash. The others need the
+ * page after their current one, because a merged page consumes at most one
+ * page of entries from any stripe. Pages cached already are skipped, and
+ * the rest are read by the caller and up to lmv_readdir_threads - 1 helpers
+ * on lmv_readdir_wq. Stripes of a wide striped directory are usually read
+ * ahead by the same number of pages, so they run out of cached pages at
+ * about the same time, and are read in parallel here.
+ */
+static void lmv_readdir_prefetch(struct lmv_dir_ctxt *ctxt, int stripe_index,
+				 __u64 hash)
+{
+	struct lmv_obd *lmv = ctxt->ldc_lmv;
+	struct lmv_readdir_batch batch = { .lrb_ctxt = ctxt };
+	struct lmv_readdir_work *works = NULL;
+	struct stripe_dirent *stripe;
+	unsigned int nr_helpers = 0;
+	__u64 end;
+	int i;
+
+	OBD_ALLOC_PTR_ARRAY(batch.lrb_index, ctxt->ldc_count);
+	OBD_ALLOC_PTR_ARRAY(batch.lrb_hash, ctxt->ldc_count);
+	if (!batch.lrb_index || !batch.lrb_hash)
+		GOTO(out, 0);
+
+	batch.lrb_index[0] = stripe_index;
+	batch.lrb_hash[0] = hash;
+	batch.lrb_count = 1;
+	for (i = 0; i < ctxt->ldc_count; i++) {
+		stripe = &ctxt->ldc_stripes[i];
+		if (i == stripe_index || stripe->sd_eof)
+			continue;
+
+		if (!stripe->sd_page) {
+			lmv_readdir_batch_add(&batch, i, ctxt->ldc_hash);
+			continue;
+		}
+
+		end = le64_to_cpu(stripe->sd_dp->ldp_hash_end);
+		if (end != MDS_DIR_END_OFF)
+			lmv_readdir_batch_add(&batch, i, end);
+	}
+
+	/* only the page of this stripe, read it in stripe_dirent_load() */
+	if (batch.lrb_count == 1)
+		GOTO(out, 0);
+
+	batch.lrb_cred = current_cred();
+	atomic_set(&batch.lrb_next, 0);
+	init_completion(&batch.lrb_done);
+
+	nr_helpers = min_t(unsigned int, READ_ONCE(lmv->lmv_readdir_threads),
+			   batch.lrb_count) - 1;
+	if (nr_helpers > 0) {
+		OBD_ALLOC_PTR_ARRAY(works, nr_helpers);
+		if (!works)
+			nr_helpers = 0;
+	}
+
+	atomic_set(&batch.lrb_pending, nr_helpers);
+	for (i = 0; i < nr_helpers; i++) {
+		INIT_WORK(&works[i].lrw_work, lmv_readdir_work_handler);
+		works[i].lrw_batch = &batch;
+		queue_work(lmv->lmv_readdir_wq, &works[i].lrw_work);
+	}
+
+	lmv_readdir_batch_read(&batch);
+	if (nr_helpers > 0) {
+		wait_for_completion(&batch.lrb_done);
+		OBD_FREE_PTR_ARRAY(works, nr_helpers);
+	}
+
+	CDEBUG(D_INODE, "dir "DFID" read %d stripe pages with %u helpers\n",
+	       PFID(&ctxt->ldc_op_data->op_fid1), batch.lrb_count, nr_helpers);
+out:
+	if (batch.lrb_index)
+		OBD_FREE_PTR_ARRAY(batch.lrb_index, ctxt->ldc_count);
+	if (batch.lrb_hash)
+		OBD_FREE_PTR_ARRAY(batch.lrb_hash, ctxt->ldc_count);
+}
+
+static struct lu_dirent *stripe_dirent_load(struct lmv_dir_ctxt *ctxt,
+					    struct stripe_dirent *stripe,
+					    int stripe_index)
+{
+	struct md_op_data *op_data = ctxt->ldc_op_data;
 	struct lu_dirent *ent = stripe->sd_ent;
 	__u64 hash = ctxt->ldc_hash;
 	int rc = 0;
@@ -2813,33 +3079,25 @@ static struct lu_dirent *stripe_dirent_load(struct lmv_dir_ctxt *ctxt,
 			hash = end;
 		}
 
-		oinfo = &op_data->op_lso1->lso_lsm.lsm_md_oinfo[stripe_index];
-		if (!oinfo->lmo_root) {
-			rc = -ENOENT;
-			break;
+		if (ctxt->ldc_count > 1 && ctxt->ldc_lmv->lmv_readdir_wq &&
+		    READ_ONCE(ctxt->ldc_lmv->lmv_readdir_threads) > 1) {
+			op_data->op_cli_flags |= CLI_READ_CACHED;
+			rc = stripe_read_page(ctxt, op_data, stripe_index,
+					      hash, &stripe->sd_page);
+			op_data->op_cli_flags &= ~CLI_READ_CACHED;
+			if (rc == -EAGAIN)
+				lmv_readdir_prefetch(ctxt, stripe_index, hash);
+			else if (rc)
+				break;
 		}
 
-		tgt = lmv_tgt(ctxt->ldc_lmv, oinfo->lmo_mds);
-		if (!tgt) {
-			rc = -ENODEV;
-			break;
+		if (!stripe->sd_page) {
+			rc = stripe_read_page(ctxt, op_data, stripe_index,
+					      hash, &stripe->sd_page);
+			if (rc)
+				break;
 		}
 
-		/* op_data is shared by stripes, reset after use */
-		op_data->op_fid1 = oinfo->lmo_fid;
-		op_data->op_fid2 = oinfo->lmo_fid;
-		op_data->op_data = oinfo->lmo_root;
-
-		rc = md_read_page(tgt->ltd_exp, op_data, ctxt->ldc_mrinfo, hash,
-				  &stripe->sd_page);
-
-		op_data->op_fid1 = fid;
-		op_data->op_fid2 = fid;
-		op_data->op_data = inode;
-
-		if (rc)
-			break;
-
 		stripe->sd_dp = page_address(stripe->sd_page);
 		ent = stripe_dirent_get(ctxt, lu_dirent_start(stripe->sd_dp),
 					stripe_index);
@@ -4153,6 +4411,12 @@ lmv_batch_locate_tgt(struct lmv_obd *lmv, struct md_op_item *item)
 
 		break;
 	}
+	case MD_OP_GETXATTR:
+		if (!fid_is_sane(&op_data->op_fid1))
+			RETURN(ERR_PTR(-EINVAL));
+
+		tgt = lmv_fid2tgt(lmv, &op_data->op_fid1);
+		break;
 	default:
 		tgt = ERR_PTR(-ENOTSUPP);
 	}
@@ -149,6 +149,59 @@ static ssize_t qos_prio_free_store(struct kobject *kobj,
 }
 LUSTRE_RW_ATTR(qos_prio_free);
 
+/*
+ * Show how much the load reported by the MDTs reduces their chance to be
+ * selected for new directories, 0% ignores the load.
+ */
+static ssize_t qos_prio_load_show(struct kobject *kobj,
+				  struct attribute *attr,
+				  char *buf)
+{
+	struct obd_device *obd = container_of(kobj, struct obd_device,
+					      obd_kset.kobj);
+
+	return scnprintf(buf, PAGE_SIZE, "%u%%\n",
+			(obd->u.lmv.lmv_qos.lq_prio_load * 100 + 255) >> 8);
+}
+
+static ssize_t qos_prio_load_store(struct kobject *kobj,
+				   struct attribute *attr,
+				   const char *buffer,
+				   size_t count)
+{
+	struct obd_device *obd = container_of(kobj, struct obd_device,
+					      obd_kset.kobj);
+	struct lmv_obd *lmv = &obd->u.lmv;
+	char buf[6], *tmp;
+	unsigned int val;
+	int rc;
+
+	/* "100%\n\0" should be largest string */
+	if (count >= sizeof(buf))
+		return -ERANGE;
+
+	strncpy(buf, buffer, sizeof(buf));
+	buf[sizeof(buf) - 1] = '\0';
+	tmp = strchr(buf, '%');
+	if (tmp)
+		*tmp = '\0';
+
+	rc = kstrtouint(buf, 0, &val);
+	if (rc)
+		return rc;
+
+	if (val > 100)
+		return -EINVAL;
+
+	lmv->lmv_qos.lq_prio_load = (val << 8) / 100;
+	set_bit(LQ_DIRTY, &lmv->lmv_qos.lq_flags);
+	/* apply it to the statfs data we already have */
+	set_bit(LQ_LOAD_DIRTY, &lmv->lmv_qos.lq_flags);
+
+	return count;
+}
+LUSTRE_RW_ATTR(qos_prio_load);
+
 static ssize_t qos_threshold_rr_show(struct kobject *kobj,
 				     struct attribute *attr,
 				     char *buf)
@@ -197,6 +250,41 @@ static ssize_t qos_threshold_rr_store(struct kobject *kobj,
 }
 LUSTRE_RW_ATTR(qos_threshold_rr);
 
+static ssize_t readdir_threads_show(struct kobject *kobj,
+				    struct attribute *attr,
+				    char *buf)
+{
+	struct obd_device *obd = container_of(kobj, struct obd_device,
+					      obd_kset.kobj);
+
+	return scnprintf(buf, PAGE_SIZE, "%u\n",
+			 obd->u.lmv.lmv_readdir_threads);
+}
+
+/* 1 reads stripes of a striped directory one by one */
+static ssize_t readdir_threads_store(struct kobject *kobj,
+				     struct attribute *attr,
+				     const char *buffer,
+				     size_t count)
+{
+	struct obd_device *obd = container_of(kobj, struct obd_device,
+					      obd_kset.kobj);
+	unsigned int val;
+	int rc;
+
+	rc = kstrtouint(buffer, 0, &val);
+	if (rc)
+		return rc;
+
+	if (val < 1 || val > LMV_READDIR_THREADS_MAX)
+		return -ERANGE;
+
+	WRITE_ONCE(obd->u.lmv.lmv_readdir_threads, val);
+
+	return count;
+}
+LUSTRE_RW_ATTR(readdir_threads);
+
 #ifdef CONFIG_PROC_FS
 static void *lmv_tgt_seq_start(struct seq_file *p, loff_t *pos)
 {
@@ -286,7 +374,9 @@ static struct attribute *lmv_attrs[] = {
 	&lustre_attr_numobd.attr,
 	&lustre_attr_qos_maxage.attr,
 	&lustre_attr_qos_prio_free.attr,
+	&lustre_attr_qos_prio_load.attr,
 	&lustre_attr_qos_threshold_rr.attr,
+	&lustre_attr_readdir_threads.attr,
 	NULL,
 };
 
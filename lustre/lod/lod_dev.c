@@ -2363,6 +2363,11 @@ static void lod_key_fini(const struct lu_context *ctx,
 
 	lod_avoid_guide_fini(&info->lti_avoid);
 
+	if (info->lti_qos_tree.lqt_size > 0)
+		OBD_FREE_LARGE(info->lti_qos_tree.lqt_sum,
+			       (2 * info->lti_qos_tree.lqt_size + 1) *
+			       sizeof(__u64));
+
 	OBD_FREE_PTR(info);
 }
 
@@ -105,6 +105,20 @@ struct lod_avoid_guide {
 	__u32			lag_ost_avail;
 };
 
+/* Fenwick tree over the weights of QoS stripe candidates, see lod_qos.c */
+struct lod_qos_tree {
+	/* prefix sums, 1-based */
+	__u64			*lqt_sum;
+	/* weight currently held by each candidate slot */
+	__u64			*lqt_weight;
+	/* sum of all slot weights */
+	__u64			lqt_total;
+	/* number of candidate slots in use */
+	unsigned int		lqt_count;
+	/* number of slots allocated */
+	unsigned int		lqt_size;
+};
+
 #define LOD_DOM_MIN_SIZE_KB (LOV_MIN_STRIPE_SIZE >> 10)
 #define LOD_DOM_SFS_MAX_AGE 10
 
@@ -439,6 +453,8 @@ struct lod_thread_info {
 	struct lu_attr			lti_layout_attr;
 	/* object allocation avoid guide info */
 	struct lod_avoid_guide		lti_avoid;
+	/* weighted OST selection for lod_ost_alloc_qos() */
+	struct lod_qos_tree		lti_qos_tree;
 	union lmv_mds_md		lti_lmv;
 	struct dt_allocation_hint	lti_ah;
 	int lti_obj_count;
@@ -197,7 +197,8 @@ int lod_add_device(const struct lu_env *env, struct lod_device *lod,
 					   OBD_CONNECT_PINGLESS |
 					   OBD_CONNECT_LFSCK |
 					   OBD_CONNECT_BULK_MBITS;
-		data->ocd_connect_flags2 = OBD_CONNECT2_REPLAY_CREATE;
+		data->ocd_connect_flags2 = OBD_CONNECT2_REPLAY_CREATE |
+					   OBD_CONNECT2_SYNC_BATCH;
 
 		data->ocd_group = tgt_index;
 		ltd = &lod->lod_ost_descs;
@@ -1506,6 +1506,186 @@ static int lod_attr_set(const struct lu_env *env,
 	RETURN(rc);
 }
 
+/* OST object of a component referenced for lod_som_ost_get() */
+struct lod_som_stripe {
+	struct dt_object	*lss_obj;
+	__u32			 lss_stripe_size;
+	__u16			 lss_stripe_count;
+	__u16			 lss_stripe_idx;
+};
+
+/**
+ * Compute the file size covered by one stripe of a component.
+ *
+ * This is the server side of lov_stripe_size(): \a ost_size bytes in
+ * the stripe described by \a lss end at the returned file offset.
+ */
+static __u64 lod_comp_stripe_size(const struct lod_som_stripe *lss,
+				  __u64 ost_size)
+{
+	__u64 swidth = (__u64)lss->lss_stripe_size * lss->lss_stripe_count;
+	__u32 rem;
+
+	if (ost_size == 0)
+		return 0;
+
+	ost_size = div_u64_rem(ost_size, lss->lss_stripe_size, &rem);
+	if (rem)
+		return ost_size * swidth +
+		       lss->lss_stripe_idx * lss->lss_stripe_size + rem;
+
+	return (ost_size - 1) * swidth +
+	       (lss->lss_stripe_idx + 1) * (__u64)lss->lss_stripe_size;
+}
+
+/**
+ * Get size and blocks of a regular file from its OST objects.
+ *
+ * Cached attributes of all instantiated OST objects are dropped and fetched
+ * again from the OSTs. The file size is the largest size covered by any
+ * stripe, the blocks are the sum of all objects, including the local object
+ * for a DoM component. The result is returned in \a buf as the on-disk
+ * struct lustre_som_attrs, so it can be stored as XATTR_NAME_SOM directly.
+ *
+ * The OST objects are referenced under ldo_layout_mutex and queried after
+ * it is dropped, so a layout change is not blocked by OST RPCs.
+ *
+ * \param[in] env	execution environment
+ * \param[in] lo	LOD object
+ * \param[out] buf	buffer to store struct lustre_som_attrs
+ *
+ * \retval		sizeof(struct lustre_som_attrs) on success
+ * \retval		-ENODATA if the file has no OST object
+ * \retval		negative errno on other failures
+ */
+static int lod_som_ost_get(const struct lu_env *env, struct lod_object *lo,
+			   struct lu_buf *buf)
+{
+	struct dt_object *next = dt_object_child(&lo->ldo_obj);
+	struct lu_attr *attr = &lod_env_info(env)->lti_attr;
+	struct lod_layout_component *comp;
+	struct lod_som_stripe *stripes = NULL;
+	struct lustre_som_attrs *som;
+	__u64 size = 0;
+	__u64 blocks = 0;
+	bool has_dom = false;
+	bool found = false;
+	int nr = 0;
+	int cnt = 0;
+	int i, j;
+	int rc;
+
+	ENTRY;
+
+	if (!S_ISREG(lo->ldo_obj.do_lu.lo_header->loh_attr))
+		RETURN(-ENODATA);
+
+	if (buf->lb_buf == NULL || buf->lb_len == 0)
+		RETURN(sizeof(*som));
+
+	if (buf->lb_len < sizeof(*som))
+		RETURN(-ERANGE);
+
+	rc = lod_striping_load(env, lo);
+	if (rc)
+		RETURN(rc);
+
+	mutex_lock(&lo->ldo_layout_mutex);
+	for (i = 0; i < lo->ldo_comp_cnt; i++) {
+		comp = &lo->ldo_comp_entries[i];
+
+		if (comp->llc_magic == LOV_MAGIC_FOREIGN ||
+		    !lod_comp_inited(comp))
+			continue;
+
+		if (comp->llc_pattern & LOV_PATTERN_MDT) {
+			has_dom = true;
+			continue;
+		}
+
+		if (comp->llc_stripe != NULL)
+			cnt += comp->llc_stripe_count;
+	}
+
+	if (cnt > 0) {
+		OBD_ALLOC_PTR_ARRAY(stripes, cnt);
+		if (stripes == NULL) {
+			mutex_unlock(&lo->ldo_layout_mutex);
+			RETURN(-ENOMEM);
+		}
+	}
+
+	for (i = 0; i < lo->ldo_comp_cnt && nr < cnt; i++) {
+		comp = &lo->ldo_comp_entries[i];
+
+		if (comp->llc_magic == LOV_MAGIC_FOREIGN ||
+		    !lod_comp_inited(comp) ||
+		    comp->llc_pattern & LOV_PATTERN_MDT ||
+		    comp->llc_stripe == NULL)
+			continue;
+
+		for (j = 0; j < comp->llc_stripe_count; j++) {
+			struct dt_object *stripe = comp->llc_stripe[j];
+
+			if (stripe == NULL)
+				continue;
+
+			lu_object_get(&stripe->do_lu);
+			stripes[nr].lss_obj = stripe;
+			stripes[nr].lss_stripe_size = comp->llc_stripe_size;
+			stripes[nr].lss_stripe_count = comp->llc_stripe_count;
+			stripes[nr].lss_stripe_idx = j;
+			nr++;
+		}
+	}
+	mutex_unlock(&lo->ldo_layout_mutex);
+
+	for (i = 0; i < nr; i++) {
+		rc = dt_invalidate(env, stripes[i].lss_obj);
+		if (!rc)
+			rc = dt_attr_get(env, stripes[i].lss_obj, attr);
+		/* object is not created on OST yet */
+		if (rc == -ENOENT)
+			continue;
+		if (rc)
+			GOTO(put, rc);
+
+		found = true;
+		blocks += attr->la_blocks;
+		size = max(size, lod_comp_stripe_size(&stripes[i],
+						      attr->la_size));
+	}
+	rc = 0;
+put:
+	for (i = 0; i < nr; i++)
+		dt_object_put(env, stripes[i].lss_obj);
+	if (stripes != NULL)
+		OBD_FREE_PTR_ARRAY(stripes, cnt);
+	if (rc)
+		RETURN(rc);
+
+	if (!found)
+		RETURN(-ENODATA);
+
+	if (has_dom) {
+		rc = dt_attr_get(env, next, attr);
+		if (rc)
+			RETURN(rc);
+
+		blocks += attr->la_blocks;
+		size = max(size, attr->la_size);
+	}
+
+	som = buf->lb_buf;
+	som->lsa_valid = SOM_FL_LAZY;
+	som->lsa_size = size;
+	som->lsa_blocks = blocks;
+	memset(&som->lsa_reserved, 0, sizeof(som->lsa_reserved));
+	lustre_som_swab(som);
+
+	RETURN(sizeof(*som));
+}
+
 /**
  * Implementation of dt_object_operations::do_xattr_get.
  *
@@ -1523,6 +1703,9 @@ static int lod_xattr_get(const struct lu_env *env, struct dt_object *dt,
 	int rc;
 	ENTRY;
 
+	if (strcmp(name, XATTR_NAME_SOM_OST) == 0)
+		RETURN(lod_som_ost_get(env, lod_dt_obj(dt), buf));
+
 	rc = dt_xattr_get(env, dt_object_child(dt), buf, name);
 	if (strcmp(name, XATTR_NAME_LMV) == 0) {
 		struct lmv_mds_md_v1	*lmv1;
@@ -199,6 +199,7 @@ void lod_qos_statfs_update(const struct lu_env *env, struct lod_device *lod,
 			/* recalculate weigths */
 			set_bit(LQ_DIRTY, &ltd->ltd_qos.lq_flags);
 	}
+	ltd_qos_load_update(ltd);
 	lod_putref(lod, ltd);
 	obd->obd_osfs_age = ktime_get_seconds();
 
@@ -628,6 +629,17 @@ static int lod_check_and_reserve_ost(const struct lu_env *env,
 		RETURN(rc);
 	}
 
+	/*
+	 * skip OSTs whose load would at least halve their QoS weight at the
+	 * first iteration, see ltd_qos_load_update()
+	 */
+	if (ost->ltd_qos.ltq_load_scale < QOS_LOAD_SCALE_MAX / 2 &&
+	    speed == 0) {
+		CDEBUG(D_OTHER, "#%d: overloaded, load scale %u\n", ost_idx,
+		       ost->ltd_qos.ltq_load_scale);
+		RETURN(rc);
+	}
+
 	/*
 	 * try not allocate on OST which has been used by other
 	 * component
@@ -1463,6 +1475,244 @@ out:
 	RETURN(rc);
 }
 
+/*
+ * Penalty changes made while striping a single object are deferred:
+ * ltd_qos_update() lowers the penalty of every target and server after each
+ * stripe, which makes the allocation O(stripes * targets). Instead, the
+ * decay owed after \a nr stripes is computed on demand for the few targets
+ * actually looked at, and applied to everybody once by lod_qos_decay().
+ */
+static inline __u64 lod_qos_penalty_now(__u64 penalty, __u64 per_obj,
+					unsigned int nr)
+{
+	__u64 decay = per_obj * nr;
+
+	return penalty < decay ? 0 : penalty - decay;
+}
+
+/**
+ * Calculate the current weight of an OST during a deferred QoS update.
+ *
+ * Same as lu_tgt_qos_weight_calc(), but accounts for the penalty decay of
+ * the \a nr stripes already allocated by the caller.
+ *
+ * \param[in] ost	OST descriptor
+ * \param[in] nr	number of stripes allocated so far
+ *
+ * \retval		weight of the OST
+ */
+static __u64 lod_qos_weight_now(struct lod_tgt_desc *ost, unsigned int nr)
+{
+	struct lu_tgt_qos *ltq = &ost->ltd_qos;
+	struct lu_svr_qos *svr = ltq->ltq_svr;
+	__u64 penalty;
+	__u64 weight;
+
+	penalty = lod_qos_penalty_now(ltq->ltq_penalty,
+				      ltq->ltq_penalty_per_obj, nr) +
+		  lod_qos_penalty_now(svr->lsq_penalty,
+				      svr->lsq_penalty_per_obj, nr);
+
+	weight = ltq->ltq_avail < penalty ? 0 : ltq->ltq_avail - penalty;
+	if (ltq->ltq_load_scale < QOS_LOAD_SCALE_MAX)
+		weight = weight / QOS_LOAD_SCALE_MAX * ltq->ltq_load_scale;
+
+	return weight;
+}
+
+/**
+ * Charge an OST and its OSS for a new stripe.
+ *
+ * This is the per-target part of ltd_qos_update(). The stored penalties
+ * keep the decay of the \a nr earlier stripes folded in, so lod_qos_decay()
+ * can later subtract the same amount from every target and get exactly the
+ * values ltd_qos_update() would have produced.
+ *
+ * \param[in] ltd	OST table
+ * \param[in] ost	OST the stripe was allocated on
+ * \param[in] nr	number of stripes allocated before this one
+ */
+static void lod_qos_charge(struct lu_tgt_descs *ltd, struct lod_tgt_desc *ost,
+			   unsigned int nr)
+{
+	struct lu_tgt_qos *ltq = &ost->ltd_qos;
+	struct lu_svr_qos *svr = ltq->ltq_svr;
+	__u64 penalty;
+
+	/* Don't allocate on this device anymore, until the next alloc_qos */
+	ltq->ltq_usable = 0;
+
+	/* mark the server and tgt as recently used */
+	ltq->ltq_used = svr->lsq_used = ktime_get_real_seconds();
+
+	penalty = lod_qos_penalty_now(ltq->ltq_penalty,
+				      ltq->ltq_penalty_per_obj, nr) >> 1;
+	penalty += ltq->ltq_penalty_per_obj *
+		   ltd->ltd_lov_desc.ld_active_tgt_count;
+	ltq->ltq_penalty = penalty + ltq->ltq_penalty_per_obj * nr;
+
+	penalty = lod_qos_penalty_now(svr->lsq_penalty,
+				      svr->lsq_penalty_per_obj, nr) >> 1;
+	penalty += svr->lsq_penalty_per_obj * ltd->ltd_qos.lq_active_svr_count;
+	svr->lsq_penalty = penalty + svr->lsq_penalty_per_obj * nr;
+
+	CDEBUG(D_OTHER, "OST%d: ltq_penalty: %llu lsq_penalty: %llu nr: %u\n",
+	       ost->ltd_index, ltq->ltq_penalty, svr->lsq_penalty, nr);
+}
+
+/**
+ * Apply the penalty decay deferred by lod_qos_charge().
+ *
+ * \param[in] ltd	OST table
+ * \param[in] nr	number of stripes allocated
+ */
+static void lod_qos_decay(struct lu_tgt_descs *ltd, unsigned int nr)
+{
+	struct lu_svr_qos *svr;
+	struct lod_tgt_desc *ost;
+
+	if (nr == 0)
+		return;
+
+	list_for_each_entry(svr, &ltd->ltd_qos.lq_svr_list, lsq_svr_list)
+		svr->lsq_penalty = lod_qos_penalty_now(svr->lsq_penalty,
+						       svr->lsq_penalty_per_obj,
+						       nr);
+
+	ltd_foreach_tgt(ltd, ost) {
+		struct lu_tgt_qos *ltq = &ost->ltd_qos;
+
+		if (!ost->ltd_active)
+			continue;
+
+		ltq->ltq_penalty = lod_qos_penalty_now(ltq->ltq_penalty,
+						       ltq->ltq_penalty_per_obj,
+						       nr);
+		lu_tgt_qos_weight_calc(ost, false);
+	}
+}
+
+/**
+ * Prepare the per-thread Fenwick tree for \a count candidates.
+ *
+ * \param[in] env	execution environment for this thread
+ * \param[in] count	number of candidate slots
+ *
+ * \retval 0		on success
+ * \retval -ENOMEM	on allocation failure
+ */
+static int lod_qos_tree_init(const struct lu_env *env, unsigned int count)
+{
+	struct lod_qos_tree *lqt = &lod_env_info(env)->lti_qos_tree;
+
+	if (lqt->lqt_size < count) {
+		__u64 *buf;
+
+		OBD_ALLOC_LARGE(buf, (2 * count + 1) * sizeof(__u64));
+		if (buf == NULL)
+			return -ENOMEM;
+
+		if (lqt->lqt_size > 0)
+			OBD_FREE_LARGE(lqt->lqt_sum,
+				       (2 * lqt->lqt_size + 1) * sizeof(__u64));
+		lqt->lqt_sum = buf;
+		lqt->lqt_weight = buf + count + 1;
+		lqt->lqt_size = count;
+	}
+	lqt->lqt_count = count;
+
+	return 0;
+}
+
+/**
+ * Change the weight of candidate \a slot, O(log n).
+ */
+static void lod_qos_tree_set(struct lod_qos_tree *lqt, unsigned int slot,
+			     __u64 weight)
+{
+	/* unsigned wrap-around takes care of weight decreases */
+	__u64 delta = weight - lqt->lqt_weight[slot];
+	unsigned int i;
+
+	if (delta == 0)
+		return;
+
+	lqt->lqt_weight[slot] = weight;
+	lqt->lqt_total += delta;
+	for (i = slot + 1; i <= lqt->lqt_count; i += i & -i)
+		lqt->lqt_sum[i] += delta;
+}
+
+/**
+ * Find the candidate covering \a rand in the cumulative weights, O(log n).
+ *
+ * \param[in] lqt	tree to search, lqt_total must be non-zero
+ * \param[in,out] rand	value in [0, lqt_total), on return the offset of the
+ *			value inside the weight of the selected slot
+ *
+ * \retval		index of the selected slot
+ */
+static unsigned int lod_qos_tree_find(struct lod_qos_tree *lqt, __u64 *rand)
+{
+	unsigned int pos = 0;
+	unsigned int step;
+
+	for (step = rounddown_pow_of_two(lqt->lqt_count); step; step >>= 1) {
+		if (pos + step <= lqt->lqt_count &&
+		    lqt->lqt_sum[pos + step] <= *rand) {
+			pos += step;
+			*rand -= lqt->lqt_sum[pos];
+		}
+	}
+	LASSERT(pos < lqt->lqt_count);
+
+	return pos;
+}
+
+/**
+ * Load the weights of all usable OSTs in \a osts into the tree, O(n).
+ *
+ * OSTs which are not usable or should be avoided get no weight, so they
+ * can't be selected. Every other OST gets its weight plus one, so that an
+ * OST with zero weight can still be used once all others are exhausted,
+ * like with the linear scan this replaced.
+ *
+ * \param[in] env	execution environment for this thread
+ * \param[in] lo	LOD object
+ * \param[in] lag	OST avoidance guide
+ * \param[in] osts	candidate OSTs
+ * \param[in] nr	number of stripes allocated so far
+ */
+static void lod_qos_tree_fill(const struct lu_env *env, struct lod_object *lo,
+			      struct lod_avoid_guide *lag,
+			      struct lu_tgt_pool *osts, unsigned int nr)
+{
+	struct lod_device *lod = lu2lod_dev(lo->ldo_obj.do_lu.lo_dev);
+	struct lod_qos_tree *lqt = &lod_env_info(env)->lti_qos_tree;
+	unsigned int i;
+	unsigned int j;
+
+	lqt->lqt_total = 0;
+	for (i = 0; i < lqt->lqt_count; i++) {
+		__u32 idx = osts->op_array[i];
+		__u64 weight = 0;
+
+		if (!lod_should_avoid_ost(lo, lag, idx) &&
+		    OST_TGT(lod, idx)->ltd_qos.ltq_usable)
+			weight = lod_qos_weight_now(OST_TGT(lod, idx), nr) + 1;
+
+		lqt->lqt_weight[i] = weight;
+		lqt->lqt_sum[i + 1] = weight;
+		lqt->lqt_total += weight;
+	}
+
+	for (i = 1; i <= lqt->lqt_count; i++) {
+		j = i + (i & -i);
+		if (j <= lqt->lqt_count)
+			lqt->lqt_sum[j] += lqt->lqt_sum[i];
+	}
+}
+
 /**
  * Allocate a striping using an algorithm with weights.
  *
@@ -1506,15 +1756,16 @@ static int lod_ost_alloc_qos(const struct lu_env *env, struct lod_object *lo,
 	struct lod_layout_component *lod_comp;
 	struct lod_device *lod = lu2lod_dev(lo->ldo_obj.do_lu.lo_dev);
 	struct lod_avoid_guide *lag = &lod_env_info(env)->lti_avoid;
+	struct lod_qos_tree *lqt = &lod_env_info(env)->lti_qos_tree;
 	struct lod_tgt_desc *ost;
 	struct dt_object *o;
-	__u64 total_weight = 0;
 	struct lod_pool_desc *pool = NULL;
 	struct lu_tgt_pool *osts;
 	unsigned int i;
 	__u32 nfound, good_osts, stripe_count, stripe_count_min;
 	bool overstriped = false;
 	int stripes_per_ost = 1;
+	bool avoiding;
 	bool slow = false;
 	int rc = 0;
 	ENTRY;
@@ -1590,6 +1841,10 @@ static int lod_ost_alloc_qos(const struct lu_env *env, struct lod_object *lo,
 	if (rc)
 		GOTO(out, rc);
 
+	rc = lod_qos_tree_init(env, osts->op_count);
+	if (rc)
+		GOTO(out, rc);
+
 	good_osts = 0;
 	/* Find all the OSTs that are valid stripe candidates */
 	for (i = 0; i < osts->op_count; i++) {
@@ -1618,7 +1873,6 @@ static int lod_ost_alloc_qos(const struct lu_env *env, struct lod_object *lo,
 
 		ost->ltd_qos.ltq_usable = 1;
 		lu_tgt_qos_weight_calc(ost, false);
-		total_weight += ost->ltd_qos.ltq_weight;
 
 		good_osts++;
 	}
@@ -1635,86 +1889,93 @@ static int lod_ost_alloc_qos(const struct lu_env *env, struct lod_object *lo,
 		stripe_count = good_osts * stripes_per_ost;
 
 	/* Find enough OSTs with weighted random allocation. */
+	avoiding = lod_is_flr(lo) && lag->lag_ost_avail > 0;
+	lod_qos_tree_fill(env, lo, lag, osts, 0);
 	nfound = 0;
 	while (nfound < stripe_count) {
-		u64 rand, cur_weight;
-
-		cur_weight = 0;
-		rc = -ENOSPC;
-
-		rand = lu_prandom_u64_max(total_weight);
+		unsigned int slot;
+		u64 rand, weight;
+		__u32 idx;
+
+		if (lqt->lqt_total == 0) {
+			/* no OST found on this pass, give up */
+			if (slow) {
+				rc = -ENOSPC;
+				break;
+			}
+			/* couldn't allocate using precreated objects
+			 * so try to wait for new precreations */
+			slow = true;
+			lod_qos_tree_fill(env, lo, lag, osts, nfound);
+			continue;
+		}
 
 		/* On average, this will hit larger-weighted OSTs more often.
-		 * 0-weight OSTs will always get used last (only when rand=0)
+		 * 0-weight OSTs will only be used once all others are gone.
 		 */
-		for (i = 0; i < osts->op_count; i++) {
-			__u32 idx = osts->op_array[i];
-			struct lod_tgt_desc *ost;
-
-			if (lod_should_avoid_ost(lo, lag, idx))
-				continue;
-
-			ost = OST_TGT(lod, idx);
-
-			if (!ost->ltd_qos.ltq_usable)
-				continue;
-
-			cur_weight += ost->ltd_qos.ltq_weight;
-			CDEBUG(D_OTHER, "stripe_count=%d nfound=%d cur_weight=%llu rand=%llu total_weight=%llu\n",
-			       stripe_count, nfound, cur_weight, rand,
-			       total_weight);
-
-			if (cur_weight < rand)
-				continue;
-
-			CDEBUG(D_OTHER, "stripe=%d to idx=%d\n", nfound, idx);
-			/*
-			 * In case of QOS it makes sense to check components
-			 * only for FLR and if current component doesn't support
-			 * overstriping.
-			 */
-			if (lo->ldo_mirror_count > 1 &&
-			    !(lod_comp->llc_pattern & LOV_PATTERN_OVERSTRIPING)
-			    && lod_comp_is_ost_used(env, lo, idx))
-				continue;
+		rand = lu_prandom_u64_max(lqt->lqt_total);
+		slot = lod_qos_tree_find(lqt, &rand);
+		idx = osts->op_array[slot];
+		ost = OST_TGT(lod, idx);
+
+		/* The stripes allocated so far may have changed the weight of
+		 * this OST. Update it, and if it went down, keep the choice
+		 * only in proportion, so the result is as if the tree had
+		 * been recalculated after every stripe.
+		 */
+		weight = lod_qos_weight_now(ost, nfound) + 1;
+		lod_qos_tree_set(lqt, slot, weight);
+		CDEBUG(D_OTHER, "stripe_count=%d nfound=%d weight=%llu rand=%llu total_weight=%llu\n",
+		       stripe_count, nfound, weight, rand, lqt->lqt_total);
+		if (rand >= weight)
+			continue;
 
-			if (lod_qos_is_tgt_used(env, idx, nfound)) {
-				if (lod_comp->llc_pattern &
-				    LOV_PATTERN_OVERSTRIPING)
-					overstriped = true;
-				else
-					continue;
-			}
+		CDEBUG(D_OTHER, "stripe=%d to idx=%d\n", nfound, idx);
+		/*
+		 * In case of QOS it makes sense to check components
+		 * only for FLR and if current component doesn't support
+		 * overstriping.
+		 */
+		if (lo->ldo_mirror_count > 1 &&
+		    !(lod_comp->llc_pattern & LOV_PATTERN_OVERSTRIPING)
+		    && lod_comp_is_ost_used(env, lo, idx)) {
+			lod_qos_tree_set(lqt, slot, 0);
+			continue;
+		}
 
-			o = lod_qos_declare_object_on(env, lod, idx, slow, th);
-			if (IS_ERR(o)) {
-				CDEBUG(D_OTHER, "can't declare object on #%u: %d\n",
-				       idx, (int) PTR_ERR(o));
+		if (lod_qos_is_tgt_used(env, idx, nfound)) {
+			if (lod_comp->llc_pattern & LOV_PATTERN_OVERSTRIPING) {
+				overstriped = true;
+			} else {
+				lod_qos_tree_set(lqt, slot, 0);
 				continue;
 			}
-
-			lod_avoid_update(lo, lag);
-			lod_qos_tgt_in_use(env, nfound, idx);
-			stripe[nfound] = o;
-			ost_indices[nfound] = idx;
-			ltd_qos_update(&lod->lod_ost_descs, ost, &total_weight);
-			nfound++;
-			rc = 0;
-			break;
 		}
 
-		if (rc && !slow && nfound < stripe_count) {
-			/* couldn't allocate using precreated objects
-			 * so try to wait for new precreations */
-			slow = true;
-			rc = 0;
+		o = lod_qos_declare_object_on(env, lod, idx, slow, th);
+		if (IS_ERR(o)) {
+			CDEBUG(D_OTHER, "can't declare object on #%u: %d\n",
+			       idx, (int) PTR_ERR(o));
+			lod_qos_tree_set(lqt, slot, 0);
+			continue;
 		}
 
-		if (rc) {
-			/* no OST found on this iteration, give up */
-			break;
+		lod_avoid_update(lo, lag);
+		lod_qos_tgt_in_use(env, nfound, idx);
+		stripe[nfound] = o;
+		ost_indices[nfound] = idx;
+		lod_qos_charge(&lod->lod_ost_descs, ost, nfound);
+		lod_qos_tree_set(lqt, slot, 0);
+		nfound++;
+
+		/* all OSTs outside of the conflicting mirrors are used,
+		 * the avoided ones become candidates again */
+		if (avoiding && lag->lag_ost_avail == 0) {
+			avoiding = false;
+			lod_qos_tree_fill(env, lo, lag, osts, nfound);
 		}
 	}
+	lod_qos_decay(&lod->lod_ost_descs, nfound);
 
 	if (unlikely(nfound < stripe_count_min)) {
 		/*
@@ -664,6 +664,100 @@ static ssize_t qos_prio_free_store(struct kobject *kobj, struct attribute *attr,
 LUSTRE_RW_ATTR(mdt_qos_prio_free);
 LUSTRE_RW_ATTR(qos_prio_free);
 
+/**
+ * Show QoS load priority parameter.
+ *
+ * The printed value is a percentage value (0-100%) indicating how much the
+ * load reported by the targets (recent service time, requests in progress
+ * and request rate) reduces the chance of a target to be selected. 0%
+ * ignores the load, 100% makes the weight of a target loaded above the
+ * average inversely proportional to its relative load.
+ */
+static ssize_t __qos_prio_load_show(struct kobject *kobj,
+				    struct attribute *attr, char *buf,
+				    bool is_mdt)
+{
+	struct dt_device *dt = container_of(kobj, struct dt_device,
+					    dd_kobj);
+	struct lod_device *lod = dt2lod_dev(dt);
+	struct lu_tgt_descs *ltd = is_mdt ? &lod->lod_mdt_descs :
+					    &lod->lod_ost_descs;
+
+	return scnprintf(buf, PAGE_SIZE, "%d%%\n",
+			 (ltd->ltd_qos.lq_prio_load * 100 + 255) >> 8);
+}
+
+static ssize_t mdt_qos_prio_load_show(struct kobject *kobj,
+				      struct attribute *attr, char *buf)
+{
+	return __qos_prio_load_show(kobj, attr, buf, true);
+}
+
+static ssize_t qos_prio_load_show(struct kobject *kobj,
+				  struct attribute *attr, char *buf)
+{
+	return __qos_prio_load_show(kobj, attr, buf, false);
+}
+
+/**
+ * Set QoS load priority parameter.
+ *
+ * See __qos_prio_load_show() for description of this parameter. The new
+ * value is applied at the next refresh of the target statfs data.
+ */
+static ssize_t __qos_prio_load_store(struct kobject *kobj,
+				     struct attribute *attr,
+				     const char *buffer, size_t count,
+				     bool is_mdt)
+{
+	struct dt_device *dt = container_of(kobj, struct dt_device,
+					    dd_kobj);
+	struct lod_device *lod = dt2lod_dev(dt);
+	struct lu_tgt_descs *ltd = is_mdt ? &lod->lod_mdt_descs :
+					    &lod->lod_ost_descs;
+	char buf[6], *tmp;
+	unsigned int val;
+	int rc;
+
+	/* "100%\n\0" should be largest string */
+	if (count >= sizeof(buf))
+		return -ERANGE;
+
+	strncpy(buf, buffer, sizeof(buf));
+	buf[sizeof(buf) - 1] = '\0';
+	tmp = strchr(buf, '%');
+	if (tmp)
+		*tmp = '\0';
+
+	rc = kstrtouint(buf, 0, &val);
+	if (rc)
+		return rc;
+
+	if (val > 100)
+		return -EINVAL;
+
+	ltd->ltd_qos.lq_prio_load = (val << 8) / 100;
+	set_bit(LQ_DIRTY, &ltd->ltd_qos.lq_flags);
+
+	return count;
+}
+
+static ssize_t mdt_qos_prio_load_store(struct kobject *kobj,
+				       struct attribute *attr,
+				       const char *buffer, size_t count)
+{
+	return __qos_prio_load_store(kobj, attr, buffer, count, true);
+}
+
+static ssize_t qos_prio_load_store(struct kobject *kobj, struct attribute *attr,
+				   const char *buffer, size_t count)
+{
+	return __qos_prio_load_store(kobj, attr, buffer, count, false);
+}
+
+LUSTRE_RW_ATTR(mdt_qos_prio_load);
+LUSTRE_RW_ATTR(qos_prio_load);
+
 /**
  * Show threshold for "same space on all OSTs" rule.
  */
@@ -1393,6 +1487,7 @@ static struct attribute *lod_attrs[] = {
 	&lustre_attr_numobd.attr,
 	&lustre_attr_qos_maxage.attr,
 	&lustre_attr_qos_prio_free.attr,
+	&lustre_attr_qos_prio_load.attr,
 	&lustre_attr_qos_threshold_rr.attr,
 	&lustre_attr_mdt_stripecount.attr,
 	&lustre_attr_mdt_stripetype.attr,
@@ -1400,6 +1495,7 @@ static struct attribute *lod_attrs[] = {
 	&lustre_attr_mdt_numobd.attr,
 	&lustre_attr_mdt_qos_maxage.attr,
 	&lustre_attr_mdt_qos_prio_free.attr,
+	&lustre_attr_mdt_qos_prio_load.attr,
 	&lustre_attr_mdt_qos_threshold_rr.attr,
 	&lustre_attr_mdt_hash.attr,
 	&lustre_attr_dist_txn_check_space.attr,
@@ -171,8 +171,64 @@ static int mdc_batch_getattr_pack(struct batch_update_head *head,
 	RETURN(rc);
 }
 
+static int mdc_batch_getxattr_pack(struct batch_update_head *head,
+				   struct lustre_msg *reqmsg,
+				   size_t *max_pack_size,
+				   struct md_op_item *item)
+{
+	struct md_op_data *op_data = &item->mop_data;
+	union ldlm_policy_data policy = {
+		.l_inodebits = { MDS_INODELOCK_XATTR }
+	};
+	u32 ea_vals_buf_size = GA_DEFAULT_EA_VAL_LEN * GA_DEFAULT_EA_NUM;
+	struct ldlm_intent *lit;
+	struct req_capsule pill;
+	__u32 size;
+	int rc;
+
+	ENTRY;
+
+	req_capsule_subreq_init(&pill, &RQF_BUT_GETXATTR, NULL,
+				reqmsg, NULL, RCL_CLIENT);
+
+	size = req_capsule_msg_size(&pill, RCL_CLIENT);
+	if (unlikely(size >= *max_pack_size)) {
+		*max_pack_size = size;
+		return -E2BIG;
+	}
+
+	req_capsule_client_pack(&pill);
+	/* pack the intent */
+	lit = req_capsule_client_get(&pill, &RMF_LDLM_INTENT);
+	lit->opc = IT_GETXATTR;
+
+	/* pack the intended request, same as mdc_intent_getxattr_pack() */
+	mdc_pack_body(&pill, &op_data->op_fid1, op_data->op_valid,
+		      ea_vals_buf_size, -1, 0);
+
+	item->mop_lock_flags |= LDLM_FL_HAS_INTENT;
+	rc = mdc_ldlm_lock_pack(head->buh_exp, &pill, &policy,
+				&op_data->op_fid1, item);
+	if (rc)
+		RETURN(rc);
+
+	req_capsule_set_size(&pill, &RMF_EADATA, RCL_SERVER,
+			     GA_DEFAULT_EA_NAME_LEN * GA_DEFAULT_EA_NUM);
+	req_capsule_set_size(&pill, &RMF_EAVALS, RCL_SERVER,
+			     ea_vals_buf_size);
+	req_capsule_set_size(&pill, &RMF_EAVALS_LENS, RCL_SERVER,
+			     sizeof(u32) * GA_DEFAULT_EA_NUM);
+	req_capsule_set_size(&pill, &RMF_ACL, RCL_SERVER, 0);
+
+	req_capsule_set_replen(&pill);
+	reqmsg->lm_opc = BUT_GETXATTR;
+	*max_pack_size = size;
+	RETURN(rc);
+}
+
 static md_update_pack_t mdc_update_packers[MD_OP_MAX] = {
-	[MD_OP_GETATTR]	= mdc_batch_getattr_pack,
+	[MD_OP_GETATTR]		= mdc_batch_getattr_pack,
+	[MD_OP_GETXATTR]	= mdc_batch_getxattr_pack,
 };
 
 static int mdc_batch_getattr_interpret(struct ptlrpc_request *req,
@@ -200,8 +256,34 @@ out:
 	return item->mop_cb(item, rc);
 }
 
+static int mdc_batch_getxattr_interpret(struct ptlrpc_request *req,
+					struct lustre_msg *repmsg,
+					struct object_update_callback *ouc,
+					int rc)
+{
+	struct md_op_item *item = (struct md_op_item *)ouc->ouc_data;
+	struct ldlm_enqueue_info *einfo = &item->mop_einfo;
+	struct batch_update_head *head = ouc->ouc_head;
+	struct obd_export *exp = head->buh_exp;
+	struct req_capsule *pill = item->mop_pill;
+
+	req_capsule_subreq_init(pill, &RQF_BUT_GETXATTR, req,
+				NULL, repmsg, RCL_CLIENT);
+
+	rc = ldlm_cli_enqueue_fini(exp, pill, einfo, 1, &item->mop_lock_flags,
+				   NULL, 0, &item->mop_lockh, rc, false);
+	if (rc)
+		GOTO(out, rc);
+
+	rc = mdc_finish_enqueue(exp, pill, einfo, &item->mop_it,
+				&item->mop_lockh, rc);
+out:
+	return item->mop_cb(item, rc);
+}
+
 object_update_interpret_t mdc_update_interpreters[MD_OP_MAX] = {
-	[MD_OP_GETATTR]	= mdc_batch_getattr_interpret,
+	[MD_OP_GETATTR]		= mdc_batch_getattr_interpret,
+	[MD_OP_GETXATTR]	= mdc_batch_getxattr_interpret,
 };
 
 int mdc_batch_add(struct obd_export *exp, struct lu_batch *bh,
@@ -218,6 +300,9 @@ int mdc_batch_add(struct obd_export *exp, struct lu_batch *bh,
 		RETURN(-EFAULT);
 	}
 
+	if (opc == MD_OP_GETXATTR && !exp_connect_batch_getxattr(exp))
+		RETURN(-EOPNOTSUPP);
+
 	OBD_ALLOC_PTR(item->mop_pill);
 	if (item->mop_pill == NULL)
 		RETURN(-ENOMEM);
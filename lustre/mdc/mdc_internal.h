@@ -204,6 +204,11 @@ int mdc_finish_enqueue(struct obd_export *exp,
 		       struct lookup_intent *it,
 		       struct lustre_handle *lockh, int rc);
 
+/* default reply buffer sizes to fetch all xattrs of a file at once */
+#define GA_DEFAULT_EA_NAME_LEN	 20
+#define GA_DEFAULT_EA_VAL_LEN	250
+#define GA_DEFAULT_EA_NUM	 10
+
 /* the minimum inline repsize should be PAGE_SIZE at least */
 #define MDC_DOM_DEF_INLINE_REPSIZE max(8192UL, PAGE_SIZE)
 #define MDC_DOM_MAX_INLINE_REPSIZE XATTR_SIZE_MAX
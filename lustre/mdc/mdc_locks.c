@@ -439,10 +439,6 @@ err_free_rq:
 	return ERR_PTR(rc);
 }
 
-#define GA_DEFAULT_EA_NAME_LEN	 20
-#define GA_DEFAULT_EA_VAL_LEN	250
-#define GA_DEFAULT_EA_NUM	 10
-
 static struct ptlrpc_request *
 mdc_intent_getxattr_pack(struct obd_export *exp, struct lookup_intent *it,
 			 struct md_op_data *op_data)
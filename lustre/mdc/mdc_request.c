@@ -1118,6 +1118,14 @@ static void mdc_release_page(struct page *page, int remove)
 	put_page(page);
 }
 
+/*
+ * Find the cached dir page containing \a hash.
+ *
+ * Return the page, NULL if it is not cached, or -EAGAIN if the nearest page
+ * was being read by another thread and doesn't contain \a hash, then the
+ * caller should look up again, because the pages read ahead with it are in
+ * cache now.
+ */
 static struct page *mdc_page_locate(struct address_space *mapping, __u64 *hash,
 				    __u64 *start, __u64 *end, int hash64)
 {
@@ -1129,6 +1137,7 @@ static struct page *mdc_page_locate(struct address_space *mapping, __u64 *hash,
 	unsigned long offset = hash_x_index(*hash, hash64);
 	struct page *page;
 	unsigned long flags;
+	bool busy;
 	int found;
 
 	ll_xa_lock_irqsave(&mapping->i_pages, flags);
@@ -1144,9 +1153,11 @@ static struct page *mdc_page_locate(struct address_space *mapping, __u64 *hash,
 		 * page cannot be truncated (while DLM lock is held) and,
 		 * hence, can avoid restart.
 		 *
-		 * In fact, page cannot be locked here at all, because
-		 * mdc_read_page_remote does synchronous io.
+		 * Page is locked only while ll_mdc_read_page_remote() reads
+		 * it from MDS for another thread, wait for that instead of
+		 * sending the same RPC again.
 		 */
+		busy = PageLocked(page);
 		wait_on_page_locked(page);
 		if (PageUptodate(page)) {
 			dp = kmap(page);
@@ -1169,7 +1180,7 @@ static struct page *mdc_page_locate(struct address_space *mapping, __u64 *hash,
 			if (*hash > *end) {
 				kunmap(page);
 				mdc_release_page(page, 0);
-				page = NULL;
+				page = busy ? ERR_PTR(-EAGAIN) : NULL;
 			} else if (*end != *start && *hash == *end) {
 				/*
 				 * upon hash collision, remove this page,
@@ -1183,8 +1194,9 @@ static struct page *mdc_page_locate(struct address_space *mapping, __u64 *hash,
 				page = NULL;
 			}
 		} else {
+			/* read by another thread failed, try it ourselves */
 			put_page(page);
-			page = ERR_PTR(-EIO);
+			page = ERR_PTR(busy ? -EAGAIN : -EIO);
 		}
 	} else {
 		ll_xa_unlock_irqrestore(&mapping->i_pages, flags);
@@ -1369,10 +1381,12 @@ static int ll_mdc_read_page_remote(void *data, struct page *page0)
 
 		SetPageUptodate(page0);
 	}
-	unlock_page(page0);
 
 	ptlrpc_req_finished(req);
 	CDEBUG(D_CACHE, "read %d/%d pages\n", rd_pgs, npages);
+	/* add pages read ahead to cache before page0 is unlocked, so that
+	 * threads waiting on page0 in mdc_page_locate() find them there
+	 */
 	for (i = 1; i < npages; i++) {
 		unsigned long	offset;
 		__u64		hash;
@@ -1403,6 +1417,7 @@ static int ll_mdc_read_page_remote(void *data, struct page *page0)
 			       " rc = %d\n", offset, ret);
 		put_page(page);
 	}
+	unlock_page(page0);
 
 	if (page_pool != &page0)
 		OBD_FREE_PTR_ARRAY_LARGE(page_pool, max_pages);
@@ -1433,6 +1448,7 @@ static inline int mdc_read_folio_remote(struct file *file, struct folio *folio)
  * \param[in] ppage	the page to be read
  *
  * retval		= 0 get the page successfully
+ *                      -EAGAIN page is not cached and CLI_READ_CACHED is set
  *                      errno(<0) get the page failed
  */
 static int mdc_read_page(struct obd_export *exp, struct md_op_data *op_data,
@@ -1458,25 +1474,34 @@ static int mdc_read_page(struct obd_export *exp, struct md_op_data *op_data,
 	LASSERT(dir != NULL);
 	mapping = dir->i_mapping;
 
-	rc = mdc_intent_lock(exp, op_data, &it, &enq_req,
-			     mrinfo->mr_blocking_ast, 0);
-	if (enq_req != NULL)
-		ptlrpc_req_finished(enq_req);
-
-	if (rc < 0) {
-		CERROR("%s: "DFID" lock enqueue fails: rc = %d\n",
-		       exp->exp_obd->obd_name, PFID(&op_data->op_fid1), rc);
-		RETURN(rc);
+	if (op_data->op_cli_flags & CLI_READ_CACHED) {
+		/* pages are cached only under UPDATE lock */
+		if (!mdc_revalidate_lock(exp, &it, &op_data->op_fid1, NULL))
+			RETURN(-EAGAIN);
+	} else {
+		rc = mdc_intent_lock(exp, op_data, &it, &enq_req,
+				     mrinfo->mr_blocking_ast, 0);
+		if (enq_req != NULL)
+			ptlrpc_req_finished(enq_req);
+
+		if (rc < 0) {
+			CERROR("%s: "DFID" lock enqueue fails: rc = %d\n",
+			       exp->exp_obd->obd_name,
+			       PFID(&op_data->op_fid1), rc);
+			RETURN(rc);
+		}
 	}
 
 	rc = 0;
 	lockh.cookie = it.it_lock_handle;
 	mdc_set_lock_data(exp, &lockh, dir, NULL);
 
-	rp_param.rp_off = hash_offset;
 	rp_param.rp_hash64 = op_data->op_cli_flags & CLI_HASH64;
-	page = mdc_page_locate(mapping, &rp_param.rp_off, &start, &end,
-			       rp_param.rp_hash64);
+	do {
+		rp_param.rp_off = hash_offset;
+		page = mdc_page_locate(mapping, &rp_param.rp_off, &start, &end,
+				       rp_param.rp_hash64);
+	} while (page == ERR_PTR(-EAGAIN));
 	if (IS_ERR(page)) {
 		CERROR("%s: dir page locate: "DFID" at %llu: rc %ld\n",
 		       exp->exp_obd->obd_name, PFID(&op_data->op_fid1),
@@ -1500,6 +1525,9 @@ static int mdc_read_page(struct obd_export *exp, struct md_op_data *op_data,
 		GOTO(hash_collision, page);
 	}
 
+	if (op_data->op_cli_flags & CLI_READ_CACHED)
+		GOTO(out_unlock, rc = -EAGAIN);
+
 	rp_param.rp_exp = exp;
 	rp_param.rp_mod = op_data;
 	page = ll_read_cache_page(mapping,
@@ -184,6 +184,8 @@ static int mdd_init0(const struct lu_env *env, struct mdd_device *mdd,
 	/* special default striping for files created with O_APPEND */
 	mdd->mdd_append_stripe_count = 1;
 	mdd->mdd_append_pool[0] = '\0';
+	/* destroy orphans with multiple threads after recovery */
+	mdd->mdd_orphan_threads = MDD_ORPHAN_THREADS_DEFAULT;
 
 	dt_conf_get(env, mdd->mdd_child, &mdd->mdd_dt_conf);
 
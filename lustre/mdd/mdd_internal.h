@@ -136,6 +136,41 @@ struct mdd_generic_thread {
 	bool			mgt_init;
 };
 
+/* threads destroying orphans in PENDING after recovery */
+#define MDD_ORPHAN_THREADS_DEFAULT	4
+#define MDD_ORPHAN_THREADS_MAX		32
+/* orphans collected from PENDING and destroyed in parallel at a time */
+#define MDD_ORPHAN_BATCH		256
+
+struct mdd_orphan_entry {
+	struct lu_fid		moe_fid;
+	/* PENDING index key, "fid" or "fid:op" in old format */
+	char			moe_key[64];
+};
+
+/* a batch of orphans, shared by orphan cleanup threads */
+struct mdd_orphan_batch {
+	spinlock_t		 mob_lock;
+	wait_queue_head_t	 mob_waitq;
+	struct mdd_orphan_entry	*mob_entries;
+	/* entries collected, next entry to take, entries handled */
+	int			 mob_count;
+	int			 mob_next;
+	int			 mob_done;
+};
+
+struct mdd_orphan_stats {
+	time64_t		mos_start;
+	/* 0 while orphan cleanup is running */
+	time64_t		mos_end;
+	int			mos_threads;
+	atomic64_t		mos_scanned;
+	atomic64_t		mos_destroyed;
+	/* still opened by clients */
+	atomic64_t		mos_skipped;
+	atomic64_t		mos_failed;
+};
+
 struct mdd_device {
         struct md_device                 mdd_md_dev;
 	struct obd_export               *mdd_child_exp;
@@ -164,6 +199,8 @@ struct mdd_device {
 	char				 mdd_append_pool[LOV_MAXPOOLNAME + 1];
 	struct local_oid_storage	*mdd_los;
 	struct mdd_generic_thread	 mdd_orphan_cleanup_thread;
+	unsigned int			 mdd_orphan_threads;
+	struct mdd_orphan_stats		 mdd_orphan_stats;
 	struct kobject			 mdd_kobj;
 	struct kobj_type		 mdd_ktype;
 	struct completion		 mdd_kobj_unregister;
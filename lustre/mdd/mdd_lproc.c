@@ -643,6 +643,34 @@ static ssize_t lfsck_async_windows_store(struct kobject *kobj,
 }
 LUSTRE_RW_ATTR(lfsck_async_windows);
 
+static ssize_t lfsck_assistant_threads_show(struct kobject *kobj,
+					    struct attribute *attr, char *buf)
+{
+	struct mdd_device *mdd = container_of(kobj, struct mdd_device,
+					      mdd_kobj);
+
+	return lfsck_get_assistant_threads(buf, mdd->mdd_bottom);
+}
+
+static ssize_t lfsck_assistant_threads_store(struct kobject *kobj,
+					     struct attribute *attr,
+					     const char *buffer, size_t count)
+{
+	struct mdd_device *mdd = container_of(kobj, struct mdd_device,
+					      mdd_kobj);
+	unsigned int val;
+	int rc;
+
+	rc = kstrtouint(buffer, 10, &val);
+	if (rc)
+		return rc;
+
+	rc = lfsck_set_assistant_threads(mdd->mdd_bottom, val);
+
+	return rc != 0 ? rc : count;
+}
+LUSTRE_RW_ATTR(lfsck_assistant_threads);
+
 static int mdd_lfsck_namespace_seq_show(struct seq_file *m, void *data)
 {
 	struct mdd_device *mdd = m->private;
@@ -766,6 +794,74 @@ static ssize_t append_pool_store(struct kobject *kobj, struct attribute *attr,
 }
 LUSTRE_RW_ATTR(append_pool);
 
+static ssize_t orphan_cleanup_threads_show(struct kobject *kobj,
+					   struct attribute *attr, char *buf)
+{
+	struct mdd_device *mdd = container_of(kobj, struct mdd_device,
+					      mdd_kobj);
+
+	return scnprintf(buf, PAGE_SIZE, "%u\n", mdd->mdd_orphan_threads);
+}
+
+/* used by the next orphan cleanup after recovery */
+static ssize_t orphan_cleanup_threads_store(struct kobject *kobj,
+					    struct attribute *attr,
+					    const char *buffer, size_t count)
+{
+	struct mdd_device *mdd = container_of(kobj, struct mdd_device,
+					      mdd_kobj);
+	unsigned int val;
+	int rc;
+
+	rc = kstrtouint(buffer, 0, &val);
+	if (rc)
+		return rc;
+
+	if (val < 1 || val > MDD_ORPHAN_THREADS_MAX)
+		return -ERANGE;
+
+	mdd->mdd_orphan_threads = val;
+
+	return count;
+}
+LUSTRE_RW_ATTR(orphan_cleanup_threads);
+
+static int mdd_orphan_stats_seq_show(struct seq_file *m, void *data)
+{
+	struct mdd_device *mdd = m->private;
+	struct mdd_orphan_stats *mos = &mdd->mdd_orphan_stats;
+	time64_t start = mos->mos_start;
+	time64_t end = mos->mos_end;
+	const char *status;
+
+	if (!start)
+		status = "init";
+	else if (!end)
+		status = "scanning";
+	else if (mdd->mdd_orphan_cleanup_thread.mgt_abort)
+		status = "stopped";
+	else
+		status = "completed";
+
+	seq_printf(m, "status: %s\n"
+		   "threads: %d\n"
+		   "start_time: %lld\n"
+		   "run_time: %lld\n"
+		   "scanned: %lld\n"
+		   "destroyed: %lld\n"
+		   "skipped: %lld\n"
+		   "failed: %lld\n",
+		   status, mos->mos_threads, start,
+		   start ? (end ? end : ktime_get_real_seconds()) - start : 0,
+		   (s64)atomic64_read(&mos->mos_scanned),
+		   (s64)atomic64_read(&mos->mos_destroyed),
+		   (s64)atomic64_read(&mos->mos_skipped),
+		   (s64)atomic64_read(&mos->mos_failed));
+
+	return 0;
+}
+LDEBUGFS_SEQ_FOPS_RO(mdd_orphan_stats);
+
 static struct ldebugfs_vars ldebugfs_mdd_obd_vars[] = {
 	{ .name =	"changelog_mask",
 	  .fops =	&mdd_changelog_mask_fops	},
@@ -777,6 +873,8 @@ static struct ldebugfs_vars ldebugfs_mdd_obd_vars[] = {
 	  .fops =	&mdd_lfsck_namespace_fops	},
 	{ .name	=	"lfsck_layout",
 	  .fops	=	&mdd_lfsck_layout_fops		},
+	{ .name =	"orphan_stats",
+	  .fops =	&mdd_orphan_stats_fops		},
 	{ NULL }
 };
 
@@ -793,10 +891,12 @@ static struct attribute *mdd_attrs[] = {
 	&lustre_attr_changelog_deniednext.attr,
 	&lustre_attr_enable_shard_pfid.attr,
 	&lustre_attr_lfsck_async_windows.attr,
+	&lustre_attr_lfsck_assistant_threads.attr,
 	&lustre_attr_lfsck_speed_limit.attr,
 	&lustre_attr_sync_permission.attr,
 	&lustre_attr_append_stripe_count.attr,
 	&lustre_attr_append_pool.attr,
+	&lustre_attr_orphan_cleanup_threads.attr,
 	NULL,
 };
 
@@ -38,6 +38,8 @@
 
 #define DEBUG_SUBSYSTEM S_MDS
 
+#include <linux/kthread.h>
+
 #include <obd.h>
 #include <obd_class.h>
 #include <obd_support.h>
@@ -321,19 +323,25 @@ static int mdd_orphan_destroy(const struct lu_env *env, struct mdd_object *obj,
 
 	mdd_write_lock(env, obj, DT_TGT_CHILD);
 	if (likely(obj->mod_count == 0)) {
+		bool destroy = mdd_object_exists(obj) &&
+			!lu_object_is_dying(obj->mod_obj.mo_lu.lo_header);
+
+		/* PENDING is locked for index update only, so that orphans
+		 * can be destroyed in parallel.
+		 */
 		dt_write_lock(env, mdd->mdd_orphans, DT_TGT_ORPHAN);
 		rc = dt_delete(env, mdd->mdd_orphans, key, th);
+		if (destroy && S_ISDIR(mdd_object_type(obj)))
+			dt_ref_del(env, mdd->mdd_orphans, th);
+		dt_write_unlock(env, mdd->mdd_orphans);
+
 		/* We should remove object even dt_delete failed */
-		if (mdd_object_exists(obj) &&
-		    !lu_object_is_dying(obj->mod_obj.mo_lu.lo_header)) {
+		if (destroy) {
 			mdo_ref_del(env, obj, th);
-			if (S_ISDIR(mdd_object_type(obj))) {
+			if (S_ISDIR(mdd_object_type(obj)))
 				mdo_ref_del(env, obj, th);
-				dt_ref_del(env, mdd->mdd_orphans, th);
-			}
 			rc1 = mdo_destroy(env, obj, th);
 		}
-		dt_write_unlock(env, mdd->mdd_orphans);
 	}
 	mdd_write_unlock(env, obj);
 stop:
@@ -385,6 +393,178 @@ static int mdd_orphan_key_test_and_delete(const struct lu_env *env,
         return rc;
 }
 
+/* destroy orphan \a moe, key of it is kept in env for orphan index delete */
+static void mdd_orphan_entry_destroy(const struct lu_env *env,
+				     struct mdd_device *mdd,
+				     struct mdd_orphan_entry *moe)
+{
+	struct mdd_thread_info *info = mdd_env_info(env);
+	struct mdd_orphan_stats *mos = &mdd->mdd_orphan_stats;
+	int rc;
+
+	strlcpy(info->mdi_key, moe->moe_key, sizeof(info->mdi_key));
+	info->mdi_flags |= MDI_KEEP_KEY;
+	rc = mdd_orphan_key_test_and_delete(env, mdd, &moe->moe_fid,
+					    (struct dt_key *)info->mdi_key);
+	if (rc == 0)
+		atomic64_inc(&mos->mos_destroyed);
+	else if (rc == -EBUSY)
+		atomic64_inc(&mos->mos_skipped);
+	else
+		atomic64_inc(&mos->mos_failed);
+}
+
+/* take orphans from \a mob and destroy them until none is left */
+static void mdd_orphan_batch_work(const struct lu_env *env,
+				  struct mdd_generic_thread *thread,
+				  struct mdd_orphan_batch *mob)
+{
+	struct mdd_device *mdd = thread->mgt_data;
+	struct mdd_orphan_entry *moe;
+	bool done;
+
+	while (1) {
+		spin_lock(&mob->mob_lock);
+		if (mob->mob_next >= mob->mob_count) {
+			spin_unlock(&mob->mob_lock);
+			break;
+		}
+		moe = &mob->mob_entries[mob->mob_next++];
+		spin_unlock(&mob->mob_lock);
+
+		/* left in PENDING, cleaned up after next recovery */
+		if (likely(!thread->mgt_abort))
+			mdd_orphan_entry_destroy(env, mdd, moe);
+
+		spin_lock(&mob->mob_lock);
+		done = ++mob->mob_done == mob->mob_count;
+		spin_unlock(&mob->mob_lock);
+		if (done)
+			wake_up_all(&mob->mob_waitq);
+	}
+}
+
+static inline bool mdd_orphan_batch_pending(struct mdd_orphan_batch *mob)
+{
+	bool pending;
+
+	spin_lock(&mob->mob_lock);
+	pending = mob->mob_next < mob->mob_count;
+	spin_unlock(&mob->mob_lock);
+
+	return pending;
+}
+
+static inline bool mdd_orphan_batch_done(struct mdd_orphan_batch *mob)
+{
+	bool done;
+
+	spin_lock(&mob->mob_lock);
+	done = mob->mob_done == mob->mob_count;
+	spin_unlock(&mob->mob_lock);
+
+	return done;
+}
+
+/* destroy orphans collected in \a mob together with helper threads */
+static void mdd_orphan_batch_run(const struct lu_env *env,
+				 struct mdd_generic_thread *thread,
+				 struct mdd_orphan_batch *mob, int count)
+{
+	if (!count)
+		return;
+
+	spin_lock(&mob->mob_lock);
+	mob->mob_count = count;
+	mob->mob_next = 0;
+	mob->mob_done = 0;
+	spin_unlock(&mob->mob_lock);
+	wake_up_all(&mob->mob_waitq);
+
+	mdd_orphan_batch_work(env, thread, mob);
+	wait_event_idle(mob->mob_waitq, mdd_orphan_batch_done(mob));
+
+	spin_lock(&mob->mob_lock);
+	mob->mob_count = 0;
+	mob->mob_next = 0;
+	mob->mob_done = 0;
+	spin_unlock(&mob->mob_lock);
+}
+
+struct mdd_orphan_helper {
+	struct mdd_generic_thread	*moh_thread;
+	struct mdd_orphan_batch		*moh_batch;
+	struct task_struct		*moh_task;
+	struct lu_env			 moh_env;
+};
+
+static int mdd_orphan_helper_main(void *args)
+{
+	struct mdd_orphan_helper *moh = args;
+	struct mdd_orphan_batch *mob = moh->moh_batch;
+
+	while (1) {
+		wait_event_idle(mob->mob_waitq,
+				kthread_should_stop() ||
+				mdd_orphan_batch_pending(mob));
+		if (kthread_should_stop())
+			break;
+
+		mdd_orphan_batch_work(&moh->moh_env, moh->moh_thread, mob);
+	}
+
+	return 0;
+}
+
+/* start up to mdd_orphan_threads - 1 helpers, return number started */
+static int mdd_orphan_helpers_start(struct mdd_generic_thread *thread,
+				    struct mdd_orphan_batch *mob,
+				    struct mdd_orphan_helper *helpers)
+{
+	struct mdd_device *mdd = thread->mgt_data;
+	struct mdd_orphan_helper *moh;
+	struct task_struct *task;
+	int threads = min_t(int, READ_ONCE(mdd->mdd_orphan_threads),
+			    MDD_ORPHAN_THREADS_MAX);
+	int i;
+	int rc = 0;
+
+	for (i = 0; i < threads - 1; i++) {
+		moh = &helpers[i];
+		moh->moh_thread = thread;
+		moh->moh_batch = mob;
+		rc = lu_env_init(&moh->moh_env, LCT_MD_THREAD);
+		if (rc)
+			break;
+
+		task = kthread_run(mdd_orphan_helper_main, moh, "orph%02d_%s",
+				   i + 1, mdd2obd_dev(mdd)->obd_name);
+		if (IS_ERR(task)) {
+			lu_env_fini(&moh->moh_env);
+			rc = PTR_ERR(task);
+			break;
+		}
+		moh->moh_task = task;
+	}
+
+	if (i < threads - 1)
+		CDEBUG(D_HA, "%s: started %d of %d orphan cleanup helpers: rc = %d\n",
+		       mdd2obd_dev(mdd)->obd_name, i, threads - 1, rc);
+
+	return i;
+}
+
+static void mdd_orphan_helpers_stop(struct mdd_orphan_helper *helpers,
+				    int count)
+{
+	int i;
+
+	for (i = 0; i < count; i++) {
+		kthread_stop(helpers[i].moh_task);
+		lu_env_fini(&helpers[i].moh_env);
+	}
+}
+
 /**
  * delete unreferenced files and directories in the PENDING directory
  *
@@ -392,6 +572,10 @@ static int mdd_orphan_key_test_and_delete(const struct lu_env *env,
  * have to be referenced (opened) by some client during recovery, or they
  * will be deleted here (for clients that did not complete recovery).
  *
+ * Orphans are collected in batches of MDD_ORPHAN_BATCH with the index
+ * iterator, and each batch is destroyed by this thread together with
+ * mdd_orphan_threads - 1 helpers while the iterator is released.
+ *
  * \param thread  info about orphan cleanup thread
  *
  * \retval 0   success
@@ -401,15 +585,35 @@ static int mdd_orphan_index_iterate(const struct lu_env *env,
 				    struct mdd_generic_thread *thread)
 {
 	struct mdd_device *mdd = (struct mdd_device *)thread->mgt_data;
+	struct mdd_orphan_stats *mos = &mdd->mdd_orphan_stats;
 	struct dt_object *dor = mdd->mdd_orphans;
 	struct lu_dirent *ent = &mdd_env_info(env)->mdi_ent;
 	const struct dt_it_ops *iops;
+	struct mdd_orphan_helper *helpers = NULL;
+	struct mdd_orphan_batch mob = { 0 };
+	struct mdd_orphan_entry *moe;
 	struct dt_it *it;
 	struct lu_fid fid;
+	int nr_helpers = 0;
+	int count = 0;
+	int namelen;
+	__u64 cookie = 0;
 	int key_sz = 0;
 	int rc;
 	ENTRY;
 
+	spin_lock_init(&mob.mob_lock);
+	init_waitqueue_head(&mob.mob_waitq);
+	OBD_ALLOC_LARGE(mob.mob_entries,
+			MDD_ORPHAN_BATCH * sizeof(*mob.mob_entries));
+	if (!mob.mob_entries)
+		RETURN(-ENOMEM);
+
+	OBD_ALLOC_PTR_ARRAY(helpers, MDD_ORPHAN_THREADS_MAX);
+	if (helpers)
+		nr_helpers = mdd_orphan_helpers_start(thread, &mob, helpers);
+	mos->mos_threads = nr_helpers + 1;
+
 	iops = &dor->do_index_ops->dio_it;
 	it = iops->init(env, dor, LUDA_64BITHASH);
 	if (IS_ERR(it)) {
@@ -454,13 +658,43 @@ static int mdd_orphan_index_iterate(const struct lu_env *env,
 			goto next;
 		}
 
-		/* kill orphan object */
-		iops->put(env, it);
-		rc = mdd_orphan_key_test_and_delete(env, mdd, &fid,
-						(struct dt_key *)ent->lde_name);
-		/* after index delete reset iterator */
+		namelen = le16_to_cpu(ent->lde_namelen);
+		if (namelen >= sizeof(moe->moe_key)) {
+			CERROR("%s: bad orphan name %.*s cleaning '%s'\n",
+			       mdd2obd_dev(mdd)->obd_name, namelen,
+			       ent->lde_name, mdd_orphan_index_name);
+			goto next;
+		}
+
+		atomic64_inc(&mos->mos_scanned);
+		moe = &mob.mob_entries[count++];
+		moe->moe_fid = fid;
+		memcpy(moe->moe_key, ent->lde_name, namelen);
+		moe->moe_key[namelen] = '\0';
+		if (count < MDD_ORPHAN_BATCH)
+			goto next;
+
+		/* remember the next orphan, and kill the batch with iterator
+		 * released, because orphan objects are deleted from it.
+		 */
+		rc = iops->next(env, it);
 		if (rc == 0)
-			rc = iops->get(env, it, (const void *)"");
+			cookie = iops->store(env, it);
+		iops->put(env, it);
+		mdd_orphan_batch_run(env, thread, &mob, count);
+		count = 0;
+		if (rc != 0)
+			GOTO(out_fini, rc = 0);
+
+		rc = iops->load(env, it, cookie);
+		if (rc <= 0)
+			break;
+
+		/* iterator is at the next orphan, or the one after it if
+		 * it has been deleted by close meanwhile.
+		 */
+		rc = 0;
+		continue;
 next:
 		rc = iops->next(env, it);
 	} while (rc == 0);
@@ -468,9 +702,17 @@ next:
 	GOTO(out_put, rc = 0);
 out_put:
 	iops->put(env, it);
+out_fini:
 	iops->fini(env, it);
+	mdd_orphan_batch_run(env, thread, &mob, count);
 
 out:
+	mdd_orphan_helpers_stop(helpers, nr_helpers);
+	if (helpers)
+		OBD_FREE_PTR_ARRAY(helpers, MDD_ORPHAN_THREADS_MAX);
+	OBD_FREE_LARGE(mob.mob_entries,
+		       MDD_ORPHAN_BATCH * sizeof(*mob.mob_entries));
+
 	return rc;
 }
 
@@ -533,6 +775,8 @@ void mdd_orphan_index_fini(const struct lu_env *env, struct mdd_device *mdd)
 static int mdd_orphan_cleanup_thread(void *args)
 {
 	struct mdd_generic_thread *thread = (struct mdd_generic_thread *)args;
+	struct mdd_device *mdd = thread->mgt_data;
+	struct mdd_orphan_stats *mos = &mdd->mdd_orphan_stats;
 	struct lu_env *env = NULL;
 	int rc;
 	ENTRY;
@@ -547,8 +791,22 @@ static int mdd_orphan_cleanup_thread(void *args)
 	if (rc)
 		GOTO(out, rc);
 
+	mos->mos_start = ktime_get_real_seconds();
+	mos->mos_end = 0;
+	atomic64_set(&mos->mos_scanned, 0);
+	atomic64_set(&mos->mos_destroyed, 0);
+	atomic64_set(&mos->mos_skipped, 0);
+	atomic64_set(&mos->mos_failed, 0);
+
 	rc = mdd_orphan_index_iterate(env, thread);
 
+	mos->mos_end = ktime_get_real_seconds();
+	CDEBUG(D_HA, "%s: orphan cleanup done in %llds with %d threads, destroyed %lld skipped %lld failed %lld: rc = %d\n",
+	       mdd2obd_dev(mdd)->obd_name, mos->mos_end - mos->mos_start,
+	       mos->mos_threads, (s64)atomic64_read(&mos->mos_destroyed),
+	       (s64)atomic64_read(&mos->mos_skipped),
+	       (s64)atomic64_read(&mos->mos_failed), rc);
+
 	lu_env_fini(env);
 	GOTO(out, rc);
 out:
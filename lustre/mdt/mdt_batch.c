@@ -52,6 +52,7 @@ static int mdt_batch_unpack(struct mdt_thread_info *info, __u32 opc)
 
 	switch (opc) {
 	case BUT_GETATTR:
+	case BUT_GETXATTR:
 		info->mti_dlm_req = req_capsule_client_get(info->mti_pill,
 							   &RMF_DLM_REQ);
 		if (info->mti_dlm_req == NULL)
@@ -106,6 +107,26 @@ static int mdt_batch_getattr(struct tgt_session_info *tsi)
 	RETURN(rc);
 }
 
+static int mdt_batch_getxattr(struct tgt_session_info *tsi)
+{
+	struct mdt_thread_info *info = mdt_th_info(tsi->tsi_env);
+	struct req_capsule *pill = &info->mti_sub_pill;
+	int rc;
+
+	ENTRY;
+
+	/*
+	 * Unlike getattr, the reply is packed late by mdt_getxattr(), so
+	 * mark it unpacked for mdt_info_reply_packed() in case of an error
+	 * before that. The buffer may be reused from an older reply.
+	 */
+	pill->rc_repmsg->lm_magic = 0;
+	rc = ldlm_handle_enqueue(info->mti_exp->exp_obd->obd_namespace,
+				 pill, info->mti_dlm_req, &mdt_dlm_cbs);
+
+	RETURN(rc);
+}
+
 /* Batch UpdaTe Request with a format known in advance */
 #define TGT_BUT_HDL(flags, opc, fn)			\
 [opc - BUT_FIRST_OPC] = {				\
@@ -121,6 +142,7 @@ static int mdt_batch_getattr(struct tgt_session_info *tsi)
 
 static struct tgt_handler mdt_batch_handlers[] = {
 TGT_BUT_HDL(HAS_KEY | HAS_REPLY,	BUT_GETATTR,	mdt_batch_getattr),
+TGT_BUT_HDL(HAS_KEY,			BUT_GETXATTR,	mdt_batch_getxattr),
 };
 
 static struct tgt_handler *mdt_batch_handler_find(__u32 opc)
@@ -563,18 +563,22 @@ static int mdt_statfs(struct tgt_session_info *tsi)
 	 * caches with brw recently */
 	CDEBUG(D_SUPER | D_CACHE, "blocks cached %llu granted %llu"
 	       " pending %llu free %llu avail %llu\n",
-	       tgd->tgd_tot_dirty, tgd->tgd_tot_granted,
-	       tgd->tgd_tot_pending,
+	       tgt_grant_tot_dirty(tgd), tgd->tgd_tot_granted,
+	       tgt_grant_tot_pending(tgd),
 	       osfs->os_bfree << current_blockbits,
 	       osfs->os_bavail << current_blockbits);
 
 	osfs->os_bavail -= min_t(u64, osfs->os_bavail,
-				 ((tgd->tgd_tot_dirty + tgd->tgd_tot_pending +
+				 ((tgt_grant_tot_dirty(tgd) +
+				   tgt_grant_tot_pending(tgd) +
 				   osfs->os_bsize - 1) >> current_blockbits));
 
 	tgt_grant_sanity_check(mdt->mdt_lu_dev.ld_obd, __func__);
 	if (mdt->mdt_lut.lut_no_create)
 		osfs->os_state |= OS_STATFS_NOCREATE;
+	/* the load of this MDT, used by LMV to place new directories */
+	if (!(osfs->os_state & OS_STATFS_SUM))
+		tgt_load_statfs(&mdt->mdt_lut, osfs);
 	CDEBUG(D_CACHE, "%llu blocks: %llu free, %llu avail; "
 	       "%llu objects: %llu free; state %x\n",
 	       osfs->os_blocks, osfs->os_bfree, osfs->os_bavail,
@@ -3483,6 +3487,23 @@ static int mdt_quota_dqacq(struct tgt_session_info *tsi)
 	RETURN(rc);
 }
 
+/*
+ * Batched quota acquire/release request handler.
+ */
+static int mdt_quota_dqacq_batch(struct tgt_session_info *tsi)
+{
+	struct mdt_device	*mdt = mdt_exp2dev(tsi->tsi_exp);
+	struct lu_device	*qmt = mdt->mdt_qmt_dev;
+	int			 rc;
+	ENTRY;
+
+	if (qmt == NULL)
+		RETURN(err_serious(-EOPNOTSUPP));
+
+	rc = qmt_hdls.qmth_dqacq_batch(tsi->tsi_env, qmt, tgt_ses_req(tsi));
+	RETURN(rc);
+}
+
 struct mdt_object *mdt_object_new(const struct lu_env *env,
 				  struct mdt_device *d,
 				  const struct lu_fid *f)
@@ -4662,6 +4683,16 @@ void mdt_intent_fixup_resent(struct mdt_thread_info *info,
 		  dlmreq->lock_handle[0].cookie);
 }
 
+/* Whether the reply of the request or of the batched sub request is packed */
+static inline bool mdt_info_reply_packed(struct mdt_thread_info *info)
+{
+	if (info->mti_batch_env)
+		return info->mti_pill->rc_repmsg->lm_magic ==
+		       LUSTRE_MSG_MAGIC_V2;
+
+	return mdt_info_req(info)->rq_repmsg != NULL;
+}
+
 static int mdt_intent_getxattr(enum ldlm_intent_flags it_opc,
 			       struct mdt_thread_info *info,
 			       struct ldlm_lock **lockp,
@@ -4687,7 +4718,7 @@ static int mdt_intent_getxattr(enum ldlm_intent_flags it_opc,
 
 	rc = mdt_getxattr(info);
 
-	if (mdt_info_req(info)->rq_repmsg != NULL)
+	if (mdt_info_reply_packed(info))
 		ldlm_rep = req_capsule_server_get(info->mti_pill, &RMF_DLM_REP);
 
 	if (ldlm_rep == NULL ||
@@ -5103,7 +5134,7 @@ static int mdt_intent_opc(enum ldlm_intent_flags it_opc,
 	rc = (*it_handler)(it_opc, info, lockp, flags);
 
 	/* Check whether the reply has been packed successfully. */
-	if (info->mti_batch_env || req->rq_repmsg != NULL) {
+	if (mdt_info_reply_packed(info)) {
 		rep = req_capsule_server_get(info->mti_pill, &RMF_DLM_REP);
 		rep->lock_policy_res2 =
 			ptlrpc_status_hton(rep->lock_policy_res2);
@@ -5975,6 +6006,7 @@ TGT_SEC_HDL_VAR(0,			SEC_CTX_FINI,	  mdt_sec_ctx_handle)
 
 static struct tgt_handler mdt_quota_ops[] = {
 TGT_QUOTA_HDL(HAS_REPLY,		QUOTA_DQACQ,	  mdt_quota_dqacq),
+TGT_QUOTA_HDL(0,			QUOTA_DQACQ_BATCH, mdt_quota_dqacq_batch),
 };
 
 static struct tgt_handler mdt_llog_handlers[] = {
@@ -6059,6 +6091,7 @@ static void mdt_fini(const struct lu_env *env, struct mdt_device *m)
 
 	mdt_stack_pre_fini(env, m, md2lu_dev(m->mdt_child));
 
+	mdt_lsom_refresher_stop(m);
 	mdt_restriper_stop(m);
 	ping_evictor_stop();
 
@@ -6393,8 +6426,14 @@ static int mdt_init0(const struct lu_env *env, struct mdt_device *m,
 	if (rc)
 		GOTO(err_ping_evictor, rc);
 
+	rc = mdt_lsom_refresher_start(m);
+	if (rc)
+		GOTO(err_restriper, rc);
+
 	RETURN(0);
 
+err_restriper:
+	mdt_restriper_stop(m);
 err_ping_evictor:
 	ping_evictor_stop();
 err_procfs:
@@ -6544,8 +6583,8 @@ static struct lu_object *mdt_object_alloc(const struct lu_env *env,
 		init_rwsem(&mo->mot_dom_sem);
 		init_rwsem(&mo->mot_open_sem);
 		atomic_set(&mo->mot_open_count, 0);
-		mo->mot_restripe_offset = 0;
 		INIT_LIST_HEAD(&mo->mot_restripe_linkage);
+		INIT_LIST_HEAD(&mo->mot_lsom_linkage);
 		mo->mot_lsom_size = 0;
 		mo->mot_lsom_blocks = 0;
 		mo->mot_lsom_inited = false;
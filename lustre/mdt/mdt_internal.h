@@ -224,10 +224,61 @@ struct rename_stats {
 /* directory auto-split allocate delta new stripes each time */
 #define DIR_SPLIT_DELTA_DEFAULT	4
 
+/* default number of sub-file migration threads */
+#define DIR_RESTRIPE_THREADS_DEFAULT	4
+#define DIR_RESTRIPE_THREADS_MAX	32
+
+/* pause sub-file migration while MDT service time exceeds this (usec) */
+#define DIR_RESTRIPE_LOAD_USEC_DEFAULT	20000
+
+/* sub-file migration of one stripe. Worker threads take disjoint name hash
+ * ranges of the stripe, one readdir page each, and migrate them in parallel.
+ */
+struct mdt_restripe_job {
+	/* link to mdr_jobs, unlinked when all ranges are handed out */
+	struct list_head	mrj_linkage;
+	struct mdt_object      *mrj_stripe;
+	/* master directory FID */
+	struct lu_fid		mrj_master;
+	/* stripe LMV, MIGRATION flag is cleared when all ranges are done */
+	struct lmv_mds_md_v1	mrj_lmv;
+	/* serialize readdir of the stripe, protect below fields */
+	struct mutex		mrj_mutex;
+	/* start hash of the next range */
+	__u64			mrj_hash;
+	/* first error, stripe is not finished if set */
+	int			mrj_rc;
+	unsigned int		mrj_eof:1;
+	atomic_t		mrj_ref;
+	atomic64_t		mrj_migrated;
+	time64_t		mrj_start;
+};
+
+struct mdt_restripe_worker {
+	struct mdt_device	*mrw_mdt;
+	struct task_struct	*mrw_task;
+	int			 mrw_index;
+	struct lu_env		 mrw_env;
+	struct lu_context	 mrw_session;
+	/* lum used in migrate */
+	union lmv_mds_md	 mrw_lmv;
+	/* page used in readdir */
+	struct page		*mrw_page;
+};
+
 struct mdt_dir_restriper {
 	struct lu_env		mdr_env;
 	struct lu_context	mdr_session;
 	struct task_struct     *mdr_task;
+	/* sub-file migration threads, started on demand */
+	struct mdt_restripe_worker *mdr_workers[DIR_RESTRIPE_THREADS_MAX];
+	int			mdr_nr_workers;
+	/* max migration threads to run */
+	int			mdr_threads;
+	/* throttle migration if MDT service time exceeds this, 0 to disable */
+	u32			mdr_load_usec;
+	/* migration threads wait for jobs here */
+	wait_queue_head_t	mdr_waitq;
 	/* lock for below fields */
 	spinlock_t		mdr_lock;
 	/* auto split when plain dir/shard sub files exceed threshold */
@@ -240,12 +291,53 @@ struct mdt_dir_restriper {
 	struct list_head	mdr_migrating;
 	/* directories waiting to update layout after migration */
 	struct list_head	mdr_updating;
+	/* stripes whose sub files are being migrated by migration threads */
+	struct list_head	mdr_jobs;
+	/* sub files migrated, migrate failures, throttled pages */
+	atomic64_t		mdr_migrated;
+	atomic64_t		mdr_migrate_failed;
+	atomic64_t		mdr_throttled;
 	/* time to update directory layout after migration */
 	time64_t		mdr_update_time;
-	/* lum used in split/migrate/layout_change */
+	/* lum used in split/layout_change */
 	union lmv_mds_md	mdr_lmv;
-	/* page used in readdir */
-	struct page	       *mdr_page;
+};
+
+/* default max files per second to refresh LSOM from OSTs */
+#define MDT_LSOM_REFRESH_RATE_DEFAULT	1000
+/* default seconds after last close to refresh LSOM, so that clients can
+ * flush dirty data to OSTs in the meantime
+ */
+#define MDT_LSOM_REFRESH_DELAY_DEFAULT	5
+/* max files waiting for LSOM refresh, more closes are not queued */
+#define MDT_LSOM_REFRESH_QUEUE_MAX	65536
+
+/* refresh LSOM of files from their OST objects after they are written */
+struct mdt_lsom_refresher {
+	struct lu_env		mlr_env;
+	struct lu_context	mlr_session;
+	struct task_struct     *mlr_task;
+	/* lock for below fields */
+	spinlock_t		mlr_lock;
+	/* files closed after write, in close order */
+	struct list_head	mlr_queue;
+	int			mlr_queued;
+	/* refresh at most this many files per second, 0 for unlimited */
+	unsigned int		mlr_rate;
+	/* refresh files this many seconds after close */
+	unsigned int		mlr_delay;
+	/* start of current rate limit window and files refreshed in it */
+	time64_t		mlr_window;
+	unsigned int		mlr_window_count;
+	/* files whose LSOM is updated, already up to date, skipped because
+	 * they are opened for write again or have strict SOM, failed, and
+	 * not queued because the queue is full
+	 */
+	atomic64_t		mlr_refreshed;
+	atomic64_t		mlr_unchanged;
+	atomic64_t		mlr_skipped;
+	atomic64_t		mlr_failed;
+	atomic64_t		mlr_dropped;
 };
 
 struct mdt_device {
@@ -317,7 +409,9 @@ struct mdt_device {
 				    */
 				   mdt_enable_dmv_implicit_inherit:1,
 				   /* set dmv by setxattr, off by default */
-				   mdt_enable_dmv_xattr:1;
+				   mdt_enable_dmv_xattr:1,
+				   /* refresh LSOM from OSTs after close */
+				   mdt_enable_lsom_refresh:1;
 
 				   /* user with gid can create remote/striped
 				    * dir, and set default dir stripe */
@@ -356,6 +450,8 @@ struct mdt_device {
 
 	struct mdt_dir_restriper   mdt_restriper;
 
+	struct mdt_lsom_refresher  mdt_lsom_refresher;
+
 	/* count of old clients that doesn't support DMV implicite inherit */
 	atomic_t		   mdt_dmv_old_client_count;
 
@@ -393,10 +489,11 @@ struct mdt_object {
 	struct rw_semaphore	mot_open_sem;
 	atomic_t		mot_lease_count;
 	atomic_t		mot_open_count;
-	/* directory offset, used in sub file migration in dir restripe */
-	loff_t			mot_restripe_offset;
 	/* link to mdt_restriper auto_splitting/migrating/updating */
 	struct list_head	mot_restripe_linkage;
+	/* link to mdt_lsom_refresher queue, and time of queueing */
+	struct list_head	mot_lsom_linkage;
+	time64_t		mot_lsom_queued;
 };
 
 struct mdt_lock_handle {
@@ -1320,6 +1417,10 @@ int mdt_get_som(struct mdt_thread_info *info, struct mdt_object *obj,
 int mdt_lsom_downgrade(struct mdt_thread_info *info, struct mdt_object *obj);
 int mdt_lsom_update(struct mdt_thread_info *info, struct mdt_object *obj,
 		    bool truncate);
+void mdt_lsom_refresh_queue(struct mdt_thread_info *info,
+			    struct mdt_object *obj);
+int mdt_lsom_refresher_start(struct mdt_device *mdt);
+void mdt_lsom_refresher_stop(struct mdt_device *mdt);
 
 /* mdt_lvb.c */
 extern struct ldlm_valblock_ops mdt_lvbo;
@@ -1533,6 +1634,10 @@ int mdt_restripe_internal(struct mdt_thread_info *info,
 			  struct lu_fid *tfid,
 			  struct md_op_spec *spec,
 			  struct md_attr *ma);
+struct mdt_thread_info *mdt_thread_env_init(struct mdt_device *mdt,
+					    struct lu_env *env,
+					    struct lu_context *session);
+void mdt_thread_env_fini(struct lu_env *env);
 int mdt_restriper_start(struct mdt_device *mdt);
 void mdt_restriper_stop(struct mdt_device *mdt);
 void mdt_auto_split_add(struct mdt_thread_info *info, struct mdt_object *o);
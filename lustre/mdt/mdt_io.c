@@ -679,6 +679,10 @@ out_stop:
 			granted = 0;
 	}
 
+	/* reply once the data is written rather than wait for it here */
+	if (rc == 0)
+		tgt_brw_async_cb_add(env, th);
+
 	th->th_result = restart ? 0 : rc;
 	dt_trans_stop(env, dt, th);
 	if (rc == -ENOSPC && retries++ < 3) {
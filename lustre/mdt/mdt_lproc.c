@@ -739,6 +739,7 @@ MDT_BOOL_RW_ATTR(enable_dir_auto_split);
 MDT_BOOL_RW_ATTR(dir_restripe_nsonly);
 MDT_BOOL_RW_ATTR(migrate_hsm_allowed);
 MDT_BOOL_RW_ATTR(enable_strict_som);
+MDT_BOOL_RW_ATTR(enable_lsom_refresh);
 MDT_BOOL_RW_ATTR(enable_dmv_implicit_inherit);
 MDT_BOOL_RW_ATTR(enable_dmv_xattr);
 
@@ -1026,6 +1027,214 @@ static ssize_t dir_split_delta_store(struct kobject *kobj,
 }
 LUSTRE_RW_ATTR(dir_split_delta);
 
+static ssize_t dir_restripe_threads_show(struct kobject *kobj,
+					 struct attribute *attr,
+					 char *buf)
+{
+	struct obd_device *obd = container_of(kobj, struct obd_device,
+					      obd_kset.kobj);
+	struct mdt_device *mdt = mdt_dev(obd->obd_lu_dev);
+
+	return scnprintf(buf, PAGE_SIZE, "%d\n",
+			 mdt->mdt_restriper.mdr_threads);
+}
+
+static ssize_t dir_restripe_threads_store(struct kobject *kobj,
+					  struct attribute *attr,
+					  const char *buffer, size_t count)
+{
+	struct obd_device *obd = container_of(kobj, struct obd_device,
+					      obd_kset.kobj);
+	struct mdt_device *mdt = mdt_dev(obd->obd_lu_dev);
+	u32 val;
+	int rc;
+
+	rc = kstrtouint(buffer, 0, &val);
+	if (rc)
+		return rc;
+
+	if (val < 1 || val > DIR_RESTRIPE_THREADS_MAX)
+		return -ERANGE;
+
+	WRITE_ONCE(mdt->mdt_restriper.mdr_threads, val);
+	/* idle migration threads may be allowed to work now */
+	wake_up_all(&mdt->mdt_restriper.mdr_waitq);
+
+	return count;
+}
+LUSTRE_RW_ATTR(dir_restripe_threads);
+
+static ssize_t dir_restripe_load_usec_show(struct kobject *kobj,
+					   struct attribute *attr,
+					   char *buf)
+{
+	struct obd_device *obd = container_of(kobj, struct obd_device,
+					      obd_kset.kobj);
+	struct mdt_device *mdt = mdt_dev(obd->obd_lu_dev);
+
+	return scnprintf(buf, PAGE_SIZE, "%u\n",
+			 mdt->mdt_restriper.mdr_load_usec);
+}
+
+static ssize_t dir_restripe_load_usec_store(struct kobject *kobj,
+					    struct attribute *attr,
+					    const char *buffer, size_t count)
+{
+	struct obd_device *obd = container_of(kobj, struct obd_device,
+					      obd_kset.kobj);
+	struct mdt_device *mdt = mdt_dev(obd->obd_lu_dev);
+	u32 val;
+	int rc;
+
+	rc = kstrtouint(buffer, 0, &val);
+	if (rc)
+		return rc;
+
+	WRITE_ONCE(mdt->mdt_restriper.mdr_load_usec, val);
+
+	return count;
+}
+LUSTRE_RW_ATTR(dir_restripe_load_usec);
+
+static int mdt_dir_restripe_status_seq_show(struct seq_file *m, void *data)
+{
+	struct obd_device *obd = m->private;
+	struct mdt_device *mdt = mdt_dev(obd->obd_lu_dev);
+	struct mdt_dir_restriper *restriper = &mdt->mdt_restriper;
+	struct mdt_restripe_job *job;
+	struct list_head *pos;
+	int splitting = 0;
+	int migrating = 0;
+	int updating = 0;
+	time64_t now = ktime_get_real_seconds();
+
+	spin_lock(&restriper->mdr_lock);
+	list_for_each(pos, &restriper->mdr_auto_splitting)
+		splitting++;
+	list_for_each(pos, &restriper->mdr_migrating)
+		migrating++;
+	list_for_each(pos, &restriper->mdr_updating)
+		updating++;
+
+	seq_printf(m, "threads: %d\n"
+		   "threads_running: %d\n"
+		   "dirs_splitting: %d\n"
+		   "stripes_queued: %d\n"
+		   "dirs_updating: %d\n"
+		   "migrated: %lld\n"
+		   "migrate_failed: %lld\n"
+		   "throttled: %lld\n"
+		   "stripes_migrating:\n",
+		   restriper->mdr_threads, restriper->mdr_nr_workers,
+		   splitting, migrating, updating,
+		   (s64)atomic64_read(&restriper->mdr_migrated),
+		   (s64)atomic64_read(&restriper->mdr_migrate_failed),
+		   (s64)atomic64_read(&restriper->mdr_throttled));
+
+	list_for_each_entry(job, &restriper->mdr_jobs, mrj_linkage)
+		seq_printf(m, "  - { fid: "DFID", parent: "DFID
+			   ", hash: %#llx, migrated: %lld, elapsed: %lld }\n",
+			   PFID(mdt_object_fid(job->mrj_stripe)),
+			   PFID(&job->mrj_master), READ_ONCE(job->mrj_hash),
+			   (s64)atomic64_read(&job->mrj_migrated),
+			   now - job->mrj_start);
+	spin_unlock(&restriper->mdr_lock);
+
+	return 0;
+}
+LPROC_SEQ_FOPS_RO(mdt_dir_restripe_status);
+
+static ssize_t lsom_refresh_rate_show(struct kobject *kobj,
+				      struct attribute *attr, char *buf)
+{
+	struct obd_device *obd = container_of(kobj, struct obd_device,
+					      obd_kset.kobj);
+	struct mdt_device *mdt = mdt_dev(obd->obd_lu_dev);
+
+	return scnprintf(buf, PAGE_SIZE, "%u\n",
+			 mdt->mdt_lsom_refresher.mlr_rate);
+}
+
+static ssize_t lsom_refresh_rate_store(struct kobject *kobj,
+				       struct attribute *attr,
+				       const char *buffer, size_t count)
+{
+	struct obd_device *obd = container_of(kobj, struct obd_device,
+					      obd_kset.kobj);
+	struct mdt_device *mdt = mdt_dev(obd->obd_lu_dev);
+	u32 val;
+	int rc;
+
+	rc = kstrtouint(buffer, 0, &val);
+	if (rc)
+		return rc;
+
+	WRITE_ONCE(mdt->mdt_lsom_refresher.mlr_rate, val);
+
+	return count;
+}
+LUSTRE_RW_ATTR(lsom_refresh_rate);
+
+static ssize_t lsom_refresh_delay_show(struct kobject *kobj,
+				       struct attribute *attr, char *buf)
+{
+	struct obd_device *obd = container_of(kobj, struct obd_device,
+					      obd_kset.kobj);
+	struct mdt_device *mdt = mdt_dev(obd->obd_lu_dev);
+
+	return scnprintf(buf, PAGE_SIZE, "%u\n",
+			 mdt->mdt_lsom_refresher.mlr_delay);
+}
+
+static ssize_t lsom_refresh_delay_store(struct kobject *kobj,
+					struct attribute *attr,
+					const char *buffer, size_t count)
+{
+	struct obd_device *obd = container_of(kobj, struct obd_device,
+					      obd_kset.kobj);
+	struct mdt_device *mdt = mdt_dev(obd->obd_lu_dev);
+	struct mdt_lsom_refresher *refresher = &mdt->mdt_lsom_refresher;
+	u32 val;
+	int rc;
+
+	rc = kstrtouint(buffer, 0, &val);
+	if (rc)
+		return rc;
+
+	WRITE_ONCE(refresher->mlr_delay, val);
+	/* let the refresh thread recompute its wait */
+	spin_lock(&refresher->mlr_lock);
+	if (refresher->mlr_task)
+		wake_up_process(refresher->mlr_task);
+	spin_unlock(&refresher->mlr_lock);
+
+	return count;
+}
+LUSTRE_RW_ATTR(lsom_refresh_delay);
+
+static int mdt_lsom_refresh_stats_seq_show(struct seq_file *m, void *data)
+{
+	struct obd_device *obd = m->private;
+	struct mdt_device *mdt = mdt_dev(obd->obd_lu_dev);
+	struct mdt_lsom_refresher *refresher = &mdt->mdt_lsom_refresher;
+
+	seq_printf(m, "queued: %d\n"
+		   "refreshed: %lld\n"
+		   "unchanged: %lld\n"
+		   "skipped: %lld\n"
+		   "failed: %lld\n"
+		   "dropped: %lld\n",
+		   READ_ONCE(refresher->mlr_queued),
+		   (s64)atomic64_read(&refresher->mlr_refreshed),
+		   (s64)atomic64_read(&refresher->mlr_unchanged),
+		   (s64)atomic64_read(&refresher->mlr_skipped),
+		   (s64)atomic64_read(&refresher->mlr_failed),
+		   (s64)atomic64_read(&refresher->mlr_dropped));
+
+	return 0;
+}
+LPROC_SEQ_FOPS_RO(mdt_lsom_refresh_stats);
+
 static ssize_t enable_remote_subdir_mount_show(struct kobject *kobj,
 					       struct attribute *attr,
 					       char *buf)
@@ -1338,6 +1547,9 @@ static struct attribute *mdt_attrs[] = {
 	&lustre_attr_dom_lock.attr,
 	&lustre_attr_dom_read_open.attr,
 	&lustre_attr_enable_strict_som.attr,
+	&lustre_attr_enable_lsom_refresh.attr,
+	&lustre_attr_lsom_refresh_rate.attr,
+	&lustre_attr_lsom_refresh_delay.attr,
 	&lustre_attr_migrate_hsm_allowed.attr,
 	&lustre_attr_hsm_control.attr,
 	&lustre_attr_job_cleanup_interval.attr,
@@ -1346,6 +1558,8 @@ static struct attribute *mdt_attrs[] = {
 	&lustre_attr_dir_split_count.attr,
 	&lustre_attr_dir_split_delta.attr,
 	&lustre_attr_dir_restripe_nsonly.attr,
+	&lustre_attr_dir_restripe_threads.attr,
+	&lustre_attr_dir_restripe_load_usec.attr,
 	&lustre_attr_checksum_t10pi_enforce.attr,
 	&lustre_attr_enable_remote_subdir_mount.attr,
 	&lustre_attr_max_mod_rpcs_in_flight.attr,
@@ -1378,6 +1592,10 @@ static struct lprocfs_vars lprocfs_mdt_obd_vars[] = {
 	  .fops =	&mdt_nosquash_nids_fops			},
 	{ .name =	"checksum_type",
 	  .fops =	&mdt_checksum_type_fops		},
+	{ .name =	"dir_restripe_status",
+	  .fops =	&mdt_dir_restripe_status_fops		},
+	{ .name =	"lsom_refresh_stats",
+	  .fops =	&mdt_lsom_refresh_stats_fops		},
 	{ NULL }
 };
 
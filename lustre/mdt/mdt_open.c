@@ -2541,6 +2541,10 @@ int mdt_mfd_close(struct mdt_thread_info *info, struct mdt_file_data *mfd)
 		}
 	}
 
+	if (S_ISREG(lu_object_attr(&o->mot_obj)) &&
+	    ma->ma_attr_flags & MDS_DATA_MODIFIED)
+		mdt_lsom_refresh_queue(info, o);
+
 	if (open_flags & MDS_FMODE_WRITE)
 		mdt_write_put(o);
 	else if (open_flags & MDS_FMODE_EXEC)
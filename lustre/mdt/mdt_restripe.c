@@ -64,7 +64,6 @@ void mdt_restripe_migrate_add(struct mdt_thread_info *info,
 	spin_lock(&restriper->mdr_lock);
 	if (!o->mot_restriping) {
 		o->mot_restriping = 1;
-		o->mot_restripe_offset = 0;
 		mdt_object_get(NULL, o);
 		LASSERT(list_empty(&o->mot_restripe_linkage));
 		list_add_tail(&o->mot_restripe_linkage,
@@ -438,6 +437,21 @@ out:
 	return rc;
 }
 
+/* stripe is removed from restriping, it may be added back on next access */
+static void mdt_restripe_migrate_put(const struct lu_env *env,
+				     struct mdt_device *mdt,
+				     struct mdt_object *stripe)
+{
+	LASSERT(list_empty(&stripe->mot_restripe_linkage));
+	LASSERT(stripe->mot_restriping);
+
+	spin_lock(&mdt->mdt_restriper.mdr_lock);
+	stripe->mot_restriping = 0;
+	spin_unlock(&mdt->mdt_restriper.mdr_lock);
+
+	mdt_object_put(env, stripe);
+}
+
 /* sub-files under one stripe are migrated, clear MIGRATION flag in its LMV */
 static int mdt_restripe_migrate_finish(struct mdt_thread_info *info,
 				       struct mdt_object *stripe,
@@ -467,15 +481,7 @@ static int mdt_restripe_migrate_finish(struct mdt_thread_info *info,
 		CERROR("%s: update "DFID" LMV failed: rc = %d\n",
 		       mdt_obd_name(mdt), PFID(mdt_object_fid(stripe)), rc);
 
-	LASSERT(!list_empty(&stripe->mot_restripe_linkage));
-	LASSERT(stripe->mot_restriping);
-
-	spin_lock(&mdt->mdt_lock);
-	stripe->mot_restriping = 0;
-	list_del_init(&stripe->mot_restripe_linkage);
-	spin_unlock(&mdt->mdt_lock);
-
-	mdt_object_put(info->mti_env, stripe);
+	mdt_restripe_migrate_put(info->mti_env, mdt, stripe);
 
 	RETURN(rc);
 }
@@ -485,12 +491,12 @@ static void mdt_restripe_migrate_prep(struct mdt_thread_info *info,
 				      const struct lu_fid *fid2,
 				      const struct lu_name *lname,
 				      __u16 type,
-				      const struct lmv_mds_md_v1 *lmv)
+				      const struct lmv_mds_md_v1 *lmv,
+				      struct lmv_user_md_v1 *lum)
 {
 	struct lu_attr *attr = &info->mti_attr.ma_attr;
 	struct mdt_reint_record *rr = &info->mti_rr;
 	struct md_op_spec *spec = &info->mti_spec;
-	struct lmv_user_md_v1 *lum;
 
 	attr->la_ctime = attr->la_mtime = ktime_get_real_seconds();
 	attr->la_valid = LA_CTIME | LA_MTIME;
@@ -499,7 +505,6 @@ static void mdt_restripe_migrate_prep(struct mdt_thread_info *info,
 	rr->rr_fid2 = fid2;
 	rr->rr_name = *lname;
 
-	lum = &info->mti_mdt->mdt_restriper.mdr_lmv.lmv_user_md;
 	lum->lum_magic = cpu_to_le32(LMV_USER_MAGIC);
 	lum->lum_stripe_offset = cpu_to_le32(LMV_OFFSET_DEFAULT);
 	if (lmv_is_splitting(lmv)) {
@@ -524,36 +529,442 @@ static void mdt_restripe_migrate_prep(struct mdt_thread_info *info,
 			info->mti_mdt->mdt_dir_restripe_nsonly;
 }
 
-/* migrate sub-file from @mdr_restripe_offset */
-static int mdt_restripe_migrate(struct mdt_thread_info *info)
+static void mdt_restripe_job_put(struct mdt_thread_info *info,
+				 struct mdt_restripe_job *job)
+{
+	if (!atomic_dec_and_test(&job->mrj_ref))
+		return;
+
+	LASSERT(list_empty(&job->mrj_linkage));
+	if (!job->mrj_rc) {
+		LASSERT(job->mrj_eof);
+		mdt_restripe_migrate_finish(info, job->mrj_stripe,
+					    &job->mrj_lmv);
+	} else {
+		mdt_restripe_migrate_put(info->mti_env, info->mti_mdt,
+					 job->mrj_stripe);
+	}
+
+	CDEBUG(D_INFO, "%s: migrated %lld sub files of "DFID" in %llds: rc = %d\n",
+	       mdt_obd_name(info->mti_mdt),
+	       (s64)atomic64_read(&job->mrj_migrated),
+	       PFID(&job->mrj_master),
+	       ktime_get_real_seconds() - job->mrj_start, job->mrj_rc);
+
+	OBD_FREE_PTR(job);
+}
+
+/* all ranges of @job are handed out, or it failed, stop handing out more */
+static void mdt_restripe_job_unlink(struct mdt_thread_info *info,
+				    struct mdt_restripe_job *job)
+{
+	struct mdt_dir_restriper *restriper = &info->mti_mdt->mdt_restriper;
+	bool linked;
+
+	spin_lock(&restriper->mdr_lock);
+	linked = !list_empty(&job->mrj_linkage);
+	list_del_init(&job->mrj_linkage);
+	spin_unlock(&restriper->mdr_lock);
+
+	if (linked)
+		mdt_restripe_job_put(info, job);
+}
+
+/* get the next job to work on, and move it to the tail for fairness */
+static struct mdt_restripe_job *
+mdt_restripe_job_get(struct mdt_dir_restriper *restriper)
+{
+	struct mdt_restripe_job *job = NULL;
+
+	spin_lock(&restriper->mdr_lock);
+	if (!list_empty(&restriper->mdr_jobs)) {
+		job = list_first_entry(&restriper->mdr_jobs,
+				       struct mdt_restripe_job, mrj_linkage);
+		atomic_inc(&job->mrj_ref);
+		list_move_tail(&job->mrj_linkage, &restriper->mdr_jobs);
+	}
+	spin_unlock(&restriper->mdr_lock);
+
+	return job;
+}
+
+/* migrate sub file @ent of @job stripe */
+static int mdt_restripe_migrate_one(struct mdt_thread_info *info,
+				    struct mdt_restripe_job *job,
+				    struct lu_dirent *ent,
+				    struct lmv_user_md_v1 *lum)
 {
 	const struct lu_env *env = info->mti_env;
 	struct mdt_device *mdt = info->mti_mdt;
+	struct lu_name *lname = &info->mti_name;
+	struct mdt_object *master;
+	struct lu_fid fid2;
+	int namelen = le16_to_cpu(ent->lde_namelen);
+	__u16 type = lu_dirent_type_get(ent);
+	int rc;
+
+	/* copy name out because it should end with '\0' */
+	memcpy(info->mti_filename, ent->lde_name, namelen);
+	info->mti_filename[namelen] = '\0';
+	lname->ln_name = info->mti_filename;
+	lname->ln_namelen = namelen;
+
+	CDEBUG(D_INFO, "migrate "DFID"/"DNAME" type %ho\n",
+	       PFID(&job->mrj_master), PNAME(lname), type);
+
+	master = mdt_object_find(env, mdt, &job->mrj_master);
+	if (IS_ERR(master))
+		GOTO(out, rc = PTR_ERR(master));
+
+	rc = mdt_fid_alloc(env, mdt, &fid2, master, lname);
+	mdt_object_put(env, master);
+	if (rc < 0)
+		GOTO(out, rc);
+
+	mdt_restripe_migrate_prep(info, &job->mrj_master, &fid2, lname, type,
+				  &job->mrj_lmv, lum);
+
+	rc = mdt_reint_migrate(info, NULL);
+	/* mti_big_buf is allocated in XATTR migration */
+	if (unlikely(info->mti_big_buf.lb_buf))
+		lu_buf_free(&info->mti_big_buf);
+	if (!rc) {
+		atomic64_inc(&job->mrj_migrated);
+		atomic64_inc(&mdt->mdt_restriper.mdr_migrated);
+	} else if (rc == -EALREADY) {
+		rc = 0;
+	}
+out:
+	/* -EBUSY: file is opened by others */
+	if (rc && rc != -EBUSY)
+		CERROR("%s: migrate "DFID"/"DNAME" failed: rc = %d\n",
+		       mdt_obd_name(mdt), PFID(&job->mrj_master),
+		       PNAME(lname), rc);
+
+	return rc;
+}
+
+/* slow down migration while this MDT is slow to serve client requests */
+static void mdt_restripe_throttle(struct mdt_device *mdt)
+{
 	struct mdt_dir_restriper *restriper = &mdt->mdt_restriper;
-	struct mdt_object *stripe = NULL;
-	struct mdt_object *master = NULL;
+	struct lu_target *lut = &mdt->mdt_lut;
+	u32 limit = READ_ONCE(restriper->mdr_load_usec);
+
+	if (!limit || !atomic_read(&lut->lut_load_depth) ||
+	    READ_ONCE(lut->lut_load_usec) < limit)
+		return;
+
+	atomic64_inc(&restriper->mdr_throttled);
+	set_current_state(TASK_IDLE);
+	schedule_timeout(cfs_time_seconds(1) / 10);
+}
+
+/**
+ * Take the next name hash range (one readdir page) of \a job, and migrate
+ * sub files in it. Ranges of the same stripe are taken by different threads
+ * and migrated in parallel, readdir of the stripe is serialized.
+ *
+ * \param[in] info	mdt_thread_info of migration thread
+ * \param[in] worker	migration thread
+ * \param[in] job	stripe to migrate, reference is released on return
+ */
+static void mdt_restripe_job_run(struct mdt_thread_info *info,
+				 struct mdt_restripe_worker *worker,
+				 struct mdt_restripe_job *job)
+{
+	const struct lu_env *env = info->mti_env;
+	struct mdt_dir_restriper *restriper = &info->mti_mdt->mdt_restriper;
+	struct lu_rdpg *rdpg = &info->mti_u.rdpg.mti_rdpg;
+	struct lu_dirpage *dp = NULL;
+	struct lu_dirent *ent;
+	__u64 hash_end;
+	bool done;
+	int namelen;
+	int rc = 0;
+
+	ENTRY;
+
+	mdt_restripe_throttle(info->mti_mdt);
+
+	mutex_lock(&job->mrj_mutex);
+	if (job->mrj_eof || job->mrj_rc) {
+		mutex_unlock(&job->mrj_mutex);
+		GOTO(put, rc = 0);
+	}
+
+	rdpg->rp_hash = job->mrj_hash;
+	rdpg->rp_count = PAGE_SIZE;
+	rdpg->rp_npages = 1;
+	rdpg->rp_attrs = LUDA_64BITHASH | LUDA_FID | LUDA_TYPE;
+	rdpg->rp_pages = &worker->mrw_page;
+	rc = mo_readpage(env, mdt_object_child(job->mrj_stripe), rdpg);
+	if (rc >= 0) {
+		dp = page_address(worker->mrw_page);
+		hash_end = le64_to_cpu(dp->ldp_hash_end);
+		rc = 0;
+		if (hash_end == MDS_DIR_END_OFF)
+			job->mrj_eof = 1;
+		else if (hash_end <= job->mrj_hash)
+			rc = -EBADF;
+		else
+			job->mrj_hash = hash_end;
+	}
+	if (rc)
+		job->mrj_rc = rc;
+	done = job->mrj_eof || job->mrj_rc;
+	mutex_unlock(&job->mrj_mutex);
+
+	if (done)
+		mdt_restripe_job_unlink(info, job);
+	if (rc)
+		GOTO(out, rc);
+
+	for (ent = lu_dirent_start(dp); ent; ent = lu_dirent_next(ent)) {
+		if (unlikely(!(le32_to_cpu(ent->lde_attrs) & LUDA_TYPE)))
+			GOTO(out, rc = -EINVAL);
+
+		namelen = le16_to_cpu(ent->lde_namelen);
+		if (!namelen)
+			continue;
+
+		if (name_is_dot_or_dotdot(ent->lde_name, namelen))
+			continue;
+
+		if (kthread_should_stop())
+			GOTO(out, rc = -ESHUTDOWN);
+
+		rc = mdt_restripe_migrate_one(info, job, ent,
+					      &worker->mrw_lmv.lmv_user_md);
+		if (rc)
+			GOTO(out, rc);
+
+		cond_resched();
+	}
+
+	EXIT;
+out:
+	if (rc) {
+		if (rc != -ESHUTDOWN)
+			atomic64_inc(&restriper->mdr_migrate_failed);
+
+		mutex_lock(&job->mrj_mutex);
+		if (!job->mrj_rc)
+			job->mrj_rc = rc;
+		mutex_unlock(&job->mrj_mutex);
+		mdt_restripe_job_unlink(info, job);
+	}
+put:
+	mdt_restripe_job_put(info, job);
+}
+
+static inline bool mdt_restripe_job_ready(struct mdt_restripe_worker *worker)
+{
+	struct mdt_dir_restriper *restriper = &worker->mrw_mdt->mdt_restriper;
+
+	return worker->mrw_index < READ_ONCE(restriper->mdr_threads) &&
+	       !list_empty(&restriper->mdr_jobs);
+}
+
+static int mdt_restripe_worker_main(void *arg)
+{
+	struct mdt_restripe_worker *worker = arg;
+	struct mdt_dir_restriper *restriper = &worker->mrw_mdt->mdt_restriper;
+	struct mdt_thread_info *info;
+	struct mdt_restripe_job *job;
+
+	ENTRY;
+
+	info = lu_context_key_get(&worker->mrw_env.le_ctx, &mdt_thread_key);
+	while (1) {
+		wait_event_idle(restriper->mdr_waitq,
+				kthread_should_stop() ||
+				mdt_restripe_job_ready(worker));
+		if (kthread_should_stop())
+			break;
+
+		job = mdt_restripe_job_get(restriper);
+		if (job)
+			mdt_restripe_job_run(info, worker, job);
+		cond_resched();
+	}
+
+	RETURN(0);
+}
+
+/* initialize env of MDT internal threads, like restripe, migration and
+ * LSOM refresh threads
+ */
+struct mdt_thread_info *mdt_thread_env_init(struct mdt_device *mdt,
+					    struct lu_env *env,
+					    struct lu_context *session)
+{
+	struct mdt_thread_info *info;
+	struct lu_ucred *uc;
+	int rc;
+
+	rc = lu_env_init(env, LCT_MD_THREAD);
+	if (rc)
+		return ERR_PTR(rc);
+
+	rc = lu_context_init(session, LCT_SERVER_SESSION);
+	if (rc) {
+		lu_env_fini(env);
+		return ERR_PTR(rc);
+	}
+
+	lu_context_enter(session);
+	env->le_ses = session;
+
+	info = lu_context_key_get(&env->le_ctx, &mdt_thread_key);
+	info->mti_env = env;
+	info->mti_mdt = mdt;
+	info->mti_pill = NULL;
+	info->mti_dlm_req = NULL;
+
+	uc = mdt_ucred(info);
+	uc->uc_valid = UCRED_OLD;
+	uc->uc_o_uid = 0;
+	uc->uc_o_gid = 0;
+	uc->uc_o_fsuid = 0;
+	uc->uc_o_fsgid = 0;
+	uc->uc_uid = 0;
+	uc->uc_gid = 0;
+	uc->uc_fsuid = 0;
+	uc->uc_fsgid = 0;
+	uc->uc_suppgids[0] = -1;
+	uc->uc_suppgids[1] = -1;
+	uc->uc_cap = cap_combine(CAP_FS_SET, CAP_NFSD_SET);
+	uc->uc_umask = 0644;
+	uc->uc_ginfo = NULL;
+	uc->uc_identity = NULL;
+	/* do not let rbac interfere with internal processing */
+	uc->uc_rbac_file_perms = 1;
+	uc->uc_rbac_dne_ops = 1;
+	uc->uc_rbac_quota_ops = 1;
+	uc->uc_rbac_byfid_ops = 1;
+	uc->uc_rbac_chlg_ops = 1;
+	uc->uc_rbac_fscrypt_admin = 1;
+
+	return info;
+}
+
+void mdt_thread_env_fini(struct lu_env *env)
+{
+	lu_context_exit(env->le_ses);
+	lu_context_fini(env->le_ses);
+	lu_env_fini(env);
+}
+
+static void mdt_restripe_worker_free(struct mdt_restripe_worker *worker)
+{
+	mdt_thread_env_fini(&worker->mrw_env);
+	__free_page(worker->mrw_page);
+	OBD_FREE_PTR(worker);
+}
+
+/* start migration threads up to mdr_threads, called by restripe thread */
+static int mdt_restripe_workers_start(struct mdt_device *mdt)
+{
+	struct mdt_dir_restriper *restriper = &mdt->mdt_restriper;
+	struct mdt_restripe_worker *worker;
+	struct mdt_thread_info *info;
+	struct task_struct *task;
+	int rc = 0;
+
+	while (restriper->mdr_nr_workers < READ_ONCE(restriper->mdr_threads)) {
+		OBD_ALLOC_PTR(worker);
+		if (!worker)
+			GOTO(out, rc = -ENOMEM);
+
+		worker->mrw_page = alloc_page(GFP_KERNEL);
+		if (!worker->mrw_page) {
+			OBD_FREE_PTR(worker);
+			GOTO(out, rc = -ENOMEM);
+		}
+
+		info = mdt_thread_env_init(mdt, &worker->mrw_env,
+					   &worker->mrw_session);
+		if (IS_ERR(info)) {
+			__free_page(worker->mrw_page);
+			OBD_FREE_PTR(worker);
+			GOTO(out, rc = PTR_ERR(info));
+		}
+
+		worker->mrw_mdt = mdt;
+		worker->mrw_index = restriper->mdr_nr_workers;
+		task = kthread_run(mdt_restripe_worker_main, worker,
+				   "mdt_rmig_%03d_%02d",
+				   mdt_seq_site(mdt)->ss_node_id,
+				   worker->mrw_index);
+		if (IS_ERR(task)) {
+			mdt_restripe_worker_free(worker);
+			GOTO(out, rc = PTR_ERR(task));
+		}
+
+		worker->mrw_task = task;
+		restriper->mdr_workers[restriper->mdr_nr_workers++] = worker;
+	}
+out:
+	if (rc)
+		CERROR("%s: cannot start migration thread %d: rc = %d\n",
+		       mdt_obd_name(mdt), restriper->mdr_nr_workers, rc);
+
+	/* go on with threads started */
+	return restriper->mdr_nr_workers ? 0 : rc;
+}
+
+static void mdt_restripe_workers_stop(struct mdt_device *mdt)
+{
+	struct mdt_dir_restriper *restriper = &mdt->mdt_restriper;
+	struct mdt_restripe_worker *worker;
+	int i;
+
+	for (i = 0; i < restriper->mdr_nr_workers; i++) {
+		worker = restriper->mdr_workers[i];
+		kthread_stop(worker->mrw_task);
+		mdt_restripe_worker_free(worker);
+		restriper->mdr_workers[i] = NULL;
+	}
+	restriper->mdr_nr_workers = 0;
+}
+
+/**
+ * Check stripe at the head of migrating list, and queue it to migration
+ * threads if its sub files need to be migrated.
+ *
+ * \param[in] info	mdt_thread_info of restripe thread
+ *
+ * \retval		0 on success
+ * \retval		negative errno on failure
+ */
+static int mdt_restripe_migrate_queue(struct mdt_thread_info *info)
+{
+	const struct lu_env *env = info->mti_env;
+	struct mdt_device *mdt = info->mti_mdt;
+	struct mdt_dir_restriper *restriper = &mdt->mdt_restriper;
+	struct mdt_object *stripe;
+	struct mdt_restripe_job *job;
 	struct md_attr *ma = &info->mti_attr;
 	struct lmv_mds_md_v1 *lmv;
 	struct lu_name *lname = &info->mti_name;
-	struct lu_rdpg *rdpg = &info->mti_u.rdpg.mti_rdpg;
 	struct lu_fid fid1;
-	struct lu_fid fid2;
-	struct lu_dirpage *dp;
-	struct lu_dirent *ent;
-	const char *name = NULL;
-	int namelen = 0;
-	__u16 type;
 	int idx = 0;
 	int len;
 	int rc;
 
 	ENTRY;
 
-	if (list_empty(&restriper->mdr_migrating))
+	spin_lock(&restriper->mdr_lock);
+	if (list_empty(&restriper->mdr_migrating)) {
+		spin_unlock(&restriper->mdr_lock);
 		RETURN(0);
+	}
 
 	stripe = list_entry(restriper->mdr_migrating.next, typeof(*stripe),
 			    mot_restripe_linkage);
+	list_del_init(&stripe->mot_restripe_linkage);
+	spin_unlock(&restriper->mdr_lock);
 
 	/* get master object FID and stripe name */
 	rc = mdt_attr_get_pfid_name(info, stripe, &fid1, lname);
@@ -604,105 +1015,38 @@ static int mdt_restripe_migrate(struct mdt_thread_info *info)
 		RETURN(rc);
 	}
 
-	/* get sub file name @mot_restripe_offset.
-	 * TODO: read one dirent instead of whole page.
-	 */
-	rdpg->rp_hash = stripe->mot_restripe_offset;
-	rdpg->rp_count = PAGE_SIZE;
-	rdpg->rp_npages = 1;
-	rdpg->rp_attrs = LUDA_64BITHASH | LUDA_FID | LUDA_TYPE;
-	rdpg->rp_pages = &restriper->mdr_page;
-	rc = mo_readpage(env, mdt_object_child(stripe), rdpg);
-	if (rc < 0)
-		GOTO(out, rc);
-
-	dp = page_address(restriper->mdr_page);
-	for (ent = lu_dirent_start(dp); ent; ent = lu_dirent_next(ent)) {
-		LASSERT(le64_to_cpu(ent->lde_hash) >= rdpg->rp_hash);
-
-		if (unlikely(!(le32_to_cpu(ent->lde_attrs) & LUDA_TYPE)))
-			GOTO(out, rc = -EINVAL);
-
-		namelen = le16_to_cpu(ent->lde_namelen);
-		if (!namelen)
-			continue;
-
-		if (name_is_dot_or_dotdot(ent->lde_name, namelen))
-			continue;
-
-		name = ent->lde_name;
-		type = lu_dirent_type_get(ent);
-		break;
-	}
-
-	if (!name) {
-		if (le64_to_cpu(dp->ldp_hash_end) == MDS_DIR_END_OFF) {
-			rc = mdt_restripe_migrate_finish(info, stripe, lmv);
-			RETURN(rc);
-		}
-
-		GOTO(out, rc = -EBADF);
-	}
-
-	/* copy name out because it should end with '\0' */
-	memcpy(info->mti_filename, name, namelen);
-	info->mti_filename[namelen] = '\0';
-	lname->ln_name = info->mti_filename;
-	lname->ln_namelen = namelen;
-
-	CDEBUG(D_INFO, "migrate "DFID"/"DNAME" type %ho\n",
-	       PFID(&fid1), PNAME(lname), type);
-
-	master = mdt_object_find(env, mdt, &fid1);
-	if (IS_ERR(master))
-		GOTO(out, rc = PTR_ERR(master));
-
-	rc = mdt_fid_alloc(env, mdt, &fid2, master, lname);
-	mdt_object_put(env, master);
-	if (rc < 0)
-		GOTO(out, rc);
-
-	mdt_restripe_migrate_prep(info, &fid1, &fid2, lname, type, lmv);
-
-	rc = mdt_reint_migrate(info, NULL);
-	/* mti_big_buf is allocated in XATTR migration */
-	if (unlikely(info->mti_big_buf.lb_buf))
-		lu_buf_free(&info->mti_big_buf);
-	if (rc == -EALREADY)
-		rc = 0;
+	rc = mdt_restripe_workers_start(mdt);
 	if (rc)
 		GOTO(out, rc);
 
-	LASSERT(ent);
-	do {
-		ent = lu_dirent_next(ent);
-		if (!ent)
-			break;
+	OBD_ALLOC_PTR(job);
+	if (!job)
+		GOTO(out, rc = -ENOMEM);
 
-		namelen = le16_to_cpu(ent->lde_namelen);
-	} while (namelen == 0); /* Skip dummy record */
+	INIT_LIST_HEAD(&job->mrj_linkage);
+	job->mrj_stripe = stripe;
+	job->mrj_master = fid1;
+	job->mrj_lmv = *lmv;
+	mutex_init(&job->mrj_mutex);
+	/* reference for mdr_jobs */
+	atomic_set(&job->mrj_ref, 1);
+	atomic64_set(&job->mrj_migrated, 0);
+	job->mrj_start = ktime_get_real_seconds();
 
-	if (ent)
-		stripe->mot_restripe_offset = le64_to_cpu(ent->lde_hash);
-	else
-		stripe->mot_restripe_offset = le64_to_cpu(dp->ldp_hash_end);
+	spin_lock(&restriper->mdr_lock);
+	list_add_tail(&job->mrj_linkage, &restriper->mdr_jobs);
+	spin_unlock(&restriper->mdr_lock);
 
-	EXIT;
-out:
-	if (rc) {
-		/* -EBUSY: file is opened by others */
-		if (rc != -EBUSY)
-			CERROR("%s: migrate "DFID"/"DNAME" failed: rc = %d\n",
-			       mdt_obd_name(mdt), PFID(&fid1), PNAME(lname),
-			       rc);
+	wake_up_all(&restriper->mdr_waitq);
 
-		spin_lock(&mdt->mdt_lock);
-		stripe->mot_restriping = 0;
-		list_del_init(&stripe->mot_restripe_linkage);
-		spin_unlock(&mdt->mdt_lock);
+	CDEBUG(D_INFO, "%s: migrate sub files of "DFID"\n",
+	       mdt_obd_name(mdt), PFID(mdt_object_fid(stripe)));
 
-		mdt_object_put(env, stripe);
-	}
+	RETURN(0);
+out:
+	CERROR("%s: migrate sub files of "DFID" failed: rc = %d\n",
+	       mdt_obd_name(mdt), PFID(mdt_object_fid(stripe)), rc);
+	mdt_restripe_migrate_put(env, mdt, stripe);
 
 	return rc;
 }
@@ -856,7 +1200,7 @@ static int mdt_restriper_main(void *arg)
 			cond_resched();
 		} else if (!list_empty(&restriper->mdr_migrating)) {
 			__set_current_state(TASK_RUNNING);
-			mdt_restripe_migrate(info);
+			mdt_restripe_migrate_queue(info);
 			cond_resched();
 		} else {
 			schedule();
@@ -872,62 +1216,29 @@ int mdt_restriper_start(struct mdt_device *mdt)
 	struct mdt_dir_restriper *restriper = &mdt->mdt_restriper;
 	struct task_struct *task;
 	struct mdt_thread_info *info;
-	struct lu_ucred *uc;
 	int rc;
 
 	ENTRY;
 
 	spin_lock_init(&restriper->mdr_lock);
+	init_waitqueue_head(&restriper->mdr_waitq);
 	INIT_LIST_HEAD(&restriper->mdr_auto_splitting);
 	INIT_LIST_HEAD(&restriper->mdr_migrating);
 	INIT_LIST_HEAD(&restriper->mdr_updating);
+	INIT_LIST_HEAD(&restriper->mdr_jobs);
+	atomic64_set(&restriper->mdr_migrated, 0);
+	atomic64_set(&restriper->mdr_migrate_failed, 0);
+	atomic64_set(&restriper->mdr_throttled, 0);
 	restriper->mdr_dir_split_count = DIR_SPLIT_COUNT_DEFAULT;
 	restriper->mdr_dir_split_delta = DIR_SPLIT_DELTA_DEFAULT;
+	restriper->mdr_threads = DIR_RESTRIPE_THREADS_DEFAULT;
+	restriper->mdr_load_usec = DIR_RESTRIPE_LOAD_USEC_DEFAULT;
+	restriper->mdr_nr_workers = 0;
 
-	restriper->mdr_page = alloc_page(GFP_KERNEL);
-	if (!restriper->mdr_page)
-		RETURN(-ENOMEM);
-
-	rc = lu_env_init(&restriper->mdr_env, LCT_MD_THREAD);
-	if (rc)
-		GOTO(out_page, rc);
-
-	rc = lu_context_init(&restriper->mdr_session, LCT_SERVER_SESSION);
-	if (rc)
-		GOTO(out_env, rc);
-
-	lu_context_enter(&restriper->mdr_session);
-	restriper->mdr_env.le_ses = &restriper->mdr_session;
-
-	info = lu_context_key_get(&restriper->mdr_env.le_ctx, &mdt_thread_key);
-	info->mti_env = &restriper->mdr_env;
-	info->mti_mdt = mdt;
-	info->mti_pill = NULL;
-	info->mti_dlm_req = NULL;
-
-	uc = mdt_ucred(info);
-	uc->uc_valid = UCRED_OLD;
-	uc->uc_o_uid = 0;
-	uc->uc_o_gid = 0;
-	uc->uc_o_fsuid = 0;
-	uc->uc_o_fsgid = 0;
-	uc->uc_uid = 0;
-	uc->uc_gid = 0;
-	uc->uc_fsuid = 0;
-	uc->uc_fsgid = 0;
-	uc->uc_suppgids[0] = -1;
-	uc->uc_suppgids[1] = -1;
-	uc->uc_cap = cap_combine(CAP_FS_SET, CAP_NFSD_SET);
-	uc->uc_umask = 0644;
-	uc->uc_ginfo = NULL;
-	uc->uc_identity = NULL;
-	/* do not let rbac interfere with restriper internal processing */
-	uc->uc_rbac_file_perms = 1;
-	uc->uc_rbac_dne_ops = 1;
-	uc->uc_rbac_quota_ops = 1;
-	uc->uc_rbac_byfid_ops = 1;
-	uc->uc_rbac_chlg_ops = 1;
-	uc->uc_rbac_fscrypt_admin = 1;
+	info = mdt_thread_env_init(mdt, &restriper->mdr_env,
+				   &restriper->mdr_session);
+	if (IS_ERR(info))
+		RETURN(PTR_ERR(info));
 
 	task = kthread_create(mdt_restriper_main, info, "mdt_restriper_%03d",
 			      mdt_seq_site(mdt)->ss_node_id);
@@ -935,28 +1246,21 @@ int mdt_restriper_start(struct mdt_device *mdt)
 		rc = PTR_ERR(task);
 		CERROR("%s: Can't start directory restripe thread: rc %d\n",
 		       mdt_obd_name(mdt), rc);
-		GOTO(out_ses, rc);
+		mdt_thread_env_fini(&restriper->mdr_env);
+		RETURN(rc);
 	}
 	restriper->mdr_task = task;
 	wake_up_process(task);
 
 	RETURN(0);
-
-out_ses:
-	lu_context_exit(restriper->mdr_env.le_ses);
-	lu_context_fini(restriper->mdr_env.le_ses);
-out_env:
-	lu_env_fini(&restriper->mdr_env);
-out_page:
-	__free_page(restriper->mdr_page);
-
-	return rc;
 }
 
 void mdt_restriper_stop(struct mdt_device *mdt)
 {
 	struct mdt_dir_restriper *restriper = &mdt->mdt_restriper;
 	struct lu_env *env = &restriper->mdr_env;
+	struct mdt_thread_info *info;
+	struct mdt_restripe_job *job, *tmp;
 	struct mdt_object *mo, *next;
 
 	if (!restriper->mdr_task)
@@ -965,6 +1269,19 @@ void mdt_restriper_stop(struct mdt_device *mdt)
 	kthread_stop(restriper->mdr_task);
 	restriper->mdr_task = NULL;
 
+	mdt_restripe_workers_stop(mdt);
+
+	/* jobs left are not finished, their stripes will be migrated again
+	 * when accessed after restart.
+	 */
+	info = lu_context_key_get(&env->le_ctx, &mdt_thread_key);
+	list_for_each_entry_safe(job, tmp, &restriper->mdr_jobs, mrj_linkage) {
+		list_del_init(&job->mrj_linkage);
+		if (!job->mrj_rc)
+			job->mrj_rc = -ESHUTDOWN;
+		mdt_restripe_job_put(info, job);
+	}
+
 	list_for_each_entry_safe(mo, next, &restriper->mdr_auto_splitting,
 				 mot_restripe_linkage) {
 		list_del_init(&mo->mot_restripe_linkage);
@@ -983,9 +1300,5 @@ void mdt_restriper_stop(struct mdt_device *mdt)
 		mdt_object_put(env, mo);
 	}
 
-	__free_page(restriper->mdr_page);
-
-	lu_context_exit(env->le_ses);
-	lu_context_fini(env->le_ses);
-	lu_env_fini(env);
+	mdt_thread_env_fini(env);
 }
@@ -317,3 +317,277 @@ int mdt_lsom_update(struct mdt_thread_info *info,
 
 	RETURN(rc);
 }
+
+/**
+ * Queue a file for LSOM refresh after it is closed with data modified.
+ *
+ * The file is refreshed mlr_delay seconds after its last close, a file
+ * already in the queue is moved to the tail.
+ */
+void mdt_lsom_refresh_queue(struct mdt_thread_info *info,
+			    struct mdt_object *o)
+{
+	struct mdt_device *mdt = info->mti_mdt;
+	struct mdt_lsom_refresher *refresher = &mdt->mdt_lsom_refresher;
+
+	if (!mdt->mdt_enable_lsom_refresh)
+		return;
+
+	spin_lock(&refresher->mlr_lock);
+	if (!refresher->mlr_task) {
+		spin_unlock(&refresher->mlr_lock);
+		return;
+	}
+
+	o->mot_lsom_queued = ktime_get_seconds();
+	if (!list_empty(&o->mot_lsom_linkage)) {
+		list_move_tail(&o->mot_lsom_linkage, &refresher->mlr_queue);
+	} else if (refresher->mlr_queued >= MDT_LSOM_REFRESH_QUEUE_MAX) {
+		atomic64_inc(&refresher->mlr_dropped);
+	} else {
+		mdt_object_get(info->mti_env, o);
+		list_add_tail(&o->mot_lsom_linkage, &refresher->mlr_queue);
+		if (++refresher->mlr_queued == 1)
+			wake_up_process(refresher->mlr_task);
+	}
+	spin_unlock(&refresher->mlr_lock);
+}
+
+/* return true if mlr_rate files are refreshed in current second */
+static bool mdt_lsom_refresh_throttle(struct mdt_lsom_refresher *refresher,
+				      time64_t now)
+{
+	unsigned int rate = READ_ONCE(refresher->mlr_rate);
+
+	if (!rate)
+		return false;
+
+	if (refresher->mlr_window != now) {
+		refresher->mlr_window = now;
+		refresher->mlr_window_count = 0;
+	}
+
+	if (refresher->mlr_window_count >= rate)
+		return true;
+
+	refresher->mlr_window_count++;
+	return false;
+}
+
+/**
+ * Refresh LSOM of a file from the attributes of its OST objects.
+ *
+ * Unlike mdt_lsom_update() which only grows LSOM with the size and blocks
+ * sent by clients on close, LSOM is set to what OSTs have now, so it is
+ * corrected after truncate, and after writes by clients that don't send
+ * size on close. The result is still lazy: the file may be written again
+ * just after OST attributes are fetched, and its next close will queue it
+ * again.
+ */
+static int mdt_lsom_refresh_one(struct mdt_thread_info *info,
+				struct mdt_object *o)
+{
+	struct mdt_lsom_refresher *refresher =
+		&info->mti_mdt->mdt_lsom_refresher;
+	struct md_attr *ma = &info->mti_attr;
+	struct lu_buf *buf = &info->mti_buf;
+	struct lustre_som_attrs *som;
+	struct md_som *ms = &ma->ma_som;
+	__u64 size;
+	__u64 blocks;
+	bool busy;
+	int rc;
+
+	ENTRY;
+
+	if (!mdt_object_exists(o) || mdt_object_remote(o))
+		GOTO(skip, rc = 0);
+
+	/* opened for write again, its next close will queue it again */
+	spin_lock(&o->mot_write_lock);
+	busy = o->mot_write_count > 0;
+	spin_unlock(&o->mot_write_lock);
+	if (busy)
+		GOTO(skip, rc = 0);
+
+	som = (struct lustre_som_attrs *)info->mti_xattr_buf;
+	BUILD_BUG_ON(sizeof(info->mti_xattr_buf) < sizeof(*som));
+	buf->lb_buf = som;
+	buf->lb_len = sizeof(*som);
+	rc = mo_xattr_get(info->mti_env, mdt_object_child(o), buf,
+			  XATTR_NAME_SOM_OST);
+	/* no OST object, or file is removed */
+	if (rc == -ENODATA || rc == -ENOENT)
+		GOTO(skip, rc = 0);
+	if (rc < 0)
+		GOTO(failed, rc);
+	if (rc != sizeof(*som))
+		GOTO(failed, rc = -EPROTO);
+
+	lustre_som_swab(som);
+	size = som->lsa_size;
+	blocks = som->lsa_blocks;
+
+	mutex_lock(&o->mot_som_mutex);
+	ma->ma_need = MA_INODE | MA_SOM;
+	ma->ma_valid = 0;
+	rc = mdt_attr_get_complex(info, o, ma);
+	if (rc)
+		GOTO(unlock, rc);
+
+	if (ma->ma_attr.la_nlink == 0 ||
+	    (ma->ma_valid & MA_SOM && ms->ms_valid & SOM_FL_STRICT)) {
+		mutex_unlock(&o->mot_som_mutex);
+		GOTO(skip, rc = 0);
+	}
+
+	if (ma->ma_valid & MA_SOM && ms->ms_valid & SOM_FL_LAZY &&
+	    ms->ms_size == size && ms->ms_blocks == blocks) {
+		mutex_unlock(&o->mot_som_mutex);
+		atomic64_inc(&refresher->mlr_unchanged);
+		RETURN(0);
+	}
+
+	rc = mdt_set_som(info, o, SOM_FL_LAZY, size, blocks);
+unlock:
+	mutex_unlock(&o->mot_som_mutex);
+	if (rc)
+		GOTO(failed, rc);
+
+	atomic64_inc(&refresher->mlr_refreshed);
+	RETURN(0);
+
+skip:
+	atomic64_inc(&refresher->mlr_skipped);
+	RETURN(rc);
+
+failed:
+	atomic64_inc(&refresher->mlr_failed);
+	CDEBUG(D_INODE, "%s: refresh LSOM of "DFID" failed: rc = %d\n",
+	       mdt_obd_name(info->mti_mdt), PFID(mdt_object_fid(o)), rc);
+	RETURN(rc);
+}
+
+static int mdt_lsom_refresher_main(void *arg)
+{
+	struct mdt_thread_info *info = arg;
+	struct mdt_lsom_refresher *refresher =
+		&info->mti_mdt->mdt_lsom_refresher;
+	struct mdt_object *o;
+	time64_t due;
+	time64_t now;
+	long timeout;
+
+	ENTRY;
+
+	while (({set_current_state(TASK_IDLE);
+		 !kthread_should_stop(); })) {
+		timeout = MAX_SCHEDULE_TIMEOUT;
+		now = ktime_get_seconds();
+		o = NULL;
+
+		spin_lock(&refresher->mlr_lock);
+		if (!list_empty(&refresher->mlr_queue)) {
+			o = list_first_entry(&refresher->mlr_queue,
+					     struct mdt_object,
+					     mot_lsom_linkage);
+			due = o->mot_lsom_queued +
+			      READ_ONCE(refresher->mlr_delay);
+			if (due > now) {
+				timeout = cfs_time_seconds(due - now);
+				o = NULL;
+			} else if (mdt_lsom_refresh_throttle(refresher, now)) {
+				timeout = cfs_time_seconds(1);
+				o = NULL;
+			} else {
+				list_del_init(&o->mot_lsom_linkage);
+				refresher->mlr_queued--;
+			}
+		}
+		spin_unlock(&refresher->mlr_lock);
+
+		if (!o) {
+			schedule_timeout(timeout);
+			continue;
+		}
+
+		__set_current_state(TASK_RUNNING);
+		mdt_lsom_refresh_one(info, o);
+		mdt_object_put(info->mti_env, o);
+		cond_resched();
+	}
+	__set_current_state(TASK_RUNNING);
+
+	RETURN(0);
+}
+
+int mdt_lsom_refresher_start(struct mdt_device *mdt)
+{
+	struct mdt_lsom_refresher *refresher = &mdt->mdt_lsom_refresher;
+	struct mdt_thread_info *info;
+	struct task_struct *task;
+	int rc;
+
+	ENTRY;
+
+	spin_lock_init(&refresher->mlr_lock);
+	INIT_LIST_HEAD(&refresher->mlr_queue);
+	refresher->mlr_queued = 0;
+	refresher->mlr_rate = MDT_LSOM_REFRESH_RATE_DEFAULT;
+	refresher->mlr_delay = MDT_LSOM_REFRESH_DELAY_DEFAULT;
+	refresher->mlr_window = 0;
+	refresher->mlr_window_count = 0;
+	atomic64_set(&refresher->mlr_refreshed, 0);
+	atomic64_set(&refresher->mlr_unchanged, 0);
+	atomic64_set(&refresher->mlr_skipped, 0);
+	atomic64_set(&refresher->mlr_failed, 0);
+	atomic64_set(&refresher->mlr_dropped, 0);
+
+	info = mdt_thread_env_init(mdt, &refresher->mlr_env,
+				   &refresher->mlr_session);
+	if (IS_ERR(info))
+		RETURN(PTR_ERR(info));
+
+	task = kthread_create(mdt_lsom_refresher_main, info, "mdt_lsom_%03d",
+			      mdt_seq_site(mdt)->ss_node_id);
+	if (IS_ERR(task)) {
+		rc = PTR_ERR(task);
+		CERROR("%s: Can't start LSOM refresh thread: rc %d\n",
+		       mdt_obd_name(mdt), rc);
+		mdt_thread_env_fini(&refresher->mlr_env);
+		RETURN(rc);
+	}
+	refresher->mlr_task = task;
+	wake_up_process(task);
+
+	RETURN(0);
+}
+
+void mdt_lsom_refresher_stop(struct mdt_device *mdt)
+{
+	struct mdt_lsom_refresher *refresher = &mdt->mdt_lsom_refresher;
+	struct lu_env *env = &refresher->mlr_env;
+	struct task_struct *task;
+	struct mdt_object *mo, *next;
+
+	if (!refresher->mlr_task)
+		return;
+
+	/* stop queueing from close */
+	spin_lock(&refresher->mlr_lock);
+	task = refresher->mlr_task;
+	refresher->mlr_task = NULL;
+	spin_unlock(&refresher->mlr_lock);
+
+	kthread_stop(task);
+
+	/* files left are not refreshed, LSOM is still what close set */
+	list_for_each_entry_safe(mo, next, &refresher->mlr_queue,
+				 mot_lsom_linkage) {
+		list_del_init(&mo->mot_lsom_linkage);
+		mdt_object_put(env, mo);
+	}
+	refresher->mlr_queued = 0;
+
+	mdt_thread_env_fini(env);
+}
@@ -73,9 +73,15 @@ static int mdt_getxattr_pack_reply(struct mdt_thread_info *info)
 		    !strncmp(xattr_name, user_string, sizeof(user_string) - 1))
 			RETURN(-EOPNOTSUPP);
 
-		size = mo_xattr_get(info->mti_env,
-				    mdt_object_child(info->mti_object),
-				    &LU_BUF_NULL, xattr_name);
+		/* XATTR_NAME_SOM_OST is a virtual xattr to refresh SOM from
+		 * the OST objects, it is used by the MDT only.
+		 */
+		if (strcmp(xattr_name, XATTR_NAME_SOM_OST) == 0)
+			size = -ENODATA;
+		else
+			size = mo_xattr_get(info->mti_env,
+					    mdt_object_child(info->mti_object),
+					    &LU_BUF_NULL, xattr_name);
 		if (size == -ENODATA) {
 			/* XXX: Some client code will not handle -ENODATA
 			 * for XATTR_NAME_LOV (trusted.lov) properly.
@@ -135,6 +135,7 @@ int lu_qos_add_tgt(struct lu_qos *qos, struct lu_tgt_desc *tgt)
 
 	svr->lsq_tgt_count++;
 	tgt->ltd_qos.ltq_svr = svr;
+	tgt->ltd_qos.ltq_load_scale = QOS_LOAD_SCALE_MAX;
 
 	CDEBUG(D_OTHER, "add tgt %s to server %s (%d targets)\n",
 	       obd_uuid2str(&tgt->ltd_uuid), obd_uuid2str(&svr->lsq_uuid),
@@ -212,7 +213,8 @@ EXPORT_SYMBOL(lu_qos_del_tgt);
  *
  * The final tgt weight uses only free space for OSTs, but combines
  * both free space and inodes for MDTs, minus tgt and server penalties.
- * See ltd_qos_penalties_calc() for how penalties are calculated.
+ * See ltd_qos_penalties_calc() for how penalties are calculated. The
+ * result is scaled down for loaded tgts, see ltd_qos_load_update().
  *
  * \param[in] tgt	target descriptor
  * \param[in] is_mdt	target table is for MDT selection (use inodes)
@@ -234,9 +236,66 @@ void lu_tgt_qos_weight_calc(struct lu_tgt_desc *tgt, bool is_mdt)
 		ltq->ltq_weight = 0;
 	else
 		ltq->ltq_weight = ltq->ltq_avail - penalty;
+	if (ltq->ltq_load_scale < QOS_LOAD_SCALE_MAX)
+		ltq->ltq_weight = ltq->ltq_weight / QOS_LOAD_SCALE_MAX *
+				  ltq->ltq_load_scale;
 }
 EXPORT_SYMBOL(lu_tgt_qos_weight_calc);
 
+/**
+ * Calculate the load scale of all tgts.
+ *
+ * The load of a tgt is the recent service time reported in statfs,
+ * multiplied by the number of requests it is handling, see
+ * tgt_statfs_load(). A tgt loaded above
+ * the average of all active tgts gets its weight scaled down by
+ * avg / (avg + prio * (load - avg)), so with lq_prio_load at 100% the weight
+ * is inversely proportional to the relative load, and with 0% the load is
+ * ignored. Tgts at or below the average keep their full weight.
+ *
+ * Should be called once the statfs data of the tgts were refreshed, with
+ * the statfs data stable and ltq_load_scale updates serialized by the caller.
+ *
+ * \param[in] ltd		lu_tgt_descs
+ */
+void ltd_qos_load_update(struct lu_tgt_descs *ltd)
+{
+	struct lu_qos *qos = &ltd->ltd_qos;
+	struct lu_tgt_desc *tgt;
+	unsigned int prio = qos->lq_prio_load;
+	u64 sum = 0;
+	u64 avg;
+	u64 load;
+	u32 count = 0;
+
+	ltd_foreach_tgt(ltd, tgt) {
+		if (!tgt->ltd_active)
+			continue;
+		sum += tgt_statfs_load(tgt);
+		count++;
+	}
+	avg = count ? div_u64(sum, count) : 0;
+
+	ltd_foreach_tgt(ltd, tgt) {
+		struct lu_tgt_qos *ltq = &tgt->ltd_qos;
+		u32 scale = QOS_LOAD_SCALE_MAX;
+
+		load = tgt_statfs_load(tgt);
+		if (prio && avg && load > avg) {
+			u64 excess = div_u64((load - avg) * prio, 256);
+
+			scale = div64_u64(avg * QOS_LOAD_SCALE_MAX,
+					  avg + excess);
+			scale = max_t(u32, scale, 1);
+		}
+		if (ltq->ltq_load_scale != scale)
+			CDEBUG(D_OTHER, "tgt %d load %llu avg %llu scale %u\n",
+			       tgt->ltd_index, load, avg, scale);
+		ltq->ltq_load_scale = scale;
+	}
+}
+EXPORT_SYMBOL(ltd_qos_load_update);
+
 /**
  * Allocate and initialize target table.
  *
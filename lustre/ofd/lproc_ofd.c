@@ -991,6 +991,10 @@ void ofd_stats_counter_init(struct lprocfs_stats *stats, unsigned int offset,
 			     LPROCFS_TYPE_LATENCY & (~cntr_umask), "quotactl");
 	lprocfs_counter_init(stats, LPROC_OFD_STATS_PREALLOC,
 			     LPROCFS_TYPE_LATENCY & (~cntr_umask), "prealloc");
+	lprocfs_counter_init(stats, LPROC_OFD_STATS_CACHE_HIT,
+			     LPROCFS_TYPE_PAGES & (~cntr_umask), "cache_hit");
+	lprocfs_counter_init(stats, LPROC_OFD_STATS_CACHE_MISS,
+			     LPROCFS_TYPE_PAGES & (~cntr_umask), "cache_miss");
 }
 
 LPROC_SEQ_FOPS(lprocfs_nid_stats_clear);
@@ -1339,6 +1339,120 @@ out:
 	return rc;
 }
 
+/**
+ * OFD request handler for OST_SETATTR_BATCH RPC.
+ *
+ * It changes the ownership and the layout version of the data objects after
+ * the files are changed on the MDT, the objects and their new attributes are
+ * listed in the request and they all are changed in one transaction.
+ *
+ * \param[in] tsi	target session environment for this request
+ *
+ * \retval		0 if successful
+ * \retval		-ENOENT if some objects don't exist, the others are
+ *			changed
+ * \retval		negative value on other error
+ */
+static int ofd_setattr_batch_hdl(struct tgt_session_info *tsi)
+{
+	const struct lu_env *env = tsi->tsi_env;
+	struct ofd_thread_info *fti = tsi2ofd_info(tsi);
+	struct req_capsule *pill = tsi->tsi_pill;
+	struct ofd_device *ofd = ofd_exp(tsi->tsi_exp);
+	ktime_t kstart = ktime_get();
+	struct ofd_object **fos;
+	struct ost_body *bodies;
+	struct ost_body *repbody;
+	struct ldlm_resource *res;
+	struct lu_attr *las;
+	int count;
+	int rc = 0;
+	int rc2;
+	int i;
+
+	ENTRY;
+
+	bodies = req_capsule_client_get(pill, &RMF_OST_BODIES);
+	count = req_capsule_get_size(pill, &RMF_OST_BODIES, RCL_CLIENT) /
+		sizeof(*bodies);
+	if (bodies == NULL || count == 0 || count > OFD_SYNC_BATCH_MAX)
+		RETURN(-EPROTO);
+
+	repbody = req_capsule_server_get(pill, &RMF_OST_BODY);
+	if (repbody == NULL)
+		RETURN(-ENOMEM);
+
+	repbody->oa.o_oi = tsi->tsi_ost_body->oa.o_oi;
+	repbody->oa.o_valid = OBD_MD_FLID | OBD_MD_FLGROUP;
+
+	OBD_ALLOC_PTR_ARRAY_LARGE(fos, count);
+	if (fos == NULL)
+		RETURN(-ENOMEM);
+
+	OBD_ALLOC_PTR_ARRAY_LARGE(las, count);
+	if (las == NULL)
+		GOTO(out_free, rc = -ENOMEM);
+
+	for (i = 0; i < count; i++) {
+		struct obdo *oa = &bodies[i].oa;
+
+		/* only the ownership and the layout version are batched */
+		if (oa->o_valid & ~(OBD_MD_FLID | OBD_MD_FLGROUP |
+				    OBD_MD_FLUID | OBD_MD_FLGID |
+				    OBD_MD_FLPROJID | OBD_MD_LAYOUT_VERSION))
+			GOTO(out_put, rc = -EPROTO);
+
+		rc2 = tgt_validate_obdo(tsi, oa);
+		if (rc2 != 0)
+			GOTO(out_put, rc = rc2);
+
+		fos[i] = ofd_object_find_exists(env, ofd, &oa->o_oi.oi_fid);
+		if (IS_ERR(fos[i])) {
+			rc2 = PTR_ERR(fos[i]);
+			fos[i] = NULL;
+			if (rc2 != -ENOENT)
+				GOTO(out_put, rc = rc2);
+
+			rc = -ENOENT;
+			continue;
+		}
+
+		la_from_obdo(&las[i], oa, oa->o_valid);
+		las[i].la_valid &= ~LA_TYPE;
+	}
+
+	rc2 = ofd_attr_set_batch(env, ofd, fos, las, bodies, count);
+	if (rc2 != 0)
+		rc = rc2;
+
+	ofd_counter_incr(tsi->tsi_exp, LPROC_OFD_STATS_SETATTR,
+			 tsi->tsi_jobid, ktime_us_delta(ktime_get(), kstart));
+	EXIT;
+out_put:
+	for (i = 0; i < count; i++) {
+		if (fos[i] != NULL)
+			ofd_object_put(env, fos[i]);
+	}
+
+	/* see ofd_setattr_hdl() for why it's done after the objects put */
+	for (i = 0; (rc == 0 || rc == -ENOENT) && i < count; i++) {
+		if (fos[i] == NULL)
+			continue;
+
+		ost_fid_build_resid(&bodies[i].oa.o_oi.oi_fid, &fti->fti_resid);
+		res = ldlm_resource_get(ofd->ofd_namespace, &fti->fti_resid,
+					LDLM_EXTENT, 0);
+		if (!IS_ERR(res)) {
+			ldlm_res_lvbo_update(res, NULL, 0);
+			ldlm_resource_putref(res);
+		}
+	}
+	OBD_FREE_PTR_ARRAY_LARGE(las, count);
+out_free:
+	OBD_FREE_PTR_ARRAY_LARGE(fos, count);
+	return rc;
+}
+
 /**
  * Destroy OST orphans.
  *
@@ -1806,6 +1920,83 @@ out:
 	return rc;
 }
 
+/**
+ * OFD request handler for OST_DESTROY_BATCH RPC.
+ *
+ * It destroys the data objects of the files unlinked on the MDT, the objects
+ * are listed in the request and they all are destroyed in one transaction.
+ *
+ * \param[in] tsi	target session environment for this request
+ *
+ * \retval		0 if successful
+ * \retval		-ENOENT if some objects don't exist, the others are
+ *			destroyed
+ * \retval		negative value on other error
+ */
+static int ofd_destroy_batch_hdl(struct tgt_session_info *tsi)
+{
+	struct req_capsule *pill = tsi->tsi_pill;
+	struct ofd_device *ofd = ofd_exp(tsi->tsi_exp);
+	ktime_t kstart = ktime_get();
+	struct ost_body *repbody;
+	struct lu_fid *fids;
+	struct ost_id *ids;
+	int count;
+	int rc = 0;
+	int i;
+
+	ENTRY;
+
+	if (CFS_FAIL_CHECK(OBD_FAIL_OST_EROFS))
+		RETURN(-EROFS);
+
+	ids = req_capsule_client_get(pill, &RMF_OST_IDS);
+	count = req_capsule_get_size(pill, &RMF_OST_IDS, RCL_CLIENT) /
+		sizeof(*ids);
+	if (ids == NULL || count == 0 || count > OFD_SYNC_BATCH_MAX)
+		RETURN(-EPROTO);
+
+	repbody = req_capsule_server_get(pill, &RMF_OST_BODY);
+	if (repbody == NULL)
+		RETURN(-ENOMEM);
+
+	repbody->oa.o_oi = tsi->tsi_ost_body->oa.o_oi;
+	repbody->oa.o_valid = OBD_MD_FLID | OBD_MD_FLGROUP;
+
+	OBD_ALLOC_PTR_ARRAY_LARGE(fids, count);
+	if (fids == NULL)
+		RETURN(-ENOMEM);
+
+	for (i = 0; i < count; i++) {
+		u64 seq = ostid_seq(&ids[i]);
+
+		if (ostid_id(&ids[i]) == 0 ||
+		    !(fid_seq_is_idif(seq) || fid_seq_is_mdt0(seq) ||
+		      fid_seq_is_norm(seq)))
+			GOTO(out, rc = -EPROTO);
+
+		rc = ostid_to_fid(&fids[i], &ids[i],
+				  ofd->ofd_lut.lut_lsd.lsd_osd_index);
+		if (rc != 0)
+			GOTO(out, rc);
+	}
+
+	CDEBUG(D_HA, "%s: Destroy %d objects from "DOSTID"\n", ofd_name(ofd),
+	       count, POSTID(&ids[0]));
+
+	rc = ofd_destroy_by_fids(tsi->tsi_env, ofd, fids, count);
+	if (rc != 0 && rc != -ENOENT)
+		CERROR("%s: error destroying %d objects from "DOSTID": rc = %d\n",
+		       ofd_name(ofd), count, POSTID(&ids[0]), rc);
+
+	ofd_counter_incr(tsi->tsi_exp, LPROC_OFD_STATS_DESTROY,
+			 tsi->tsi_jobid, ktime_us_delta(ktime_get(), kstart));
+	EXIT;
+out:
+	OBD_FREE_PTR_ARRAY_LARGE(fids, count);
+	return rc;
+}
+
 /**
  * OFD request handler for OST_STATFS RPC.
  *
@@ -2841,6 +3032,10 @@ TGT_OST_HDL(HAS_REPLY,	OST_QUOTACTL,	ofd_quotactl),
 TGT_OST_HDL(HAS_BODY | HAS_REPLY, OST_LADVISE,	ofd_ladvise_hdl),
 TGT_OST_HDL(HAS_BODY | HAS_REPLY | IS_MUTABLE, OST_FALLOCATE, ofd_fallocate_hdl),
 TGT_OST_HDL(HAS_BODY | HAS_REPLY, OST_SEEK, tgt_lseek),
+TGT_OST_HDL(HAS_BODY | HAS_REPLY | IS_MUTABLE, OST_DESTROY_BATCH,
+	    ofd_destroy_batch_hdl),
+TGT_OST_HDL(HAS_BODY | HAS_REPLY | IS_MUTABLE, OST_SETATTR_BATCH,
+	    ofd_setattr_batch_hdl),
 };
 
 static struct tgt_opc_slice ofd_common_slice[] = {
@@ -52,6 +52,9 @@
 
 #define OFD_SOFT_SYNC_LIMIT_DEFAULT 16
 
+/* max number of objects changed by one OST_DESTROY_BATCH/OST_SETATTR_BATCH */
+#define OFD_SYNC_BATCH_MAX	1024
+
 /*
  * update atime if on-disk value older than client's one
  * by OFD_ATIME_DIFF or more
@@ -75,6 +78,8 @@ enum {
 	LPROC_OFD_STATS_SET_INFO,
 	LPROC_OFD_STATS_QUOTACTL,
 	LPROC_OFD_STATS_PREALLOC,
+	LPROC_OFD_STATS_CACHE_HIT,
+	LPROC_OFD_STATS_CACHE_MISS,
 	LPROC_OFD_STATS_LAST,
 };
 
@@ -311,6 +316,8 @@ int ofd_fiemap_get(const struct lu_env *env, struct ofd_device *ofd,
 extern const struct obd_ops ofd_obd_ops;
 int ofd_destroy_by_fid(const struct lu_env *env, struct ofd_device *ofd,
 		       const struct lu_fid *fid, int orphan);
+int ofd_destroy_by_fids(const struct lu_env *env, struct ofd_device *ofd,
+			const struct lu_fid *fids, int count);
 int ofd_statfs(const struct lu_env *env,  struct obd_export *exp,
 	       struct obd_statfs *osfs, time64_t max_age, __u32 flags);
 int ofd_obd_disconnect(struct obd_export *exp);
@@ -397,7 +404,12 @@ int ofd_object_punch(const struct lu_env *env, struct ofd_object *fo,
 int ofd_object_fallocate(const struct lu_env *env, struct ofd_object *fo,
 			 __u64 start, __u64 end, int mode, struct lu_attr *la,
 			 struct obdo *oa);
+int ofd_attr_set_batch(const struct lu_env *env, struct ofd_device *ofd,
+		       struct ofd_object **fos, struct lu_attr *las,
+		       const struct ost_body *bodies, int count);
 int ofd_destroy(const struct lu_env *, struct ofd_object *, int);
+int ofd_destroy_batch(const struct lu_env *env, struct ofd_device *ofd,
+		      struct ofd_object **fos, int count);
 int ofd_attr_get(const struct lu_env *env, struct ofd_object *fo,
 		 struct lu_attr *la);
 int ofd_attr_handle_id(const struct lu_env *env, struct ofd_object *fo,
@@ -1377,6 +1377,10 @@ out_stop:
 			granted = 0;
 	}
 
+	/* reply once the data is written rather than wait for it here */
+	if (rc == 0)
+		tgt_brw_async_cb_add(env, th);
+
 	rc2 = ofd_trans_stop(env, ofd, th, restart ? 0 : rc);
 	if (!rc)
 		rc = rc2;
@@ -1574,11 +1578,30 @@ int ofd_commitrw(const struct lu_env *env, int cmd, struct obd_export *exp,
 		oa->o_gid = mapped_gid;
 		oa->o_projid = mapped_projid;
 	} else if (cmd == OBD_BRW_READ) {
+		int hits = 0;
+		int misses = 0;
+		int i;
+
 		/* see comment on LPROC_OFD_STATS_WRITE_BYTES usage above */
 		ofd_counter_incr(exp, LPROC_OFD_STATS_READ_BYTES, jobid, nob);
 		ofd_counter_incr(exp, LPROC_OFD_STATS_READ, jobid,
 				 ktime_us_delta(ktime_get(), kstart));
 
+		for (i = 0; i < npages; i++) {
+			if (lnb[i].lnb_rc <= 0)
+				continue;
+			if (lnb[i].lnb_cached)
+				hits++;
+			else
+				misses++;
+		}
+		if (hits)
+			ofd_counter_incr(exp, LPROC_OFD_STATS_CACHE_HIT, jobid,
+					 hits);
+		if (misses)
+			ofd_counter_incr(exp, LPROC_OFD_STATS_CACHE_MISS,
+					 jobid, misses);
+
 		rc = ofd_commitrw_read(env, ofd, fid, objcount,
 				       npages, lnb);
 		if (old_rc)
@@ -737,13 +737,14 @@ int ofd_statfs(const struct lu_env *env,  struct obd_export *exp,
 	 */
 	CDEBUG(D_SUPER | D_CACHE,
 	       "blocks cached %llu granted %llu pending %llu free %llu avail %llu\n",
-	       tgd->tgd_tot_dirty, tgd->tgd_tot_granted,
-	       tgd->tgd_tot_pending,
+	       tgt_grant_tot_dirty(tgd), tgd->tgd_tot_granted,
+	       tgt_grant_tot_pending(tgd),
 	       osfs->os_bfree << current_blockbits,
 	       osfs->os_bavail << current_blockbits);
 
 	osfs->os_bavail -= min_t(u64, osfs->os_bavail,
-				 ((tgd->tgd_tot_dirty + tgd->tgd_tot_pending +
+				 ((tgt_grant_tot_dirty(tgd) +
+				   tgt_grant_tot_pending(tgd) +
 				   osfs->os_bsize - 1) >> current_blockbits));
 
 	/*
@@ -898,6 +899,38 @@ out:
 	return rc;
 }
 
+/**
+ * Discard the data of an object being destroyed from the client caches.
+ *
+ * \param[in] env	execution environment
+ * \param[in] ofd	OFD device
+ * \param[in] fid	FID of object
+ */
+static void ofd_destroy_discard_cache(const struct lu_env *env,
+				      struct ofd_device *ofd,
+				      const struct lu_fid *fid)
+{
+	struct ofd_thread_info *info = ofd_info(env);
+	struct lustre_handle lockh;
+	union ldlm_policy_data policy = { .l_extent = { 0, OBD_OBJECT_EOF } };
+	__u64 flags = LDLM_FL_AST_DISCARD_DATA;
+	int rc;
+
+	/*
+	 * Tell the clients that the object is gone now and that they should
+	 * throw away any cached pages.
+	 */
+	ost_fid_build_resid(fid, &info->fti_resid);
+	rc = ldlm_cli_enqueue_local(env, ofd->ofd_namespace, &info->fti_resid,
+				    LDLM_EXTENT, &policy, LCK_PW, &flags,
+				    ldlm_blocking_ast, ldlm_completion_ast,
+				    NULL, NULL, 0, LVB_T_NONE, NULL, &lockh);
+
+	/* We only care about the side-effects, just drop the lock. */
+	if (rc == ELDLM_OK)
+		ldlm_lock_decref(&lockh, LCK_PW);
+}
+
 /**
  * Destroy OFD object by its FID.
  *
@@ -916,11 +949,7 @@ out:
 int ofd_destroy_by_fid(const struct lu_env *env, struct ofd_device *ofd,
 		       const struct lu_fid *fid, int orphan)
 {
-	struct ofd_thread_info *info = ofd_info(env);
-	struct lustre_handle lockh;
-	union ldlm_policy_data policy = { .l_extent = { 0, OBD_OBJECT_EOF } };
 	struct ofd_object *fo;
-	__u64 flags = LDLM_FL_AST_DISCARD_DATA;
 	__u64 rc = 0;
 
 	ENTRY;
@@ -929,19 +958,7 @@ int ofd_destroy_by_fid(const struct lu_env *env, struct ofd_device *ofd,
 	if (IS_ERR(fo))
 		RETURN(PTR_ERR(fo));
 
-	/*
-	 * Tell the clients that the object is gone now and that they should
-	 * throw away any cached pages.
-	 */
-	ost_fid_build_resid(fid, &info->fti_resid);
-	rc = ldlm_cli_enqueue_local(env, ofd->ofd_namespace, &info->fti_resid,
-				    LDLM_EXTENT, &policy, LCK_PW, &flags,
-				    ldlm_blocking_ast, ldlm_completion_ast,
-				    NULL, NULL, 0, LVB_T_NONE, NULL, &lockh);
-
-	/* We only care about the side-effects, just drop the lock. */
-	if (rc == ELDLM_OK)
-		ldlm_lock_decref(&lockh, LCK_PW);
+	ofd_destroy_discard_cache(env, ofd, fid);
 
 	LASSERT(fo != NULL);
 
@@ -952,6 +969,69 @@ int ofd_destroy_by_fid(const struct lu_env *env, struct ofd_device *ofd,
 	RETURN(rc);
 }
 
+/**
+ * Destroy a batch of OFD objects by their FIDs.
+ *
+ * The cached data of all the objects is discarded from the clients first,
+ * then all of them are destroyed by ofd_destroy_batch() in one transaction.
+ *
+ * \param[in] env	execution environment
+ * \param[in] ofd	OFD device
+ * \param[in] fids	FIDs of the objects
+ * \param[in] count	number of FIDs in \a fids
+ *
+ * \retval		0 if successful
+ * \retval		-ENOENT if some objects don't exist, the others are
+ *			destroyed
+ * \retval		negative value on other error
+ */
+int ofd_destroy_by_fids(const struct lu_env *env, struct ofd_device *ofd,
+			const struct lu_fid *fids, int count)
+{
+	struct ofd_object **fos;
+	int nr = 0;
+	int rc = 0;
+	int rc2;
+	int i;
+
+	ENTRY;
+
+	OBD_ALLOC_PTR_ARRAY_LARGE(fos, count);
+	if (fos == NULL)
+		RETURN(-ENOMEM);
+
+	for (i = 0; i < count; i++) {
+		struct ofd_object *fo;
+
+		fo = ofd_object_find_exists(env, ofd, &fids[i]);
+		if (IS_ERR(fo)) {
+			if (PTR_ERR(fo) != -ENOENT)
+				GOTO(out, rc = PTR_ERR(fo));
+
+			CDEBUG(D_INODE,
+			       "%s: destroying non-existent object "DFID"\n",
+			       ofd_name(ofd), PFID(&fids[i]));
+			rc = -ENOENT;
+			continue;
+		}
+
+		ofd_destroy_discard_cache(env, ofd, &fids[i]);
+		fos[nr++] = fo;
+	}
+
+	if (nr > 0) {
+		rc2 = ofd_destroy_batch(env, ofd, fos, nr);
+		if (rc2 != 0)
+			rc = rc2;
+	}
+	EXIT;
+out:
+	for (i = 0; i < nr; i++)
+		ofd_object_put(env, fos[i]);
+	OBD_FREE_PTR_ARRAY_LARGE(fos, count);
+	return rc;
+}
+
 /**
  * Implementation of obd_ops::o_destroy.
  *
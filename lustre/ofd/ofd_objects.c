@@ -751,6 +751,122 @@ out:
 	return rc;
 }
 
+/**
+ * Set attributes of a batch of OFD objects in one transaction.
+ *
+ * This is used to apply the setattr records of the MDT llog received in one
+ * OST_SETATTR_BATCH RPC, those change only the ownership and the layout
+ * version of the objects. Objects destroyed meanwhile are skipped.
+ *
+ * \param[in] env	execution environment
+ * \param[in] ofd	OFD device
+ * \param[in] fos	OFD objects, NULL for the objects which don't exist
+ * \param[in] las	new attributes of each object
+ * \param[in] bodies	obdo of each object from the request
+ * \param[in] count	number of objects in \a fos
+ *
+ * \retval		0 if successful
+ * \retval		-ENOENT if some objects don't exist, the others are
+ *			updated
+ * \retval		negative value on other error
+ */
+int ofd_attr_set_batch(const struct lu_env *env, struct ofd_device *ofd,
+		       struct ofd_object **fos, struct lu_attr *las,
+		       const struct ost_body *bodies, int count)
+{
+	struct ofd_thread_info *info = ofd_info(env);
+	struct filter_fid *ff = &info->fti_mds_fid;
+	struct thandle *th;
+	int missing = 0;
+	int nr = 0;
+	int rc = 0;
+	int rc2;
+	int fl;
+	int i;
+
+	ENTRY;
+
+	for (i = 0; i < count; i++) {
+		if (fos[i] == NULL)
+			continue;
+
+		rc = ofd_attr_handle_id(env, fos[i], &las[i], 1);
+		if (rc != 0)
+			RETURN(rc);
+		nr++;
+	}
+
+	if (nr == 0)
+		RETURN(0);
+
+	th = ofd_trans_create(env, ofd);
+	if (IS_ERR(th))
+		RETURN(PTR_ERR(th));
+
+	info->fti_buf.lb_buf = ff;
+	info->fti_buf.lb_len = sizeof(*ff);
+	for (i = 0; i < count; i++) {
+		if (fos[i] == NULL)
+			continue;
+
+		rc = dt_declare_attr_set(env, ofd_object_child(fos[i]),
+					 &las[i], th);
+		if (rc)
+			GOTO(stop, rc);
+
+		rc = dt_declare_xattr_set(env, ofd_object_child(fos[i]),
+					  &info->fti_buf, XATTR_NAME_FID, 0,
+					  th);
+		if (rc)
+			GOTO(stop, rc);
+	}
+
+	rc = ofd_trans_start(env, ofd, NULL, th);
+	if (rc)
+		GOTO(stop, rc);
+
+	for (i = 0; i < count && rc == 0; i++) {
+		struct ofd_object *fo = fos[i];
+
+		if (fo == NULL)
+			continue;
+
+		ofd_write_lock(env, fo);
+		if (!ofd_object_exists(fo)) {
+			missing++;
+			ofd_write_unlock(env, fo);
+			continue;
+		}
+
+		rc = dt_attr_set(env, ofd_object_child(fo), &las[i], th);
+		fl = rc ? 0 : ofd_object_ff_update(env, fo, &bodies[i].oa, ff);
+		if (fl < 0) {
+			rc = fl;
+		} else if (fl > 0) {
+			info->fti_buf.lb_buf = ff;
+			info->fti_buf.lb_len = sizeof(*ff);
+			rc = dt_xattr_set(env, ofd_object_child(fo),
+					  &info->fti_buf, XATTR_NAME_FID, fl,
+					  th);
+			if (!rc)
+				filter_fid_le_to_cpu(&fo->ofo_ff, ff,
+						     sizeof(*ff));
+		}
+		ofd_write_unlock(env, fo);
+	}
+	EXIT;
+stop:
+	rc2 = ofd_trans_stop(env, ofd, th, rc);
+	if (rc2)
+		CERROR("%s: failed to stop transaction: rc = %d\n",
+		       ofd_name(ofd), rc2);
+	if (!rc)
+		rc = rc2;
+	if (!rc && missing > 0)
+		rc = -ENOENT;
+	return rc;
+}
+
 /**
  * Fallocate(Preallocate) space for OFD object.
  *
@@ -1072,6 +1188,79 @@ out:
 	RETURN(rc);
 }
 
+/**
+ * Destroy a batch of OFD objects in one transaction.
+ *
+ * This is used to apply the unlink records of the MDT llog received in one
+ * OST_DESTROY_BATCH RPC. Objects destroyed meanwhile are skipped.
+ *
+ * \param[in] env	execution environment
+ * \param[in] ofd	OFD device
+ * \param[in] fos	OFD objects to destroy
+ * \param[in] count	number of objects in \a fos
+ *
+ * \retval		0 if successful
+ * \retval		-ENOENT if some objects don't exist, the others are
+ *			destroyed
+ * \retval		negative value on other error
+ */
+int ofd_destroy_batch(const struct lu_env *env, struct ofd_device *ofd,
+		      struct ofd_object **fos, int count)
+{
+	struct thandle *th;
+	int missing = 0;
+	int rc = 0;
+	int rc2;
+	int i;
+
+	ENTRY;
+
+	th = ofd_trans_create(env, ofd);
+	if (IS_ERR(th))
+		RETURN(PTR_ERR(th));
+
+	for (i = 0; i < count; i++) {
+		rc = dt_declare_ref_del(env, ofd_object_child(fos[i]), th);
+		if (rc < 0)
+			GOTO(stop, rc);
+
+		rc = dt_declare_destroy(env, ofd_object_child(fos[i]), th);
+		if (rc < 0)
+			GOTO(stop, rc);
+	}
+
+	rc = ofd_trans_start(env, ofd, NULL, th);
+	if (rc)
+		GOTO(stop, rc);
+
+	for (i = 0; i < count && rc == 0; i++) {
+		struct ofd_object *fo = fos[i];
+
+		ofd_write_lock(env, fo);
+		if (ofd_object_exists(fo)) {
+			tgt_fmd_drop(ofd_info(env)->fti_exp,
+				     &fo->ofo_header.loh_fid);
+			rc = dt_ref_del(env, ofd_object_child(fo), th);
+			if (rc == 0)
+				rc = dt_destroy(env, ofd_object_child(fo), th);
+		} else {
+			missing++;
+		}
+		ofd_write_unlock(env, fo);
+	}
+	EXIT;
+stop:
+	rc2 = ofd_trans_stop(env, ofd, th, rc);
+	if (rc2)
+		CERROR("%s failed to stop transaction: %d\n",
+		       ofd_name(ofd), rc2);
+	if (!rc)
+		rc = rc2;
+	if (!rc && missing > 0)
+		rc = -ENOENT;
+	return rc;
+}
+
 /**
  * Get OFD object attributes.
  *
@@ -244,6 +244,54 @@ static ssize_t osc_cached_mb_seq_write(struct file *file,
 
 LPROC_SEQ_FOPS(osc_cached_mb);
 
+static ssize_t compr_cache_max_mb_show(struct kobject *kobj,
+				       struct attribute *attr, char *buf)
+{
+	struct obd_device *obd = container_of(kobj, struct obd_device,
+					      obd_kset.kobj);
+	struct osc_compr_cache *occ = obd->u.cli.cl_compr_cache;
+
+	return scnprintf(buf, PAGE_SIZE, "%lu\n",
+			 occ ? occ->occ_max_bytes >> 20 : 0);
+}
+
+static ssize_t compr_cache_max_mb_store(struct kobject *kobj,
+					struct attribute *attr,
+					const char *buffer, size_t count)
+{
+	struct obd_device *obd = container_of(kobj, struct obd_device,
+					      obd_kset.kobj);
+	unsigned long max_mb;
+	int rc;
+
+	rc = kstrtoul(buffer, 10, &max_mb);
+	if (rc)
+		return rc;
+
+	if (max_mb > (cfs_totalram_pages() >> (20 - PAGE_SHIFT)) / 4)
+		return -ERANGE;
+
+	rc = osc_compr_cache_set_max(&obd->u.cli, max_mb << 20);
+
+	return rc ?: count;
+}
+LUSTRE_RW_ATTR(compr_cache_max_mb);
+
+#ifdef HAVE_OSC_COMPR_CACHE
+static ssize_t osc_compr_cache_stats_seq_write(struct file *file,
+					       const char __user *buffer,
+					       size_t count, loff_t *off)
+{
+	struct seq_file *m = file->private_data;
+	struct obd_device *obd = m->private;
+
+	osc_compr_cache_stats_clear(&obd->u.cli);
+
+	return count;
+}
+LPROC_SEQ_FOPS(osc_compr_cache_stats);
+#endif
+
 static ssize_t cur_dirty_bytes_show(struct kobject *kobj,
 				    struct attribute *attr,
 				    char *buf)
@@ -701,6 +749,10 @@ struct lprocfs_vars lprocfs_osc_obd_vars[] = {
 	  .fops	=	&osc_pinger_recov_fops		},
 	{ .name	=	"unstable_stats",
 	  .fops	=	&osc_unstable_stats_fops	},
+#ifdef HAVE_OSC_COMPR_CACHE
+	{ .name	=	"compr_cache_stats",
+	  .fops	=	&osc_compr_cache_stats_fops	},
+#endif
 	{ NULL }
 };
 
@@ -871,6 +923,7 @@ static struct attribute *osc_attrs[] = {
 	&lustre_attr_active.attr,
 	&lustre_attr_checksums.attr,
 	&lustre_attr_checksum_dump.attr,
+	&lustre_attr_compr_cache_max_mb.attr,
 	&lustre_attr_cur_dirty_bytes.attr,
 	&lustre_attr_cur_lost_grant_bytes.attr,
 	&lustre_attr_cur_dirty_grant_bytes.attr,
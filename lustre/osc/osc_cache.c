@@ -2289,6 +2289,8 @@ int osc_queue_async_io(const struct lu_env *env, struct cl_io *io,
 	    !list_empty(&oap->oap_rpc_item))
 		RETURN(-EBUSY);
 
+	osc_compr_cache_invalidate(cli, osc, osc_index(ops), osc_index(ops));
+
 	/* Set the OBD_BRW_SRVLOCK before the page is queued. */
 	brw_flags |= ops->ops_srvlock ? OBD_BRW_SRVLOCK : 0;
 	if (io->ci_noquota) {
@@ -3281,6 +3283,11 @@ int osc_lock_discard_pages(const struct lu_env *env, struct osc_object *osc,
 
 	osc_page_gang_lookup(env, io, osc,
 			     info->oti_next_index, end, cb, osc);
+	/* Compressed pages are only valid under the lock being cancelled.
+	 * Drop them after the page cache, so that nothing evicted from the
+	 * LRU meanwhile is left behind.
+	 */
+	osc_compr_cache_invalidate(osc_cli(osc), osc, start, end);
 out:
 	cl_io_fini(env, io);
 	RETURN(result);
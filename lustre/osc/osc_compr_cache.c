@@ -0,0 +1,406 @@
+/*
+ * GPL HEADER START
+ *
+ * DO NOT ALTER OR REMOVE COPYRIGHT NOTICES OR THIS FILE HEADER.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 only,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License version 2 for more details (a copy is included
+ * in the LICENSE file that accompanied this code).
+ *
+ * You should have received a copy of the GNU General Public License
+ * version 2 along with this program; If not, see
+ * http://www.gnu.org/licenses/gpl-2.0.html
+ *
+ * GPL HEADER END
+ */
+/*
+ * This file is part of Lustre, http://www.lustre.org/
+ *
+ * Compressed second tier for clean pages evicted from the OSC LRU.
+ *
+ * When osc_lru_shrink() drops clean, uptodate pages, their content is LZ4
+ * compressed into a bounded per-OSC pool instead of being thrown away. A
+ * later read of the same page is served from the pool by osc_io_submit()
+ * without an OST_READ RPC. Entries hang off the osc_object in a radix tree
+ * indexed by page index, so they go away together with the object, and are
+ * dropped whenever the covering pages would be: on DLM lock cancellation
+ * (osc_lock_discard_pages()), truncate and when a page is dirtied again.
+ * An entry is consumed when it is decompressed, the page cache copy is then
+ * authoritative until it is evicted again.
+ */
+
+#define DEBUG_SUBSYSTEM S_OSC
+
+#include <linux/highmem.h>
+#include <lustre_osc.h>
+
+#include "osc_internal.h"
+
+#ifdef HAVE_OSC_COMPR_CACHE
+#include <linux/lz4.h>
+
+/* do not bother keeping pages which compress worse than this */
+#define OSC_COMPR_MAX_LEN	(PAGE_SIZE - (PAGE_SIZE >> 3))
+
+struct osc_compr_page {
+	struct list_head	 ocp_lru;
+	struct osc_object	*ocp_obj;
+	pgoff_t			 ocp_index;
+	unsigned int		 ocp_len;
+	char			 ocp_data[];
+};
+
+static inline unsigned int ocp_size(struct osc_compr_page *ocp)
+{
+	return offsetof(struct osc_compr_page, ocp_data[ocp->ocp_len]);
+}
+
+static void osc_compr_page_free(struct osc_compr_page *ocp)
+{
+	OBD_FREE(ocp, ocp_size(ocp));
+}
+
+/* caller must hold occ_lock */
+static void __osc_compr_page_del(struct osc_compr_cache *occ,
+				 struct osc_compr_page *ocp,
+				 struct list_head *freelist)
+{
+	assert_spin_locked(&occ->occ_lock);
+
+	radix_tree_delete(&ocp->ocp_obj->oo_compr_tree, ocp->ocp_index);
+	ocp->ocp_obj->oo_compr_npages--;
+	list_move(&ocp->ocp_lru, freelist);
+	occ->occ_bytes -= ocp_size(ocp);
+	occ->occ_npages--;
+}
+
+static void osc_compr_freelist(struct list_head *freelist)
+{
+	struct osc_compr_page *ocp;
+	struct osc_compr_page *tmp;
+
+	list_for_each_entry_safe(ocp, tmp, freelist, ocp_lru) {
+		list_del(&ocp->ocp_lru);
+		osc_compr_page_free(ocp);
+	}
+}
+
+/* caller must hold occ_lock */
+static void osc_compr_cache_trim(struct osc_compr_cache *occ,
+				 unsigned long target,
+				 struct list_head *freelist)
+{
+	struct osc_compr_page *ocp;
+
+	while (occ->occ_bytes > target && !list_empty(&occ->occ_lru)) {
+		ocp = list_first_entry(&occ->occ_lru, struct osc_compr_page,
+				       ocp_lru);
+		__osc_compr_page_del(occ, ocp, freelist);
+		occ->occ_evictions++;
+	}
+}
+
+int osc_compr_cache_setup(struct client_obd *cli)
+{
+	struct osc_compr_cache *occ;
+
+	OBD_ALLOC_PTR(occ);
+	if (!occ)
+		return -ENOMEM;
+
+	spin_lock_init(&occ->occ_lock);
+	INIT_LIST_HEAD(&occ->occ_lru);
+	mutex_init(&occ->occ_wrk_mutex);
+	occ->occ_init = ktime_get_real();
+	cli->cl_compr_cache = occ;
+
+	return 0;
+}
+
+void osc_compr_cache_cleanup(struct client_obd *cli)
+{
+	struct osc_compr_cache *occ = cli->cl_compr_cache;
+	LIST_HEAD(freelist);
+
+	if (!occ)
+		return;
+
+	spin_lock(&occ->occ_lock);
+	osc_compr_cache_trim(occ, 0, &freelist);
+	spin_unlock(&occ->occ_lock);
+	osc_compr_freelist(&freelist);
+
+	if (occ->occ_wrkmem)
+		OBD_FREE_LARGE(occ->occ_wrkmem, LZ4_MEM_COMPRESS);
+	if (occ->occ_buf)
+		OBD_FREE_LARGE(occ->occ_buf, LZ4_COMPRESSBOUND(PAGE_SIZE));
+	OBD_FREE_PTR(occ);
+	cli->cl_compr_cache = NULL;
+}
+
+int osc_compr_cache_set_max(struct client_obd *cli, unsigned long bytes)
+{
+	struct osc_compr_cache *occ = cli->cl_compr_cache;
+	LIST_HEAD(freelist);
+	int rc = 0;
+
+	if (!occ)
+		return -EOPNOTSUPP;
+
+	mutex_lock(&occ->occ_wrk_mutex);
+	if (bytes > 0 && !occ->occ_wrkmem) {
+		OBD_ALLOC_LARGE(occ->occ_wrkmem, LZ4_MEM_COMPRESS);
+		OBD_ALLOC_LARGE(occ->occ_buf, LZ4_COMPRESSBOUND(PAGE_SIZE));
+		if (!occ->occ_wrkmem || !occ->occ_buf) {
+			if (occ->occ_wrkmem)
+				OBD_FREE_LARGE(occ->occ_wrkmem,
+					       LZ4_MEM_COMPRESS);
+			if (occ->occ_buf)
+				OBD_FREE_LARGE(occ->occ_buf,
+					       LZ4_COMPRESSBOUND(PAGE_SIZE));
+			occ->occ_wrkmem = NULL;
+			occ->occ_buf = NULL;
+			GOTO(out, rc = -ENOMEM);
+		}
+	}
+
+	spin_lock(&occ->occ_lock);
+	occ->occ_max_bytes = bytes;
+	osc_compr_cache_trim(occ, bytes, &freelist);
+	spin_unlock(&occ->occ_lock);
+	osc_compr_freelist(&freelist);
+out:
+	mutex_unlock(&occ->occ_wrk_mutex);
+
+	return rc;
+}
+
+/**
+ * Compress the content of a clean page that is being dropped from the OSC
+ * LRU and keep it in the pool. This is best effort only: nothing is cached
+ * if another thread is compressing, the page does not compress well or
+ * memory is short.
+ *
+ * The caller owns the page, so it can't be dirtied or invalidated under us.
+ */
+void osc_compr_cache_insert(struct client_obd *cli, struct osc_object *osc,
+			    pgoff_t index, struct page *vmpage)
+{
+	struct osc_compr_cache *occ = cli->cl_compr_cache;
+	struct osc_compr_page *ocp = NULL;
+	struct osc_compr_page *old;
+	LIST_HEAD(freelist);
+	void *src;
+	int len;
+	int rc;
+
+	if (!occ || !READ_ONCE(occ->occ_max_bytes))
+		return;
+
+	if (!PageUptodate(vmpage) || PageDirty(vmpage) ||
+	    PageWriteback(vmpage))
+		return;
+
+	if (!mutex_trylock(&occ->occ_wrk_mutex))
+		return;
+
+	if (!occ->occ_wrkmem)
+		GOTO(out_unlock, 0);
+
+	src = kmap(vmpage);
+	len = LZ4_compress_default(src, occ->occ_buf, PAGE_SIZE,
+				   LZ4_COMPRESSBOUND(PAGE_SIZE),
+				   occ->occ_wrkmem);
+	kunmap(vmpage);
+	if (len <= 0 || len > OSC_COMPR_MAX_LEN) {
+		spin_lock(&occ->occ_lock);
+		occ->occ_incompressible++;
+		spin_unlock(&occ->occ_lock);
+		GOTO(out_unlock, 0);
+	}
+
+	/* called from page reclaim paths, do not recurse into it */
+	OBD_ALLOC_GFP(ocp, offsetof(struct osc_compr_page, ocp_data[len]),
+		      GFP_NOWAIT | __GFP_NOWARN);
+	if (!ocp)
+		GOTO(out_unlock, 0);
+
+	INIT_LIST_HEAD(&ocp->ocp_lru);
+	ocp->ocp_obj = osc;
+	ocp->ocp_index = index;
+	ocp->ocp_len = len;
+	memcpy(ocp->ocp_data, occ->occ_buf, len);
+	mutex_unlock(&occ->occ_wrk_mutex);
+
+	spin_lock(&occ->occ_lock);
+	old = radix_tree_lookup(&osc->oo_compr_tree, index);
+	if (old)
+		__osc_compr_page_del(occ, old, &freelist);
+
+	rc = radix_tree_insert(&osc->oo_compr_tree, index, ocp);
+	if (rc == 0) {
+		list_add_tail(&ocp->ocp_lru, &occ->occ_lru);
+		osc->oo_compr_npages++;
+		occ->occ_bytes += ocp_size(ocp);
+		occ->occ_npages++;
+		occ->occ_inserts++;
+		osc_compr_cache_trim(occ, occ->occ_max_bytes, &freelist);
+		ocp = NULL;
+	}
+	spin_unlock(&occ->occ_lock);
+
+	if (ocp)
+		osc_compr_page_free(ocp);
+	osc_compr_freelist(&freelist);
+	return;
+
+out_unlock:
+	mutex_unlock(&occ->occ_wrk_mutex);
+}
+
+/**
+ * Try to fill \a vmpage from the compressed pool. The entry is consumed on
+ * success, the page cache holds the data from now on.
+ *
+ * \retval true		page content was restored, no RPC is needed
+ * \retval false	page is not cached, or could not be decompressed
+ */
+bool osc_compr_cache_fill(struct client_obd *cli, struct osc_object *osc,
+			  pgoff_t index, struct page *vmpage)
+{
+	struct osc_compr_cache *occ = cli->cl_compr_cache;
+	struct osc_compr_page *ocp;
+	LIST_HEAD(freelist);
+	void *dst;
+	int len;
+
+	if (!occ || !READ_ONCE(occ->occ_max_bytes))
+		return false;
+
+	spin_lock(&occ->occ_lock);
+	ocp = osc->oo_compr_npages ?
+	      radix_tree_lookup(&osc->oo_compr_tree, index) : NULL;
+	if (ocp)
+		__osc_compr_page_del(occ, ocp, &freelist);
+	else
+		occ->occ_misses++;
+	spin_unlock(&occ->occ_lock);
+
+	if (!ocp)
+		return false;
+
+	dst = kmap(vmpage);
+	len = LZ4_decompress_safe(ocp->ocp_data, dst, ocp->ocp_len, PAGE_SIZE);
+	kunmap(vmpage);
+	osc_compr_freelist(&freelist);
+
+	spin_lock(&occ->occ_lock);
+	if (len == PAGE_SIZE)
+		occ->occ_hits++;
+	else
+		occ->occ_misses++;
+	spin_unlock(&occ->occ_lock);
+
+	if (len != PAGE_SIZE) {
+		CDEBUG(D_CACHE, "%s: bad compressed page "DOSTID":%lu: rc = %d\n",
+		       cli_name(cli), POSTID(&osc->oo_oinfo->loi_oi), index,
+		       len);
+		return false;
+	}
+
+	return true;
+}
+
+/**
+ * Drop compressed copies of pages [\a start, \a end] of \a osc, because the
+ * DLM lock protecting them is going away or the data is being changed.
+ */
+void osc_compr_cache_invalidate(struct client_obd *cli, struct osc_object *osc,
+				pgoff_t start, pgoff_t end)
+{
+	struct osc_compr_cache *occ = cli->cl_compr_cache;
+	struct osc_compr_page *batch[16];
+	LIST_HEAD(freelist);
+	unsigned int nr;
+	unsigned int i;
+
+	if (!occ || !READ_ONCE(osc->oo_compr_npages))
+		return;
+
+	spin_lock(&occ->occ_lock);
+	while (start <= end && osc->oo_compr_npages) {
+		nr = radix_tree_gang_lookup(&osc->oo_compr_tree,
+					    (void **)batch, start,
+					    ARRAY_SIZE(batch));
+		if (nr == 0)
+			break;
+
+		for (i = 0; i < nr; i++) {
+			if (batch[i]->ocp_index > end)
+				break;
+			start = batch[i]->ocp_index + 1;
+			__osc_compr_page_del(occ, batch[i], &freelist);
+			occ->occ_invalidations++;
+		}
+		/* reached the end of range or wrapped around at CL_PAGE_EOF */
+		if (i < nr || start == 0)
+			break;
+	}
+	spin_unlock(&occ->occ_lock);
+
+	osc_compr_freelist(&freelist);
+}
+
+int osc_compr_cache_stats_seq_show(struct seq_file *m, void *v)
+{
+	struct obd_device *obd = m->private;
+	struct osc_compr_cache *occ = obd->u.cli.cl_compr_cache;
+
+	if (!occ)
+		return 0;
+
+	spin_lock(&occ->occ_lock);
+	lprocfs_stats_header(m, ktime_get_real(), occ->occ_init, 25, ":",
+			     true, "");
+	seq_printf(m, "max_bytes:              %lu\n"
+		   "cached_bytes:           %lu\n"
+		   "cached_pages:           %lu\n"
+		   "hits:                   %llu\n"
+		   "misses:                 %llu\n"
+		   "inserts:                %llu\n"
+		   "evictions:              %llu\n"
+		   "invalidations:          %llu\n"
+		   "incompressible:         %llu\n",
+		   occ->occ_max_bytes, occ->occ_bytes, occ->occ_npages,
+		   occ->occ_hits, occ->occ_misses, occ->occ_inserts,
+		   occ->occ_evictions, occ->occ_invalidations,
+		   occ->occ_incompressible);
+	spin_unlock(&occ->occ_lock);
+
+	return 0;
+}
+
+void osc_compr_cache_stats_clear(struct client_obd *cli)
+{
+	struct osc_compr_cache *occ = cli->cl_compr_cache;
+
+	if (!occ)
+		return;
+
+	spin_lock(&occ->occ_lock);
+	occ->occ_hits = 0;
+	occ->occ_misses = 0;
+	occ->occ_inserts = 0;
+	occ->occ_evictions = 0;
+	occ->occ_invalidations = 0;
+	occ->occ_incompressible = 0;
+	occ->occ_init = ktime_get_real();
+	spin_unlock(&occ->occ_lock);
+}
+#endif /* HAVE_OSC_COMPR_CACHE */
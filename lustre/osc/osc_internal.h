@@ -51,6 +51,54 @@ void osc_extent_release(const struct lu_env *env, struct osc_extent *ext);
 int osc_lock_discard_pages(const struct lu_env *env, struct osc_object *osc,
 			   pgoff_t start, pgoff_t end, bool discard);
 
+#ifdef HAVE_OSC_COMPR_CACHE
+int osc_compr_cache_setup(struct client_obd *cli);
+void osc_compr_cache_cleanup(struct client_obd *cli);
+int osc_compr_cache_set_max(struct client_obd *cli, unsigned long bytes);
+void osc_compr_cache_insert(struct client_obd *cli, struct osc_object *osc,
+			    pgoff_t index, struct page *vmpage);
+bool osc_compr_cache_fill(struct client_obd *cli, struct osc_object *osc,
+			  pgoff_t index, struct page *vmpage);
+void osc_compr_cache_invalidate(struct client_obd *cli, struct osc_object *osc,
+				pgoff_t start, pgoff_t end);
+int osc_compr_cache_stats_seq_show(struct seq_file *m, void *v);
+void osc_compr_cache_stats_clear(struct client_obd *cli);
+#else
+static inline int osc_compr_cache_setup(struct client_obd *cli)
+{
+	return 0;
+}
+
+static inline void osc_compr_cache_cleanup(struct client_obd *cli)
+{
+}
+
+static inline int osc_compr_cache_set_max(struct client_obd *cli,
+					  unsigned long bytes)
+{
+	return -EOPNOTSUPP;
+}
+
+static inline void osc_compr_cache_insert(struct client_obd *cli,
+					  struct osc_object *osc,
+					  pgoff_t index, struct page *vmpage)
+{
+}
+
+static inline bool osc_compr_cache_fill(struct client_obd *cli,
+					struct osc_object *osc,
+					pgoff_t index, struct page *vmpage)
+{
+	return false;
+}
+
+static inline void osc_compr_cache_invalidate(struct client_obd *cli,
+					      struct osc_object *osc,
+					      pgoff_t start, pgoff_t end)
+{
+}
+#endif /* HAVE_OSC_COMPR_CACHE */
+
 void osc_lock_lvb_update(const struct lu_env *env,
 			 struct osc_object *osc,
 			 struct ldlm_lock *dlmlock,
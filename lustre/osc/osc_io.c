@@ -129,6 +129,7 @@ int osc_io_submit(const struct lu_env *env, const struct cl_io_slice *ios,
 	struct osc_page	  *opg;
 	struct cl_io	  *io;
 	LIST_HEAD(list);
+	LIST_HEAD(list_hit);
 
 	struct cl_page_list *qin      = &queue->c2_qin;
 	struct cl_page_list *qout     = &queue->c2_qout;
@@ -198,6 +199,22 @@ int osc_io_submit(const struct lu_env *env, const struct cl_io_slice *ios,
 			continue;
                 }
 
+		if (crt == CRT_WRITE) {
+			osc_compr_cache_invalidate(cli, osc, osc_index(opg),
+						   osc_index(opg));
+		} else if (page->cp_type != CPT_TRANSIENT &&
+			   page->cp_sync_io == NULL &&
+			   osc_compr_cache_fill(cli, osc, osc_index(opg),
+						cl_page_vmpage(page))) {
+			/* served from the compressed tier, no RPC needed */
+			cl_page_completion(env, page, crt, 0);
+			cl_page_list_del(env, qin, page);
+			list_add(&oap->oap_pending_item, &list_hit);
+			osc_lru_add_batch(cli, &list_hit);
+			list_del_init(&oap->oap_pending_item);
+			continue;
+		}
+
 		if (page->cp_type != CPT_TRANSIENT) {
 			oap->oap_async_flags = ASYNC_URGENT|ASYNC_READY|ASYNC_COUNT_STABLE;
 		}
@@ -601,6 +618,10 @@ static int osc_io_setattr_start(const struct lu_env *env,
 	if (io_is_falloc &&
 	    io->u.ci_setattr.sa_falloc_mode & FALLOC_FL_PUNCH_HOLE)
 		result = osc_punch_start(env, io, obj);
+	/* compressed copies may not survive a change of object data */
+	if (cl_io_is_trunc(io) || io_is_falloc)
+		osc_compr_cache_invalidate(osc_cli(cl2osc(obj)), cl2osc(obj),
+					   0, CL_PAGE_EOF);
 
 	if (result == 0 && oio->oi_lockless == 0) {
 		cl_object_attr_lock(obj);
@@ -83,6 +83,7 @@ int osc_object_init(const struct lu_env *env, struct lu_object *obj,
 	atomic_set(&osc->oo_nr_writes, 0);
 	spin_lock_init(&osc->oo_lock);
 	spin_lock_init(&osc->oo_tree_lock);
+	INIT_RADIX_TREE(&osc->oo_compr_tree, GFP_ATOMIC);
 	spin_lock_init(&osc->oo_ol_spin);
 	INIT_LIST_HEAD(&osc->oo_ol_list);
 
@@ -116,6 +117,10 @@ void osc_object_free(const struct lu_env *env, struct lu_object *obj)
 	LASSERT(list_empty(&osc->oo_ol_list));
 	LASSERT(atomic_read(&osc->oo_nr_ios) == 0);
 
+	if (osc->oo_compr_npages)
+		osc_compr_cache_invalidate(osc_cli(osc), osc, 0, CL_PAGE_EOF);
+	LASSERT(osc->oo_compr_npages == 0);
+
 	lu_object_fini(obj);
 	/* osc doen't contain an lu_object_header, so we don't need call_rcu */
 	OBD_SLAB_FREE_PTR(osc, osc_object_kmem);
@@ -488,16 +488,21 @@ static void osc_lru_use(struct client_obd *cli, struct osc_page *opg)
 }
 
 static void discard_pagevec(const struct lu_env *env, struct cl_io *io,
-				struct cl_page **pvec, int max_index)
+			    struct client_obd *cli, struct osc_page **pvec,
+			    int max_index)
 {
 	struct pagevec *pagevec = &osc_env_info(env)->oti_pagevec;
 	int i;
 
 	ll_pagevec_init(pagevec, 0);
 	for (i = 0; i < max_index; i++) {
-		struct cl_page *page = pvec[i];
+		struct osc_page *opg = pvec[i];
+		struct cl_page *page = opg->ops_cl.cpl_page;
 
 		LASSERT(cl_page_is_owned(page, io));
+		/* keep a compressed copy of clean pages before dropping them */
+		osc_compr_cache_insert(cli, osc_page_object(opg), osc_index(opg),
+				       cl_page_vmpage(page));
 		cl_page_discard(env, io, page);
 		cl_page_disown(env, io, page);
 		cl_pagevec_put(env, page, pagevec);
@@ -537,7 +542,7 @@ long osc_lru_shrink(const struct lu_env *env, struct client_obd *cli,
 {
 	struct cl_io *io;
 	struct cl_object *clobj = NULL;
-	struct cl_page **pvec;
+	struct osc_page **pvec;
 	struct osc_page *opg;
 	long count = 0;
 	int maxscan = 0;
@@ -563,7 +568,7 @@ long osc_lru_shrink(const struct lu_env *env, struct client_obd *cli,
 		atomic_inc(&cli->cl_lru_shrinkers);
 	}
 
-	pvec = (struct cl_page **)osc_env_info(env)->oti_pvec;
+	pvec = (struct osc_page **)osc_env_info(env)->oti_pvec;
 	io = osc_env_thread_io(env);
 
 	spin_lock(&cli->cl_lru_list_lock);
@@ -596,7 +601,7 @@ long osc_lru_shrink(const struct lu_env *env, struct client_obd *cli,
 			spin_unlock(&cli->cl_lru_list_lock);
 
 			if (clobj != NULL) {
-				discard_pagevec(env, io, pvec, index);
+				discard_pagevec(env, io, cli, pvec, index);
 				index = 0;
 
 				cl_io_fini(env, io);
@@ -638,10 +643,10 @@ long osc_lru_shrink(const struct lu_env *env, struct client_obd *cli,
 		}
 
 		/* Don't discard and free the page with cl_lru_list held */
-		pvec[index++] = page;
+		pvec[index++] = opg;
 		if (unlikely(index == OTI_PVEC_SIZE)) {
 			spin_unlock(&cli->cl_lru_list_lock);
-			discard_pagevec(env, io, pvec, index);
+			discard_pagevec(env, io, cli, pvec, index);
 			index = 0;
 
 			spin_lock(&cli->cl_lru_list_lock);
@@ -653,7 +658,7 @@ long osc_lru_shrink(const struct lu_env *env, struct client_obd *cli,
 	spin_unlock(&cli->cl_lru_list_lock);
 
 	if (clobj != NULL) {
-		discard_pagevec(env, io, pvec, index);
+		discard_pagevec(env, io, cli, pvec, index);
 
 		cl_io_fini(env, io);
 		cl_object_put(env, clobj);
@@ -3787,9 +3787,13 @@ int osc_setup(struct obd_device *obd, struct lustre_cfg *lcfg)
 	if (rc < 0)
 		RETURN(rc);
 
+	rc = osc_compr_cache_setup(cli);
+	if (rc)
+		GOTO(err_osc_cleanup, rc);
+
 	rc = osc_tunables_init(obd);
 	if (rc)
-		RETURN(rc);
+		GOTO(err_osc_cleanup, rc);
 
 	/*
 	 * We try to control the total number of requests with a upper limit
@@ -3815,6 +3819,11 @@ int osc_setup(struct obd_device *obd, struct lustre_cfg *lcfg)
 	cli->cl_import->imp_idle_debug = D_HA;
 
 	RETURN(0);
+
+err_osc_cleanup:
+	/* also frees the compressed page cache if it was set up */
+	osc_cleanup_common(obd);
+	RETURN(rc);
 }
 
 int osc_precleanup_common(struct obd_device *obd)
@@ -3879,6 +3888,9 @@ int osc_cleanup_common(struct obd_device *obd)
 		cli->cl_cache = NULL;
 	}
 
+	/* free compressed pages, all objects are gone by now */
+	osc_compr_cache_cleanup(cli);
+
 	/* free memory of osc quota cache */
 	osc_quota_cleanup(obd);
 
@@ -465,6 +465,7 @@ static struct lu_object *osd_object_alloc(const struct lu_env *env,
 		init_rwsem(&mo->oo_ext_idx_sem);
 		spin_lock_init(&mo->oo_guard);
 		INIT_LIST_HEAD(&mo->oo_xattr_list);
+		INIT_LIST_HEAD(&mo->oo_rc_list);
 		return l;
 	}
 	return NULL;
@@ -1694,6 +1695,8 @@ static void osd_object_free(const struct lu_env *env, struct lu_object *l)
 	LINVRNT(osd_invariant(obj));
 
 	osd_oxc_fini(obj);
+	if (obj->oo_prealloc)
+		OBD_FREE_PTR(obj->oo_prealloc);
 	dt_object_fini(&obj->oo_dt);
 	if (obj->oo_hl_head != NULL)
 		ldiskfs_htree_lock_head_free(obj->oo_hl_head);
@@ -1905,7 +1908,7 @@ static struct thandle *osd_trans_create(const struct lu_env *env,
 					struct dt_device *d)
 {
 	struct osd_thread_info *oti = osd_oti_get(env);
-	struct osd_iobuf *iobuf = &oti->oti_iobuf;
+	struct osd_iobuf *iobuf = oti->oti_iobuf;
 	struct osd_thandle *oh;
 	struct thandle *th;
 
@@ -1939,6 +1942,7 @@ static struct thandle *osd_trans_create(const struct lu_env *env,
 	oh->oh_declared_ext = 0;
 	INIT_LIST_HEAD(&oh->ot_commit_dcb_list);
 	INIT_LIST_HEAD(&oh->ot_stop_dcb_list);
+	INIT_LIST_HEAD(&oh->ot_io_dcb_list);
 	INIT_LIST_HEAD(&oh->ot_trunc_locks);
 	INIT_LIST_HEAD(&oh->ot_declare_list);
 	osd_th_alloced(oh);
@@ -2128,6 +2132,21 @@ static int osd_seq_exists(const struct lu_env *env,
 	RETURN(ss->ss_node_id == range->lsr_index);
 }
 
+static void osd_trans_io_done_cb(struct list_head *dcbs)
+{
+	struct dt_txn_commit_cb *dcb;
+	struct dt_txn_commit_cb *tmp;
+
+	/* the I/O is done already, errors are returned by osd_trans_stop() */
+	list_for_each_entry_safe(dcb, tmp, dcbs, dcb_linkage) {
+		LASSERTF(dcb->dcb_magic == TRANS_COMMIT_CB_MAGIC,
+			 "commit callback entry: magic=%x name='%s'\n",
+			 dcb->dcb_magic, dcb->dcb_name);
+		list_del_init(&dcb->dcb_linkage);
+		dcb->dcb_func(NULL, NULL, dcb, 0);
+	}
+}
+
 static void osd_trans_stop_cb(struct osd_thandle *oth, int result)
 {
 	struct dt_txn_commit_cb *dcb;
@@ -2152,12 +2171,15 @@ static int osd_trans_stop(const struct lu_env *env, struct dt_device *dt,
 {
 	struct osd_thread_info *oti = osd_oti_get(env);
 	struct osd_thandle *oh;
-	struct osd_iobuf *iobuf = &oti->oti_iobuf;
+	struct osd_iobuf *iobuf = oti->oti_iobuf;
 	struct osd_device *osd = osd_dt_dev(th->th_dev);
 	struct qsd_instance *qsd = osd_def_qsd(osd);
 	struct lquota_trans *qtrans;
 	LIST_HEAD(truncates);
-	int rc = 0, remove_agents = 0;
+	LIST_HEAD(io_dcbs);
+	/* a failed or restarted write is waited for as usual */
+	bool wait_io = th->th_result != 0 || th->th_restart_tran;
+	int rc = 0, rc2, remove_agents = 0;
 
 	ENTRY;
 
@@ -2165,6 +2187,9 @@ static int osd_trans_stop(const struct lu_env *env, struct dt_device *dt,
 
 	remove_agents = oh->ot_remove_agents;
 
+	/* the handle can be freed by the commit callback once stopped */
+	list_splice_init(&oh->ot_io_dcb_list, &io_dcbs);
+
 	qtrans = oh->ot_quota_trans;
 	oh->ot_quota_trans = NULL;
 
@@ -2174,8 +2199,6 @@ static int osd_trans_stop(const struct lu_env *env, struct dt_device *dt,
 	list_splice(&oh->ot_trunc_locks, &truncates);
 
 	if (oh->ot_handle != NULL) {
-		int rc2;
-
 		handle_t *hdl = oh->ot_handle;
 
 		/*
@@ -2234,14 +2257,17 @@ static int osd_trans_stop(const struct lu_env *env, struct dt_device *dt,
 	 *
 	 * IMPORTANT: we have to wait till any IO submited by the thread is
 	 * completed otherwise iobuf may be corrupted by different request
+	 *
+	 * unless the caller asked to be called back once the IO is done,
+	 * then the iobuf completes on its own, see osd_iobuf_defer()
 	 */
-	wait_event(iobuf->dr_wait,
-		       atomic_read(&iobuf->dr_numreqs) == 0);
-
-	if (!rc)
-		rc = iobuf->dr_error;
-
-	osd_fini_iobuf(osd, iobuf);
+	if (list_empty(&io_dcbs) || rc != 0 || wait_io ||
+	    osd_iobuf_defer(oti, &io_dcbs) != 0) {
+		rc2 = osd_wait_iobuf(osd, iobuf);
+		if (!rc)
+			rc = rc2;
+		osd_trans_io_done_cb(&io_dcbs);
+	}
 
 	if (unlikely(remove_agents != 0))
 		osd_process_scheduled_agent_removals(env, osd);
@@ -2264,7 +2290,9 @@ static int osd_trans_cb_add(struct thandle *th, struct dt_txn_commit_cb *dcb)
 
 	LASSERT(dcb->dcb_magic == TRANS_COMMIT_CB_MAGIC);
 	LASSERT(&dcb->dcb_func != NULL);
-	if (dcb->dcb_flags & DCB_TRANS_STOP)
+	if (dcb->dcb_flags & DCB_IO_DONE)
+		list_add(&dcb->dcb_linkage, &oh->ot_io_dcb_list);
+	else if (dcb->dcb_flags & DCB_TRANS_STOP)
 		list_add(&dcb->dcb_linkage, &oh->ot_stop_dcb_list);
 	else
 		list_add(&dcb->dcb_linkage, &oh->ot_commit_dcb_list);
@@ -2327,6 +2355,7 @@ static void osd_object_delete(const struct lu_env *env, struct lu_object *l)
 	 */
 
 	osd_index_fini(obj);
+	osd_rcache_del(osd_obj2dev(obj), obj);
 
 	if (!inode)
 		return;
@@ -8092,8 +8121,14 @@ static void *osd_key_init(const struct lu_context *ctx,
 	if (info->oti_hlock == NULL)
 		goto out_free_ea;
 
+	OBD_ALLOC_PTR(info->oti_iobuf);
+	if (info->oti_iobuf == NULL)
+		goto out_free_hlock;
+
 	return info;
 
+out_free_hlock:
+	ldiskfs_htree_lock_free(info->oti_hlock);
 out_free_ea:
 	OBD_FREE(info->oti_it_ea_buf, OSD_IT_EA_BUFSIZE);
 out_free_info:
@@ -8129,8 +8164,7 @@ static void osd_key_fini(const struct lu_context *ctx,
 	if (info->oti_hlock != NULL)
 		ldiskfs_htree_lock_free(info->oti_hlock);
 	OBD_FREE(info->oti_it_ea_buf, OSD_IT_EA_BUFSIZE);
-	lu_buf_free(&info->oti_iobuf.dr_bl_buf);
-	lu_buf_free(&info->oti_iobuf.dr_lnb_buf);
+	osd_iobuf_free(info->oti_iobuf);
 	lu_buf_free(&info->oti_big_buf);
 	if (idc != NULL) {
 		LASSERT(info->oti_ins_cache_size > 0);
@@ -8156,6 +8190,7 @@ static void osd_key_exit(const struct lu_context *ctx,
 	LASSERT(info->oti_txns    == 0);
 	LASSERTF(info->oti_dio_pages_used == 0, "%d\n",
 		 info->oti_dio_pages_used);
+	LASSERT(info->oti_iobuf_deferred == NULL);
 }
 
 /* type constructor/destructor: osd_type_init, osd_type_fini */
@@ -8501,6 +8536,13 @@ static struct lu_device *osd_device_fini(const struct lu_env *env,
 	ENTRY;
 
 	osd_index_backup(env, o, false);
+	/* writes handed over by osd_trans_stop() still hold pages */
+	wait_var_event(&o->od_iobufs_deferred,
+		       !atomic_read(&o->od_iobufs_deferred));
+	if (o->od_iobuf_wq != NULL) {
+		destroy_workqueue(o->od_iobuf_wq);
+		o->od_iobuf_wq = NULL;
+	}
 	osd_shutdown(env, o);
 	osd_procfs_fini(o);
 	if (o->od_oi_table != NULL)
@@ -8553,6 +8595,10 @@ static int osd_device_init0(const struct lu_env *env,
 	o->od_scrub.os_scrub.os_auto_scrub_interval = AS_DEFAULT;
 	/* default fallocate to unwritten extents: LU-14326/LU-14333 */
 	o->od_fallocate_zero_blocks = 0;
+	/* reserving blocks ahead of writers is opt-in */
+	o->od_prealloc_max = 0;
+	o->od_extent_stats.oes_init = ktime_get_real();
+	osd_rcache_init(&o->od_rcache);
 
 	cplen = strlcpy(o->od_svname, lustre_cfg_string(cfg, 4),
 			sizeof(o->od_svname));
@@ -8569,6 +8615,7 @@ static int osd_device_init0(const struct lu_env *env,
 
 	o->od_full_scrub_ratio = OFSR_DEFAULT;
 	o->od_full_scrub_threshold_rate = FULL_SCRUB_THRESHOLD_RATE_DEFAULT;
+	o->od_scrub_threads = OSD_SCRUB_THREADS_DEFAULT;
 	rc = osd_mount(env, o, cfg);
 	if (rc != 0)
 		GOTO(out, rc);
@@ -8577,9 +8624,17 @@ static int osd_device_init0(const struct lu_env *env,
 	o->od_nonrotational =
 		blk_queue_nonrot(bdev_get_queue(osd_sb(o)->s_bdev));
 
+	o->od_iobuf_wq = cfs_cpt_bind_workqueue(o->od_svname, cfs_cpt_tab,
+						WQ_MEM_RECLAIM, CFS_CPT_ANY, 0);
+	if (IS_ERR(o->od_iobuf_wq)) {
+		rc = PTR_ERR(o->od_iobuf_wq);
+		o->od_iobuf_wq = NULL;
+		GOTO(out_mnt, rc);
+	}
+
 	rc = osd_obj_map_init(env, o);
 	if (rc != 0)
-		GOTO(out_mnt, rc);
+		GOTO(out_wq, rc);
 
 	rc = lu_site_init(&o->od_site, l);
 	if (rc != 0)
@@ -8600,12 +8655,19 @@ static int osd_device_init0(const struct lu_env *env,
 	if (rc)
 		GOTO(out_brw_stats, rc);
 
+	rc = lprocfs_oh_alloc_pcpu(&o->od_extent_stats.oes_alloc_hist);
+	if (rc == 0)
+		rc = lprocfs_oh_alloc_pcpu(
+				&o->od_extent_stats.oes_prealloc_hist);
+	if (rc)
+		GOTO(out_extent_stats, rc);
+
 	/* setup scrub, including OI files initialization */
 	o->od_in_init = 1;
 	rc = osd_scrub_setup(env, o, restored);
 	o->od_in_init = 0;
 	if (rc < 0)
-		GOTO(out_brw_stats, rc);
+		GOTO(out_extent_stats, rc);
 
 	rc = osd_procfs_init(o, o->od_svname);
 	if (rc != 0) {
@@ -8656,12 +8718,18 @@ out_procfs:
 	osd_procfs_fini(o);
 out_scrub:
 	osd_scrub_cleanup(env, o);
+out_extent_stats:
+	lprocfs_oh_release_pcpu(&o->od_extent_stats.oes_prealloc_hist);
+	lprocfs_oh_release_pcpu(&o->od_extent_stats.oes_alloc_hist);
 out_brw_stats:
 	lprocfs_fini_brw_stats(&o->od_brw_stats);
 out_site:
 	lu_site_fini(&o->od_site);
 out_compat:
 	osd_obj_map_fini(o);
+out_wq:
+	destroy_workqueue(o->od_iobuf_wq);
+	o->od_iobuf_wq = NULL;
 out_mnt:
 	osd_umount(env, o);
 out:
@@ -8710,6 +8778,7 @@ static struct lu_device *osd_device_free(const struct lu_env *env,
 	lu_site_print(env, d->ld_site, &d->ld_site->ls_obj_hash.nelems,
 		      D_ERROR, lu_cdebug_printer);
 	lu_site_fini(&o->od_site);
+	osd_rcache_fini(&o->od_rcache);
 	dt_device_fini(&o->od_dt_dev);
 	OBD_FREE_PTR(o);
 	RETURN(NULL);
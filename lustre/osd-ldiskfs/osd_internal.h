@@ -101,6 +101,19 @@ extern struct kmem_cache *dynlock_cachep;
 /* Default extent bytes when declaring write commit */
 #define OSD_DEFAULT_EXTENT_BYTES	(1U << 20)
 
+/* Maximum window of unwritten blocks reserved ahead of a write stream */
+#define OSD_MAX_PREALLOC_BYTES		(256U << 20)
+/* sequential writes seen before the object is treated as a stream */
+#define OSD_WR_STREAM_MIN		2
+#define OSD_WR_STREAM_MAX		16
+/* write streams followed per object, e.g. interleaved N-to-1 writers */
+#define OSD_WR_STREAMS			4
+/* seconds without write after which a stream releases its reservation */
+#define OSD_WR_STREAM_IDLE		30
+/* extents reserved ahead of the streams of an object, tracked to be released
+ * later. Nothing more is reserved once the table is full */
+#define OSD_PREALLOC_EXTENTS		16
+
 /* check if ldiskfs support project quota */
 #if LDISKFS_MAXQUOTAS < 3
 #undef HAVE_PROJECT_QUOTA
@@ -126,6 +139,13 @@ struct osd_oi {
 
 extern const int osd_dto_credits_noquota[];
 
+/* read cache list an object is on, see osd_readcache.c */
+enum osd_rc_list {
+	OSD_RC_NONE	= 0,
+	OSD_RC_T1,	/* resident, read once since admission */
+	OSD_RC_T2,	/* resident, read again or prefetched */
+};
+
 struct osd_object {
 	struct dt_object        oo_dt;
 	/**
@@ -164,6 +184,84 @@ struct osd_object {
 
 	struct list_head	oo_xattr_list;
 	struct lu_object_header *oo_header;
+
+	/* write streams and blocks reserved ahead of them, allocated on the
+	 * first write once write_prealloc_max is set */
+	struct osd_prealloc	*oo_prealloc;
+
+	/* read cache state, protected by osd_rcache::orc_lock */
+	struct list_head	oo_rc_list;	/* on orc_t1 or orc_t2 */
+	unsigned long		oo_rc_pages;	/* pages charged */
+	unsigned int		oo_rc_reads;	/* reads before admission */
+	enum osd_rc_list	oo_rc_where;
+};
+
+/* reads of an object before it is admitted to the read cache */
+#define OSD_RC_ADMIT_DEF	2
+#define OSD_RC_GHOST_BITS	10
+#define OSD_RC_GHOST_MAX	(4 << OSD_RC_GHOST_BITS)
+
+/* ARC-like read cache manager, see osd_readcache.c */
+struct osd_rcache {
+	spinlock_t		orc_lock;
+	struct list_head	orc_t1;		/* resident objects */
+	struct list_head	orc_t2;
+	struct list_head	orc_b1;		/* ghosts evicted from t1 */
+	struct list_head	orc_b2;		/* ghosts evicted from t2 */
+	struct hlist_head	orc_ghost_hash[1 << OSD_RC_GHOST_BITS];
+	unsigned long		orc_t1_pages;
+	unsigned long		orc_t2_pages;
+	unsigned int		orc_b1_count;
+	unsigned int		orc_b2_count;
+	unsigned int		orc_ghost_max;
+	/* adaptive target of pages held by t1 */
+	unsigned long		orc_target;
+	/* pages budget, zero disables the manager */
+	unsigned long		orc_max_pages;
+	unsigned int		orc_admit;
+	ktime_t			orc_init;
+	unsigned long		orc_hits;
+	unsigned long		orc_ghost_hits;
+	unsigned long		orc_admits;
+	unsigned long		orc_hints;
+	unsigned long		orc_bypass;
+	unsigned long		orc_evictions;
+};
+
+/* sequential writer of an object, see osd_write_stream_update() */
+struct osd_wr_stream {
+	loff_t			ows_end;	/* end of the stream so far */
+	loff_t			ows_prealloc_end; /* end of reserved window */
+	time64_t		ows_time;	/* last write, 0 if unused */
+	unsigned int		ows_count;	/* sequential writes seen */
+};
+
+/* blocks allocated as unwritten extents by osd_write_prealloc() */
+struct osd_prealloc_extent {
+	ldiskfs_lblk_t		ope_start;
+	unsigned int		ope_len;
+};
+
+/* write prealloc state of an object, protected by oo_guard */
+struct osd_prealloc {
+	struct osd_wr_stream	op_streams[OSD_WR_STREAMS];
+	struct osd_prealloc_extent op_extents[OSD_PREALLOC_EXTENTS];
+	unsigned int		op_nr_extents;
+	/* slots booked by allocations in progress */
+	unsigned int		op_nr_pending;
+};
+
+/* block allocation statistics of the write path, dumped in extent_stats */
+struct osd_extent_stats {
+	ktime_t			oes_init;
+	/* sizes of the extents allocated or converted for written data */
+	struct obd_hist_pcpu	oes_alloc_hist;
+	/* sizes of the extents reserved ahead of write streams */
+	struct obd_hist_pcpu	oes_prealloc_hist;
+	atomic64_t		oes_alloc_blocks;
+	atomic64_t		oes_prealloc_blocks;
+	atomic64_t		oes_stream_writes;
+	atomic64_t		oes_writes;
 };
 
 struct osd_obj_seq {
@@ -350,6 +448,9 @@ struct osd_device {
 	 * exceeds the osd_device::od_full_scrub_threshold_rate,
 	 * then trigger OI scrub to scan the whole device. */
 	__u64			 od_full_scrub_threshold_rate;
+	/* How many threads scan the inode table in parallel during
+	 * full speed OI scrub, 1 means the classic single scanner. */
+	__u32			 od_scrub_threads;
 
 	/* a list of orphaned agent inodes, protected with od_osfs_lock */
 	struct list_head	 od_orphan_list;
@@ -363,7 +464,15 @@ struct osd_device {
 	enum osd_t10_type	 od_t10_type;
 	atomic_t		 od_commit_cb_in_flight;
 	wait_queue_head_t	 od_commit_cb_done;
+	/* completes the writes handed over by osd_trans_stop() */
+	struct workqueue_struct	*od_iobuf_wq;
+	atomic_t		 od_iobufs_deferred;
 	unsigned int __percpu	*od_extent_bytes_percpu;
+	/* window of unwritten blocks reserved ahead of a write stream,
+	 * zero disables write preallocation */
+	unsigned int		 od_prealloc_max;
+	struct osd_extent_stats	 od_extent_stats;
+	struct osd_rcache	 od_rcache;
 };
 
 static inline struct qsd_instance *osd_def_qsd(struct osd_device *osd)
@@ -388,6 +497,9 @@ enum osd_full_scrub_ratio {
 
 #define FULL_SCRUB_THRESHOLD_RATE_DEFAULT	60
 
+#define OSD_SCRUB_THREADS_DEFAULT	1
+#define OSD_SCRUB_THREADS_MAX		32
+
 /* There are at most 15 uid/gid/projids are affected in a transaction, and
  * that's rename case:
  * - 3 for source parent uid & gid & projid;
@@ -425,6 +537,9 @@ struct osd_access_lock {
 	bool			 tl_shared;
 	bool			 tl_truncate;
 	bool			 tl_punch;
+	/* release the reservations of idle streams,
+	 * see osd_write_prealloc_trim() */
+	bool			 tl_trim;
 };
 
 struct osd_thandle {
@@ -433,6 +548,7 @@ struct osd_thandle {
         struct ldiskfs_journal_cb_entry ot_jcb;
 	struct list_head       ot_commit_dcb_list;
 	struct list_head       ot_stop_dcb_list;
+	struct list_head       ot_io_dcb_list;
 	/* Link to the device, for debugging. */
 	struct lu_ref_link      ot_dev_link;
 	unsigned int		ot_credits;
@@ -612,6 +728,12 @@ struct osd_iobuf {
 	/* Already written blocks of the start page */
 	unsigned int	   dr_start_pg_wblks;
 	struct inode 	  *dr_inode;
+	/* handed over by osd_trans_stop() to complete in the background,
+	 * see osd_iobuf_defer() */
+	bool		   dr_deferred;
+	struct page	 **dr_held;	/* pages to release once done */
+	struct list_head   dr_io_dcbs;	/* DCB_IO_DONE callbacks */
+	struct work_struct dr_work;
 };
 
 #define osd_dirty_inode(inode, flag)  (inode)->i_sb->s_op->dirty_inode((inode), flag)
@@ -735,7 +857,9 @@ struct osd_thread_info {
 		struct filter_fid	oti_ff;
 	};
 	/** 0-copy IO */
-	struct osd_iobuf		oti_iobuf;
+	struct osd_iobuf		*oti_iobuf;
+	/* write iobuf waiting for osd_bufs_put() to hand its pages over */
+	struct osd_iobuf		*oti_iobuf_deferred;
 	/* used to access objects in /O */
 	struct inode			*oti_inode;
 #define OSD_FID_REC_SZ 32
@@ -830,6 +954,16 @@ int osd_register_proc_index_in_idif(struct osd_device *osd);
 #endif
 
 #endif
+/* osd_readcache.c */
+void osd_rcache_init(struct osd_rcache *rc);
+void osd_rcache_fini(struct osd_rcache *rc);
+bool osd_rcache_access(struct osd_device *osd, struct osd_object *obj,
+		       int npages, bool hint);
+void osd_rcache_del(struct osd_device *osd, struct osd_object *obj);
+void osd_rcache_resize(struct osd_device *osd, unsigned long max_pages);
+int osd_rcache_seq_show(struct seq_file *m, struct osd_rcache *rc);
+void osd_rcache_stats_clear(struct osd_rcache *rc);
+
 int osd_statfs(const struct lu_env *env, struct dt_device *dev,
 	       struct obd_statfs *sfs, struct obd_statfs_info *info);
 struct inode *osd_iget(struct osd_thread_info *info, struct osd_device *dev,
@@ -1536,6 +1670,9 @@ static inline struct buffer_head *__ldiskfs_bread(handle_t *handle,
 #endif /* HAVE_EXT4_INC_DEC_COUNT_2ARGS */
 
 void osd_fini_iobuf(struct osd_device *d, struct osd_iobuf *iobuf);
+int osd_wait_iobuf(struct osd_device *d, struct osd_iobuf *iobuf);
+int osd_iobuf_defer(struct osd_thread_info *oti, struct list_head *dcbs);
+void osd_iobuf_free(struct osd_iobuf *iobuf);
 
 static inline int
 osd_index_register(struct osd_device *osd, const struct lu_fid *fid,
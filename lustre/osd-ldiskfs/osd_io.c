@@ -67,8 +67,10 @@ struct kmem_cache *biop_cachep;
 
 #ifdef HAVE_BIO_ENDIO_USES_ONE_ARG
 static void dio_complete_routine(struct bio *bio);
+static void dio_iobuf_complete_routine(struct bio *bio);
 #else
 static void dio_complete_routine(struct bio *bio, int error);
+static void dio_iobuf_complete_routine(struct bio *bio, int error);
 #endif
 
 static int osd_bio_init(struct bio *bio, struct osd_iobuf *iobuf,
@@ -77,6 +79,16 @@ static int osd_bio_init(struct bio *bio, struct osd_iobuf *iobuf,
 	struct osd_bio_private *bio_private = NULL;
 	ENTRY;
 
+	/* the start page is only needed to find the pages of the bio when
+	 * integrity is generated or verified, otherwise save the allocation
+	 * and point the bio at the iobuf it completes
+	 */
+	if (!iobuf->dr_integrity) {
+		bio->bi_end_io = dio_iobuf_complete_routine;
+		bio->bi_private = iobuf;
+		RETURN(0);
+	}
+
 	OBD_SLAB_ALLOC_GFP(bio_private, biop_cachep, sizeof(*bio_private),
 			   GFP_NOIO);
 	if (bio_private == NULL)
@@ -96,6 +108,10 @@ static void osd_bio_fini(struct bio *bio)
 
 	if (!bio)
 		return;
+	if (bio->bi_end_io != dio_complete_routine) {
+		bio_put(bio);
+		return;
+	}
 	bio_private = bio->bi_private;
 	bio_put(bio);
 	OBD_SLAB_FREE(bio_private, biop_cachep, sizeof(*bio_private));
@@ -214,18 +230,191 @@ void osd_fini_iobuf(struct osd_device *d, struct osd_iobuf *iobuf)
 	iobuf->dr_error = 0;
 }
 
-#ifdef HAVE_BIO_ENDIO_USES_ONE_ARG
-static void dio_complete_routine(struct bio *bio)
+/**
+ * Wait for all the bios submitted for \a iobuf to complete.
+ *
+ * This is the only place where a thread blocks on data I/O it submitted,
+ * reads wait right away in osd_do_bio(), writes wait once the transaction
+ * is stopped, see osd_trans_stop(). The iobuf lives in the thread's env,
+ * so it has to be idle before the thread takes the next request, unless
+ * it is handed over with osd_iobuf_defer().
+ *
+ * \param[in] d		OSD device
+ * \param[in] iobuf	iobuf to wait for
+ *
+ * \retval 0		on success
+ * \retval negative	first I/O error reported by the bios
+ */
+int osd_wait_iobuf(struct osd_device *d, struct osd_iobuf *iobuf)
 {
-	int error = blk_status_to_errno(bio->bi_status);
-#else
-static void dio_complete_routine(struct bio *bio, int error)
+	int rc;
+
+	wait_event(iobuf->dr_wait, atomic_read(&iobuf->dr_numreqs) == 0);
+	rc = iobuf->dr_error;
+	osd_fini_iobuf(d, iobuf);
+
+	return rc;
+}
+
+void osd_iobuf_free(struct osd_iobuf *iobuf)
 {
-#endif
-	struct osd_bio_private *bio_private = bio->bi_private;
-	struct osd_iobuf *iobuf = bio_private->obp_iobuf;
-	struct bio_vec *bvl;
+	lu_buf_free(&iobuf->dr_bl_buf);
+	lu_buf_free(&iobuf->dr_lnb_buf);
+	OBD_FREE_PTR(iobuf);
+}
+
+/*
+ * Complete a write iobuf handed over by osd_iobuf_defer(): release the
+ * pages that were kept locked for the I/O, then let the callers know.
+ */
+static void osd_iobuf_done(struct work_struct *work)
+{
+	struct osd_iobuf *iobuf = container_of(work, struct osd_iobuf,
+					       dr_work);
+	struct osd_device *osd = iobuf->dr_dev;
+	struct dt_txn_commit_cb *dcb, *tmp;
+	int rc = iobuf->dr_error;
+	int i;
+
+	/* the last bio saw the reference of osd_bufs_put() */
+	if (!iobuf->dr_elapsed_valid) {
+		iobuf->dr_elapsed = ktime_sub(ktime_get(),
+					      iobuf->dr_start_time);
+		iobuf->dr_elapsed_valid = 1;
+	}
+	osd_fini_iobuf(osd, iobuf);
+
+	for (i = 0; i < iobuf->dr_npages; i++) {
+		struct page *page = iobuf->dr_held[i];
+
+		unlock_page(page);
+		if (PagePrivate2(page)) {
+			/* taken from the thread's pool, see osd_get_page() */
+			ClearPagePrivate2(page);
+			__free_page(page);
+		} else {
+			put_page(page);
+		}
+	}
+	OBD_FREE_PTR_ARRAY_LARGE(iobuf->dr_held, iobuf->dr_npages);
+
+	list_for_each_entry_safe(dcb, tmp, &iobuf->dr_io_dcbs, dcb_linkage) {
+		LASSERTF(dcb->dcb_magic == TRANS_COMMIT_CB_MAGIC,
+			 "commit callback entry: magic=%x name='%s'\n",
+			 dcb->dcb_magic, dcb->dcb_name);
+		list_del_init(&dcb->dcb_linkage);
+		dcb->dcb_func(NULL, NULL, dcb, rc);
+	}
+
+	osd_iobuf_free(iobuf);
+	if (atomic_dec_and_test(&osd->od_iobufs_deferred))
+		wake_up_var(&osd->od_iobufs_deferred);
+}
+
+/**
+ * Hand the write iobuf of the thread over to complete in the background.
+ *
+ * Called by osd_trans_stop() when the transaction has DCB_IO_DONE
+ * callbacks. Instead of waiting for the bios, the thread takes a new
+ * iobuf and leaves \a dcbs to be called once the bios complete. The pages
+ * under I/O stay locked until then: the next osd_bufs_put() passes them
+ * to the iobuf rather than releasing them, see osd_iobuf_hold_pages().
+ *
+ * \param[in] oti	thread info
+ * \param[in] dcbs	DCB_IO_DONE callbacks of the transaction
+ *
+ * \retval 0		iobuf handed over, \a dcbs moved to it
+ * \retval -EALREADY	no I/O in flight, nothing to wait for
+ * \retval -ENOMEM	no memory, the caller has to wait for the I/O
+ */
+int osd_iobuf_defer(struct osd_thread_info *oti, struct list_head *dcbs)
+{
+	struct osd_iobuf *iobuf = oti->oti_iobuf;
+	struct osd_iobuf *next;
+
+	if (iobuf->dr_rw != 1 || atomic_read(&iobuf->dr_numreqs) == 0)
+		return -EALREADY;
+
+	OBD_ALLOC_PTR(next);
+	if (next == NULL)
+		return -ENOMEM;
+
+	OBD_ALLOC_PTR_ARRAY_LARGE(iobuf->dr_held, iobuf->dr_npages);
+	if (iobuf->dr_held == NULL) {
+		OBD_FREE_PTR(next);
+		return -ENOMEM;
+	}
+
+	INIT_LIST_HEAD(&iobuf->dr_io_dcbs);
+	list_splice_init(dcbs, &iobuf->dr_io_dcbs);
+	INIT_WORK(&iobuf->dr_work, osd_iobuf_done);
+	atomic_inc(&iobuf->dr_dev->od_iobufs_deferred);
+	/* keep the iobuf from completing before it has the pages */
+	atomic_inc(&iobuf->dr_numreqs);
+	iobuf->dr_deferred = true;
+
+	oti->oti_iobuf_deferred = iobuf;
+	oti->oti_iobuf = next;
+
+	return 0;
+}
+
+/*
+ * Move the pages under I/O of \a iobuf from \a lnb to the iobuf, which
+ * releases them in osd_iobuf_done(). The pages not taken from the page
+ * cache leave the thread's pool, osd_get_page() allocates new ones.
+ */
+static void osd_iobuf_hold_pages(struct osd_thread_info *oti,
+				 struct osd_iobuf *iobuf,
+				 struct niobuf_local *lnb, int npages)
+{
+	int slot = oti->oti_dio_pages_used;
+	int i, j;
+
+	/* the pool is used in order, the pages of \a lnb are the last */
+	for (i = 0; i < npages; i++)
+		if (lnb[i].lnb_page != NULL && PagePrivate2(lnb[i].lnb_page))
+			slot--;
+
+	for (i = j = 0; i < npages; i++) {
+		struct page *page = lnb[i].lnb_page;
+		bool pooled;
+
+		if (page == NULL)
+			continue;
+
+		pooled = PagePrivate2(page);
+		if (j < iobuf->dr_npages && iobuf->dr_lnbs[j] == &lnb[i]) {
+			LASSERT(PageLocked(page));
+			if (pooled) {
+				LASSERT(oti->oti_dio_pages[slot] == page);
+				oti->oti_dio_pages[slot] = NULL;
+				oti->oti_dio_pages_used--;
+			}
+			iobuf->dr_held[j++] = page;
+			lnb[i].lnb_page = NULL;
+		}
+		if (pooled)
+			slot++;
+	}
+	LASSERTF(j == iobuf->dr_npages, "%d != %d\n", j, iobuf->dr_npages);
+}
+
+static void osd_iobuf_release(struct osd_iobuf *iobuf)
+{
+	if (!atomic_dec_and_test(&iobuf->dr_numreqs))
+		return;
 
+	if (iobuf->dr_deferred)
+		queue_work(iobuf->dr_dev->od_iobuf_wq, &iobuf->dr_work);
+	else
+		wake_up(&iobuf->dr_wait);
+}
+
+static void osd_dio_complete(struct bio *bio, struct osd_iobuf *iobuf,
+			     int error)
+{
+	struct bio_vec *bvl;
 
 	/* CAVEAT EMPTOR: possibly in IRQ context
 	 * DO NOT record procfs stats here!!!
@@ -273,8 +462,7 @@ static void dio_complete_routine(struct bio *bio, int error)
 		iobuf->dr_elapsed = ktime_sub(now, iobuf->dr_start_time);
 		iobuf->dr_elapsed_valid = 1;
 	}
-	if (atomic_dec_and_test(&iobuf->dr_numreqs))
-		wake_up(&iobuf->dr_wait);
+	osd_iobuf_release(iobuf);
 
 	/* Completed bios used to be chained off iobuf->dr_bios and freed in
 	 * filter_clear_dreq().  It was then possible to exhaust the biovec-256
@@ -285,6 +473,31 @@ static void dio_complete_routine(struct bio *bio, int error)
 	osd_bio_fini(bio);
 }
 
+#ifdef HAVE_BIO_ENDIO_USES_ONE_ARG
+static void dio_complete_routine(struct bio *bio)
+{
+	int error = blk_status_to_errno(bio->bi_status);
+#else
+static void dio_complete_routine(struct bio *bio, int error)
+{
+#endif
+	struct osd_bio_private *bio_private = bio->bi_private;
+
+	osd_dio_complete(bio, bio_private ? bio_private->obp_iobuf : NULL,
+			 error);
+}
+
+#ifdef HAVE_BIO_ENDIO_USES_ONE_ARG
+static void dio_iobuf_complete_routine(struct bio *bio)
+{
+	int error = blk_status_to_errno(bio->bi_status);
+#else
+static void dio_iobuf_complete_routine(struct bio *bio, int error)
+{
+#endif
+	osd_dio_complete(bio, bio->bi_private, error);
+}
+
 static void record_start_io(struct osd_iobuf *iobuf, int size)
 {
 	struct osd_device *osd = iobuf->dr_dev;
@@ -400,6 +613,7 @@ static int osd_do_bio(struct osd_device *osd, struct inode *inode,
 	int page_idx, page_idx_start;
 	int i;
 	int rc = 0;
+	int rc2;
 	bool integrity_enabled;
 	struct blk_plug plug;
 	int blocks_left_page;
@@ -508,18 +722,16 @@ out:
 	 * parallel and wait for IO completion once transaction is stopped
 	 * see osd_trans_stop() for more details -bzzz
 	 */
-	if (iobuf->dr_rw == 0 || CFS_FAIL_CHECK(OBD_FAIL_OST_INTEGRITY_FAULT)) {
-		wait_event(iobuf->dr_wait,
-			   atomic_read(&iobuf->dr_numreqs) == 0);
-	}
-
-	if (rc == 0)
-		rc = iobuf->dr_error;
-	else
+	if (rc != 0)
 		osd_bio_fini(bio);
 
-	if (iobuf->dr_rw == 0 || CFS_FAIL_CHECK(OBD_FAIL_OST_INTEGRITY_FAULT))
-		osd_fini_iobuf(osd, iobuf);
+	if (iobuf->dr_rw == 0 || CFS_FAIL_CHECK(OBD_FAIL_OST_INTEGRITY_FAULT)) {
+		rc2 = osd_wait_iobuf(osd, iobuf);
+		if (rc == 0)
+			rc = rc2;
+	} else if (rc == 0) {
+		rc = iobuf->dr_error;
+	}
 
 	/* Write only now */
 	if (rc == 0 && iobuf->dr_rw)
@@ -662,11 +874,18 @@ static int osd_bufs_put(const struct lu_env *env, struct dt_object *dt,
 {
 	struct osd_device *osd = osd_obj2dev(osd_dt_obj(dt));
 	struct osd_thread_info *oti = osd_oti_get(env);
-	struct osd_iobuf *iobuf = &oti->oti_iobuf;
+	struct osd_iobuf *iobuf = oti->oti_iobuf_deferred;
 	struct pagevec pvec;
 	int i;
 
-	osd_brw_stats_update(osd, iobuf);
+	if (iobuf != NULL) {
+		/* the write is still in flight, see osd_iobuf_defer() */
+		oti->oti_iobuf_deferred = NULL;
+		osd_iobuf_hold_pages(oti, iobuf, lnb, npages);
+		osd_brw_stats_update(osd, iobuf);
+	} else {
+		osd_brw_stats_update(osd, oti->oti_iobuf);
+	}
 	ll_pagevec_init(&pvec, 0);
 
 	for (i = 0; i < npages; i++) {
@@ -695,6 +914,9 @@ static int osd_bufs_put(const struct lu_env *env, struct dt_object *dt,
 	/* Release any partial pagevec */
 	pagevec_release(&pvec);
 
+	if (iobuf != NULL)
+		osd_iobuf_release(iobuf);
+
 	RETURN(0);
 }
 
@@ -750,11 +972,23 @@ static int osd_bufs_get(const struct lu_env *env, struct dt_object *dt,
 	fsize = max(fsize, i_size_read(obj->oo_inode));
 
 	cache = rw & DT_BUFS_TYPE_READAHEAD;
-	if (cache)
+	if (cache) {
+		/* prefetch asked by the client, admit it to the cache */
+		osd_rcache_access(osd, obj, npages, true);
 		goto bypass_checks;
+	}
 
 	cache = osd_use_page_cache(osd);
 	while (cache) {
+		/* don't use cache on large files, checked first so that
+		 * their reads don't take orc_lock nor disturb the adaptive
+		 * state of the read cache manager
+		 */
+		if (osd->od_readcache_max_filesize &&
+		    fsize > osd->od_readcache_max_filesize) {
+			cache = false;
+			break;
+		}
 		if (write) {
 			if (!osd->od_writethrough_cache) {
 				cache = false;
@@ -773,11 +1007,9 @@ static int osd_bufs_get(const struct lu_env *env, struct dt_object *dt,
 				cache = false;
 				break;
 			}
+			if (!osd_rcache_access(osd, obj, npages, false))
+				cache = false;
 		}
-		/* don't use cache on large files */
-		if (osd->od_readcache_max_filesize &&
-		    fsize > osd->od_readcache_max_filesize)
-			cache = false;
 		break;
 	}
 
@@ -912,6 +1144,316 @@ static void osd_decay_extent_bytes(struct osd_device *osd,
 		 EXTENT_BYTES_DECAY - 1) / EXTENT_BYTES_DECAY;
 }
 
+/**
+ * Get the write prealloc state of an object, allocated on the first call.
+ *
+ * \param[in] obj	object being written
+ *
+ * \retval		prealloc state, or NULL if it can't be allocated
+ */
+static struct osd_prealloc *osd_prealloc_get(struct osd_object *obj)
+{
+	struct osd_prealloc *op = READ_ONCE(obj->oo_prealloc);
+
+	if (op)
+		return op;
+
+	OBD_ALLOC_PTR(op);
+	if (!op)
+		return NULL;
+
+	spin_lock(&obj->oo_guard);
+	if (!obj->oo_prealloc) {
+		obj->oo_prealloc = op;
+		op = NULL;
+	}
+	spin_unlock(&obj->oo_guard);
+	if (op)
+		OBD_FREE_PTR(op);
+
+	return obj->oo_prealloc;
+}
+
+/**
+ * Stop tracking the reserved extents overlapping blocks [\a start, \a end).
+ *
+ * Called when the user punches, truncates or fallocates that range: the
+ * blocks are either gone or belong to the user from now on, so they must
+ * never be released by osd_write_prealloc_trim().
+ *
+ * \param[in] obj	object
+ * \param[in] start	first block of the range
+ * \param[in] end	block after the range
+ */
+static void osd_prealloc_forget(struct osd_object *obj,
+				ldiskfs_lblk_t start, ldiskfs_lblk_t end)
+{
+	struct osd_prealloc *op = READ_ONCE(obj->oo_prealloc);
+	struct osd_prealloc_extent *ope;
+	int i = 0;
+
+	if (!op)
+		return;
+
+	spin_lock(&obj->oo_guard);
+	while (i < op->op_nr_extents) {
+		ope = &op->op_extents[i];
+		if (ope->ope_start < end &&
+		    ope->ope_start + ope->ope_len > start)
+			*ope = op->op_extents[--op->op_nr_extents];
+		else
+			i++;
+	}
+	spin_unlock(&obj->oo_guard);
+}
+
+/**
+ * Track sequential writes to an object and size the block reservation.
+ *
+ * Clients writing a shared file in an interleaved pattern hit an OST
+ * object with RPCs that arrive slightly out of order, so allocating blocks
+ * per RPC leaves the object badly fragmented. A write landing within one
+ * reservation window of the end of one of the streams of the object extends
+ * that stream. Any other write starts a new stream in a free slot, or in
+ * the slot of the least recently written stream. A stream losing its slot
+ * keeps its reservation, so N-to-1 writers far apart from each other don't
+ * release the blocks reserved for one another.
+ *
+ * Streams not written for OSD_WR_STREAM_IDLE seconds are retired and
+ * \a trim is set, their reservation is released once the transaction
+ * stops, see osd_write_prealloc_trim().
+ *
+ * Once the object is streaming, the window ahead of the stream grows with
+ * the number of sequential writes seen, and is extended to the size the
+ * client reported for the object (\a user_size) when that is larger, as
+ * other clients are writing that range already.
+ *
+ * \param[in] osd	OSD device
+ * \param[in] obj	object being written
+ * \param[in] start	file offset of the first byte written
+ * \param[in] end	file offset after the last byte written
+ * \param[in] user_size	object size reported by the client
+ * \param[out] pa_start	start of the range to reserve
+ * \param[out] trim	set if reservations of idle streams are to be released
+ *
+ * \retval		end of the range to reserve, or 0 if nothing to do
+ */
+static loff_t osd_write_stream_update(struct osd_device *osd,
+				      struct osd_object *obj,
+				      loff_t start, loff_t end,
+				      __u64 user_size, loff_t *pa_start,
+				      bool *trim)
+{
+	loff_t window = READ_ONCE(osd->od_prealloc_max);
+	time64_t now = ktime_get_seconds();
+	struct osd_wr_stream *ows = NULL;
+	struct osd_wr_stream *lru = NULL;
+	struct osd_wr_stream *s;
+	struct osd_prealloc *op;
+	loff_t pa_end = 0;
+	int i;
+
+	if (window == 0)
+		return 0;
+
+	op = osd_prealloc_get(obj);
+	if (!op)
+		return 0;
+
+	spin_lock(&obj->oo_guard);
+	for (i = 0; i < OSD_WR_STREAMS; i++) {
+		s = &op->op_streams[i];
+		if (s->ows_time && s->ows_time + OSD_WR_STREAM_IDLE < now) {
+			if (op->op_nr_extents)
+				*trim = true;
+			memset(s, 0, sizeof(*s));
+		}
+
+		if (s->ows_time && !ows &&
+		    start <= s->ows_end + window &&
+		    start + window >= s->ows_end)
+			ows = s;
+		else if (!lru || s->ows_time < lru->ows_time)
+			lru = s;
+	}
+
+	if (ows) {
+		if (ows->ows_count < OSD_WR_STREAM_MAX)
+			ows->ows_count++;
+		if (end > ows->ows_end)
+			ows->ows_end = end;
+	} else {
+		ows = lru;
+		ows->ows_prealloc_end = 0;
+		ows->ows_count = 0;
+		ows->ows_end = end;
+	}
+	ows->ows_time = now;
+
+	if (ows->ows_count < OSD_WR_STREAM_MIN)
+		goto out;
+
+	atomic64_inc(&osd->od_extent_stats.oes_stream_writes);
+	/* still well inside the window reserved last time */
+	if (ows->ows_prealloc_end >= ows->ows_end + window / 2)
+		goto out;
+
+	pa_end = ows->ows_end +
+		 min_t(loff_t, window, (end - start) * ows->ows_count);
+	if (user_size > pa_end)
+		pa_end = min_t(loff_t, user_size, ows->ows_end + window);
+	pa_end = round_up(pa_end, OSD_DEFAULT_EXTENT_BYTES);
+
+	*pa_start = max(end, ows->ows_prealloc_end);
+	if (pa_end <= *pa_start)
+		pa_end = 0;
+	else
+		ows->ows_prealloc_end = pa_end;
+out:
+	spin_unlock(&obj->oo_guard);
+
+	return pa_end;
+}
+
+/**
+ * Record blocks [\a start, \a start + \a len) reserved by osd_write_prealloc().
+ *
+ * The slot was booked by the caller in op_nr_pending. Extents contiguous to
+ * an already recorded one are merged with it, so a stream whose window is
+ * moved forward keeps using a single slot.
+ */
+static void osd_prealloc_record(struct osd_object *obj,
+				ldiskfs_lblk_t start, unsigned int len)
+{
+	struct osd_prealloc *op = obj->oo_prealloc;
+	struct osd_prealloc_extent *ope;
+	int i;
+
+	spin_lock(&obj->oo_guard);
+	for (i = 0; i < op->op_nr_extents; i++) {
+		ope = &op->op_extents[i];
+		if (ope->ope_start + ope->ope_len == start) {
+			ope->ope_len += len;
+			goto out;
+		}
+	}
+	ope = &op->op_extents[op->op_nr_extents++];
+	ope->ope_start = start;
+	ope->ope_len = len;
+out:
+	spin_unlock(&obj->oo_guard);
+}
+
+/**
+ * Reserve unwritten blocks ahead of a write stream.
+ *
+ * Blocks in [\a start, \a end) not mapped yet are allocated as unwritten
+ * extents past EOF, so that the next RPCs of the stream only convert them
+ * and the object stays contiguous on disk however the RPCs are ordered.
+ * Only the blocks allocated here are recorded in oo_prealloc, to be released
+ * by osd_write_prealloc_trim(): blocks the user fallocated in the range are
+ * already mapped and left alone.
+ * This is best effort: it stops as soon as the transaction runs short of
+ * credits, the allocation fails or no slot is left to record the extents,
+ * the write itself is already mapped.
+ */
+static void osd_write_prealloc(struct osd_device *osd, struct osd_object *obj,
+			       loff_t start, loff_t end)
+{
+	struct osd_extent_stats *oes = &osd->od_extent_stats;
+	handle_t *handle = ldiskfs_journal_current_handle();
+	struct osd_prealloc *op = obj->oo_prealloc;
+	struct inode *inode = obj->oo_inode;
+	struct ldiskfs_map_blocks map;
+	unsigned int credits;
+	bool dirty = false;
+	bool booked;
+	int flags;
+	int rc;
+
+	if (!handle || osd->od_fallocate_zero_blocks != 0 ||
+	    !ldiskfs_test_inode_flag(inode, LDISKFS_INODE_EXTENTS))
+		return;
+
+	start = osd_i_blocks(inode, ALIGN(start, 1 << inode->i_blkbits));
+	end = osd_i_blocks(inode, end);
+	if (end <= start)
+		return;
+
+	map.m_lblk = start;
+	map.m_len = end - start;
+
+	flags = LDISKFS_GET_BLOCKS_CREATE_UNWRIT_EXT;
+#ifdef LDISKFS_GET_BLOCKS_KEEP_SIZE
+	flags |= LDISKFS_GET_BLOCKS_KEEP_SIZE;
+#endif
+	credits = ldiskfs_chunk_trans_blocks(inode, map.m_len);
+
+	while (map.m_len > 0) {
+		if (!ldiskfs_handle_has_enough_credits(handle, credits))
+			break;
+
+		/* book a slot to record what is about to be allocated */
+		spin_lock(&obj->oo_guard);
+		booked = op->op_nr_extents + op->op_nr_pending <
+			 OSD_PREALLOC_EXTENTS;
+		if (booked)
+			op->op_nr_pending++;
+		spin_unlock(&obj->oo_guard);
+		if (!booked)
+			break;
+
+		rc = ldiskfs_map_blocks(handle, inode, &map, flags);
+		if (rc > 0 && map.m_flags & LDISKFS_MAP_NEW)
+			osd_prealloc_record(obj, map.m_lblk, rc);
+
+		spin_lock(&obj->oo_guard);
+		op->op_nr_pending--;
+		spin_unlock(&obj->oo_guard);
+
+		if (rc <= 0) {
+			CDEBUG(D_INODE,
+			       "%s: inode #%lu: prealloc block %u len %u: rc = %d\n",
+			       osd_name(osd), inode->i_ino, map.m_lblk,
+			       map.m_len, rc);
+			break;
+		}
+
+		if (map.m_flags & LDISKFS_MAP_NEW) {
+			lprocfs_oh_tally_log2_pcpu(&oes->oes_prealloc_hist,
+					rc << (inode->i_blkbits - 10));
+			atomic64_add(rc, &oes->oes_prealloc_blocks);
+			dirty = true;
+		}
+		map.m_lblk += rc;
+		map.m_len -= rc;
+	}
+
+	if (dirty) {
+#ifdef LDISKFS_EOFBLOCKS_FL
+		ldiskfs_set_inode_flag(inode, LDISKFS_INODE_EOFBLOCKS);
+#endif
+		ldiskfs_mark_inode_dirty(handle, inode);
+	}
+}
+
+/* have osd_trans_stop() release the reservations of idle streams of \a obj
+ * by osd_write_prealloc_trim() */
+static void osd_write_prealloc_trim_defer(struct osd_object *obj,
+					  struct thandle *th)
+{
+	struct osd_thandle *oh = container_of(th, struct osd_thandle,
+					      ot_super);
+	struct osd_access_lock *al;
+
+	list_for_each_entry(al, &oh->ot_trunc_locks, tl_list) {
+		if (al->tl_obj == obj) {
+			al->tl_trim = true;
+			break;
+		}
+	}
+}
+
 static int osd_ldiskfs_map_inode_pages(struct inode *inode,
 				       struct osd_iobuf *iobuf,
 				       struct osd_device *osd,
@@ -1046,6 +1588,15 @@ cont_map:
 				BRW_ALLOC_TIME : BRW_MAP_TIME;
 			lprocfs_oh_tally_log2_pcpu(&h->bs_hist[idx],
 						   ktime_to_ms(time));
+			if (create && rc > 0 &&
+			    (map.m_flags & LDISKFS_MAP_NEW)) {
+				struct osd_extent_stats *oes =
+					&osd->od_extent_stats;
+
+				lprocfs_oh_tally_log2_pcpu(&oes->oes_alloc_hist,
+					rc << (inode->i_blkbits - 10));
+				atomic64_add(rc, &oes->oes_alloc_blocks);
+			}
 
 			for (; total < blen && c < map.m_len; c++, total++) {
 				if (rc == 0) {
@@ -1131,7 +1682,7 @@ static int osd_write_prep(const struct lu_env *env, struct dt_object *dt,
 			  struct niobuf_local *lnb, int npages)
 {
 	struct osd_thread_info *oti   = osd_oti_get(env);
-	struct osd_iobuf       *iobuf = &oti->oti_iobuf;
+	struct osd_iobuf       *iobuf = oti->oti_iobuf;
 	struct inode           *inode = osd_dt_obj(dt)->oo_inode;
 	struct osd_device      *osd   = osd_obj2dev(osd_dt_obj(dt));
 	ktime_t start, end;
@@ -1396,6 +1947,13 @@ static int osd_declare_write_commit(const struct lu_env *env,
 	else
 		credits += dirty_groups;
 
+	/* one more extent to reserve blocks ahead of a write stream,
+	 * see osd_write_prealloc() */
+	if (osd->od_prealloc_max && osd->od_fallocate_zero_blocks == 0 &&
+	    READ_ONCE(osd_dt_obj(dt)->oo_prealloc))
+		credits += ldiskfs_chunk_trans_blocks(inode,
+				osd->od_prealloc_max >> inode->i_blkbits);
+
 	CDEBUG(D_INODE,
 	       "%s: inode #%lu extent_bytes %u extents %d credits %d\n",
 	       osd_ino2name(inode), inode->i_ino, extent_bytes, extents,
@@ -1436,7 +1994,7 @@ static int osd_write_commit(const struct lu_env *env, struct dt_object *dt,
 			    struct thandle *thandle, __u64 user_size)
 {
 	struct osd_thread_info *oti = osd_oti_get(env);
-	struct osd_iobuf *iobuf = &oti->oti_iobuf;
+	struct osd_iobuf *iobuf = oti->oti_iobuf;
 	struct inode *inode = osd_dt_obj(dt)->oo_inode;
 	struct osd_device  *osd = osd_obj2dev(osd_dt_obj(dt));
 	int rc = 0, i, check_credits = 0;
@@ -1493,10 +2051,38 @@ static int osd_write_commit(const struct lu_env *env, struct dt_object *dt,
 	if (CFS_FAIL_CHECK(OBD_FAIL_OST_MAPBLK_ENOSPC)) {
 		rc = -ENOSPC;
 	} else if (iobuf->dr_npages > 0) {
+		struct blk_plug plug;
+
+		/* extents are mapped and submitted chunk by chunk, keep
+		 * the block layer plugged so all bios of the RPC are
+		 * merged and dispatched together
+		 */
+		blk_start_plug(&plug);
 		rc = osd_ldiskfs_map_inode_pages(inode, iobuf, osd,
 						 1, user_size,
 						 check_credits,
 						 thandle);
+		blk_finish_plug(&plug);
+
+		if (rc == 0 && check_credits) {
+			struct niobuf_local *last = &lnb[npages - 1];
+			loff_t pa_start = 0;
+			loff_t pa_end;
+			bool trim = false;
+
+			atomic64_inc(&osd->od_extent_stats.oes_writes);
+			pa_end = osd_write_stream_update(osd, osd_dt_obj(dt),
+						lnb[0].lnb_file_offset,
+						last->lnb_file_offset +
+						last->lnb_len,
+						user_size, &pa_start, &trim);
+			if (pa_end)
+				osd_write_prealloc(osd, osd_dt_obj(dt),
+						   pa_start, pa_end);
+			if (trim)
+				osd_write_prealloc_trim_defer(osd_dt_obj(dt),
+							      thandle);
+		}
 	} else {
 		/* no pages to write, no transno is needed */
 		thandle->th_local = 1;
@@ -1527,7 +2113,7 @@ static int osd_read_prep(const struct lu_env *env, struct dt_object *dt,
 			 struct niobuf_local *lnb, int npages)
 {
 	struct osd_thread_info *oti = osd_oti_get(env);
-	struct osd_iobuf *iobuf = &oti->oti_iobuf;
+	struct osd_iobuf *iobuf = oti->oti_iobuf;
 	struct inode *inode = osd_dt_obj(dt)->oo_inode;
 	struct osd_device *osd = osd_obj2dev(osd_dt_obj(dt));
 	int rc = 0, i, cache_hits = 0, cache_misses = 0;
@@ -1563,9 +2149,11 @@ static int osd_read_prep(const struct lu_env *env, struct dt_object *dt,
 
 		if (PageUptodate(lnb[i].lnb_page)) {
 			cache_hits++;
+			lnb[i].lnb_cached = 1;
 			unlock_page(lnb[i].lnb_page);
 		} else {
 			cache_misses++;
+			lnb[i].lnb_cached = 0;
 			osd_iobuf_add_page(iobuf, &lnb[i]);
 		}
 		/* no need to unlock in osd_bufs_put(), the sooner page is
@@ -2313,10 +2901,18 @@ static int osd_fallocate_punch(const struct lu_env *env, struct dt_object *dt,
 static int osd_fallocate(const struct lu_env *env, struct dt_object *dt,
 			 __u64 start, __u64 end, int mode, struct thandle *th)
 {
+	struct osd_object *obj = osd_dt_obj(dt);
+	struct inode *inode = obj->oo_inode;
 	int rc;
 
 	ENTRY;
 
+	/* the range is the user's now, don't release it as a reservation */
+	if (inode)
+		osd_prealloc_forget(obj, osd_i_blocks(inode, start),
+				    osd_i_blocks(inode, ALIGN(end,
+						 1 << inode->i_blkbits)));
+
 	if (mode & FALLOC_FL_PUNCH_HOLE) {
 		/* punch */
 		rc = osd_fallocate_punch(env, dt, start, end, mode, th);
@@ -2413,6 +3009,15 @@ static int osd_punch(const struct lu_env *env, struct dt_object *dt,
 	i_size_write(inode, start);
 	spin_unlock(&inode->i_lock);
 
+	/* the truncate drops any block reserved past the new size */
+	osd_prealloc_forget(obj, osd_i_blocks(inode, start), EXT_MAX_BLOCKS);
+	if (obj->oo_prealloc) {
+		spin_lock(&obj->oo_guard);
+		memset(obj->oo_prealloc->op_streams, 0,
+		       sizeof(obj->oo_prealloc->op_streams));
+		spin_unlock(&obj->oo_guard);
+	}
+
 	/* optimize grow case */
 	if (grow) {
 		osd_execute_truncate(obj);
@@ -2523,6 +3128,8 @@ static int osd_ladvise(const struct lu_env *env, struct dt_object *dt,
 			invalidate_mapping_pages(obj->oo_inode->i_mapping,
 						 start >> PAGE_SHIFT,
 						 (end - 1) >> PAGE_SHIFT);
+		if (start == 0 && end >= i_size_read(obj->oo_inode))
+			osd_rcache_del(osd_obj2dev(obj), obj);
 		break;
 	default:
 		rc = -ENOTSUPP;
@@ -2645,6 +3252,9 @@ int osd_trunc_lock(struct osd_object *obj, struct osd_thandle *oh, bool shared)
 	return 0;
 }
 
+static void osd_write_prealloc_trim(const struct lu_env *env,
+				    struct osd_object *obj);
+
 void osd_trunc_unlock_all(const struct lu_env *env, struct list_head *list)
 {
 	struct osd_access_lock *al, *tmp;
@@ -2654,6 +3264,8 @@ void osd_trunc_unlock_all(const struct lu_env *env, struct list_head *list)
 			up_read(&al->tl_obj->oo_ext_idx_sem);
 		else
 			up_write(&al->tl_obj->oo_ext_idx_sem);
+		if (al->tl_trim)
+			osd_write_prealloc_trim(env, al->tl_obj);
 		osd_object_put(env, al->tl_obj);
 		list_del(&al->tl_list);
 		OBD_FREE_PTR(al);
@@ -2757,6 +3369,186 @@ static int osd_execute_punch(const struct lu_env *env, struct osd_object *obj,
 	return rc;
 }
 
+/*
+ * Check if a reserved extent is in the window of a stream still written,
+ * [ows_end - window, ows_prealloc_end). Caller must hold oo_guard.
+ */
+static bool osd_prealloc_extent_live(struct osd_prealloc *op,
+				     struct osd_prealloc_extent *ope,
+				     loff_t window, unsigned int blkbits)
+{
+	loff_t start = (loff_t)ope->ope_start << blkbits;
+	loff_t end = (loff_t)(ope->ope_start + ope->ope_len) << blkbits;
+	struct osd_wr_stream *s;
+	int i;
+
+	for (i = 0; i < OSD_WR_STREAMS; i++) {
+		s = &op->op_streams[i];
+		if (s->ows_time &&
+		    start < max(s->ows_end, s->ows_prealloc_end) &&
+		    end + window > s->ows_end)
+			return true;
+	}
+
+	return false;
+}
+
+/* check if block \a lblk is in one of the \a nr extents \a ext, return the
+ * block after that extent or 0 */
+static ldiskfs_lblk_t osd_prealloc_extent_end(struct osd_prealloc_extent *ext,
+					      int nr, ldiskfs_lblk_t lblk)
+{
+	int i;
+
+	for (i = 0; i < nr; i++)
+		if (lblk >= ext[i].ope_start &&
+		    lblk < ext[i].ope_start + ext[i].ope_len)
+			return ext[i].ope_start + ext[i].ope_len;
+
+	return 0;
+}
+
+/*
+ * Check if all the blocks mapped past block \a eof are in the \a nr extents
+ * \a ext, so a truncate drops nothing else, e.g. space the user fallocated
+ * with FALLOC_FL_KEEP_SIZE.
+ */
+static bool osd_prealloc_owns_eof(struct inode *inode, ldiskfs_lblk_t eof,
+				  struct osd_prealloc_extent *ext, int nr)
+{
+	struct ldiskfs_map_blocks map;
+	ldiskfs_lblk_t end;
+	int rc;
+
+	map.m_lblk = eof;
+	while (map.m_lblk < EXT_MAX_BLOCKS) {
+		map.m_len = EXT_MAX_BLOCKS - map.m_lblk;
+		rc = ldiskfs_map_blocks(NULL, inode, &map, 0);
+		if (rc < 0)
+			return false;
+		if (rc == 0) {
+			/* hole, m_len is trimmed to its size */
+			map.m_lblk += max_t(unsigned int, map.m_len, 1);
+			continue;
+		}
+		end = map.m_lblk + rc;
+		while (map.m_lblk < end) {
+			map.m_lblk = osd_prealloc_extent_end(ext, nr,
+							     map.m_lblk);
+			if (map.m_lblk == 0)
+				return false;
+		}
+		map.m_lblk = end;
+	}
+
+	return true;
+}
+
+/*
+ * Punch the blocks of a reserved extent which are still unwritten, below
+ * block \a eof, return the number of blocks of the extent past \a eof.
+ */
+static int osd_prealloc_extent_release(const struct lu_env *env,
+				       struct osd_object *obj,
+				       struct osd_prealloc_extent *ope,
+				       ldiskfs_lblk_t eof)
+{
+	struct inode *inode = obj->oo_inode;
+	struct ldiskfs_map_blocks map;
+	ldiskfs_lblk_t last = ope->ope_start + ope->ope_len;
+	int rc = 0;
+
+	map.m_lblk = ope->ope_start;
+	while (map.m_lblk < min(last, eof)) {
+		map.m_len = min(last, eof) - map.m_lblk;
+		rc = ldiskfs_map_blocks(NULL, inode, &map, 0);
+		if (rc < 0)
+			break;
+		if (rc == 0) {
+			/* hole, m_len is trimmed to its size */
+			map.m_lblk += max_t(unsigned int, map.m_len, 1);
+			continue;
+		}
+		map.m_len = rc;
+		if (map.m_flags & LDISKFS_MAP_UNWRITTEN) {
+			rc = osd_execute_punch(env, obj,
+				(loff_t)map.m_lblk << inode->i_blkbits,
+				(loff_t)(map.m_lblk + map.m_len) <<
+				inode->i_blkbits,
+				FALLOC_FL_PUNCH_HOLE | FALLOC_FL_KEEP_SIZE);
+			if (rc < 0)
+				break;
+		}
+		map.m_lblk += map.m_len;
+	}
+	if (rc < 0)
+		CDEBUG(D_INODE, "%s: inode #%lu: release block %u len %u: rc = %d\n",
+		       osd_name(osd_obj2dev(obj)), inode->i_ino,
+		       ope->ope_start, ope->ope_len, rc);
+
+	return last > eof ? last - max(ope->ope_start, eof) : 0;
+}
+
+/**
+ * Release the blocks reserved ahead of write streams which went idle.
+ *
+ * Called once the transaction of the write which noticed an idle stream is
+ * stopped. Only the extents osd_write_prealloc() allocated and recorded are
+ * released, and none in the window of a stream still written. The writes in
+ * flight hold oo_ext_idx_sem shared until they have updated the object size,
+ * so with it held exclusive the blocks of those extents still unwritten were
+ * not used by anyone. Those below EOF read as zeroes and are punched. Blocks
+ * past EOF can only be dropped by a truncate, which is done only when they
+ * were all reserved here, otherwise they are kept until the object is
+ * truncated or destroyed.
+ *
+ * \param[in] env	execution environment
+ * \param[in] obj	object written
+ */
+static void osd_write_prealloc_trim(const struct lu_env *env,
+				    struct osd_object *obj)
+{
+	struct osd_prealloc_extent ext[OSD_PREALLOC_EXTENTS];
+	struct osd_prealloc *op = obj->oo_prealloc;
+	struct inode *inode = obj->oo_inode;
+	struct osd_prealloc_extent *ope;
+	ldiskfs_lblk_t eof;
+	loff_t window;
+	int past_eof = 0;
+	int nr = 0;
+	int i = 0;
+
+	LASSERT(!journal_current_handle());
+
+	down_write(&obj->oo_ext_idx_sem);
+	if (!inode || !op || obj->oo_destroyed || inode->i_nlink == 0)
+		goto out;
+
+	window = READ_ONCE(osd_obj2dev(obj)->od_prealloc_max);
+	spin_lock(&obj->oo_guard);
+	while (i < op->op_nr_extents) {
+		ope = &op->op_extents[i];
+		if (osd_prealloc_extent_live(op, ope, window,
+					     inode->i_blkbits)) {
+			i++;
+			continue;
+		}
+		ext[nr++] = *ope;
+		*ope = op->op_extents[--op->op_nr_extents];
+	}
+	spin_unlock(&obj->oo_guard);
+
+	eof = osd_i_blocks(inode, ALIGN(i_size_read(inode),
+					1 << inode->i_blkbits));
+	for (i = 0; i < nr; i++)
+		past_eof += osd_prealloc_extent_release(env, obj, &ext[i], eof);
+
+	if (past_eof && osd_prealloc_owns_eof(inode, eof, ext, nr))
+		osd_execute_truncate(obj);
+out:
+	up_write(&obj->oo_ext_idx_sem);
+}
+
 int osd_process_truncates(const struct lu_env *env, struct list_head *list)
 {
 	struct osd_access_lock *al;
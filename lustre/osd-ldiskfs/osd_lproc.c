@@ -479,6 +479,46 @@ static ssize_t full_scrub_threshold_rate_store(struct kobject *kobj,
 }
 LUSTRE_RW_ATTR(full_scrub_threshold_rate);
 
+static ssize_t scrub_threads_show(struct kobject *kobj, struct attribute *attr,
+				  char *buf)
+{
+	struct dt_device *dt = container_of(kobj, struct dt_device,
+					    dd_kobj);
+	struct osd_device *dev = osd_dt_dev(dt);
+
+	LASSERT(dev);
+	if (unlikely(!dev->od_mnt))
+		return -EINPROGRESS;
+
+	return sprintf(buf, "%u\n", dev->od_scrub_threads);
+}
+
+static ssize_t scrub_threads_store(struct kobject *kobj, struct attribute *attr,
+				   const char *buffer, size_t count)
+{
+	struct dt_device *dt = container_of(kobj, struct dt_device,
+					    dd_kobj);
+	struct osd_device *dev = osd_dt_dev(dt);
+	unsigned int val;
+	int rc;
+
+	LASSERT(dev);
+	if (unlikely(!dev->od_mnt))
+		return -EINPROGRESS;
+
+	rc = kstrtouint(buffer, 0, &val);
+	if (rc)
+		return rc;
+
+	if (val < 1 || val > OSD_SCRUB_THREADS_MAX)
+		return -ERANGE;
+
+	/* takes effect when the next OI scrub starts */
+	dev->od_scrub_threads = val;
+	return count;
+}
+LUSTRE_RW_ATTR(scrub_threads);
+
 static ssize_t extent_bytes_allocation_show(struct kobject *kobj,
 					    struct attribute *attr, char *buf)
 {
@@ -497,6 +537,225 @@ static ssize_t extent_bytes_allocation_show(struct kobject *kobj,
 }
 LUSTRE_RO_ATTR(extent_bytes_allocation);
 
+static ssize_t write_prealloc_max_show(struct kobject *kobj,
+				       struct attribute *attr, char *buf)
+{
+	struct dt_device *dt = container_of(kobj, struct dt_device,
+					    dd_kobj);
+	struct osd_device *osd = osd_dt_dev(dt);
+
+	return scnprintf(buf, PAGE_SIZE, "%u\n", osd->od_prealloc_max);
+}
+
+/*
+ * Set the window of unwritten blocks reserved ahead of sequential writers
+ * of an object, in bytes. Zero, the default, disables write preallocation.
+ */
+static ssize_t write_prealloc_max_store(struct kobject *kobj,
+					struct attribute *attr,
+					const char *buffer, size_t count)
+{
+	struct dt_device *dt = container_of(kobj, struct dt_device,
+					    dd_kobj);
+	struct osd_device *osd = osd_dt_dev(dt);
+	u64 val;
+	int rc;
+
+	rc = sysfs_memparse(buffer, count, &val, "B");
+	if (rc < 0)
+		return rc;
+
+	if (val > OSD_MAX_PREALLOC_BYTES)
+		return -ERANGE;
+
+	osd->od_prealloc_max = val;
+	return count;
+}
+LUSTRE_RW_ATTR(write_prealloc_max);
+
+static ssize_t readcache_budget_mb_show(struct kobject *kobj,
+					struct attribute *attr, char *buf)
+{
+	struct dt_device *dt = container_of(kobj, struct dt_device,
+					    dd_kobj);
+	struct osd_device *osd = osd_dt_dev(dt);
+
+	return scnprintf(buf, PAGE_SIZE, "%lu\n",
+			 osd->od_rcache.orc_max_pages >> (20 - PAGE_SHIFT));
+}
+
+/*
+ * Set the memory the read cache manager lets cached objects hold, in MiB.
+ * Zero disables the manager and every read goes through the page cache
+ * as permitted by read_cache_enable and readcache_max_filesize.
+ */
+static ssize_t readcache_budget_mb_store(struct kobject *kobj,
+					 struct attribute *attr,
+					 const char *buffer, size_t count)
+{
+	struct dt_device *dt = container_of(kobj, struct dt_device,
+					    dd_kobj);
+	struct osd_device *osd = osd_dt_dev(dt);
+	unsigned long val;
+	int rc;
+
+	rc = kstrtoul(buffer, 0, &val);
+	if (rc)
+		return rc;
+
+	if (val > cfs_totalram_pages() >> (20 - PAGE_SHIFT))
+		return -ERANGE;
+
+	osd_rcache_resize(osd, val << (20 - PAGE_SHIFT));
+	return count;
+}
+LUSTRE_RW_ATTR(readcache_budget_mb);
+
+static ssize_t readcache_admit_reads_show(struct kobject *kobj,
+					  struct attribute *attr, char *buf)
+{
+	struct dt_device *dt = container_of(kobj, struct dt_device,
+					    dd_kobj);
+	struct osd_device *osd = osd_dt_dev(dt);
+
+	return scnprintf(buf, PAGE_SIZE, "%u\n", osd->od_rcache.orc_admit);
+}
+
+/* reads of an object before the read cache manager admits it */
+static ssize_t readcache_admit_reads_store(struct kobject *kobj,
+					   struct attribute *attr,
+					   const char *buffer, size_t count)
+{
+	struct dt_device *dt = container_of(kobj, struct dt_device,
+					    dd_kobj);
+	struct osd_device *osd = osd_dt_dev(dt);
+	unsigned int val;
+	int rc;
+
+	rc = kstrtouint(buffer, 0, &val);
+	if (rc)
+		return rc;
+
+	if (val < 1)
+		return -ERANGE;
+
+	osd->od_rcache.orc_admit = val;
+	return count;
+}
+LUSTRE_RW_ATTR(readcache_admit_reads);
+
+static int ldiskfs_osd_readcache_stats_seq_show(struct seq_file *m, void *data)
+{
+	struct osd_device *osd = osd_dt_dev((struct dt_device *)m->private);
+
+	LASSERT(osd != NULL);
+	return osd_rcache_seq_show(m, &osd->od_rcache);
+}
+
+static ssize_t
+ldiskfs_osd_readcache_stats_seq_write(struct file *file,
+				      const char __user *buf,
+				      size_t count, loff_t *off)
+{
+	struct seq_file *m = file->private_data;
+	struct osd_device *osd = osd_dt_dev((struct dt_device *)m->private);
+
+	osd_rcache_stats_clear(&osd->od_rcache);
+	return count;
+}
+
+LDEBUGFS_SEQ_FOPS(ldiskfs_osd_readcache_stats);
+
+static void osd_extent_hist_show(struct seq_file *m, const char *name,
+				 struct obd_hist_pcpu *hist)
+{
+	unsigned long tot, cum = 0;
+	int i;
+
+	seq_printf(m, "\n%-22s %-8s %% cum %%\n", name, "extents");
+	tot = lprocfs_oh_sum_pcpu(hist);
+	if (tot == 0)
+		return;
+
+	for (i = 0; i < OBD_HIST_MAX; i++) {
+		unsigned long n = lprocfs_oh_counter_pcpu(hist, i);
+
+		cum += n;
+		if (cum == 0)
+			continue;
+
+		if (i < 10)
+			seq_printf(m, "%luK", BIT(i));
+		else if (i < 20)
+			seq_printf(m, "%luM", BIT(i - 10));
+		else
+			seq_printf(m, "%luG", BIT(i - 20));
+
+		seq_printf(m, ":\t\t%10lu %3u %3u\n", n, pct(n, tot),
+			   pct(cum, tot));
+		if (cum == tot)
+			break;
+	}
+}
+
+static int ldiskfs_osd_extent_stats_seq_show(struct seq_file *m, void *data)
+{
+	struct osd_device *osd = osd_dt_dev((struct dt_device *)m->private);
+	struct osd_extent_stats *oes = &osd->od_extent_stats;
+	unsigned long extents;
+	u64 blocks;
+
+	LASSERT(osd != NULL);
+	if (unlikely(osd->od_mnt == NULL))
+		return -EINPROGRESS;
+
+	/* this sampling races with updates */
+	lprocfs_stats_header(m, ktime_get_real(), oes->oes_init, 25, ":",
+			     true, "");
+
+	blocks = atomic64_read(&oes->oes_alloc_blocks);
+	extents = lprocfs_oh_sum_pcpu(&oes->oes_alloc_hist);
+	seq_printf(m, "%-25s %llu\n", "allocating_writes:",
+		   (u64)atomic64_read(&oes->oes_writes));
+	seq_printf(m, "%-25s %llu\n", "stream_writes:",
+		   (u64)atomic64_read(&oes->oes_stream_writes));
+	seq_printf(m, "%-25s %llu\n", "written_blocks:", blocks);
+	seq_printf(m, "%-25s %lu\n", "written_extents:", extents);
+	seq_printf(m, "%-25s %llu\n", "avg_extent_kb:",
+		   extents ? (blocks << (osd_sb(osd)->s_blocksize_bits - 10)) /
+			     extents : 0);
+	seq_printf(m, "%-25s %llu\n", "prealloc_blocks:",
+		   (u64)atomic64_read(&oes->oes_prealloc_blocks));
+	seq_printf(m, "%-25s %lu\n", "prealloc_extents:",
+		   lprocfs_oh_sum_pcpu(&oes->oes_prealloc_hist));
+
+	osd_extent_hist_show(m, "written extent size", &oes->oes_alloc_hist);
+	osd_extent_hist_show(m, "prealloc extent size",
+			     &oes->oes_prealloc_hist);
+	return 0;
+}
+
+static ssize_t
+ldiskfs_osd_extent_stats_seq_write(struct file *file, const char __user *buf,
+				   size_t count, loff_t *off)
+{
+	struct seq_file *m = file->private_data;
+	struct osd_device *osd = osd_dt_dev((struct dt_device *)m->private);
+	struct osd_extent_stats *oes = &osd->od_extent_stats;
+
+	lprocfs_oh_clear_pcpu(&oes->oes_alloc_hist);
+	lprocfs_oh_clear_pcpu(&oes->oes_prealloc_hist);
+	atomic64_set(&oes->oes_alloc_blocks, 0);
+	atomic64_set(&oes->oes_prealloc_blocks, 0);
+	atomic64_set(&oes->oes_stream_writes, 0);
+	atomic64_set(&oes->oes_writes, 0);
+	oes->oes_init = ktime_get_real();
+
+	return count;
+}
+
+LDEBUGFS_SEQ_FOPS(ldiskfs_osd_extent_stats);
+
 static int ldiskfs_osd_oi_scrub_seq_show(struct seq_file *m, void *data)
 {
 	struct osd_device *dev = osd_dt_dev((struct dt_device *)m->private);
@@ -770,6 +1029,10 @@ struct ldebugfs_vars ldebugfs_osd_obd_vars[] = {
 	  .fops =	&ldiskfs_osd_readcache_max_io_fops      },
 	{ .name =	"writethrough_max_io_mb",
 	  .fops =	&ldiskfs_osd_writethrough_max_io_fops   },
+	{ .name =	"extent_stats",
+	  .fops =	&ldiskfs_osd_extent_stats_fops	},
+	{ .name =	"readcache_stats",
+	  .fops =	&ldiskfs_osd_readcache_stats_fops	},
 	{ NULL }
 };
 
@@ -787,7 +1050,11 @@ static struct attribute *ldiskfs_attrs[] = {
 	&lustre_attr_pdo.attr,
 	&lustre_attr_full_scrub_ratio.attr,
 	&lustre_attr_full_scrub_threshold_rate.attr,
+	&lustre_attr_scrub_threads.attr,
 	&lustre_attr_extent_bytes_allocation.attr,
+	&lustre_attr_write_prealloc_max.attr,
+	&lustre_attr_readcache_budget_mb.attr,
+	&lustre_attr_readcache_admit_reads.attr,
 	NULL,
 };
 
@@ -848,6 +1115,8 @@ out:
 int osd_procfs_fini(struct osd_device *osd)
 {
 	lprocfs_fini_brw_stats(&osd->od_brw_stats);
+	lprocfs_oh_release_pcpu(&osd->od_extent_stats.oes_prealloc_hist);
+	lprocfs_oh_release_pcpu(&osd->od_extent_stats.oes_alloc_hist);
 
 	if (osd->od_stats)
 		lprocfs_stats_free(&osd->od_stats);
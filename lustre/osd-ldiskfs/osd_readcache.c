@@ -0,0 +1,398 @@
+/*
+ * GPL HEADER START
+ *
+ * DO NOT ALTER OR REMOVE COPYRIGHT NOTICES OR THIS FILE HEADER.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 only,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License version 2 for more details (a copy is included
+ * in the LICENSE file that accompanied this code).
+ *
+ * You should have received a copy of the GNU General Public License
+ * version 2 along with this program; If not, see
+ * http://www.gnu.org/licenses/gpl-2.0.html
+ *
+ * GPL HEADER END
+ */
+/*
+ * This file is part of Lustre, http://www.lustre.org/
+ *
+ * lustre/osd-ldiskfs/osd_readcache.c
+ *
+ * Read cache manager of the OSS.
+ *
+ * Without it, any object read through the page cache stays there until the
+ * kernel reclaims it, so a single large scan pushes out the hot working set
+ * of other clients. The manager decides which objects are read through the
+ * page cache and bounds the pages they hold:
+ *
+ * - an object is admitted once it has been read osd_rcache::orc_admit times
+ *   while it stays in the object cache, or when a client asks to prefetch it
+ *   with ladvise willread; reads of other objects bypass the page cache.
+ * - resident objects are kept on two LRU lists as in ARC: T1 for objects read
+ *   once since admission and T2 for objects read again or hinted. Evicted
+ *   objects leave their FID on ghost lists B1 and B2, a read of a ghost
+ *   re-admits the object to T2 and moves the T1 target towards the list
+ *   that would have kept it.
+ * - when the pages charged to resident objects exceed the budget, the LRU
+ *   object of T1 or T2 is evicted by dropping its clean pages.
+ *
+ * Pages are charged to an object from the size of its mapping when it is
+ * read, the accounting is an estimate as the kernel can drop pages at any
+ * time without telling us.
+ */
+
+#define DEBUG_SUBSYSTEM S_OSD
+
+#include "osd_internal.h"
+
+/* objects evicted in one pass, their pages are dropped after unlocking */
+#define OSD_RC_EVICT_BATCH	8
+
+struct osd_rc_ghost {
+	struct hlist_node	org_hash;
+	struct list_head	org_list;
+	struct lu_fid		org_fid;
+	unsigned long		org_pages;
+	enum osd_rc_list	org_where;
+};
+
+void osd_rcache_init(struct osd_rcache *rc)
+{
+	int i;
+
+	spin_lock_init(&rc->orc_lock);
+	INIT_LIST_HEAD(&rc->orc_t1);
+	INIT_LIST_HEAD(&rc->orc_t2);
+	INIT_LIST_HEAD(&rc->orc_b1);
+	INIT_LIST_HEAD(&rc->orc_b2);
+	for (i = 0; i < ARRAY_SIZE(rc->orc_ghost_hash); i++)
+		INIT_HLIST_HEAD(&rc->orc_ghost_hash[i]);
+	rc->orc_admit = OSD_RC_ADMIT_DEF;
+	rc->orc_ghost_max = OSD_RC_GHOST_MAX;
+	rc->orc_init = ktime_get_real();
+}
+
+void osd_rcache_fini(struct osd_rcache *rc)
+{
+	struct osd_rc_ghost *g, *tmp;
+
+	list_splice_init(&rc->orc_b2, &rc->orc_b1);
+	list_for_each_entry_safe(g, tmp, &rc->orc_b1, org_list) {
+		list_del(&g->org_list);
+		OBD_FREE_PTR(g);
+	}
+	LASSERTF(list_empty(&rc->orc_t1) && list_empty(&rc->orc_t2),
+		 "resident objects left in read cache\n");
+}
+
+static inline struct hlist_head *osd_rc_ghost_head(struct osd_rcache *rc,
+						   const struct lu_fid *fid)
+{
+	return &rc->orc_ghost_hash[fid_hash(fid, OSD_RC_GHOST_BITS)];
+}
+
+static struct osd_rc_ghost *osd_rc_ghost_find(struct osd_rcache *rc,
+					      const struct lu_fid *fid)
+{
+	struct osd_rc_ghost *g;
+
+	hlist_for_each_entry(g, osd_rc_ghost_head(rc, fid), org_hash) {
+		if (lu_fid_eq(&g->org_fid, fid))
+			return g;
+	}
+
+	return NULL;
+}
+
+static void osd_rc_ghost_unlink(struct osd_rcache *rc, struct osd_rc_ghost *g)
+{
+	hlist_del(&g->org_hash);
+	list_del(&g->org_list);
+	if (g->org_where == OSD_RC_T1)
+		rc->orc_b1_count--;
+	else
+		rc->orc_b2_count--;
+}
+
+/* remember an evicted object on the ghost list matching \a where */
+static void osd_rc_ghost_add(struct osd_rcache *rc, const struct lu_fid *fid,
+			     unsigned long pages, enum osd_rc_list where)
+{
+	struct osd_rc_ghost *g = NULL;
+
+	if (rc->orc_b1_count + rc->orc_b2_count >= rc->orc_ghost_max) {
+		/* recycle the oldest ghost of the longer list */
+		if (rc->orc_b1_count > rc->orc_b2_count)
+			g = list_first_entry(&rc->orc_b1, struct osd_rc_ghost,
+					     org_list);
+		else if (rc->orc_b2_count > 0)
+			g = list_first_entry(&rc->orc_b2, struct osd_rc_ghost,
+					     org_list);
+		if (!g)
+			return;
+		osd_rc_ghost_unlink(rc, g);
+	} else {
+		OBD_ALLOC_GFP(g, sizeof(*g), GFP_ATOMIC);
+		if (!g)
+			return;
+	}
+
+	g->org_fid = *fid;
+	g->org_pages = pages;
+	g->org_where = where;
+	hlist_add_head(&g->org_hash, osd_rc_ghost_head(rc, fid));
+	if (where == OSD_RC_T1) {
+		list_add_tail(&g->org_list, &rc->orc_b1);
+		rc->orc_b1_count++;
+	} else {
+		list_add_tail(&g->org_list, &rc->orc_b2);
+		rc->orc_b2_count++;
+	}
+}
+
+static void osd_rc_unlink(struct osd_rcache *rc, struct osd_object *obj)
+{
+	list_del_init(&obj->oo_rc_list);
+	if (obj->oo_rc_where == OSD_RC_T1)
+		rc->orc_t1_pages -= obj->oo_rc_pages;
+	else
+		rc->orc_t2_pages -= obj->oo_rc_pages;
+	obj->oo_rc_where = OSD_RC_NONE;
+	obj->oo_rc_pages = 0;
+	obj->oo_rc_reads = 0;
+}
+
+static void osd_rc_link(struct osd_rcache *rc, struct osd_object *obj,
+			enum osd_rc_list where, unsigned long pages)
+{
+	obj->oo_rc_where = where;
+	obj->oo_rc_pages = pages;
+	if (where == OSD_RC_T1) {
+		list_add_tail(&obj->oo_rc_list, &rc->orc_t1);
+		rc->orc_t1_pages += pages;
+	} else {
+		list_add_tail(&obj->oo_rc_list, &rc->orc_t2);
+		rc->orc_t2_pages += pages;
+	}
+}
+
+/**
+ * Evict resident objects until the budget is met.
+ *
+ * The victim is the LRU object of T1 while T1 holds more than its target,
+ * of T2 otherwise. Victims move to the ghost lists under the lock, their
+ * inodes are pinned and their pages dropped once the lock is released.
+ * Inodes of destroyed objects are skipped, their pages go away with the
+ * truncate anyway.
+ *
+ * \param[in] osd	OSD device
+ * \param[in] keep	object being read, never evicted
+ */
+static void osd_rc_evict(struct osd_device *osd, struct osd_object *keep)
+{
+	struct osd_rcache *rc = &osd->od_rcache;
+	struct inode *victims[OSD_RC_EVICT_BATCH];
+	int nr = 0;
+	int i;
+
+	spin_lock(&rc->orc_lock);
+	while (rc->orc_max_pages &&
+	       rc->orc_t1_pages + rc->orc_t2_pages > rc->orc_max_pages &&
+	       nr < OSD_RC_EVICT_BATCH) {
+		struct list_head *list;
+		struct osd_object *obj;
+		enum osd_rc_list where;
+
+		if (!list_empty(&rc->orc_t1) &&
+		    (rc->orc_t1_pages > rc->orc_target ||
+		     list_empty(&rc->orc_t2)))
+			list = &rc->orc_t1;
+		else
+			list = &rc->orc_t2;
+		if (list_empty(list))
+			break;
+
+		obj = list_first_entry(list, struct osd_object, oo_rc_list);
+		if (obj == keep) {
+			/* the only object left is the one being read */
+			if (list_is_singular(list))
+				break;
+			list_move_tail(&obj->oo_rc_list, list);
+			continue;
+		}
+
+		where = obj->oo_rc_where;
+		osd_rc_ghost_add(rc, lu_object_fid(&obj->oo_dt.do_lu),
+				 obj->oo_rc_pages, where);
+		osd_rc_unlink(rc, obj);
+		rc->orc_evictions++;
+
+		if (obj->oo_inode && obj->oo_inode->i_nlink > 0) {
+			victims[nr] = igrab(obj->oo_inode);
+			if (victims[nr])
+				nr++;
+		}
+	}
+	spin_unlock(&rc->orc_lock);
+
+	for (i = 0; i < nr; i++) {
+		invalidate_mapping_pages(victims[i]->i_mapping, 0, -1);
+		iput(victims[i]);
+	}
+}
+
+/**
+ * Account a read of \a obj and decide whether it goes through page cache.
+ *
+ * \param[in] osd	OSD device
+ * \param[in] obj	object being read
+ * \param[in] npages	pages of the read
+ * \param[in] hint	read is a prefetch asked by ladvise willread
+ *
+ * \retval true		read the object through the page cache
+ * \retval false	bypass the page cache for this read
+ */
+bool osd_rcache_access(struct osd_device *osd, struct osd_object *obj,
+		       int npages, bool hint)
+{
+	struct osd_rcache *rc = &osd->od_rcache;
+	unsigned long pages;
+	struct osd_rc_ghost *g;
+	bool cache = true;
+
+	if (!READ_ONCE(rc->orc_max_pages) || !obj->oo_inode)
+		return true;
+
+	pages = READ_ONCE(obj->oo_inode->i_mapping->nrpages) + npages;
+
+	spin_lock(&rc->orc_lock);
+	if (hint)
+		rc->orc_hints++;
+
+	if (obj->oo_rc_where != OSD_RC_NONE) {
+		/* resident: a second read makes it frequent */
+		rc->orc_hits++;
+		osd_rc_unlink(rc, obj);
+		osd_rc_link(rc, obj, OSD_RC_T2, pages);
+		goto out;
+	}
+
+	g = osd_rc_ghost_find(rc, lu_object_fid(&obj->oo_dt.do_lu));
+	if (g) {
+		unsigned long delta;
+
+		/* evicted too early: grow the list which lost it */
+		rc->orc_ghost_hits++;
+		if (g->org_where == OSD_RC_T1) {
+			delta = max_t(unsigned long, g->org_pages, 1) *
+				max(rc->orc_b2_count / max(rc->orc_b1_count, 1U),
+				    1U);
+			rc->orc_target = min(rc->orc_target + delta,
+					     rc->orc_max_pages);
+		} else {
+			delta = max_t(unsigned long, g->org_pages, 1) *
+				max(rc->orc_b1_count / max(rc->orc_b2_count, 1U),
+				    1U);
+			rc->orc_target = rc->orc_target > delta ?
+					 rc->orc_target - delta : 0;
+		}
+		osd_rc_ghost_unlink(rc, g);
+		OBD_FREE_PTR(g);
+		rc->orc_admits++;
+		osd_rc_link(rc, obj, OSD_RC_T2, pages);
+		goto out;
+	}
+
+	if (hint || ++obj->oo_rc_reads >= rc->orc_admit) {
+		rc->orc_admits++;
+		osd_rc_link(rc, obj, hint ? OSD_RC_T2 : OSD_RC_T1, pages);
+		goto out;
+	}
+
+	rc->orc_bypass++;
+	cache = false;
+out:
+	spin_unlock(&rc->orc_lock);
+
+	if (cache)
+		osd_rc_evict(osd, obj);
+
+	return cache;
+}
+
+/* forget \a obj, on object deletion or ladvise dontneed */
+void osd_rcache_del(struct osd_device *osd, struct osd_object *obj)
+{
+	struct osd_rcache *rc = &osd->od_rcache;
+
+	if (obj->oo_rc_where == OSD_RC_NONE && obj->oo_rc_reads == 0)
+		return;
+
+	spin_lock(&rc->orc_lock);
+	if (obj->oo_rc_where != OSD_RC_NONE)
+		osd_rc_unlink(rc, obj);
+	obj->oo_rc_reads = 0;
+	spin_unlock(&rc->orc_lock);
+}
+
+/* apply a new budget, evicting objects if needed */
+void osd_rcache_resize(struct osd_device *osd, unsigned long max_pages)
+{
+	struct osd_rcache *rc = &osd->od_rcache;
+
+	spin_lock(&rc->orc_lock);
+	rc->orc_max_pages = max_pages;
+	if (rc->orc_target > max_pages)
+		rc->orc_target = max_pages;
+	spin_unlock(&rc->orc_lock);
+
+	while (max_pages &&
+	       READ_ONCE(rc->orc_t1_pages) + READ_ONCE(rc->orc_t2_pages) >
+	       max_pages) {
+		unsigned long evicted = rc->orc_evictions;
+
+		osd_rc_evict(osd, NULL);
+		if (evicted == READ_ONCE(rc->orc_evictions))
+			break;
+	}
+}
+
+int osd_rcache_seq_show(struct seq_file *m, struct osd_rcache *rc)
+{
+	/* this sampling races with updates */
+	lprocfs_stats_header(m, ktime_get_real(), rc->orc_init, 20, ":",
+			     true, "");
+	seq_printf(m, "%-20s %lu\n", "budget_pages:", rc->orc_max_pages);
+	seq_printf(m, "%-20s %lu\n", "t1_target_pages:", rc->orc_target);
+	seq_printf(m, "%-20s %lu\n", "t1_pages:", rc->orc_t1_pages);
+	seq_printf(m, "%-20s %lu\n", "t2_pages:", rc->orc_t2_pages);
+	seq_printf(m, "%-20s %u\n", "b1_ghosts:", rc->orc_b1_count);
+	seq_printf(m, "%-20s %u\n", "b2_ghosts:", rc->orc_b2_count);
+	seq_printf(m, "%-20s %lu\n", "resident_hits:", rc->orc_hits);
+	seq_printf(m, "%-20s %lu\n", "ghost_hits:", rc->orc_ghost_hits);
+	seq_printf(m, "%-20s %lu\n", "admits:", rc->orc_admits);
+	seq_printf(m, "%-20s %lu\n", "hints:", rc->orc_hints);
+	seq_printf(m, "%-20s %lu\n", "bypass:", rc->orc_bypass);
+	seq_printf(m, "%-20s %lu\n", "evictions:", rc->orc_evictions);
+
+	return 0;
+}
+
+void osd_rcache_stats_clear(struct osd_rcache *rc)
+{
+	spin_lock(&rc->orc_lock);
+	rc->orc_hits = 0;
+	rc->orc_ghost_hits = 0;
+	rc->orc_admits = 0;
+	rc->orc_hints = 0;
+	rc->orc_bypass = 0;
+	rc->orc_evictions = 0;
+	rc->orc_init = ktime_get_real();
+	spin_unlock(&rc->orc_lock);
+}
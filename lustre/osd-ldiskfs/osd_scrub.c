@@ -285,7 +285,7 @@ int osd_scrub_refresh_mapping(struct osd_thread_info *info,
 
 static int
 osd_scrub_check_update(struct osd_thread_info *info, struct osd_device *dev,
-		       struct osd_idmap_cache *oic, int val)
+		       struct osd_idmap_cache *oic, int val, bool prior)
 {
 	struct lustre_scrub *scrub = &dev->od_scrub.os_scrub;
 	struct scrub_file *sf = &scrub->os_file;
@@ -297,11 +297,25 @@ osd_scrub_check_update(struct osd_thread_info *info, struct osd_device *dev,
 	int ops = DTO_INDEX_UPDATE;
 	bool exist = false;
 	bool bad_inode = false;
+	bool igif = false;
+	bool failed = false;
+	__u32 sf_flags = 0;
+	__u32 latest_start;
+	int updated = 0;
+	int recreated = -1;
 	int flags = 0;
 	int rc;
 
 	ENTRY;
+	/* os_rwsem only covers the scrub file, the OI lookups and updates
+	 * below are done without it so that several scrub threads can run
+	 * them in parallel
+	 */
 	down_write(&scrub->os_rwsem);
+	scrub->os_new_checked++;
+	latest_start = sf->sf_pos_latest_start;
+	up_write(&scrub->os_rwsem);
+
 	/* remove IDIF support to simplify logic */
 	if (val == SCRUB_NEXT_OSTOBJ_OLD)
 		GOTO(out, rc = -EOPNOTSUPP);
@@ -309,24 +323,23 @@ osd_scrub_check_update(struct osd_thread_info *info, struct osd_device *dev,
 	if (val == SCRUB_NEXT_OSTOBJ)
 		flags = OI_KNOWN_ON_OST;
 
-	scrub->os_new_checked++;
 	if (val < 0)
 		GOTO(out, rc = val);
 
-	if (scrub->os_in_prior) {
+	if (prior) {
 		oii = list_entry(oic, struct osd_inconsistent_item,
 				 oii_cache);
 		if (CFS_FAIL_CHECK(OBD_FAIL_OSD_SCRUB_STALE))
 			GOTO(out, rc = -ESTALE);
 	}
 
-	if (lid->oii_ino < sf->sf_pos_latest_start && !oii)
+	if (lid->oii_ino < latest_start && !oii)
 		GOTO(skip, rc = 0);
 	if (lid->oii_ino < LDISKFS_FIRST_INO(osd_sb(dev)))
 		GOTO(out, rc = -ENOENT);
 
 	if (fid_is_igif(fid))
-		sf->sf_items_igif++;
+		igif = true;
 
 	/* verify inode */
 	inode = osd_iget(info, dev, lid);
@@ -343,7 +356,7 @@ osd_scrub_check_update(struct osd_thread_info *info, struct osd_device *dev,
 			GOTO(out, rc = 0);
 
 		/* set LMA if missing */
-		sf->sf_flags |= SF_UPGRADE;
+		sf_flags |= SF_UPGRADE;
 		if (!(sf->sf_param & SP_DRYRUN)) {
 			rc = osd_ea_fid_set(info, inode, fid, 0, 0);
 			if (rc)
@@ -364,7 +377,7 @@ osd_scrub_check_update(struct osd_thread_info *info, struct osd_device *dev,
 			GOTO(skip, rc = 0);
 
 		if (val == SCRUB_NEXT_OSTOBJ)
-			sf->sf_flags |= SF_INCONSISTENT;
+			sf_flags |= SF_INCONSISTENT;
 	} else if (osd_id_eq(lid, lid2)) {
 		/* mapping matches */
 		if (bad_inode) {
@@ -387,7 +400,7 @@ osd_scrub_check_update(struct osd_thread_info *info, struct osd_device *dev,
 			scrub->os_full_speed = 1;
 			spin_unlock(&scrub->os_lock);
 		}
-		sf->sf_flags |= SF_INCONSISTENT;
+		sf_flags |= SF_INCONSISTENT;
 
 		/* if new inode is bad, keep existing mapping */
 		if (bad_inode)
@@ -440,27 +453,16 @@ delete:
 	rc = osd_scrub_refresh_mapping(info, dev, fid, lid, ops, false, flags,
 				       &exist);
 	if (rc == 0) {
-		if (scrub->os_in_prior)
-			sf->sf_items_updated_prior++;
-		else
-			sf->sf_items_updated++;
-
+		updated = 1;
 		if (ops == DTO_INDEX_INSERT && val == 0 && !exist) {
-			int idx = osd_oi_fid2idx(dev, fid);
-
-			sf->sf_flags |= SF_RECREATED;
-			if (unlikely(!ldiskfs_test_bit(idx, sf->sf_oi_bitmap)))
-				ldiskfs_set_bit(idx, sf->sf_oi_bitmap);
+			sf_flags |= SF_RECREATED;
+			recreated = osd_oi_fid2idx(dev, fid);
 		}
 	}
 	GOTO(out, rc);
 out:
 	if (rc < 0) {
-		sf->sf_items_failed++;
-		if (lid->oii_ino >= LDISKFS_FIRST_INO(osd_sb(dev)) &&
-		    (sf->sf_pos_first_inconsistent == 0 ||
-		    sf->sf_pos_first_inconsistent > lid->oii_ino))
-			sf->sf_pos_first_inconsistent = lid->oii_ino;
+		failed = true;
 	} else {
 		if (!oii && !CFS_FAIL_CHECK(OBD_FAIL_OSD_SCRUB_STALE)) {
 			if (osd_scrub_oi_resurrect(scrub, fid))
@@ -484,6 +486,26 @@ out:
 		rc = 0;
 	}
 skip:
+	down_write(&scrub->os_rwsem);
+	if (igif)
+		sf->sf_items_igif++;
+	sf->sf_flags |= sf_flags;
+	if (prior)
+		sf->sf_items_updated_prior += updated;
+	else
+		sf->sf_items_updated += updated;
+	if (recreated >= 0 &&
+	    unlikely(!ldiskfs_test_bit(recreated, sf->sf_oi_bitmap)))
+		ldiskfs_set_bit(recreated, sf->sf_oi_bitmap);
+	if (failed) {
+		sf->sf_items_failed++;
+		if (lid->oii_ino >= LDISKFS_FIRST_INO(osd_sb(dev)) &&
+		    (sf->sf_pos_first_inconsistent == 0 ||
+		    sf->sf_pos_first_inconsistent > lid->oii_ino))
+			sf->sf_pos_first_inconsistent = lid->oii_ino;
+	}
+	up_write(&scrub->os_rwsem);
+
 	if (oii) {
 		/* something strange with item, moving to stale */
 		osd_scrub_oi_mark_stale(scrub, oii);
@@ -492,7 +514,6 @@ skip:
 		       osd_dev2name(dev), PFID(fid), lid->oii_ino,
 		       lid->oii_gen, rc);
 	}
-	up_write(&scrub->os_rwsem);
 
 	if (!IS_ERR_OR_NULL(inode))
 		iput(inode);
@@ -687,8 +708,11 @@ static int osd_iit_iget(struct osd_thread_info *info, struct osd_device *dev,
 		RETURN(rc);
 	}
 
-	if (dev->od_is_ost && S_ISREG(inode->i_mode) && inode->i_nlink > 1)
+	if (dev->od_is_ost && S_ISREG(inode->i_mode) && inode->i_nlink > 1) {
+		spin_lock(&dev->od_scrub.os_scrub.os_lock);
 		dev->od_scrub.os_scrub.os_has_ml_file = 1;
+		spin_unlock(&dev->od_scrub.os_scrub.os_lock);
+	}
 
 	if (scrub &&
 	    ldiskfs_test_inode_state(inode, LDISKFS_STATE_LUSTRE_NOSCRUB)) {
@@ -826,7 +850,7 @@ static int osd_scrub_exec(struct osd_thread_info *info, struct osd_device *dev,
 		goto wait;
 	}
 
-	rc = osd_scrub_check_update(info, dev, oic, rc);
+	rc = osd_scrub_check_update(info, dev, oic, rc, scrub->os_in_prior);
 	if (rc != 0) {
 		spin_lock(&scrub->os_lock);
 		scrub->os_in_prior = 0;
@@ -961,6 +985,314 @@ static void osd_scrub_join(const struct lu_env *env, struct osd_device *dev,
 	EXIT;
 }
 
+/* parallel inode table scanning */
+
+/* The lowest inode that has not been checked yet, caller holds os_lock. */
+static __u64 osd_scrub_par_pos(struct osd_scrub *oscrub)
+{
+	struct super_block *sb = oscrub->os_workers[0].osw_param.sb;
+	__u64 pos;
+	int i;
+
+	pos = 1 + (__u64)oscrub->os_next_bg * LDISKFS_INODES_PER_GROUP(sb);
+	if (pos < oscrub->os_par_start)
+		pos = oscrub->os_par_start;
+
+	for (i = 0; i < oscrub->os_nr_workers; i++) {
+		struct osd_scrub_worker *osw = &oscrub->os_workers[i];
+
+		if (osw->osw_pos != 0 && osw->osw_pos < pos)
+			pos = osw->osw_pos;
+	}
+
+	return pos;
+}
+
+static bool osd_scrub_worker_next_range(struct osd_scrub_worker *osw)
+{
+	struct osd_scrub *oscrub = &osw->osw_dev->od_scrub;
+	struct osd_iit_param *param = &osw->osw_param;
+	__u32 ipg = LDISKFS_INODES_PER_GROUP(param->sb);
+	ldiskfs_group_t ngroups = LDISKFS_SB(param->sb)->s_groups_count;
+	bool found = false;
+
+	spin_lock(&oscrub->os_scrub.os_lock);
+	/* the previous range (if any) has been checked completely */
+	osw->osw_pos = 0;
+	if (oscrub->os_next_bg < ngroups) {
+		param->bg = oscrub->os_next_bg;
+		osw->osw_bg_end = min_t(ldiskfs_group_t, ngroups,
+					param->bg + OSD_SCRUB_RANGE_GROUPS);
+		oscrub->os_next_bg = osw->osw_bg_end;
+
+		param->gbase = 1 + param->bg * ipg;
+		param->start = max_t(__u64, param->gbase,
+				     oscrub->os_par_start);
+		param->offset = param->start - param->gbase;
+		osw->osw_pos = param->start;
+		found = true;
+	}
+	spin_unlock(&oscrub->os_scrub.os_lock);
+
+	return found;
+}
+
+static int osd_scrub_worker_scan(struct osd_thread_info *info,
+				 struct osd_scrub_worker *osw)
+{
+	struct osd_device *dev = osw->osw_dev;
+	struct lustre_scrub *scrub = &dev->od_scrub.os_scrub;
+	struct osd_iit_param *param = &osw->osw_param;
+	struct osd_idmap_cache *oic = &osw->osw_oic;
+	__u32 ipg = LDISKFS_INODES_PER_GROUP(param->sb);
+	__u64 pos = param->start;
+	int rc = 0;
+	ENTRY;
+
+	while (param->bg < osw->osw_bg_end) {
+		struct ldiskfs_group_desc *desc;
+
+		desc = ldiskfs_get_group_desc(param->sb, param->bg, NULL);
+		if (!desc)
+			RETURN(-EIO);
+
+		if (desc->bg_flags & cpu_to_le16(LDISKFS_BG_INODE_UNINIT))
+			goto next_group;
+
+		param->bitmap = ldiskfs_read_inode_bitmap(param->sb, param->bg);
+		if (IS_ERR_OR_NULL(param->bitmap)) {
+			rc = param->bitmap ? PTR_ERR(param->bitmap) : -EIO;
+			param->bitmap = NULL;
+			CERROR("%s: fail to read bitmap for %u, scanner will stop: rc = %d\n",
+			       osd_scrub2name(scrub), (__u32)param->bg, rc);
+			RETURN(rc);
+		}
+
+		while (param->offset +
+		       ldiskfs_itable_unused_count(param->sb, desc) < ipg) {
+			if (kthread_should_stop())
+				GOTO(put, rc = SCRUB_NEXT_EXIT);
+
+			if (CFS_FAIL_CHECK(OBD_FAIL_OSD_SCRUB_FATAL))
+				GOTO(put, rc = -EINVAL);
+
+			if (osd_iit_next(param, &pos) == SCRUB_NEXT_BREAK)
+				break;
+
+			osw->osw_pos = pos;
+			rc = osd_iit_iget(info, dev, &oic->oic_fid,
+					  &oic->oic_lid, pos, param->sb, true);
+			if (rc == SCRUB_NEXT_CONTINUE)
+				continue;
+
+			osw->osw_checked++;
+			if (rc == SCRUB_NEXT_NOSCRUB) {
+				down_write(&scrub->os_rwsem);
+				scrub->os_new_checked++;
+				scrub->os_file.sf_items_noscrub++;
+				up_write(&scrub->os_rwsem);
+				continue;
+			}
+
+			rc = osd_scrub_check_update(info, dev, oic, rc, false);
+			if (rc != 0)
+				GOTO(put, rc);
+		}
+
+		brelse(param->bitmap);
+		param->bitmap = NULL;
+
+next_group:
+		param->bg++;
+		param->offset = 0;
+		param->gbase = 1 + param->bg * ipg;
+		param->start = param->gbase;
+		pos = param->start;
+	}
+
+	RETURN(0);
+
+put:
+	brelse(param->bitmap);
+	param->bitmap = NULL;
+	return rc;
+}
+
+static int osd_scrub_worker_main(void *args)
+{
+	struct osd_scrub_worker *osw = args;
+	struct osd_scrub *oscrub = &osw->osw_dev->od_scrub;
+	struct lustre_scrub *scrub = &oscrub->os_scrub;
+	struct lu_env env;
+	int rc;
+
+	rc = lu_env_init(&env, LCT_LOCAL | LCT_DT_THREAD);
+	if (rc == 0) {
+		while (osd_scrub_worker_next_range(osw)) {
+			rc = osd_scrub_worker_scan(osd_oti_get(&env), osw);
+			if (rc != 0)
+				break;
+		}
+		lu_env_fini(&env);
+	}
+
+	/* An unfinished range keeps its osw_pos, so that the checkpoint
+	 * will not go beyond it. */
+	spin_lock(&scrub->os_lock);
+	osw->osw_rc = rc;
+	spin_unlock(&scrub->os_lock);
+	atomic_dec(&oscrub->os_workers_running);
+	wake_up_var(scrub);
+
+	/* osd_scrub_parallel() will stop and reap us */
+	wait_var_event(scrub, kthread_should_stop());
+	return rc;
+}
+
+/**
+ * Scan the inode table with several threads.
+ *
+ * The block groups are handed out to the scanners in ranges of
+ * OSD_SCRUB_RANGE_GROUPS in increasing order, while the OI scrub thread
+ * itself handles the inconsistent items found by RPCs, and advances the
+ * position and checkpoint to the lowest inode still being checked. Then
+ * resuming from the checkpoint never skips any unchecked inode.
+ *
+ * \param[in] info	thread info of the OI scrub thread
+ * \param[in] dev	OSD device
+ *
+ * \retval SCRUB_IT_ALL	the whole inode table has been scanned
+ * \retval SCRUB_IT_CRASH	simulate crash
+ * \retval 0		stopped
+ * \retval negative	error number
+ */
+static int osd_scrub_parallel(struct osd_thread_info *info,
+			      struct osd_device *dev)
+{
+	struct osd_scrub *oscrub = &dev->od_scrub;
+	struct lustre_scrub *scrub = &oscrub->os_scrub;
+	struct osd_iit_param *param = &oscrub->os_iit_param;
+	struct osd_scrub_worker *workers;
+	__u32 ipg = LDISKFS_INODES_PER_GROUP(osd_sb(dev));
+	__u32 limit;
+	__u64 pos;
+	int nr = min_t(int, dev->od_scrub_threads, OSD_SCRUB_THREADS_MAX);
+	int rc = 0;
+	int i;
+	ENTRY;
+
+	OBD_ALLOC_PTR_ARRAY(workers, nr);
+	if (!workers)
+		RETURN(-ENOMEM);
+
+	for (i = 0; i < nr; i++) {
+		workers[i].osw_dev = dev;
+		workers[i].osw_param.sb = osd_sb(dev);
+	}
+
+	atomic_set(&oscrub->os_workers_running, 0);
+	spin_lock(&scrub->os_lock);
+	oscrub->os_par_start = scrub->os_pos_current;
+	oscrub->os_next_bg = (scrub->os_pos_current - 1) / ipg;
+	oscrub->os_workers = workers;
+	oscrub->os_nr_workers = nr;
+	spin_unlock(&scrub->os_lock);
+
+	for (i = 0; i < nr; i++) {
+		struct task_struct *task;
+
+		atomic_inc(&oscrub->os_workers_running);
+		task = kthread_run(osd_scrub_worker_main, &workers[i],
+				   "OI_scrub_%02d", i);
+		if (IS_ERR(task)) {
+			atomic_dec(&oscrub->os_workers_running);
+			rc = PTR_ERR(task);
+			CERROR("%s: cannot start OI scrub scanner %d: rc = %d\n",
+			       osd_scrub2name(scrub), i, rc);
+			break;
+		}
+		workers[i].osw_task = task;
+	}
+
+	/* go ahead as long as there is any scanner */
+	if (i > 0)
+		rc = 0;
+
+	CDEBUG(D_LFSCK, "%s: OI scrub scans with %d threads from pos %llu\n",
+	       osd_scrub2name(scrub), i, oscrub->os_par_start);
+
+	while (rc == 0) {
+		struct osd_idmap_cache *oic = NULL;
+		bool noslot = true;
+
+		rc = osd_scrub_next(info, dev, param, &oic, noslot);
+		if (rc == 0) {
+			osd_scrub_exec(info, dev, param, oic, &noslot, rc);
+			continue;
+		}
+
+		if (rc != SCRUB_NEXT_WAIT)
+			break;
+
+		rc = 0;
+		spin_lock(&scrub->os_lock);
+		scrub->os_pos_current = osd_scrub_par_pos(oscrub) - 1;
+		for (i = 0; i < nr && rc == 0; i++)
+			rc = min(workers[i].osw_rc, 0);
+		spin_unlock(&scrub->os_lock);
+
+		/* wakeup the otable-based iterator waiting for the scanner */
+		osd_scrub_exec(info, dev, param, NULL, &noslot,
+			       SCRUB_NEXT_WAIT);
+
+		if (scrub_checkpoint(info->oti_env, scrub))
+			CDEBUG(D_LFSCK, "%s: fail to checkpoint, pos = %llu\n",
+			       osd_scrub2name(scrub), scrub->os_pos_current);
+
+		if (rc != 0 || atomic_read(&oscrub->os_workers_running) == 0)
+			break;
+
+		wait_var_event_timeout(scrub,
+			!list_empty(&scrub->os_inconsistent_items) ||
+			atomic_read(&oscrub->os_workers_running) == 0 ||
+			kthread_should_stop(),
+			cfs_time_seconds(1));
+	}
+
+	switch (rc) {
+	case SCRUB_NEXT_EXIT:
+		rc = 0;
+		break;
+	case SCRUB_NEXT_CRASH:
+		rc = SCRUB_IT_CRASH;
+		break;
+	case SCRUB_NEXT_FATAL:
+		rc = -EINVAL;
+		break;
+	}
+
+	for (i = 0; i < nr; i++) {
+		if (workers[i].osw_task)
+			kthread_stop(workers[i].osw_task);
+	}
+
+	spin_lock(&scrub->os_lock);
+	pos = osd_scrub_par_pos(oscrub);
+	scrub->os_pos_current = pos - 1;
+	for (i = 0; i < nr && rc == 0; i++)
+		rc = min(workers[i].osw_rc, 0);
+	oscrub->os_workers = NULL;
+	oscrub->os_nr_workers = 0;
+	spin_unlock(&scrub->os_lock);
+	OBD_FREE_PTR_ARRAY(workers, nr);
+
+	limit = le32_to_cpu(LDISKFS_SB(osd_sb(dev))->s_es->s_inodes_count);
+	if (rc == 0 && pos > limit)
+		rc = SCRUB_IT_ALL;
+
+	RETURN(rc);
+}
+
 static int osd_inode_iteration(struct osd_thread_info *info,
 			       struct osd_device *dev, __u32 max, bool preload)
 {
@@ -1066,6 +1398,9 @@ full:
 
 		if (kthread_should_stop())
 			RETURN(0);
+
+		if (scrub->os_full_speed && dev->od_scrub_threads > 1)
+			RETURN(osd_scrub_parallel(info, dev));
 	}
 
 	noslot = false;
@@ -2987,6 +3322,7 @@ const struct dt_index_operations osd_otable_ops = {
 void osd_scrub_dump(struct seq_file *m, struct osd_device *dev)
 {
 	struct osd_scrub *scrub = &dev->od_scrub;
+	int i;
 
 	scrub_dump(m, &scrub->os_scrub);
 	seq_printf(m, "lf_scanned: %llu\n"
@@ -2997,6 +3333,13 @@ void osd_scrub_dump(struct seq_file *m, struct osd_device *dev)
 			"inconsistent" : "repaired",
 		   scrub->os_lf_repaired,
 		   scrub->os_lf_failed);
+
+	spin_lock(&scrub->os_scrub.os_lock);
+	for (i = 0; i < scrub->os_nr_workers; i++)
+		seq_printf(m, "scanner_%02d: { position: %llu, checked: %llu }\n",
+			   i, scrub->os_workers[i].osw_pos,
+			   scrub->os_workers[i].osw_checked);
+	spin_unlock(&scrub->os_scrub.os_lock);
 }
 
 typedef int (*scan_dir_helper_t)(const struct lu_env *env,
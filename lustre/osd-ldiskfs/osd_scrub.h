@@ -51,12 +51,40 @@ struct osd_iit_param {
 	__u32 start;
 };
 
+/* Block groups handed to a parallel scanner at a time. */
+#define OSD_SCRUB_RANGE_GROUPS	16
+
+/* One inode table scanner of the parallel OI scrub. */
+struct osd_scrub_worker {
+	struct osd_device	*osw_dev;
+	struct task_struct	*osw_task;
+	struct osd_idmap_cache	 osw_oic;
+	struct osd_iit_param	 osw_param;
+	/* the first group after the assigned range */
+	ldiskfs_group_t		 osw_bg_end;
+	/* the inode being checked, 0 if idle, protected by os_lock
+	 * when assigning or releasing a range */
+	__u64			 osw_pos;
+	/* how many objects this scanner has checked */
+	__u64			 osw_checked;
+	int			 osw_rc;
+};
+
 struct osd_scrub {
 	struct lustre_scrub	os_scrub;
 	struct lvfs_run_ctxt    os_ctxt;
 	struct osd_idmap_cache  os_oic;
 	struct osd_iit_param	os_iit_param;
 
+	/* parallel inode table scanners, protected by os_scrub.os_lock */
+	struct osd_scrub_worker *os_workers;
+	int			os_nr_workers;
+	atomic_t		os_workers_running;
+	/* the next block group not yet handed to any scanner */
+	ldiskfs_group_t		os_next_bg;
+	/* where the parallel scanning (re)started */
+	__u64			os_par_start;
+
 	/* statistics for /lost+found are in ram only, it will be reset
 	 * when each time the device remount. */
 
@@ -177,6 +177,9 @@ static int osd_trans_cb_add(struct thandle *th, struct dt_txn_commit_cb *dcb)
 
 	LASSERT(dcb->dcb_magic == TRANS_COMMIT_CB_MAGIC);
 	LASSERT(&dcb->dcb_func != NULL);
+	/* data goes through the DMU, there are no bios to complete later */
+	if (dcb->dcb_flags & DCB_IO_DONE)
+		return -EOPNOTSUPP;
 	if (dcb->dcb_flags & DCB_TRANS_STOP)
 		list_add(&dcb->dcb_linkage, &oh->ot_stop_dcb_list);
 	else
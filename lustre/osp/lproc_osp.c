@@ -369,6 +369,113 @@ static ssize_t max_rpcs_in_progress_store(struct kobject *kobj,
 }
 LUSTRE_RW_ATTR(max_rpcs_in_progress);
 
+/**
+ * Show maximum number of objects destroyed or changed by one sync RPC
+ *
+ * \param[in] kobj	kobject of the OSP device
+ * \param[in] attr	unused
+ * \param[in] buf	output buffer
+ * \retval		number of bytes written
+ */
+static ssize_t max_sync_batch_show(struct kobject *kobj,
+				   struct attribute *attr,
+				   char *buf)
+{
+	struct dt_device *dt = container_of(kobj, struct dt_device,
+					    dd_kobj);
+	struct osp_device *osp = dt2osp_dev(dt);
+
+	return sprintf(buf, "%d\n", osp->opd_sync_max_batch);
+}
+
+/**
+ * Change maximum number of objects destroyed or changed by one sync RPC,
+ * 1 disables batching of destroys and setattrs
+ *
+ * \param[in] kobj	kobject of the OSP device
+ * \param[in] attr	unused
+ * \param[in] buffer	string which represents maximum number
+ * \param[in] count	\a buffer length
+ * \retval		\a count on success
+ * \retval		negative number on error
+ */
+static ssize_t max_sync_batch_store(struct kobject *kobj,
+				    struct attribute *attr,
+				    const char *buffer,
+				    size_t count)
+{
+	struct dt_device *dt = container_of(kobj, struct dt_device,
+					    dd_kobj);
+	struct osp_device *osp = dt2osp_dev(dt);
+	unsigned int val;
+	int rc;
+
+	rc = kstrtouint(buffer, 0, &val);
+	if (rc)
+		return rc;
+
+	if (val == 0 || val > OSP_SYNC_MAX_BATCH)
+		return -ERANGE;
+
+	osp->opd_sync_max_batch = val;
+
+	return count;
+}
+LUSTRE_RW_ATTR(max_sync_batch);
+
+/**
+ * Show number of workers cancelling llog records of synced changes
+ *
+ * \param[in] kobj	kobject of the OSP device
+ * \param[in] attr	unused
+ * \param[in] buf	output buffer
+ * \retval		number of bytes written
+ */
+static ssize_t max_sync_threads_show(struct kobject *kobj,
+				     struct attribute *attr,
+				     char *buf)
+{
+	struct dt_device *dt = container_of(kobj, struct dt_device,
+					    dd_kobj);
+	struct osp_device *osp = dt2osp_dev(dt);
+
+	return sprintf(buf, "%d\n", osp->opd_sync_threads);
+}
+
+/**
+ * Change number of workers cancelling llog records of synced changes,
+ * 1 makes the sync thread cancel them itself
+ *
+ * \param[in] kobj	kobject of the OSP device
+ * \param[in] attr	unused
+ * \param[in] buffer	string which represents number of workers
+ * \param[in] count	\a buffer length
+ * \retval		\a count on success
+ * \retval		negative number on error
+ */
+static ssize_t max_sync_threads_store(struct kobject *kobj,
+				      struct attribute *attr,
+				      const char *buffer, size_t count)
+{
+	struct dt_device *dt = container_of(kobj, struct dt_device,
+					    dd_kobj);
+	struct osp_device *osp = dt2osp_dev(dt);
+	unsigned int val;
+	int rc;
+
+	rc = kstrtouint(buffer, 0, &val);
+	if (rc)
+		return rc;
+
+	if (val == 0 || val > OSP_SYNC_THREADS_MAX)
+		return -ERANGE;
+
+	osp->opd_sync_threads = val;
+
+	return count;
+}
+LUSTRE_RW_ATTR(max_sync_threads);
+
 /**
  * Show number of objects to precreate next time
  *
@@ -945,6 +1052,61 @@ static ssize_t osp_rpc_stats_seq_write(struct file *file,
 }
 LDEBUGFS_SEQ_FOPS(osp_rpc_stats);
 
+static int osp_precreate_stats_seq_show(struct seq_file *seq, void *v)
+{
+	struct obd_device *obd = seq->private;
+	struct osp_device *osp = lu2osp_dev(obd->obd_lu_dev);
+	struct obd_histogram *hist;
+	unsigned long tot, cum = 0;
+	int i;
+
+	if (osp == NULL || osp->opd_pre == NULL)
+		return -EINVAL;
+
+	hist = &osp->opd_pre_stall_hist;
+	lprocfs_stats_header(seq, ktime_get_real(), osp->opd_pre_stats_init,
+			     25, ":", true, "");
+	seq_printf(seq, "create_rate:             %u objs/s\n",
+		   osp->opd_pre_rate);
+	seq_printf(seq, "precreate_rpc_time:      %u usecs\n",
+		   osp->opd_pre_rpc_usec);
+	seq_printf(seq, "predicted_demand:        %d objs\n",
+		   osp_precreate_predicted(osp));
+	seq_printf(seq, "create_count:            %d\n",
+		   osp->opd_pre_create_count);
+
+	seq_puts(seq, "\nstall time (ms)       stalls   % cum %\n");
+	tot = lprocfs_oh_sum(hist);
+	for (i = 0; i < OBD_HIST_MAX && cum < tot; i++) {
+		unsigned long n = hist->oh_buckets[i];
+
+		cum += n;
+		seq_printf(seq, "%d:\t\t%10lu %3u %3u\n",
+			   1 << i, n, pct(n, tot),
+			   pct(cum, tot));
+	}
+
+	return 0;
+}
+
+static ssize_t osp_precreate_stats_seq_write(struct file *file,
+					     const char __user *buf,
+					     size_t len, loff_t *off)
+{
+	struct seq_file *seq = file->private_data;
+	struct obd_device *obd = seq->private;
+	struct osp_device *osp = lu2osp_dev(obd->obd_lu_dev);
+
+	if (osp == NULL || osp->opd_pre == NULL)
+		return -EINVAL;
+
+	lprocfs_oh_clear(&osp->opd_pre_stall_hist);
+	osp->opd_pre_stats_init = ktime_get_real();
+
+	return len;
+}
+LDEBUGFS_SEQ_FOPS(osp_precreate_stats);
+
 /**
  * Show high watermark (in megabytes). If available free space at OST is greater
  * than high watermark and object allocation for OST is disabled, enable it.
@@ -1154,6 +1316,8 @@ static struct ldebugfs_vars ldebugfs_osp_obd_vars[] = {
 	  .fops =	&osp_import_fops		},
 	{ .name =	"state",
 	  .fops =	&osp_state_fops			},
+	{ .name =	"precreate_stats",
+	  .fops =	&osp_precreate_stats_fops	},
 	{ NULL }
 };
 
@@ -1180,6 +1344,8 @@ static struct attribute *osp_obd_attrs[] = {
 	&lustre_attr_active.attr,
 	&lustre_attr_max_rpcs_in_flight.attr,
 	&lustre_attr_max_rpcs_in_progress.attr,
+	&lustre_attr_max_sync_batch.attr,
+	&lustre_attr_max_sync_threads.attr,
 	&lustre_attr_maxage.attr,
 	&lustre_attr_ost_conn_uuid.attr,
 	&lustre_attr_ping.attr,
@@ -88,6 +88,19 @@ struct osp_precreate {
 					 osp_pre_recovering:1,
 	/* force new seq rollover */
 					 osp_pre_force_new_seq:1;
+	/*
+	 * Create rate prediction, see osp_precreate_predicted_nolock()
+	 */
+	/* objects used per second, moving average */
+	unsigned int			 osp_pre_rate;
+	/* objects used since osp_pre_rate_stamp */
+	unsigned int			 osp_pre_rate_used;
+	ktime_t				 osp_pre_rate_stamp;
+	/* duration of precreate RPC in usec, moving average */
+	unsigned int			 osp_pre_rpc_usec;
+	/* time creations had to wait for objects, in msec */
+	struct obd_histogram		 osp_pre_stall_hist;
+	ktime_t				 osp_pre_stats_init;
 };
 
 struct osp_update_request_sub {
@@ -150,6 +163,15 @@ struct osp_updates {
 	struct lu_env		ou_env;
 };
 
+/* committed changes whose llog records are cancelled by one worker */
+struct osp_sync_shard {
+	struct osp_device	*oss_dev;
+	struct work_struct	 oss_work;
+	struct lu_env		 oss_env;
+	/* protected by opd_sync_lock */
+	struct list_head	 oss_committed;
+};
+
 struct osp_device {
 	struct dt_device		 opd_dt_dev;
 	/* corresponded OST index */
@@ -224,6 +246,18 @@ struct osp_device {
 	/* number of RPC in processing (including non-committed by OST) */
 	atomic_t			 opd_sync_rpcs_in_progress;
 	int				 opd_sync_max_rpcs_in_progress;
+	/* destroy or setattr RPC being filled with records, not sent yet */
+	struct ptlrpc_request		*opd_sync_batch_req;
+	/* max number of objects changed by one RPC, 1 to disable */
+	int				 opd_sync_max_batch;
+	/* workers cancelling llog records of committed changes, each one
+	 * handles its own subset of plain llogs, allocated on demand by
+	 * the sync thread */
+	struct workqueue_struct		*opd_sync_wq;
+	struct osp_sync_shard		*opd_sync_shards;
+	int				 opd_sync_nr_shards;
+	/* number of workers to use, 1 to cancel from the sync thread */
+	int				 opd_sync_threads;
 	/* osd api's commit cb control structure */
 	struct dt_txn_callback		 opd_sync_txn_cb;
 	/* last used change number -- semantically similar to transno */
@@ -291,6 +325,12 @@ struct osp_device {
 #define opd_pre_create_slow		opd_pre->osp_pre_create_slow
 #define opd_pre_recovering		opd_pre->osp_pre_recovering
 #define opd_pre_force_new_seq		opd_pre->osp_pre_force_new_seq
+#define opd_pre_rate			opd_pre->osp_pre_rate
+#define opd_pre_rate_used		opd_pre->osp_pre_rate_used
+#define opd_pre_rate_stamp		opd_pre->osp_pre_rate_stamp
+#define opd_pre_rpc_usec		opd_pre->osp_pre_rpc_usec
+#define opd_pre_stall_hist		opd_pre->osp_pre_stall_hist
+#define opd_pre_stats_init		opd_pre->osp_pre_stats_init
 
 extern struct kmem_cache *osp_object_kmem;
 
@@ -331,8 +371,14 @@ struct osp_object {
 	atomic_t		opo_invalidate_seq;
 	struct rw_semaphore	opo_invalidate_sem;
 	atomic_t		opo_writes_in_flight;
+	/* async attr/xattr get sub-requests not interpreted yet */
+	atomic_t		opo_async_pending;
 };
 
+/* The shared asynchronous request queue is sent once it holds so many
+ * attr/xattr get sub-requests, or earlier if some object in it is wanted. */
+#define OSP_ASYNC_GET_BATCH	64
+
 extern const struct lu_object_operations osp_lu_obj_ops;
 extern const struct dt_object_operations osp_md_obj_ops;
 extern const struct dt_body_operations osp_md_body_ops;
@@ -800,6 +846,7 @@ __u64 osp_precreate_get_id(struct osp_device *d);
 int osp_precreate_get_fid(const struct lu_env *env, struct osp_device *d,
 			  struct lu_fid *fid);
 void osp_precreate_fini(struct osp_device *d);
+int osp_precreate_predicted(struct osp_device *d);
 int osp_object_truncate(const struct lu_env *env, struct dt_object *dt, __u64);
 void osp_pre_update_status(struct osp_device *d, int rc);
 void osp_statfs_need_now(struct osp_device *d);
@@ -824,6 +871,10 @@ int osp_sync_init(const struct lu_env *env, struct osp_device *d);
 int osp_sync_fini(struct osp_device *d);
 void osp_sync_check_for_work(struct osp_device *osp);
 void osp_sync_force(const struct lu_env *env, struct osp_device *d);
+#define OSP_SYNC_MAX_BATCH	512
+#define OSP_SYNC_THREADS_DEF	4
+#define OSP_SYNC_THREADS_MAX	16
+
 int osp_sync_add_commit_cb_1s(const struct lu_env *env, struct osp_device *d,
 			      struct thandle *th);
 
@@ -483,6 +483,67 @@ static int osp_get_attr_from_reply(const struct lu_env *env,
 	return 0;
 }
 
+/**
+ * Send the shared asynchronous request queue if it is not empty.
+ *
+ * \param[in] env	pointer to the thread context
+ * \param[in] osp	pointer to the OSP device
+ * \param[in] batch	only send it if it holds so many sub-requests
+ *
+ * \retval		0 for success
+ * \retval		negative error number on failure
+ */
+static int osp_async_requests_flush(const struct lu_env *env,
+				    struct osp_device *osp, int batch)
+{
+	struct osp_update_request	*our;
+	struct osp_update_request_sub	*ours;
+
+	mutex_lock(&osp->opd_async_requests_mutex);
+	our = osp->opd_async_requests;
+	if (our == NULL) {
+		mutex_unlock(&osp->opd_async_requests_mutex);
+		return 0;
+	}
+
+	ours = osp_current_object_update_request(our);
+	if (ours == NULL || ours->ours_req == NULL ||
+	    ours->ours_req->ourq_count < max(batch, 1)) {
+		mutex_unlock(&osp->opd_async_requests_mutex);
+		return 0;
+	}
+
+	osp->opd_async_requests = NULL;
+	mutex_unlock(&osp->opd_async_requests_mutex);
+
+	return osp_unplug_async_request(env, osp, our);
+}
+
+/**
+ * Wait for the prefetched attributes of the given object.
+ *
+ * The attr/xattr get sub-requests added by osp_declare_attr_get() and
+ * osp_declare_xattr_get() are batched in the shared asynchronous request
+ * queue. If some of them for this object are not interpreted yet, then
+ * send the queue, and wait for the replies instead of sending another
+ * synchronous RPC for the same attribute.
+ *
+ * \param[in] env	pointer to the thread context
+ * \param[in] obj	pointer to the OSP object
+ */
+static void osp_async_pending_wait(const struct lu_env *env,
+				   struct osp_object *obj)
+{
+	struct osp_device *osp = lu2osp_dev(osp2lu_obj(obj)->lo_dev);
+
+	if (atomic_read(&obj->opo_async_pending) == 0)
+		return;
+
+	osp_async_requests_flush(env, osp, 1);
+	wait_var_event(&obj->opo_async_pending,
+		       atomic_read(&obj->opo_async_pending) == 0);
+}
+
 /**
  * Interpreter function for getting OSP object attribute asynchronously.
  *
@@ -512,8 +573,8 @@ static int osp_attr_get_interpterer(const struct lu_env *env,
 		osp2lu_obj(obj)->lo_header->loh_attr |= LOHA_EXISTS;
 		obj->opo_non_exist = 0;
 
-		return osp_get_attr_from_reply(env, reply, req, NULL, obj,
-					       index);
+		rc = osp_get_attr_from_reply(env, reply, req, NULL, obj,
+					     index);
 	} else {
 		if (rc == -ENOENT) {
 			osp2lu_obj(obj)->lo_header->loh_attr &= ~LOHA_EXISTS;
@@ -523,9 +584,13 @@ static int osp_attr_get_interpterer(const struct lu_env *env,
 		spin_lock(&obj->opo_lock);
 		attr->la_valid = 0;
 		spin_unlock(&obj->opo_lock);
+		rc = 0;
 	}
 
-	return 0;
+	if (atomic_dec_and_test(&obj->opo_async_pending))
+		wake_up_var(&obj->opo_async_pending);
+
+	return rc;
 }
 
 /**
@@ -551,9 +616,12 @@ static int osp_declare_attr_get(const struct lu_env *env, struct dt_object *dt)
 	int			 rc	= 0;
 
 	mutex_lock(&osp->opd_async_requests_mutex);
+	atomic_inc(&obj->opo_async_pending);
 	rc = osp_insert_async_request(env, OUT_ATTR_GET, obj, 0, NULL, NULL,
 				      &obj->opo_attr, sizeof(struct obdo),
 				      osp_attr_get_interpterer);
+	if (rc != 0)
+		atomic_dec(&obj->opo_async_pending);
 	mutex_unlock(&osp->opd_async_requests_mutex);
 
 	return rc;
@@ -588,6 +656,7 @@ int osp_attr_get(const struct lu_env *env, struct dt_object *dt,
 	int				invalidated, cache = 0, rc = 0;
 	ENTRY;
 
+	osp_async_pending_wait(env, obj);
 	if (is_ost_obj(&dt->do_lu) && obj->opo_non_exist)
 		RETURN(-ENOENT);
 	if (obj->opo_destroyed)
@@ -897,6 +966,9 @@ unlock:
 	/* Put the reference obtained in the osp_declare_xattr_get(). */
 	osp_oac_xattr_put(oxe);
 
+	if (atomic_dec_and_test(&obj->opo_async_pending))
+		wake_up_var(&obj->opo_async_pending);
+
 	return 0;
 }
 
@@ -939,35 +1011,24 @@ static int osp_declare_xattr_get(const struct lu_env *env, struct dt_object *dt,
 
 	len = strlen(name) + 1;
 	mutex_lock(&osp->opd_async_requests_mutex);
+	atomic_inc(&obj->opo_async_pending);
 	rc = osp_insert_async_request(env, OUT_XATTR_GET, obj, 1,
 				      &len, (const void **)&name,
 				      oxe, buf->lb_len,
 				      osp_xattr_get_interpterer);
 	if (rc != 0) {
+		atomic_dec(&obj->opo_async_pending);
 		mutex_unlock(&osp->opd_async_requests_mutex);
 		osp_oac_xattr_put(oxe);
-	} else {
-		struct osp_update_request *our;
-		struct osp_update_request_sub *ours;
-
-		/* XXX: Currently, we trigger the batched async OUT
-		 *	RPC via dt_declare_xattr_get(). It is not
-		 *	perfect solution, but works well now.
-		 *
-		 *	We will improve it in the future. */
-		our = osp->opd_async_requests;
-		ours = osp_current_object_update_request(our);
-		if (ours != NULL && ours->ours_req != NULL &&
-		    ours->ours_req->ourq_count > 0) {
-			osp->opd_async_requests = NULL;
-			mutex_unlock(&osp->opd_async_requests_mutex);
-			rc = osp_unplug_async_request(env, osp, our);
-		} else {
-			mutex_unlock(&osp->opd_async_requests_mutex);
-		}
+
+		return rc;
 	}
+	mutex_unlock(&osp->opd_async_requests_mutex);
 
-	return rc;
+	/* The batched async OUT RPC is triggered via dt_declare_xattr_get()
+	 * once enough sub-requests are queued, or by the osp_attr_get() and
+	 * osp_xattr_get() on an object that is still in the queue. */
+	return osp_async_requests_flush(env, osp, OSP_ASYNC_GET_BATCH);
 }
 
 /**
@@ -1022,6 +1083,7 @@ int osp_xattr_get(const struct lu_env *env, struct dt_object *dt,
 		}
 	}
 
+	osp_async_pending_wait(env, obj);
 	if (unlikely(obj->opo_non_exist))
 		RETURN(-ENOENT);
 
@@ -2278,6 +2340,7 @@ static const struct dt_object_operations osp_obj_ops = {
 	.do_declare_destroy	= osp_declare_destroy,
 	.do_destroy		= osp_destroy,
 	.do_index_try		= osp_index_try,
+	.do_invalidate		= osp_invalidate,
 };
 
 /**
@@ -302,6 +302,92 @@ void osp_statfs_need_now(struct osp_device *d)
 	}
 }
 
+/* create rate is sampled this often, in msec */
+#define OSP_PRE_RATE_INTERVAL	100
+/* weight of a new sample in the moving averages is 1/(1 << this) */
+#define OSP_PRE_EWMA_SHIFT	2
+
+static inline unsigned int osp_pre_ewma(unsigned int avg, unsigned int val)
+{
+	return (avg * ((1 << OSP_PRE_EWMA_SHIFT) - 1) + val) >>
+		OSP_PRE_EWMA_SHIFT;
+}
+
+/**
+ * Account objects used from the pool to estimate the create rate.
+ *
+ * Every OSP_PRE_RATE_INTERVAL the number of objects used in the interval
+ * is folded into the moving average. Intervals passed without creates
+ * decay the average, so an idle OSP goes back to reactive precreation.
+ * The precreate thread calls this with \a used == 0 before it looks at
+ * the predicted demand, so the decay doesn't wait for the next create.
+ * Notice this function relies on external locking by opd_pre_lock.
+ *
+ * \param[in] d		OSP device
+ * \param[in] used	number of objects just used
+ */
+static void osp_precreate_rate_update_nolock(struct osp_device *d,
+					     unsigned int used)
+{
+	ktime_t now = ktime_get();
+	s64 elapsed = ktime_ms_delta(now, d->opd_pre_rate_stamp);
+	unsigned int rate;
+
+	d->opd_pre_rate_used += used;
+	if (elapsed < OSP_PRE_RATE_INTERVAL)
+		return;
+
+	rate = div64_s64((s64)d->opd_pre_rate_used * MSEC_PER_SEC, elapsed);
+	for (elapsed -= OSP_PRE_RATE_INTERVAL;
+	     elapsed >= OSP_PRE_RATE_INTERVAL && d->opd_pre_rate != 0;
+	     elapsed -= OSP_PRE_RATE_INTERVAL)
+		d->opd_pre_rate = osp_pre_ewma(d->opd_pre_rate, 0);
+	d->opd_pre_rate = osp_pre_ewma(d->opd_pre_rate, rate);
+	d->opd_pre_rate_used = 0;
+	d->opd_pre_rate_stamp = now;
+}
+
+/**
+ * Number of objects expected to be used while the next precreate is done.
+ *
+ * This is the create rate times twice the precreate RPC time, so that the
+ * next precreate is sent early enough and big enough to refill the pool
+ * before it is drained by a create burst.
+ * Notice this function relies on external locking by opd_pre_lock.
+ *
+ * \param[in] d		OSP device
+ *
+ * \retval		number of objects
+ */
+static int osp_precreate_predicted_nolock(struct osp_device *d)
+{
+	u64 need;
+
+	need = (u64)d->opd_pre_rate * d->opd_pre_rpc_usec * 2;
+	need = div_u64(need, USEC_PER_SEC);
+
+	return min_t(u64, need, d->opd_pre_max_create_count / 2);
+}
+
+/**
+ * Locked version of osp_precreate_predicted_nolock() for lprocfs.
+ *
+ * \param[in] d		OSP device
+ *
+ * \retval		number of objects
+ */
+int osp_precreate_predicted(struct osp_device *d)
+{
+	int need;
+
+	spin_lock(&d->opd_pre_lock);
+	osp_precreate_rate_update_nolock(d, 0);
+	need = osp_precreate_predicted_nolock(d);
+	spin_unlock(&d->opd_pre_lock);
+
+	return need;
+}
+
 /**
  * Check pool of precreated objects is getting low.
  *
@@ -326,6 +412,7 @@ static inline int osp_precreate_is_low_nolock(struct osp_device *d)
 
 	/* no new precreation until OST is healthy and has free space */
 	return ((d->opd_pre_create_count - available > precreate_needed ||
+		 available < osp_precreate_predicted_nolock(d) ||
 		 d->opd_force_creation) && (d->opd_pre_status == 0));
 }
 
@@ -348,6 +435,8 @@ static inline int osp_precreate_is_low(struct osp_device *d)
 
 	/* XXX: do we really need locking here? */
 	spin_lock(&d->opd_pre_lock);
+	/* decay the create rate of an idle OSP before it's used */
+	osp_precreate_rate_update_nolock(d, 0);
 	rc = osp_precreate_is_low_nolock(d);
 	spin_unlock(&d->opd_pre_lock);
 	return rc;
@@ -594,8 +683,9 @@ static int osp_precreate_send(const struct lu_env *env, struct osp_device *d)
 	struct ptlrpc_request	*req;
 	struct obd_import	*imp;
 	struct ost_body		*body;
-	int			 rc, grow, diff;
+	int			 rc, grow, diff, need;
 	struct lu_fid		*fid = &oti->osi_fid;
+	ktime_t			 start;
 	ENTRY;
 
 	/* don't precreate new objects till OST healthy and has free space */
@@ -635,6 +725,11 @@ static int osp_precreate_send(const struct lu_env *env, struct osp_device *d)
 	}
 
 	spin_lock(&d->opd_pre_lock);
+	/* provision ahead of the predicted demand if the OST keeps up */
+	osp_precreate_rate_update_nolock(d, 0);
+	need = osp_precreate_predicted_nolock(d);
+	if (!d->opd_pre_create_slow && need > d->opd_pre_create_count)
+		d->opd_pre_create_count = need;
 	if (d->opd_pre_create_count > d->opd_pre_max_create_count / 2)
 		d->opd_pre_create_count = d->opd_pre_max_create_count / 2;
 	grow = d->opd_pre_create_count;
@@ -664,6 +759,7 @@ static int osp_precreate_send(const struct lu_env *env, struct osp_device *d)
 	if (CFS_FAIL_CHECK(OBD_FAIL_OSP_FAKE_PRECREATE))
 		GOTO(ready, rc = 0);
 
+	start = ktime_get();
 	rc = ptlrpc_queue_wait(req);
 	if (rc) {
 		CERROR("%s: can't precreate: rc = %d\n", d->opd_obd->obd_name,
@@ -680,6 +776,10 @@ static int osp_precreate_send(const struct lu_env *env, struct osp_device *d)
 
 	ostid_to_fid(fid, &body->oa.o_oi, d->opd_index);
 
+	spin_lock(&d->opd_pre_lock);
+	d->opd_pre_rpc_usec = osp_pre_ewma(d->opd_pre_rpc_usec,
+					   ktime_us_delta(ktime_get(), start));
+	spin_unlock(&d->opd_pre_lock);
 ready:
 	if (osp_fid_diff(fid, &d->opd_pre_used_fid) <= 0) {
 		CERROR("%s: precreate fid "DFID" <= local used fid "DFID
@@ -1456,6 +1556,7 @@ int osp_precreate_reserve(const struct lu_env *env, struct osp_device *d,
 {
 	time64_t expire = ktime_get_seconds() + obd_timeout;
 	int precreated, rc, synced = 0;
+	ktime_t stall = 0;
 
 	ENTRY;
 
@@ -1561,6 +1662,8 @@ int osp_precreate_reserve(const struct lu_env *env, struct osp_device *d,
 
 		CDEBUG(D_INFO, "%s: Sleeping on objects\n",
 		       d->opd_obd->obd_name);
+		if (!stall)
+			stall = ktime_get();
 		if (wait_event_idle_timeout(
 			    d->opd_pre_user_waitq,
 			    osp_precreate_ready_condition(env, d),
@@ -1581,6 +1684,10 @@ int osp_precreate_reserve(const struct lu_env *env, struct osp_device *d,
 		}
 	}
 
+	if (stall)
+		lprocfs_oh_tally_log2(&d->opd_pre_stall_hist,
+				      ktime_ms_delta(ktime_get(), stall));
+
 	RETURN(rc);
 }
 
@@ -1637,6 +1744,7 @@ int osp_precreate_get_fid(const struct lu_env *env, struct osp_device *d,
 
 	memcpy(fid, pre_used_fid, sizeof(*fid));
 	d->opd_pre_reserved--;
+	osp_precreate_rate_update_nolock(d, 1);
 	/*
 	 * last_used_id must be changed along with getting new id otherwise
 	 * we might miscalculate gap causing object loss or leak
@@ -1796,6 +1904,9 @@ int osp_init_precreate(struct osp_device *d)
 	d->opd_reserved_mb_low = 0;
 	d->opd_cleanup_orphans_done = false;
 	d->opd_force_creation = false;
+	d->opd_pre_rate_stamp = ktime_get();
+	spin_lock_init(&d->opd_pre_stall_hist.oh_lock);
+	d->opd_pre_stats_init = ktime_get_real();
 
 	RETURN(0);
 }
@@ -78,18 +78,56 @@
 #define OSP_MAX_RPCS_IN_FLIGHT		8
 #define OSP_MAX_RPCS_IN_PROGRESS	4096
 #define OSP_MAX_SYNC_CHANGES		2000000000
+#define OSP_DEF_SYNC_BATCH		256
+/* setattrs sent by one OST_SETATTR_BATCH, limited by OST_MAXREQSIZE */
+#define OSP_SYNC_SETATTR_BATCH		64
 
 #define OSP_JOB_MAGIC		0x26112005
 
+/*
+ * Unlink or setattr records of the same plain llog are sent as one
+ * OST_DESTROY_BATCH or OST_SETATTR_BATCH listing all the objects, or as
+ * one OST_DESTROY with OBD_MD_FLOBJCOUNT for consecutive objects if the
+ * OST doesn't support those. The llog indices of all the records are kept
+ * here so they can be cancelled once the RPC commits. Allocated only once
+ * a second record joins the RPC.
+ */
+struct osp_sync_batch {
+	int				osb_count;
+	/* number of slots allocated in osb_idx */
+	int				osb_max;
+	/* error of a batch partly executed by the target */
+	int				osb_rc;
+	__u32				osb_idx[];
+};
+
 struct osp_job_req_args {
 	/** bytes reserved for ptlrpc_replay_req() */
 	struct ptlrpc_replay_async_args	jra_raa;
 	struct list_head		jra_committed_link;
 	struct list_head		jra_in_flight_link;
 	struct llog_cookie		jra_lcookie;
+	/* records of the batch, NULL for a single record */
+	struct osp_sync_batch		*jra_batch;
 	__u32				jra_magic;
 };
 
+static inline int osp_sync_batch_count(struct osp_job_req_args *jra)
+{
+	return jra->jra_batch ? jra->jra_batch->osb_count : 1;
+}
+
+static void osp_sync_batch_free(struct osp_job_req_args *jra)
+{
+	struct osp_sync_batch *osb = jra->jra_batch;
+
+	if (osb == NULL)
+		return;
+
+	OBD_FREE(osb, offsetof(struct osp_sync_batch, osb_idx[osb->osb_max]));
+	jra->jra_batch = NULL;
+}
+
 static int osp_sync_add_commit_cb(const struct lu_env *env,
 				  struct osp_device *d, struct thandle *th);
 
@@ -107,6 +145,32 @@ static inline int osp_sync_has_new_job(struct osp_device *d)
 		d->opd_sync_prev_done == 0;
 }
 
+/*
+ * Check whether the object is changed by a batch of setattrs, other than
+ * the first object of the batch. A batch of destroys can't conflict with the
+ * following records, the object isn't changed anymore once it is unlinked.
+ */
+static bool osp_sync_batch_has_object(struct ptlrpc_request *req,
+				      struct osp_job_req_args *jra,
+				      const struct ost_id *oi)
+{
+	struct ost_body *bodies;
+	int count;
+	int i;
+
+	if (lustre_msg_get_opc(req->rq_reqmsg) != OST_SETATTR_BATCH)
+		return false;
+
+	bodies = req_capsule_client_get(&req->rq_pill, &RMF_OST_BODIES);
+	count = osp_sync_batch_count(jra);
+	for (i = 1; i < count; i++) {
+		if (memcmp(oi, &bodies[i].oa.o_oi, sizeof(*oi)) == 0)
+			return true;
+	}
+
+	return false;
+}
+
 static inline int osp_sync_in_flight_conflict(struct osp_device *d,
 					     struct llog_rec_hdr *h)
 {
@@ -160,6 +224,22 @@ static inline int osp_sync_in_flight_conflict(struct osp_device *d,
 			conflict = 1;
 			break;
 		}
+
+		/* destroy of several objects starting from o_oi */
+		if (body->oa.o_valid & OBD_MD_FLOBJCOUNT &&
+		    body->oa.o_misc > 1 &&
+		    ostid_seq(&ostid) == ostid_seq(&body->oa.o_oi) &&
+		    ostid_id(&ostid) > ostid_id(&body->oa.o_oi) &&
+		    ostid_id(&ostid) < ostid_id(&body->oa.o_oi) +
+				       body->oa.o_misc) {
+			conflict = 1;
+			break;
+		}
+
+		if (osp_sync_batch_has_object(req, jra, &ostid)) {
+			conflict = 1;
+			break;
+		}
 	}
 	spin_unlock(&d->opd_sync_lock);
 
@@ -549,12 +629,21 @@ static int osp_sync_interpret(const struct lu_env *env,
 	       atomic_read(&req->rq_refcount),
 	       rc, (unsigned) req->rq_transno);
 
-	if (rc == -ENOENT) {
+	if (rc == -ENOENT && req->rq_transno != 0) {
+		/*
+		 * some objects of a batch were destroyed, others did not
+		 * exist anymore - the records are cancelled by the commit
+		 * callback once the destroys are committed
+		 */
+		CDEBUG(D_HA, "%s: some objects from "DOSTID" don't exist\n",
+		       d->opd_obd->obd_name,
+		       POSTID(&req_capsule_client_get(&req->rq_pill,
+						       &RMF_OST_BODY)->oa.o_oi));
+	} else if (rc == -ENOENT) {
 		/*
 		 * we tried to destroy object or update attributes,
 		 * but object doesn't exist anymore - cancell llog record
 		 */
-		LASSERT(req->rq_transno == 0);
 		LASSERT(list_empty(&jra->jra_committed_link));
 
 		ptlrpc_request_addref(req);
@@ -570,17 +659,37 @@ static int osp_sync_interpret(const struct lu_env *env,
 		/*
 		 * error happened, we'll try to repeat on next boot ?
 		 */
-		LASSERTF(req->rq_transno == 0 || rc == -EIO || rc == -EROFS ||
-			 req->rq_import_generation < imp->imp_generation,
-			 "transno %llu, rc %d, gen: req %d, imp %d\n",
-			 req->rq_transno, rc, req->rq_import_generation,
-			 imp->imp_generation);
+		if (jra->jra_batch != NULL && req->rq_transno != 0) {
+			/*
+			 * some changes of the batch were executed, but
+			 * the reply doesn't tell which ones failed - keep
+			 * all the records in the llog to be repeated, the
+			 * destroyed objects will get -ENOENT then and the
+			 * setattrs are just applied again
+			 */
+			CDEBUG(D_HA, "%s: batch of %d objects from "DOSTID
+			       " partly failed: rc = %d\n",
+			       d->opd_obd->obd_name, jra->jra_batch->osb_count,
+			       POSTID(&req_capsule_client_get(&req->rq_pill,
+						&RMF_OST_BODY)->oa.o_oi), rc);
+			jra->jra_batch->osb_rc = rc;
+		} else {
+			LASSERTF(req->rq_transno == 0 || rc == -EIO ||
+				 rc == -EROFS ||
+				 req->rq_import_generation <
+				 imp->imp_generation,
+				 "transno %llu, rc %d, gen: req %d, imp %d\n",
+				 req->rq_transno, rc,
+				 req->rq_import_generation,
+				 imp->imp_generation);
+		}
 		if (req->rq_transno == 0) {
 			/* this is the last time we see the request
 			 * if transno is not zero, then commit cb
 			 * will be called at some point */
 			LASSERT(atomic_read(&d->opd_sync_rpcs_in_progress) > 0);
 			atomic_dec(&d->opd_sync_rpcs_in_progress);
+			osp_sync_batch_free(jra);
 		}
 
 		wake_up(&d->opd_sync_waitq);
@@ -611,19 +720,20 @@ static int osp_sync_interpret(const struct lu_env *env,
 }
 
 /*
- ** Add request to ptlrpc queue.
+ ** Track request as in flight.
  *
- * This is just a tiny helper function to put the request on the sending list
+ * Initialize the job arguments and put the request on the in-flight list,
+ * so that conflicting records wait for it.
  *
  * \param[in] d		OSP device
  * \param[in] llh	llog handle where the record is stored
  * \param[in] h		llog record
  * \param[in] req	request
  */
-static void osp_sync_send_new_rpc(struct osp_device *d,
-				  struct llog_handle *llh,
-				  struct llog_rec_hdr *h,
-				  struct ptlrpc_request *req)
+static void osp_sync_track_new_rpc(struct osp_device *d,
+				   struct llog_handle *llh,
+				   struct llog_rec_hdr *h,
+				   struct ptlrpc_request *req)
 {
 	struct osp_job_req_args *jra;
 
@@ -635,14 +745,242 @@ static void osp_sync_send_new_rpc(struct osp_device *d,
 	jra->jra_lcookie.lgc_lgl = llh->lgh_id;
 	jra->jra_lcookie.lgc_subsys = LLOG_MDS_OST_ORIG_CTXT;
 	jra->jra_lcookie.lgc_index = h->lrh_index;
+	jra->jra_batch = NULL;
 	INIT_LIST_HEAD(&jra->jra_committed_link);
 	spin_lock(&d->opd_sync_lock);
 	list_add_tail(&jra->jra_in_flight_link, &d->opd_sync_in_flight_list);
 	spin_unlock(&d->opd_sync_lock);
+}
+
+/*
+ ** Add request to ptlrpc queue.
+ *
+ * This is just a tiny helper function to put the request on the sending list
+ *
+ * \param[in] d		OSP device
+ * \param[in] llh	llog handle where the record is stored
+ * \param[in] h		llog record
+ * \param[in] req	request
+ */
+static void osp_sync_send_new_rpc(struct osp_device *d,
+				  struct llog_handle *llh,
+				  struct llog_rec_hdr *h,
+				  struct ptlrpc_request *req)
+{
+	osp_sync_track_new_rpc(d, llh, h, req);
+	ptlrpcd_add_req(req);
+}
+
+/**
+ * Send the pending batch of changes, if any.
+ *
+ * The batch is already accounted as in flight and linked to the in-flight
+ * list so that conflicting records wait for it. It must be sent before the
+ * sync thread goes to sleep, otherwise those would wait forever. The array
+ * of objects of the request is shrunk to the records added to the batch.
+ *
+ * \param[in] d		OSP device
+ */
+static void osp_sync_batch_flush(struct osp_device *d)
+{
+	struct ptlrpc_request *req = d->opd_sync_batch_req;
+	struct osp_job_req_args *jra;
+	int count;
+
+	if (req == NULL)
+		return;
+
+	d->opd_sync_batch_req = NULL;
+	jra = ptlrpc_req_async_args(jra, req);
+	count = osp_sync_batch_count(jra);
+
+	switch (lustre_msg_get_opc(req->rq_reqmsg)) {
+	case OST_DESTROY_BATCH:
+		req_capsule_shrink(&req->rq_pill, &RMF_OST_IDS,
+				   count * sizeof(struct ost_id), RCL_CLIENT);
+		break;
+	case OST_SETATTR_BATCH:
+		req_capsule_shrink(&req->rq_pill, &RMF_OST_BODIES,
+				   count * sizeof(struct ost_body),
+				   RCL_CLIENT);
+		break;
+	default:
+		break;
+	}
 
+	CDEBUG(D_OTHER, "%s: send opc %u for %d objects from "DOSTID"\n",
+	       d->opd_obd->obd_name, lustre_msg_get_opc(req->rq_reqmsg), count,
+	       POSTID(&req_capsule_client_get(&req->rq_pill,
+					       &RMF_OST_BODY)->oa.o_oi));
 	ptlrpcd_add_req(req);
 }
 
+/**
+ * Number of objects the pending batch request has room for.
+ *
+ * \param[in] req	request of the batch
+ *
+ * \retval		max number of records in the batch
+ */
+static int osp_sync_batch_slots(struct ptlrpc_request *req)
+{
+	switch (lustre_msg_get_opc(req->rq_reqmsg)) {
+	case OST_DESTROY_BATCH:
+		return req_capsule_get_size(&req->rq_pill, &RMF_OST_IDS,
+					    RCL_CLIENT) /
+		       sizeof(struct ost_id);
+	case OST_SETATTR_BATCH:
+		return req_capsule_get_size(&req->rq_pill, &RMF_OST_BODIES,
+					    RCL_CLIENT) /
+		       sizeof(struct ost_body);
+	default:
+		return OSP_SYNC_MAX_BATCH;
+	}
+}
+
+static inline bool osp_sync_setattr_valid(struct llog_setattr64_rec *rec)
+{
+	/* lsr_valid can only be 0 or HAVE OBD_MD_{FLUID, FLGID, FLPROJID} set,
+	 * so no bits other than these should be set. */
+	return (rec->lsr_valid & ~(OBD_MD_FLUID | OBD_MD_FLGID |
+				   OBD_MD_FLPROJID |
+				   OBD_MD_LAYOUT_VERSION)) == 0;
+}
+
+/**
+ * Fill obdo of the setattr request from the llog record.
+ *
+ * \param[in] h		llog record
+ * \param[out] oa	obdo to fill
+ */
+static void osp_sync_setattr_pack(struct llog_rec_hdr *h, struct obdo *oa)
+{
+	struct llog_setattr64_rec *rec = (struct llog_setattr64_rec *)h;
+
+	oa->o_oi = rec->lsr_oi;
+	oa->o_uid = rec->lsr_uid;
+	oa->o_gid = rec->lsr_gid;
+	oa->o_valid = OBD_MD_FLGROUP | OBD_MD_FLID;
+	if (h->lrh_len > sizeof(struct llog_setattr64_rec)) {
+		struct llog_setattr64_rec_v2 *rec_v2 = (typeof(rec_v2))rec;
+		oa->o_projid = rec_v2->lsr_projid;
+		oa->o_layout_version = rec_v2->lsr_layout_version;
+	}
+
+	/* old setattr record (prior 2.6.0) doesn't have 'valid' stored,
+	 * we assume that both UID and GID are valid in that case. */
+	if (rec->lsr_valid == 0)
+		oa->o_valid |= (OBD_MD_FLUID | OBD_MD_FLGID);
+	else
+		oa->o_valid |= rec->lsr_valid;
+}
+
+/**
+ * Try to add a record to the pending batch.
+ *
+ * The record must be stored in the same plain llog as the records of the
+ * batch. An OST_DESTROY_BATCH takes any single-object unlink record and an
+ * OST_SETATTR_BATCH takes any setattr record, while an OST_DESTROY takes
+ * the unlink record of the object following the last object of the batch.
+ *
+ * \param[in] d		OSP device
+ * \param[in] llh	llog handle where the record is stored
+ * \param[in] h		llog record
+ *
+ * \retval true		the record was added to the batch
+ * \retval false	the record must be processed separately
+ */
+static bool osp_sync_batch_add(struct osp_device *d,
+			       struct llog_handle *llh,
+			       struct llog_rec_hdr *h)
+{
+	struct llog_unlink64_rec *rec = (struct llog_unlink64_rec *)h;
+	struct ptlrpc_request *req = d->opd_sync_batch_req;
+	struct osp_job_req_args *jra;
+	struct osp_sync_batch *osb;
+	struct ost_body *body;
+	struct ost_id oi;
+	__u32 opc;
+	int count;
+
+	if (req == NULL)
+		return false;
+
+	jra = ptlrpc_req_async_args(jra, req);
+	osb = jra->jra_batch;
+	count = osp_sync_batch_count(jra);
+	if ((osb != NULL && count >= osb->osb_max) ||
+	    memcmp(&jra->jra_lcookie.lgc_lgl, &llh->lgh_id,
+		   sizeof(llh->lgh_id)) != 0)
+		return false;
+
+	body = req_capsule_client_get(&req->rq_pill, &RMF_OST_BODY);
+	opc = lustre_msg_get_opc(req->rq_reqmsg);
+	switch (opc) {
+	case OST_DESTROY:
+	case OST_DESTROY_BATCH:
+		if (h->lrh_type != MDS_UNLINK64_REC || rec->lur_count != 1 ||
+		    fid_to_ostid(&rec->lur_fid, &oi) < 0)
+			return false;
+
+		if (opc == OST_DESTROY &&
+		    (ostid_seq(&oi) != ostid_seq(&body->oa.o_oi) ||
+		     ostid_id(&oi) != ostid_id(&body->oa.o_oi) +
+				      body->oa.o_misc))
+			return false;
+		break;
+	case OST_SETATTR_BATCH:
+		if (h->lrh_type != MDS_SETATTR64_REC ||
+		    CFS_FAIL_PRECHECK(OBD_FAIL_OSP_CHECK_INVALID_REC) ||
+		    !osp_sync_setattr_valid((struct llog_setattr64_rec *)h))
+			return false;
+		break;
+	default:
+		return false;
+	}
+
+	if (osb == NULL) {
+		int max = min(d->opd_sync_max_batch,
+			      osp_sync_batch_slots(req));
+
+		/* the second record, the first one is in jra_lcookie */
+		if (max <= 1)
+			return false;
+
+		OBD_ALLOC(osb, offsetof(struct osp_sync_batch, osb_idx[max]));
+		if (osb == NULL)
+			return false;
+
+		osb->osb_max = max;
+		osb->osb_idx[0] = jra->jra_lcookie.lgc_index;
+		osb->osb_count = 1;
+		jra->jra_batch = osb;
+	}
+
+	if (opc == OST_DESTROY_BATCH) {
+		struct ost_id *ids;
+
+		ids = req_capsule_client_get(&req->rq_pill, &RMF_OST_IDS);
+		ids[count] = oi;
+	} else if (opc == OST_SETATTR_BATCH) {
+		struct ost_body *bodies;
+
+		bodies = req_capsule_client_get(&req->rq_pill,
+						&RMF_OST_BODIES);
+		osp_sync_setattr_pack(h, &bodies[count].oa);
+	}
+
+	osb->osb_idx[count] = h->lrh_index;
+	/* osp_sync_in_flight_conflict() checks the batch under the lock */
+	spin_lock(&d->opd_sync_lock);
+	osb->osb_count++;
+	if (opc == OST_DESTROY)
+		body->oa.o_misc++;
+	spin_unlock(&d->opd_sync_lock);
+
+	return true;
+}
+
 
 /**
  * Allocate and prepare RPC for a new change.
@@ -655,13 +993,17 @@ static void osp_sync_send_new_rpc(struct osp_device *d,
  * \param[in] d		OSP device
  * \param[in] op	type of the change
  * \param[in] format	request format to be used
+ * \param[in] array	array of objects of a batch request, NULL otherwise
+ * \param[in] size	size of \a array in bytes
  *
  * \retval pointer		new request on success
  * \retval ERR_PTR(errno)	on error
  */
 static struct ptlrpc_request *osp_sync_new_job(struct osp_device *d,
 					       enum ost_cmd op,
-					       const struct req_format *format)
+					       const struct req_format *format,
+					       const struct req_msg_field *array,
+					       __u32 size)
 {
 	struct ptlrpc_request	*req;
 	struct obd_import	*imp;
@@ -678,6 +1020,9 @@ static struct ptlrpc_request *osp_sync_new_job(struct osp_device *d,
 	if (req == NULL)
 		RETURN(ERR_PTR(-ENOMEM));
 
+	if (array != NULL)
+		req_capsule_set_size(&req->rq_pill, array, RCL_CLIENT, size);
+
 	rc = ptlrpc_request_pack(req, LUSTRE_OST_VERSION, op);
 	if (rc) {
 		ptlrpc_req_finished(req);
@@ -697,7 +1042,8 @@ static struct ptlrpc_request *osp_sync_new_job(struct osp_device *d,
  * Generate a request for setattr change.
  *
  * The function prepares a new RPC, initializes it with setattr specific
- * bits and send the RPC.
+ * bits and send the RPC. If the OST supports OST_SETATTR_BATCH, the RPC
+ * is held so that the following setattr records can be added to it.
  *
  * \param[in] d		OSP device
  * \param[in] llh	llog handle where the record is stored
@@ -712,8 +1058,10 @@ static int osp_sync_new_setattr_job(struct osp_device *d,
 				    struct llog_rec_hdr *h)
 {
 	struct llog_setattr64_rec	*rec = (struct llog_setattr64_rec *)h;
+	struct obd_import		*imp = d->opd_obd->u.cli.cl_import;
 	struct ptlrpc_request		*req;
 	struct ost_body			*body;
+	bool				 batch;
 
 	ENTRY;
 	LASSERT(h->lrh_type == MDS_SETATTR64_REC);
@@ -721,38 +1069,43 @@ static int osp_sync_new_setattr_job(struct osp_device *d,
 	if (CFS_FAIL_CHECK(OBD_FAIL_OSP_CHECK_INVALID_REC))
 		RETURN(1);
 
-	/* lsr_valid can only be 0 or HAVE OBD_MD_{FLUID, FLGID, FLPROJID} set,
-	 * so no bits other than these should be set. */
-	if ((rec->lsr_valid & ~(OBD_MD_FLUID | OBD_MD_FLGID |
-	    OBD_MD_FLPROJID | OBD_MD_LAYOUT_VERSION)) != 0) {
+	if (!osp_sync_setattr_valid(rec)) {
 		CERROR("%s: invalid setattr record, lsr_valid:%llu\n",
 			d->opd_obd->obd_name, rec->lsr_valid);
 		/* return 1 on invalid record */
 		RETURN(1);
 	}
 
-	req = osp_sync_new_job(d, OST_SETATTR, &RQF_OST_SETATTR);
+	batch = d->opd_sync_max_batch > 1 && imp_connect_sync_batch(imp);
+	if (batch)
+		req = osp_sync_new_job(d, OST_SETATTR_BATCH,
+				       &RQF_OST_SETATTR_BATCH, &RMF_OST_BODIES,
+				       min(d->opd_sync_max_batch,
+					   OSP_SYNC_SETATTR_BATCH) *
+				       sizeof(struct ost_body));
+	else
+		req = osp_sync_new_job(d, OST_SETATTR, &RQF_OST_SETATTR,
+				       NULL, 0);
 	if (IS_ERR(req))
 		RETURN(PTR_ERR(req));
 
 	body = req_capsule_client_get(&req->rq_pill, &RMF_OST_BODY);
 	LASSERT(body);
-	body->oa.o_oi = rec->lsr_oi;
-	body->oa.o_uid = rec->lsr_uid;
-	body->oa.o_gid = rec->lsr_gid;
-	body->oa.o_valid = OBD_MD_FLGROUP | OBD_MD_FLID;
-	if (h->lrh_len > sizeof(struct llog_setattr64_rec)) {
-		struct llog_setattr64_rec_v2 *rec_v2 = (typeof(rec_v2))rec;
-		body->oa.o_projid = rec_v2->lsr_projid;
-		body->oa.o_layout_version = rec_v2->lsr_layout_version;
-	}
+	osp_sync_setattr_pack(h, &body->oa);
 
-	/* old setattr record (prior 2.6.0) doesn't have 'valid' stored,
-	 * we assume that both UID and GID are valid in that case. */
-	if (rec->lsr_valid == 0)
-		body->oa.o_valid |= (OBD_MD_FLUID | OBD_MD_FLGID);
-	else
-		body->oa.o_valid |= rec->lsr_valid;
+	/* hold the RPC, setattrs of other objects can be added to it */
+	if (batch) {
+		struct ost_body *bodies;
+
+		bodies = req_capsule_client_get(&req->rq_pill,
+						&RMF_OST_BODIES);
+		bodies[0] = *body;
+		osp_sync_track_new_rpc(d, llh, h, req);
+
+		LASSERT(d->opd_sync_batch_req == NULL);
+		d->opd_sync_batch_req = req;
+		RETURN(0);
+	}
 
 	osp_sync_send_new_rpc(d, llh, h, req);
 	RETURN(0);
@@ -785,7 +1138,7 @@ static int osp_sync_new_unlink_job(struct osp_device *d,
 	ENTRY;
 	LASSERT(h->lrh_type == MDS_UNLINK_REC);
 
-	req = osp_sync_new_job(d, OST_DESTROY, &RQF_OST_DESTROY);
+	req = osp_sync_new_job(d, OST_DESTROY, &RQF_OST_DESTROY, NULL, 0);
 	if (IS_ERR(req))
 		RETURN(PTR_ERR(req));
 
@@ -810,10 +1163,9 @@ static int osp_sync_new_unlink_job(struct osp_device *d,
  * The function prepares a new RPC, initializes it with unlink(destroy)
  * specific bits and sends the RPC. Depending on the target (MDT or OST)
  * two different protocols are used. For MDT we use OUT (basically OSD API
- * updates transferred via a network). For OST we still use the old
- * protocol (OBD?), originally for compatibility. Later we can start to
- * use OUT for OST as well, this will allow batching and better code
- * unification.
+ * updates transferred via a network). For OST we use OST_DESTROY_BATCH
+ * if the OST supports it, so the RPC is held and the following unlink
+ * records are added to it, or the old OST_DESTROY otherwise.
  *
  * \param[in] d		OSP device
  * \param[in] llh	llog handle where the record is stored
@@ -827,13 +1179,26 @@ static int osp_sync_new_unlink64_job(struct osp_device *d,
 				     struct llog_rec_hdr *h)
 {
 	struct llog_unlink64_rec	*rec = (struct llog_unlink64_rec *)h;
+	struct obd_import		*imp = d->opd_obd->u.cli.cl_import;
 	struct ptlrpc_request		*req = NULL;
 	struct ost_body			*body;
+	bool				 batch;
+	bool				 multi;
 	int				 rc;
 
 	ENTRY;
 	LASSERT(h->lrh_type == MDS_UNLINK64_REC);
-	req = osp_sync_new_job(d, OST_DESTROY, &RQF_OST_DESTROY);
+
+	batch = d->opd_sync_max_batch > 1 && rec->lur_count == 1;
+	multi = batch && imp_connect_sync_batch(imp);
+	if (multi)
+		req = osp_sync_new_job(d, OST_DESTROY_BATCH,
+				       &RQF_OST_DESTROY_BATCH, &RMF_OST_IDS,
+				       d->opd_sync_max_batch *
+				       sizeof(struct ost_id));
+	else
+		req = osp_sync_new_job(d, OST_DESTROY, &RQF_OST_DESTROY,
+				       NULL, 0);
 	if (IS_ERR(req))
 		RETURN(PTR_ERR(req));
 
@@ -843,9 +1208,28 @@ static int osp_sync_new_unlink64_job(struct osp_device *d,
 	rc = fid_to_ostid(&rec->lur_fid, &body->oa.o_oi);
 	if (rc < 0)
 		RETURN(rc);
-	body->oa.o_misc = rec->lur_count;
-	body->oa.o_valid = OBD_MD_FLGROUP | OBD_MD_FLID |
-			   OBD_MD_FLOBJCOUNT;
+
+	if (multi) {
+		struct ost_id *ids;
+
+		ids = req_capsule_client_get(&req->rq_pill, &RMF_OST_IDS);
+		ids[0] = body->oa.o_oi;
+		body->oa.o_valid = OBD_MD_FLGROUP | OBD_MD_FLID;
+	} else {
+		body->oa.o_misc = rec->lur_count;
+		body->oa.o_valid = OBD_MD_FLGROUP | OBD_MD_FLID |
+				   OBD_MD_FLOBJCOUNT;
+	}
+
+	/* hold the RPC, destroys of other objects can be added to it */
+	if (batch) {
+		osp_sync_track_new_rpc(d, llh, h, req);
+
+		LASSERT(d->opd_sync_batch_req == NULL);
+		d->opd_sync_batch_req = req;
+		RETURN(0);
+	}
+
 	osp_sync_send_new_rpc(d, llh, h, req);
 	RETURN(0);
 }
@@ -883,6 +1267,17 @@ static void osp_sync_process_record(const struct lu_env *env,
 
 	d->opd_sync_last_catalog_idx = llh->lgh_hdr->llh_cat_idx;
 
+	if (osp_sync_batch_add(d, llh, rec)) {
+		if (d->opd_sync_prev_done) {
+			LASSERT(atomic_read(&d->opd_sync_changes) > 0);
+			atomic_dec(&d->opd_sync_changes);
+			wake_up(&d->opd_sync_barrier_waitq);
+		}
+		atomic64_inc(&d->opd_sync_processed_recs);
+		RETURN_EXIT;
+	}
+	osp_sync_batch_flush(d);
+
 	if (unlikely(rec->lrh_type == LLOG_GEN_REC)) {
 		struct llog_gen_rec *gen = (struct llog_gen_rec *)rec;
 
@@ -967,6 +1362,31 @@ static void osp_sync_process_record(const struct lu_env *env,
 	RETURN_EXIT;
 }
 
+/**
+ * Cancel an array of records from the same plain llog.
+ *
+ * \param[in] env	LU environment provided by the caller
+ * \param[in] d		OSP device
+ * \param[in] llh	catalog handle
+ * \param[in] lgid	plain llog the records belong to
+ * \param[in] count	number of records
+ * \param[in] arr	llog indices of the records
+ */
+static void osp_sync_cancel_arr(const struct lu_env *env,
+				struct osp_device *d, struct llog_handle *llh,
+				struct llog_logid *lgid, int count, int *arr)
+{
+	int rc;
+
+	rc = llog_cat_cancel_arr_rec(env, llh, lgid, count, arr);
+	if (rc)
+		CERROR("%s: can't cancel %d records: rc = %d\n",
+		       d->opd_obd->obd_name, count, rc);
+	else
+		CDEBUG(D_OTHER, "%s: massive records cancel id "DFID" num %d\n",
+		       d->opd_obd->obd_name, PLOGID(lgid), count);
+}
+
 /**
  * Cancel llog records for the committed changes.
  *
@@ -976,9 +1396,13 @@ static void osp_sync_process_record(const struct lu_env *env,
  *
  * \param[in] env	LU environment provided by the caller
  * \param[in] d		OSP device
+ * \param[in] list	list of the committed RPCs
+ *
+ * \retval		number of RPCs released
  */
-static void osp_sync_process_committed(const struct lu_env *env,
-				       struct osp_device *d)
+static int osp_sync_cancel_committed(const struct lu_env *env,
+				     struct osp_device *d,
+				     struct list_head *list)
 {
 	struct obd_device	*obd = d->opd_obd;
 	struct obd_import	*imp = obd->u.cli.cl_import;
@@ -987,45 +1411,25 @@ static void osp_sync_process_committed(const struct lu_env *env,
 	struct llog_ctxt	*ctxt;
 	struct llog_handle	*llh;
 	int			*arr, arr_size;
-	LIST_HEAD(list);
 	struct list_head	 *le;
 	struct llog_logid	 lgid;
 	int			 rc, i, count = 0, done = 0;
 
 	ENTRY;
 
-	if (list_empty(&d->opd_sync_committed_there))
-		return;
-
-	/*
-	 * if current status is -ENOSPC (lack of free space on OST)
-	 * then we should poll OST immediately once object destroy
-	 * is committed.
-	 * notice: we do this upon commit as well because some backends
-	 * (like DMU) do not release space right away.
-	 */
-	if (d->opd_pre != NULL && unlikely(d->opd_pre_status == -ENOSPC))
-		osp_statfs_need_now(d);
-
-	/*
-	 * now cancel them all
-	 * XXX: can we improve this using some batching?
-	 *      with batch RPC that'll happen automatically?
-	 * XXX: can we store ctxt in lod_device and save few cycles ?
-	 */
 	ctxt = llog_get_context(obd, LLOG_MDS_OST_ORIG_CTXT);
 	LASSERT(ctxt);
 
 	llh = ctxt->loc_handle;
 	LASSERT(llh);
 
-	spin_lock(&d->opd_sync_lock);
-	list_splice(&d->opd_sync_committed_there, &list);
-	INIT_LIST_HEAD(&d->opd_sync_committed_there);
-	spin_unlock(&d->opd_sync_lock);
+	list_for_each(le, list) {
+		struct osp_job_req_args *jra;
 
-	list_for_each(le, &list)
-		count++;
+		jra = list_entry(le, struct osp_job_req_args,
+				 jra_committed_link);
+		count += osp_sync_batch_count(jra);
+	}
 	if (count > 2) {
 		arr_size = sizeof(int) * count;
 		/* limit cookie array to order 2 */
@@ -1037,10 +1441,10 @@ static void osp_sync_process_committed(const struct lu_env *env,
 		arr_size = 0;
 	}
 	i = 0;
-	while (!list_empty(&list)) {
+	while (!list_empty(list)) {
 		struct osp_job_req_args	*jra;
 
-		jra = list_first_entry(&list, struct osp_job_req_args,
+		jra = list_first_entry(list, struct osp_job_req_args,
 				       jra_committed_link);
 		LASSERT(jra->jra_magic == OSP_JOB_MAGIC);
 		list_del_init(&jra->jra_committed_link);
@@ -1052,41 +1456,53 @@ static void osp_sync_process_committed(const struct lu_env *env,
 		LASSERT(body);
 		/* import can be closing, thus all commit cb's are
 		 * called we can check committness directly */
-		if (req->rq_import_generation == imp->imp_generation) {
-			if (arr && (!i ||
-				    !memcmp(&jra->jra_lcookie.lgc_lgl, &lgid,
-					   sizeof(lgid)))) {
-				if (unlikely(!i))
-					lgid = jra->jra_lcookie.lgc_lgl;
-
-				arr[i++] = jra->jra_lcookie.lgc_index;
-			} else {
-				rc = llog_cat_cancel_records(env, llh, 1,
-							     &jra->jra_lcookie);
-				if (rc)
-					CERROR("%s: can't cancel record: rc = %d\n",
-					       obd->obd_name, rc);
+		if (jra->jra_batch != NULL && jra->jra_batch->osb_rc != 0) {
+			/* leave the records to be repeated later */
+			DEBUG_REQ(D_HA, req, "keep %d records, rc = %d",
+				  jra->jra_batch->osb_count,
+				  jra->jra_batch->osb_rc);
+		} else if (req->rq_import_generation == imp->imp_generation) {
+			struct osp_sync_batch *osb = jra->jra_batch;
+			int nr = osp_sync_batch_count(jra);
+			int k;
+
+			for (k = 0; k < nr; k++) {
+				if (osb)
+					jra->jra_lcookie.lgc_index =
+						osb->osb_idx[k];
+
+				if (arr && (!i ||
+					    !memcmp(&jra->jra_lcookie.lgc_lgl,
+						    &lgid, sizeof(lgid)))) {
+					if (unlikely(!i))
+						lgid = jra->jra_lcookie.lgc_lgl;
+
+					arr[i++] = jra->jra_lcookie.lgc_index;
+				} else {
+					rc = llog_cat_cancel_records(env, llh, 1,
+							&jra->jra_lcookie);
+					if (rc)
+						CERROR("%s: can't cancel record: rc = %d\n",
+						       obd->obd_name, rc);
+				}
+
+				if (arr && (i * sizeof(int)) == arr_size) {
+					osp_sync_cancel_arr(env, d, llh, &lgid,
+							    i, arr);
+					i = 0;
+				}
 			}
 		} else {
 			DEBUG_REQ(D_OTHER, req, "imp_committed = %llu",
 				  imp->imp_peer_committed_transno);
 		}
+		osp_sync_batch_free(jra);
 		ptlrpc_req_finished(req);
 		done++;
-		if (arr &&
-		    ((i * sizeof(int)) == arr_size ||
-		     (list_empty(&list) && i > 0))) {
-			rc = llog_cat_cancel_arr_rec(env, llh, &lgid, i, arr);
-
-			if (rc)
-				CERROR("%s: can't cancel %d records: rc = %d\n",
-				       obd->obd_name, i, rc);
-			else
-				CDEBUG(D_OTHER, "%s: massive records cancel id "DFID" num %d\n",
-				       obd->obd_name, PLOGID(&lgid), i);
+		if (arr && list_empty(list) && i > 0) {
+			osp_sync_cancel_arr(env, d, llh, &lgid, i, arr);
 			i = 0;
 		}
-
 	}
 
 	if (arr)
@@ -1094,6 +1510,17 @@ static void osp_sync_process_committed(const struct lu_env *env,
 
 	llog_ctxt_put(ctxt);
 
+	RETURN(done);
+}
+
+/**
+ * Account RPCs released by cancelling their llog records.
+ *
+ * \param[in] d		OSP device
+ * \param[in] done	number of RPCs released
+ */
+static void osp_sync_committed_done(struct osp_device *d, int done)
+{
 	LASSERT(atomic_read(&d->opd_sync_rpcs_in_progress) >= done);
 	atomic_sub(done, &d->opd_sync_rpcs_in_progress);
 	CDEBUG((done > 2 ? D_HA : D_OTHER), "%s: %u changes, %u in progress,"
@@ -1111,6 +1538,184 @@ static void osp_sync_process_committed(const struct lu_env *env,
 	 */
 	if (atomic_read(&d->opd_sync_rpcs_in_progress) == 0)
 		wake_up(&d->opd_sync_waitq);
+}
+
+/**
+ * Cancel llog records of the committed changes handed to a shard.
+ *
+ * \param[in] work	work item of the shard
+ */
+static void osp_sync_shard_work(struct work_struct *work)
+{
+	struct osp_sync_shard *shard = container_of(work, struct osp_sync_shard,
+						    oss_work);
+	struct osp_device *d = shard->oss_dev;
+	LIST_HEAD(list);
+	int done;
+
+	spin_lock(&d->opd_sync_lock);
+	list_splice_init(&shard->oss_committed, &list);
+	spin_unlock(&d->opd_sync_lock);
+
+	done = osp_sync_cancel_committed(&shard->oss_env, d, &list);
+	osp_sync_committed_done(d, done);
+}
+
+/**
+ * Stop the workers cancelling llog records and release their resources.
+ *
+ * \param[in] d		OSP device
+ */
+static void osp_sync_shards_fini(struct osp_device *d)
+{
+	int i;
+
+	if (d->opd_sync_wq != NULL) {
+		destroy_workqueue(d->opd_sync_wq);
+		d->opd_sync_wq = NULL;
+	}
+
+	if (d->opd_sync_shards == NULL)
+		return;
+
+	for (i = 0; i < d->opd_sync_nr_shards; i++) {
+		LASSERT(list_empty(&d->opd_sync_shards[i].oss_committed));
+		lu_env_fini(&d->opd_sync_shards[i].oss_env);
+	}
+	OBD_FREE_PTR_ARRAY(d->opd_sync_shards, d->opd_sync_nr_shards);
+	d->opd_sync_shards = NULL;
+	d->opd_sync_nr_shards = 0;
+}
+
+/**
+ * Start the workers cancelling llog records of the committed changes.
+ *
+ * Called by the sync thread the first time the records are cancelled with
+ * more than one worker, or once the number of workers is changed.
+ *
+ * \param[in] d		OSP device
+ * \param[in] nr		number of workers
+ *
+ * \retval 0		on success
+ * \retval negative	negated errno on error
+ */
+static int osp_sync_shards_init(struct osp_device *d, int nr)
+{
+	struct osp_sync_shard *shard;
+	char name[24];
+	int rc;
+	int i;
+
+	LASSERT(d->opd_sync_shards == NULL);
+
+	OBD_ALLOC_PTR_ARRAY(d->opd_sync_shards, nr);
+	if (d->opd_sync_shards == NULL)
+		GOTO(out, rc = -ENOMEM);
+
+	for (i = 0; i < nr; i++) {
+		shard = &d->opd_sync_shards[i];
+		shard->oss_dev = d;
+		INIT_WORK(&shard->oss_work, osp_sync_shard_work);
+		INIT_LIST_HEAD(&shard->oss_committed);
+		rc = lu_env_init(&shard->oss_env, LCT_LOCAL);
+		if (rc)
+			GOTO(out, rc);
+		d->opd_sync_nr_shards++;
+	}
+
+	snprintf(name, sizeof(name), "osp-syn-%u-%u", d->opd_index,
+		 d->opd_group);
+	d->opd_sync_wq = cfs_cpt_bind_workqueue(name, cfs_cpt_tab, 0,
+						CFS_CPT_ANY, nr);
+	if (IS_ERR(d->opd_sync_wq)) {
+		rc = PTR_ERR(d->opd_sync_wq);
+		d->opd_sync_wq = NULL;
+		GOTO(out, rc);
+	}
+
+	return 0;
+out:
+	CWARN("%s: can't start %d sync workers, cancel serially: rc = %d\n",
+	      d->opd_obd->obd_name, nr, rc);
+	osp_sync_shards_fini(d);
+	/* do not retry with every commit */
+	d->opd_sync_threads = 1;
+	return rc;
+}
+
+/**
+ * Process the changes committed by the target.
+ *
+ * Changes are spread among the sync workers by plain llog, so that every
+ * plain llog is cancelled by a single worker and the workers don't contend
+ * on the same llog. The sync thread waits for the workers, so the records
+ * are never cancelled while its llog_cat_process() is running. With a
+ * single worker the records are cancelled right here by the sync thread.
+ *
+ * \param[in] env	LU environment provided by the caller
+ * \param[in] d		OSP device
+ */
+static void osp_sync_process_committed(const struct lu_env *env,
+				       struct osp_device *d)
+{
+	struct osp_job_req_args *jra, *tmp;
+	struct osp_sync_shard *shard;
+	LIST_HEAD(list);
+	int nr = READ_ONCE(d->opd_sync_threads);
+	int done;
+
+	ENTRY;
+
+	if (list_empty(&d->opd_sync_committed_there))
+		return;
+
+	/*
+	 * if current status is -ENOSPC (lack of free space on OST)
+	 * then we should poll OST immediately once object destroy
+	 * is committed.
+	 * notice: we do this upon commit as well because some backends
+	 * (like DMU) do not release space right away.
+	 */
+	if (d->opd_pre != NULL && unlikely(d->opd_pre_status == -ENOSPC))
+		osp_statfs_need_now(d);
+
+	/* the workers are idle here, resize them to the tunable */
+	if (nr <= 1) {
+		osp_sync_shards_fini(d);
+	} else if (nr != d->opd_sync_nr_shards) {
+		osp_sync_shards_fini(d);
+		if (osp_sync_shards_init(d, nr) != 0)
+			nr = 1;
+	}
+
+	spin_lock(&d->opd_sync_lock);
+	if (nr <= 1) {
+		list_splice_init(&d->opd_sync_committed_there, &list);
+		spin_unlock(&d->opd_sync_lock);
+		done = osp_sync_cancel_committed(env, d, &list);
+		osp_sync_committed_done(d, done);
+		RETURN_EXIT;
+	}
+
+	list_for_each_entry_safe(jra, tmp, &d->opd_sync_committed_there,
+				 jra_committed_link) {
+		shard = &d->opd_sync_shards[logid_id(&jra->jra_lcookie.lgc_lgl) %
+					    nr];
+		list_move_tail(&jra->jra_committed_link,
+			       &shard->oss_committed);
+	}
+	for (shard = d->opd_sync_shards; shard < d->opd_sync_shards + nr;
+	     shard++)
+		if (!list_empty(&shard->oss_committed))
+			queue_work(d->opd_sync_wq, &shard->oss_work);
+	spin_unlock(&d->opd_sync_lock);
+
+	/*
+	 * llog_cat_process() of this thread is suspended in the middle of
+	 * the catalog, the records can be cancelled only as long as it is
+	 * parked in osp_sync_process_queues()
+	 */
+	flush_workqueue(d->opd_sync_wq);
 
 	EXIT;
 }
@@ -1141,6 +1746,7 @@ static int osp_sync_process_queues(const struct lu_env *env,
 	do {
 		if (!d->opd_sync_task) {
 			CDEBUG(D_HA, "stop llog processing\n");
+			osp_sync_batch_flush(d);
 			return LLOG_PROC_BREAK;
 		}
 
@@ -1162,6 +1768,11 @@ static int osp_sync_process_queues(const struct lu_env *env,
 			    cfs_fail_val != 1)
 			msleep(1 * MSEC_PER_SEC);
 
+		/* nothing more to add to the batch for now */
+		if (d->opd_sync_batch_req != NULL &&
+		    !osp_sync_can_process_new(d, rec))
+			osp_sync_batch_flush(d);
+
 		wait_event_idle(d->opd_sync_waitq,
 				!d->opd_sync_task ||
 				osp_sync_can_process_new(d, rec) ||
@@ -1287,6 +1898,7 @@ next:
 		 atomic_read(&d->opd_sync_rpcs_in_flight));
 
 wait:
+	osp_sync_batch_flush(d);
 	/* wait till all the requests are completed */
 	count = 0;
 	while (atomic_read(&d->opd_sync_rpcs_in_progress) > 0) {
@@ -1305,6 +1917,8 @@ wait:
 			 list_empty(&d->opd_sync_committed_there) ? "" : "!");
 
 	}
+	/* the workers are idle, nothing is left to cancel */
+	osp_sync_shards_fini(d);
 
 	llog_cat_close(env, llh);
 	rc = llog_cleanup(env, ctxt);
@@ -1506,6 +2120,8 @@ int osp_sync_init(const struct lu_env *env, struct osp_device *d)
 
 	d->opd_sync_max_rpcs_in_flight = OSP_MAX_RPCS_IN_FLIGHT;
 	d->opd_sync_max_rpcs_in_progress = OSP_MAX_RPCS_IN_PROGRESS;
+	d->opd_sync_max_batch = OSP_DEF_SYNC_BATCH;
+	d->opd_sync_threads = OSP_SYNC_THREADS_DEF;
 	d->opd_sync_max_changes = OSP_MAX_SYNC_CHANGES;
 	spin_lock_init(&d->opd_sync_lock);
 	init_waitqueue_head(&d->opd_sync_waitq);
@@ -109,6 +109,11 @@ static const struct req_msg_field *quota_body_only[] = {
 	&RMF_QUOTA_BODY
 };
 
+static const struct req_msg_field *quota_batch_only[] = {
+	&RMF_PTLRPC_BODY,
+	&RMF_QUOTA_BATCH
+};
+
 static const struct req_msg_field *ldlm_intent_quota_client[] = {
 	&RMF_PTLRPC_BODY,
 	&RMF_DLM_REQ,
@@ -655,6 +660,18 @@ static const struct req_msg_field *ost_destroy_client[] = {
 	&RMF_CAPA1
 };
 
+static const struct req_msg_field *ost_destroy_batch_client[] = {
+	&RMF_PTLRPC_BODY,
+	&RMF_OST_BODY,
+	&RMF_OST_IDS
+};
+
+static const struct req_msg_field *ost_setattr_batch_client[] = {
+	&RMF_PTLRPC_BODY,
+	&RMF_OST_BODY,
+	&RMF_OST_BODIES
+};
+
 
 static const struct req_msg_field *ost_brw_client[] = {
 	&RMF_PTLRPC_BODY,
@@ -795,6 +812,23 @@ static const struct req_msg_field *mds_batch_getattr_server[] = {
 	&RMF_FILE_ENCCTX,
 };
 
+static const struct req_msg_field *mds_batch_getxattr_client[] = {
+	&RMF_DLM_REQ,
+	&RMF_LDLM_INTENT,
+	&RMF_MDT_BODY,     /* coincides with ldlm_intent_getxattr_client[] */
+	&RMF_CAPA1,
+};
+
+static const struct req_msg_field *mds_batch_getxattr_server[] = {
+	&RMF_DLM_REP,
+	&RMF_MDT_BODY,
+	&RMF_MDT_MD,
+	&RMF_ACL,
+	&RMF_EADATA,
+	&RMF_EAVALS,
+	&RMF_EAVALS_LENS
+};
+
 static struct req_format *req_formats[] = {
 	&RQF_OBD_PING,
 	&RQF_OBD_SET_INFO,
@@ -858,6 +892,8 @@ static struct req_format *req_formats[] = {
 	&RQF_OST_FALLOCATE,
 	&RQF_OST_SYNC,
 	&RQF_OST_DESTROY,
+	&RQF_OST_DESTROY_BATCH,
+	&RQF_OST_SETATTR_BATCH,
 	&RQF_OST_BRW_READ,
 	&RQF_OST_BRW_WRITE,
 	&RQF_OST_STATFS,
@@ -887,6 +923,7 @@ static struct req_format *req_formats[] = {
 	&RQF_LDLM_INTENT_GETXATTR,
 	&RQF_LDLM_INTENT_QUOTA,
 	&RQF_QUOTA_DQACQ,
+	&RQF_QUOTA_DQACQ_BATCH,
 	&RQF_LLOG_ORIGIN_HANDLE_CREATE,
 	&RQF_LLOG_ORIGIN_HANDLE_NEXT_BLOCK,
 	&RQF_LLOG_ORIGIN_HANDLE_PREV_BLOCK,
@@ -895,6 +932,7 @@ static struct req_format *req_formats[] = {
 	&RQF_LFSCK_NOTIFY,
 	&RQF_LFSCK_QUERY,
 	&RQF_BUT_GETATTR,
+	&RQF_BUT_GETXATTR,
 	&RQF_MDS_BATCH,
 };
 
@@ -1041,6 +1079,11 @@ struct req_msg_field RMF_QUOTA_BODY =
 		    sizeof(struct quota_body), lustre_swab_quota_body, NULL);
 EXPORT_SYMBOL(RMF_QUOTA_BODY);
 
+struct req_msg_field RMF_QUOTA_BATCH =
+	DEFINE_MSGF("quota_batch", RMF_F_STRUCT_ARRAY,
+		    sizeof(struct quota_body), lustre_swab_quota_body, NULL);
+EXPORT_SYMBOL(RMF_QUOTA_BATCH);
+
 struct req_msg_field RMF_MDT_EPOCH =
 	DEFINE_MSGF("mdt_ioepoch", 0, sizeof(struct mdt_ioepoch),
 		    lustre_swab_mdt_ioepoch, NULL);
@@ -1214,6 +1257,12 @@ struct req_msg_field RMF_OST_BODY =
 		    dump_ost_body);
 EXPORT_SYMBOL(RMF_OST_BODY);
 
+struct req_msg_field RMF_OST_BODIES =
+	DEFINE_MSGF("ost_bodies", RMF_F_STRUCT_ARRAY,
+		    sizeof(struct ost_body), lustre_swab_ost_body,
+		    dump_ost_body);
+EXPORT_SYMBOL(RMF_OST_BODIES);
+
 struct req_msg_field RMF_OBD_IOOBJ =
 	DEFINE_MSGF("obd_ioobj", RMF_F_STRUCT_ARRAY,
 		    sizeof(struct obd_ioobj), lustre_swab_obd_ioobj, dump_ioo);
@@ -1256,6 +1305,11 @@ struct req_msg_field RMF_OST_ID =
 		    sizeof(struct ost_id), lustre_swab_ost_id, NULL);
 EXPORT_SYMBOL(RMF_OST_ID);
 
+struct req_msg_field RMF_OST_IDS =
+	DEFINE_MSGF("ost_ids", RMF_F_STRUCT_ARRAY,
+		    sizeof(struct ost_id), lustre_swab_ost_id, NULL);
+EXPORT_SYMBOL(RMF_OST_IDS);
+
 struct req_msg_field RMF_FIEMAP_KEY =
 	DEFINE_MSGF("fiemap_key", 0, sizeof(struct ll_fiemap_info_key),
 		    lustre_swab_fiemap_info_key, NULL);
@@ -1457,6 +1511,11 @@ struct req_format RQF_QUOTA_DQACQ =
 	DEFINE_REQ_FMT0("QUOTA_DQACQ", quota_body_only, quota_body_only);
 EXPORT_SYMBOL(RQF_QUOTA_DQACQ);
 
+struct req_format RQF_QUOTA_DQACQ_BATCH =
+	DEFINE_REQ_FMT0("QUOTA_DQACQ_BATCH", quota_batch_only,
+			quota_batch_only);
+EXPORT_SYMBOL(RQF_QUOTA_DQACQ_BATCH);
+
 struct req_format RQF_LDLM_INTENT_QUOTA =
 	DEFINE_REQ_FMT0("LDLM_INTENT_QUOTA",
 			ldlm_intent_quota_client,
@@ -1772,6 +1831,16 @@ struct req_format RQF_OST_DESTROY =
 	DEFINE_REQ_FMT0("OST_DESTROY", ost_destroy_client, ost_body_only);
 EXPORT_SYMBOL(RQF_OST_DESTROY);
 
+struct req_format RQF_OST_DESTROY_BATCH =
+	DEFINE_REQ_FMT0("OST_DESTROY_BATCH", ost_destroy_batch_client,
+			ost_body_only);
+EXPORT_SYMBOL(RQF_OST_DESTROY_BATCH);
+
+struct req_format RQF_OST_SETATTR_BATCH =
+	DEFINE_REQ_FMT0("OST_SETATTR_BATCH", ost_setattr_batch_client,
+			ost_body_only);
+EXPORT_SYMBOL(RQF_OST_SETATTR_BATCH);
+
 struct req_format RQF_OST_BRW_READ =
 	DEFINE_REQ_FMT0("OST_BRW_READ", ost_brw_client, ost_brw_read_server);
 EXPORT_SYMBOL(RQF_OST_BRW_READ);
@@ -1831,6 +1900,11 @@ struct req_format RQF_BUT_GETATTR =
 			mds_batch_getattr_server);
 EXPORT_SYMBOL(RQF_BUT_GETATTR);
 
+struct req_format RQF_BUT_GETXATTR =
+	DEFINE_REQ_FMT0("MDS_BATCH_GETXATTR", mds_batch_getxattr_client,
+			mds_batch_getxattr_server);
+EXPORT_SYMBOL(RQF_BUT_GETXATTR);
+
 /* Convenience macro */
 #define FMT_FIELD(fmt, i, j) (fmt)->rf_fields[(i)].d[(j)]
 
@@ -1921,9 +1921,9 @@ void lustre_swab_obd_statfs(struct obd_statfs *os)
 	__swab32s(&os->os_state);
 	__swab32s(&os->os_fprecreated);
 	__swab32s(&os->os_granted);
-	BUILD_BUG_ON(offsetof(typeof(*os), os_spare3) == 0);
-	BUILD_BUG_ON(offsetof(typeof(*os), os_spare4) == 0);
-	BUILD_BUG_ON(offsetof(typeof(*os), os_spare5) == 0);
+	__swab32s(&os->os_load_usec);
+	__swab32s(&os->os_load_depth);
+	__swab32s(&os->os_load_rate);
 	BUILD_BUG_ON(offsetof(typeof(*os), os_spare6) == 0);
 	BUILD_BUG_ON(offsetof(typeof(*os), os_spare7) == 0);
 	BUILD_BUG_ON(offsetof(typeof(*os), os_spare8) == 0);
@@ -2766,6 +2766,7 @@ void lustre_swab_quota_body(struct quota_body *b)
 	lustre_swab_lu_fid(&b->qb_fid);
 	lustre_swab_lu_fid((struct lu_fid *)&b->qb_id);
 	__swab32s(&b->qb_flags);
+	__swab32s(&b->qb_batch_rc);
 	__swab64s(&b->qb_count);
 	__swab64s(&b->qb_usage);
 	__swab64s(&b->qb_slv_ver);
@@ -2252,6 +2252,7 @@ static int ptlrpc_server_handle_request(struct ptlrpc_service_part *svcpt,
 {
 	struct ptlrpc_service *svc = svcpt->scp_service;
 	struct ptlrpc_request *request;
+	struct lustre_msg *repmsg;
 	ktime_t work_start;
 	ktime_t work_end;
 	ktime_t arrived;
@@ -2360,6 +2361,8 @@ put_conn:
 	work_end = ktime_get_real();
 	timediff_usecs = ktime_us_delta(work_end, work_start);
 	arrived_usecs = ktime_us_delta(work_end, arrived);
+	/* a deferred reply can be sent and dropped meanwhile */
+	repmsg = request->rq_reply_deferred ? NULL : request->rq_repmsg;
 	CDEBUG(D_RPCTRACE,
 	       "Handled RPC req@%p pname:cluuid+ref:pid:xid:nid:opc:job %s:%s+%d:%d:x%llu:%s:%d:%s Request processed in %lldus (%lldus total) trans %llu rc %d/%d\n",
 	       request, current->comm,
@@ -2374,12 +2377,10 @@ put_conn:
 	       lustre_msg_get_jobid(request->rq_reqmsg) ?: "",
 	       timediff_usecs,
 	       arrived_usecs,
-	       (request->rq_repmsg ?
-	       lustre_msg_get_transno(request->rq_repmsg) :
+	       (repmsg ? lustre_msg_get_transno(repmsg) :
 	       request->rq_transno),
 	       request->rq_status,
-	       (request->rq_repmsg ?
-	       lustre_msg_get_status(request->rq_repmsg) : -999));
+	       (repmsg ? lustre_msg_get_status(repmsg) : -999));
 	if (likely(svc->srv_stats != NULL && request->rq_reqmsg != NULL)) {
 		__u32 op = lustre_msg_get_opc(request->rq_reqmsg);
 		int opc = opcode_offset(op);
@@ -75,6 +75,97 @@
 
 static const struct lu_device_operations qmt_lu_ops;
 
+/* some procfs helpers */
+static int qmt_glimpse_batch_seq_show(struct seq_file *m, void *data)
+{
+	struct qmt_device *qmt = m->private;
+
+	LASSERT(qmt != NULL);
+	seq_printf(m, "%u\n", qmt->qmt_gl_batch);
+	return 0;
+}
+
+static ssize_t
+qmt_glimpse_batch_seq_write(struct file *file, const char __user *buffer,
+			    size_t count, loff_t *off)
+{
+	struct seq_file *m = file->private_data;
+	struct qmt_device *qmt = m->private;
+	unsigned int batch;
+	int rc;
+
+	LASSERT(qmt != NULL);
+	rc = kstrtouint_from_user(buffer, count, 0, &batch);
+	if (rc)
+		return rc;
+
+	if (batch < 1 || batch > QMT_GL_BATCH_MAX)
+		return -ERANGE;
+
+	qmt->qmt_gl_batch = batch;
+	return count;
+}
+LPROC_SEQ_FOPS(qmt_glimpse_batch);
+
+static int qmt_glimpse_rate_seq_show(struct seq_file *m, void *data)
+{
+	struct qmt_device *qmt = m->private;
+
+	LASSERT(qmt != NULL);
+	seq_printf(m, "%u\n", qmt->qmt_gl_rate);
+	return 0;
+}
+
+static ssize_t
+qmt_glimpse_rate_seq_write(struct file *file, const char __user *buffer,
+			   size_t count, loff_t *off)
+{
+	struct seq_file *m = file->private_data;
+	struct qmt_device *qmt = m->private;
+	unsigned int rate;
+	int rc;
+
+	LASSERT(qmt != NULL);
+	rc = kstrtouint_from_user(buffer, count, 0, &rate);
+	if (rc)
+		return rc;
+
+	qmt->qmt_gl_rate = rate;
+	return count;
+}
+LPROC_SEQ_FOPS(qmt_glimpse_rate);
+
+static int qmt_glimpse_stats_seq_show(struct seq_file *m, void *data)
+{
+	struct qmt_device *qmt = m->private;
+	struct qmt_gl_stats *stats;
+
+	LASSERT(qmt != NULL);
+	stats = &qmt->qmt_gl_stats;
+	seq_printf(m, "queued: %lld\n"
+		   "rounds: %lld\n"
+		   "sent: %lld\n"
+		   "failed: %lld\n"
+		   "throttled: %lld\n",
+		   (s64)atomic64_read(&stats->qgs_queued),
+		   (s64)atomic64_read(&stats->qgs_rounds),
+		   (s64)atomic64_read(&stats->qgs_sent),
+		   (s64)atomic64_read(&stats->qgs_failed),
+		   (s64)atomic64_read(&stats->qgs_throttled));
+	return 0;
+}
+LPROC_SEQ_FOPS_RO(qmt_glimpse_stats);
+
+static struct lprocfs_vars lprocfs_quota_qmt_vars[] = {
+	{ .name	=	"glimpse_batch",
+	  .fops	=	&qmt_glimpse_batch_fops		},
+	{ .name	=	"glimpse_rate",
+	  .fops	=	&qmt_glimpse_rate_fops		},
+	{ .name	=	"glimpse_stats",
+	  .fops	=	&qmt_glimpse_stats_fops		},
+	{ NULL }
+};
+
 /*
  * Release quota master target and all data structure associated with this
  * target.
@@ -248,6 +339,9 @@ static int qmt_device_init0(const struct lu_env *env, struct qmt_device *qmt,
 	/* set up and start rebalance thread */
 	INIT_LIST_HEAD(&qmt->qmt_reba_list);
 	spin_lock_init(&qmt->qmt_reba_lock);
+	INIT_LIST_HEAD(&qmt->qmt_gl_list);
+	init_waitqueue_head(&qmt->qmt_gl_waitq);
+	qmt->qmt_gl_batch = QMT_GL_BATCH_DEFAULT;
 	if (!qmt->qmt_child->dd_rdonly) {
 		rc = qmt_start_reba_thread(qmt);
 		if (rc) {
@@ -267,7 +361,7 @@ static int qmt_device_init0(const struct lu_env *env, struct qmt_device *qmt,
 
 	/* register proc directory associated with this qmt */
 	qmt->qmt_proc = lprocfs_register(qmt->qmt_svname, type->typ_procroot,
-					 NULL, NULL);
+					 lprocfs_quota_qmt_vars, qmt);
 	if (IS_ERR(qmt->qmt_proc)) {
 		rc = PTR_ERR(qmt->qmt_proc);
 		CERROR("%s: failed to create qmt proc entry (%d)\n",
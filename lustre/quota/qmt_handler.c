@@ -31,6 +31,7 @@
 #define DEBUG_SUBSYSTEM S_LQUOTA
 
 #include <obd_class.h>
+#include <lustre_errno.h>
 #include "qmt_internal.h"
 
 /*
@@ -556,6 +557,7 @@ static int qmt_quotactl(const struct lu_env *env, struct lu_device *ld,
 	char *poolname;
 	int rc = 0;
 	bool is_default = false;
+	bool notify = false;
 	ENTRY;
 
 	LASSERT(qmt != NULL);
@@ -593,6 +595,7 @@ static int qmt_quotactl(const struct lu_env *env, struct lu_device *ld,
 		/* setinfo should be using dqi->dqi_valid, but lfs incorrectly
 		 * sets the valid flags in dqb->dqb_valid instead, try to live
 		 * with that ... */
+		notify = true;
 
 		/* Global grace time is stored in quota settings of ID 0. */
 		id->qid_uid = 0;
@@ -657,6 +660,7 @@ static int qmt_quotactl(const struct lu_env *env, struct lu_device *ld,
 
 	case Q_SETQUOTA: /* change quota limits */
 	case LUSTRE_Q_SETQUOTAPOOL:
+		notify = true;
 		/* extract quota ID from quotactl request */
 		id->qid_uid = oqctl->qc_id;
 
@@ -681,6 +685,7 @@ static int qmt_quotactl(const struct lu_env *env, struct lu_device *ld,
 		break;
 
 	case LUSTRE_Q_DELETEQID:
+		notify = true;
 		rc = qmt_delete_qid(env, qmt, LQUOTA_RES_MD, oqctl->qc_type,
 				    oqctl->qc_id);
 		if (rc)
@@ -694,6 +699,7 @@ static int qmt_quotactl(const struct lu_env *env, struct lu_device *ld,
 		if (oqctl->qc_id == 0)
 			RETURN(-EINVAL);
 
+		notify = true;
 		id->qid_uid = oqctl->qc_id;
 		/* save the quota setting before resetting */
 		rc = qmt_get(env, qmt, LQUOTA_RES_MD, oqctl->qc_type, id,
@@ -731,6 +737,11 @@ static int qmt_quotactl(const struct lu_env *env, struct lu_device *ld,
 		RETURN(-ENOTSUPP);
 	}
 
+	/* the rebalance thread glimpses the new settings to slaves, return
+	 * once they got them as if they were sent synchronously */
+	if (notify)
+		qmt_glb_notify_wait(qmt);
+
 	RETURN(rc);
 }
 
@@ -1171,36 +1182,32 @@ int qmt_uuid2idx(struct obd_uuid *uuid, int *idx)
 }
 
 /*
- * Handle quota request from slave.
+ * Process one quota body sent by a slave.
  *
- * \param env  - is the environment passed by the caller
- * \param ld   - is the lu device associated with the qmt
- * \param req  - is the quota acquire request
+ * \param env     - is the environment passed by the caller
+ * \param qmt     - is the quota master target
+ * \param req     - is the quota acquire request
+ * \param uuid    - is the uuid of the slave
+ * \param stype   - is the slave type (QMT_STYPE_MDT or QMT_STYPE_OST)
+ * \param idx     - is the slave index
+ * \param qbody   - is the quota body sent by the slave
+ * \param repbody - is the quota body to fill in the reply
  */
-static int qmt_dqacq(const struct lu_env *env, struct lu_device *ld,
-		     struct ptlrpc_request *req)
+static int qmt_dqacq_one(const struct lu_env *env, struct qmt_device *qmt,
+			 struct ptlrpc_request *req, struct obd_uuid *uuid,
+			 int stype, int idx, struct quota_body *qbody,
+			 struct quota_body *repbody)
 {
-	struct qmt_device *qmt = lu2qmt_dev(ld);
-	struct quota_body *qbody, *repbody;
-	struct obd_uuid	*uuid;
 	struct ldlm_lock *lock;
-	int rtype, qtype;
-	int rc, idx, stype;
 	struct obd_device *obd = NULL;
+	int rtype, qtype;
+	int rc;
 
 	ENTRY;
 
 	if (req->rq_export)
 		obd = req->rq_export->exp_obd;
 
-	qbody = req_capsule_client_get(&req->rq_pill, &RMF_QUOTA_BODY);
-	if (qbody == NULL)
-		RETURN(err_serious(-EPROTO));
-
-	repbody = req_capsule_server_get(&req->rq_pill, &RMF_QUOTA_BODY);
-	if (repbody == NULL)
-		RETURN(err_serious(-EFAULT));
-
 	/* verify if global lock is stale */
 	if (!lustre_handle_is_used(&qbody->qb_glb_lockh))
 		RETURN(-ENOLCK);
@@ -1210,11 +1217,6 @@ static int qmt_dqacq(const struct lu_env *env, struct lu_device *ld,
 		RETURN(-ENOLCK);
 	LDLM_LOCK_PUT(lock);
 
-	uuid = &req->rq_export->exp_client_uuid;
-	stype = qmt_uuid2idx(uuid, &idx);
-	if (stype < 0)
-		RETURN(stype);
-
 	if (req_is_rel(qbody->qb_flags) + req_is_acq(qbody->qb_flags) +
 	    req_is_preacq(qbody->qb_flags) > 1) {
 		CERROR("%s: malformed quota request with conflicting flags set "
@@ -1286,12 +1288,101 @@ static int qmt_dqacq(const struct lu_env *env, struct lu_device *ld,
 	RETURN(rc);
 }
 
+/*
+ * Handle quota request from slave.
+ *
+ * \param env  - is the environment passed by the caller
+ * \param ld   - is the lu device associated with the qmt
+ * \param req  - is the quota acquire request
+ */
+static int qmt_dqacq(const struct lu_env *env, struct lu_device *ld,
+		     struct ptlrpc_request *req)
+{
+	struct qmt_device *qmt = lu2qmt_dev(ld);
+	struct quota_body *qbody, *repbody;
+	struct obd_uuid	*uuid;
+	int idx, stype;
+
+	ENTRY;
+
+	qbody = req_capsule_client_get(&req->rq_pill, &RMF_QUOTA_BODY);
+	if (qbody == NULL)
+		RETURN(err_serious(-EPROTO));
+
+	repbody = req_capsule_server_get(&req->rq_pill, &RMF_QUOTA_BODY);
+	if (repbody == NULL)
+		RETURN(err_serious(-EFAULT));
+
+	uuid = &req->rq_export->exp_client_uuid;
+	stype = qmt_uuid2idx(uuid, &idx);
+	if (stype < 0)
+		RETURN(stype);
+
+	RETURN(qmt_dqacq_one(env, qmt, req, uuid, stype, idx, qbody, repbody));
+}
+
+/*
+ * Handle batched quota request from slave. Each quota body is processed
+ * independently and its status is returned in the qb_batch_rc field of the
+ * matching reply body, the RPC itself only fails on malformed requests.
+ *
+ * \param env  - is the environment passed by the caller
+ * \param ld   - is the lu device associated with the qmt
+ * \param req  - is the batched quota acquire request
+ */
+static int qmt_dqacq_batch(const struct lu_env *env, struct lu_device *ld,
+			   struct ptlrpc_request *req)
+{
+	struct qmt_device *qmt = lu2qmt_dev(ld);
+	struct req_capsule *pill = &req->rq_pill;
+	struct quota_body *qbodies, *repbodies;
+	struct obd_uuid	*uuid;
+	int count, i, idx, stype, rc;
+
+	ENTRY;
+
+	qbodies = req_capsule_client_get(pill, &RMF_QUOTA_BATCH);
+	if (qbodies == NULL)
+		RETURN(err_serious(-EPROTO));
+
+	count = req_capsule_get_size(pill, &RMF_QUOTA_BATCH, RCL_CLIENT) /
+		sizeof(*qbodies);
+	if (count == 0 || count > QUOTA_DQACQ_BATCH_MAX)
+		RETURN(err_serious(-EPROTO));
+
+	req_capsule_set_size(pill, &RMF_QUOTA_BATCH, RCL_SERVER,
+			     count * sizeof(*repbodies));
+	rc = req_capsule_server_pack(pill);
+	if (rc)
+		RETURN(err_serious(rc));
+
+	repbodies = req_capsule_server_get(pill, &RMF_QUOTA_BATCH);
+	if (repbodies == NULL)
+		RETURN(err_serious(-EFAULT));
+
+	uuid = &req->rq_export->exp_client_uuid;
+	stype = qmt_uuid2idx(uuid, &idx);
+	if (stype < 0)
+		RETURN(stype);
+
+	for (i = 0; i < count; i++) {
+		rc = qmt_dqacq_one(env, qmt, req, uuid, stype, idx,
+				   &qbodies[i], &repbodies[i]);
+		repbodies[i].qb_batch_rc = lustre_errno_hton(-rc);
+	}
+
+	CDEBUG(D_QUOTA, "%s: processed %d quota requests from slave %s\n",
+	       qmt->qmt_svname, count, obd_uuid2str(uuid));
+	RETURN(0);
+}
+
 /* Vector of quota request handlers. This vector is used by the MDT to forward
  * requests to the quota master. */
 struct qmt_handlers qmt_hdls = {
 	/* quota request handlers */
 	.qmth_quotactl		= qmt_quotactl,
 	.qmth_dqacq		= qmt_dqacq,
+	.qmth_dqacq_batch	= qmt_dqacq_batch,
 
 	/* ldlm handlers */
 	.qmth_intent_policy	= qmt_intent_policy,
@@ -75,10 +75,44 @@ struct qmt_device {
 	/* lock protecting rebalancing list */
 	spinlock_t		 qmt_reba_lock;
 
+	/* list of global quota setting changes waiting to be glimpsed to
+	 * slaves by the rebalance thread, protected by qmt_reba_lock */
+	struct list_head	 qmt_gl_list;
+
+	/* max number of setting changes sent in one round of glimpses */
+	unsigned int		 qmt_gl_batch;
+
+	/* max number of glimpse callbacks sent per second, 0 = unlimited */
+	unsigned int		 qmt_gl_rate;
+
+	/* start and glimpse count of the current rate limiting window, only
+	 * used by the rebalance thread */
+	time64_t		 qmt_gl_window;
+	unsigned int		 qmt_gl_window_sent;
+
+	/* sequence of the last setting change queued and of the last one
+	 * glimpsed to slaves, protected by qmt_reba_lock */
+	__u64			 qmt_gl_seq;
+	__u64			 qmt_gl_done;
+	wait_queue_head_t	 qmt_gl_waitq;
+
+	/* glimpse statistics exported via procfs */
+	struct qmt_gl_stats {
+		atomic64_t	 qgs_queued;	/* setting changes queued */
+		atomic64_t	 qgs_rounds;	/* rounds of glimpses */
+		atomic64_t	 qgs_sent;	/* glimpse callbacks sent */
+		atomic64_t	 qgs_failed;	/* glimpse callbacks failed */
+		atomic64_t	 qgs_throttled;	/* rounds delayed by the rate */
+	}			 qmt_gl_stats;
+
 	unsigned long		 qmt_stopping:1; /* qmt is stopping */
 
 };
 
+/* default number of setting changes sent in one round of glimpses */
+#define QMT_GL_BATCH_DEFAULT	256
+#define QMT_GL_BATCH_MAX	4096
+
 struct qmt_pool_info;
 #define QPI_MAXNAME	(LOV_MAXPOOLNAME + 1)
 #define qmt_pool_global(qpi) \
@@ -544,5 +578,6 @@ int qmt_lvbo_free(struct lu_device *, struct ldlm_resource *);
 int qmt_start_reba_thread(struct qmt_device *);
 void qmt_stop_reba_thread(struct qmt_device *);
 void qmt_glb_lock_notify(const struct lu_env *, struct lquota_entry *, __u64);
+void qmt_glb_notify_wait(struct qmt_device *);
 void qmt_id_lock_notify(struct qmt_device *, struct lquota_entry *);
 #endif /* _QMT_INTERNAL_H */
@@ -816,6 +816,280 @@ out:
 	RETURN(rc);
 }
 
+/* global quota setting change waiting to be glimpsed to slaves */
+struct qmt_gl_notify {
+	struct list_head	qgn_link;
+	/* FID of the global index the change applies to */
+	struct lu_fid		qgn_fid;
+	/* glimpse descriptor with the new settings */
+	union ldlm_gl_desc	qgn_desc;
+	/* queuing order, see qmt_glb_notify_wait() */
+	__u64			qgn_seq;
+};
+
+/*
+ * Wait for the next rate limiting window if the glimpse budget of the current
+ * one is exhausted.
+ *
+ * \param qmt  - is the quota master target
+ * \param want - is the number of glimpse callbacks to send
+ *
+ * \retval    - number of callbacks which can be sent now, at least one
+ */
+static unsigned int qmt_glimpse_throttle(struct qmt_device *qmt,
+					 unsigned int want)
+{
+	unsigned int rate = READ_ONCE(qmt->qmt_gl_rate);
+	time64_t now = ktime_get_seconds();
+
+	if (rate == 0 || kthread_should_stop())
+		return want;
+
+	if (now != qmt->qmt_gl_window) {
+		qmt->qmt_gl_window = now;
+		qmt->qmt_gl_window_sent = 0;
+	}
+
+	if (qmt->qmt_gl_window_sent >= rate) {
+		atomic64_inc(&qmt->qmt_gl_stats.qgs_throttled);
+		schedule_timeout_interruptible(cfs_time_seconds(1));
+		qmt->qmt_gl_window = ktime_get_seconds();
+		qmt->qmt_gl_window_sent = 0;
+	}
+
+	return min(want, rate - qmt->qmt_gl_window_sent);
+}
+
+/*
+ * Send the global quota setting changes in \a list to all the slaves holding a
+ * lock on resource \a res in a single round of glimpse callbacks, instead of
+ * waiting for all the slaves once per change.
+ *
+ * \param env  - is the environment passed by the caller
+ * \param qmt  - is the quota master target
+ * \param res  - is the dlm resource associated with the global index
+ * \param list - is the list of qmt_gl_notify to send
+ *
+ * \retval    - number of glimpse callbacks sent
+ */
+static int qmt_glimpse_lock_batch(const struct lu_env *env,
+				  struct qmt_device *qmt,
+				  struct ldlm_resource *res,
+				  struct list_head *list)
+{
+	struct qmt_gl_stats *stats = &qmt->qmt_gl_stats;
+	struct ldlm_glimpse_work *work, *tmp;
+	struct qmt_gl_lock_array locks;
+	struct qmt_gl_notify *qgn;
+	LIST_HEAD(gl_list);
+	LIST_HEAD(chunk);
+	unsigned int count;
+	unsigned long i;
+	int sent = 0;
+	int left;
+	int rc;
+	ENTRY;
+
+	memset(&locks, 0, sizeof(locks));
+	rc = qmt_alloc_lock_array(res, &locks, NULL, NULL);
+	if (rc) {
+		CERROR("%s: failed to allocate glimpse lock array (%d)\n",
+		       qmt->qmt_svname, rc);
+		RETURN(0);
+	}
+	if (!locks.q_cnt) {
+		CDEBUG(D_QUOTA, "%s: no granted locks to send glimpse\n",
+		       qmt->qmt_svname);
+		RETURN(0);
+	}
+
+	list_for_each_entry(qgn, list, qgn_link) {
+		for (i = 0; i < locks.q_cnt; i++) {
+			OBD_ALLOC_PTR(work);
+			if (work == NULL) {
+				CERROR("%s: failed to notify a lock.\n",
+				       qmt->qmt_svname);
+				continue;
+			}
+			work->gl_lock  = LDLM_LOCK_GET(locks.q_locks[i]);
+			work->gl_flags = 0;
+			work->gl_desc  = &qgn->qgn_desc;
+			list_add_tail(&work->gl_list, &gl_list);
+			sent++;
+		}
+	}
+	qmt_free_lock_array(&locks);
+
+	if (list_empty(&gl_list))
+		RETURN(0);
+
+	/* issue glimpse callbacks for all the changes in parallel, as many
+	 * at a time as glimpse_rate allows */
+	for (left = sent; left > 0; left -= count) {
+		count = qmt_glimpse_throttle(qmt, left);
+		for (i = 0; i < count; i++)
+			list_move_tail(gl_list.next, &chunk);
+		qmt->qmt_gl_window_sent += count;
+		atomic64_add(count, &stats->qgs_sent);
+
+		ldlm_glimpse_locks(res, &chunk);
+
+		list_for_each_entry_safe(work, tmp, &chunk, gl_list) {
+			struct obd_export *exp = work->gl_lock->l_export;
+
+			list_del(&work->gl_list);
+			CERROR("%s: failed to notify %s of new quota settings\n",
+			       qmt->qmt_svname,
+			       obd_uuid2str(&exp->exp_client_uuid));
+			LDLM_LOCK_RELEASE(work->gl_lock);
+			OBD_FREE_PTR(work);
+			atomic64_inc(&stats->qgs_failed);
+		}
+	}
+	atomic64_inc(&stats->qgs_rounds);
+
+	RETURN(sent);
+}
+
+/*
+ * Queue a global quota setting change to be glimpsed to slaves by the
+ * rebalance thread, so that changes of many IDs can be sent together.
+ *
+ * \retval 0       - change queued
+ * \retval -ve     - change not queued, caller should send it itself
+ */
+static int qmt_glb_notify_queue(struct qmt_device *qmt, struct lu_fid *fid,
+				union ldlm_gl_desc *desc)
+{
+	struct qmt_gl_notify *qgn;
+	int rc = -ESRCH;
+
+	OBD_ALLOC_PTR(qgn);
+	if (qgn == NULL)
+		return -ENOMEM;
+
+	INIT_LIST_HEAD(&qgn->qgn_link);
+	qgn->qgn_fid = *fid;
+	qgn->qgn_desc = *desc;
+
+	spin_lock(&qmt->qmt_reba_lock);
+	if (!qmt->qmt_stopping && qmt->qmt_reba_task) {
+		qgn->qgn_seq = ++qmt->qmt_gl_seq;
+		list_add_tail(&qgn->qgn_link, &qmt->qmt_gl_list);
+		wake_up_process(qmt->qmt_reba_task);
+		rc = 0;
+	}
+	spin_unlock(&qmt->qmt_reba_lock);
+
+	if (rc)
+		OBD_FREE_PTR(qgn);
+	else
+		atomic64_inc(&qmt->qmt_gl_stats.qgs_queued);
+	return rc;
+}
+
+/*
+ * Send the queued global quota setting changes to slaves. Changes on the same
+ * global index are sent together, up to qmt_gl_batch of them per round.
+ * Called by the rebalance thread.
+ *
+ * \param env - is the environment passed by the caller
+ * \param qmt - is the quota master target
+ */
+static void qmt_glb_notify_flush(const struct lu_env *env,
+				 struct qmt_device *qmt)
+{
+	struct qmt_thread_info	*qti = qmt_info(env);
+	struct qmt_gl_notify	*qgn, *tmp;
+	struct ldlm_resource	*res;
+	LIST_HEAD(batch);
+	unsigned int		 count, max;
+	ENTRY;
+
+	spin_lock(&qmt->qmt_reba_lock);
+	while (!list_empty(&qmt->qmt_gl_list) && !kthread_should_stop()) {
+		max = max_t(unsigned int, READ_ONCE(qmt->qmt_gl_batch), 1);
+		count = 0;
+
+		/* take the oldest change along with the following ones on
+		 * the same global index, keeping them in version order */
+		qgn = list_first_entry(&qmt->qmt_gl_list, struct qmt_gl_notify,
+				       qgn_link);
+		qti->qti_fid = qgn->qgn_fid;
+		list_for_each_entry_safe(qgn, tmp, &qmt->qmt_gl_list,
+					 qgn_link) {
+			if (!lu_fid_eq(&qgn->qgn_fid, &qti->qti_fid))
+				continue;
+			list_move_tail(&qgn->qgn_link, &batch);
+			if (++count >= max)
+				break;
+		}
+		spin_unlock(&qmt->qmt_reba_lock);
+
+		fid_build_reg_res_name(&qti->qti_fid, &qti->qti_resid);
+		res = ldlm_resource_get(qmt->qmt_ns, &qti->qti_resid,
+					LDLM_PLAIN, 0);
+		if (IS_ERR(res)) {
+			/* this might happen if no slaves have enqueued global
+			 * quota locks yet */
+			CDEBUG(D_QUOTA, "%s: failed to lookup ldlm resource "
+			       "associated with "DFID"\n", qmt->qmt_svname,
+			       PFID(&qti->qti_fid));
+		} else {
+			CDEBUG(D_QUOTA, "%s: glimpse %u setting changes on "
+			       DFID"\n", qmt->qmt_svname, count,
+			       PFID(&qti->qti_fid));
+			qmt_glimpse_lock_batch(env, qmt, res, &batch);
+			ldlm_resource_putref(res);
+		}
+
+		list_for_each_entry_safe(qgn, tmp, &batch, qgn_link) {
+			list_del(&qgn->qgn_link);
+			OBD_FREE_PTR(qgn);
+		}
+		spin_lock(&qmt->qmt_reba_lock);
+		/* the list is in queuing order, the changes before the first
+		 * one left were all sent */
+		if (list_empty(&qmt->qmt_gl_list))
+			qmt->qmt_gl_done = qmt->qmt_gl_seq;
+		else
+			qmt->qmt_gl_done = list_first_entry(&qmt->qmt_gl_list,
+						struct qmt_gl_notify,
+						qgn_link)->qgn_seq - 1;
+		wake_up_all(&qmt->qmt_gl_waitq);
+	}
+	spin_unlock(&qmt->qmt_reba_lock);
+	EXIT;
+}
+
+static bool qmt_glb_notify_done(struct qmt_device *qmt, __u64 seq)
+{
+	bool done;
+
+	spin_lock(&qmt->qmt_reba_lock);
+	done = qmt->qmt_gl_done >= seq || !qmt->qmt_reba_task;
+	spin_unlock(&qmt->qmt_reba_lock);
+
+	return done;
+}
+
+/*
+ * Wait until the global quota setting changes queued so far were glimpsed to
+ * slaves, so that quotactl returns once slaves enforce the new settings.
+ *
+ * \param qmt - is the quota master target
+ */
+void qmt_glb_notify_wait(struct qmt_device *qmt)
+{
+	__u64 seq;
+
+	spin_lock(&qmt->qmt_reba_lock);
+	seq = qmt->qmt_gl_seq;
+	spin_unlock(&qmt->qmt_reba_lock);
+
+	wait_event_idle(qmt->qmt_gl_waitq, qmt_glb_notify_done(qmt, seq));
+}
+
 /*
  * Send glimpse request to all global quota locks to push new quota setting to
  * slaves.
@@ -865,6 +1139,11 @@ void qmt_glb_lock_notify(const struct lu_env *env, struct lquota_entry *lqe,
 	}
 	qti->qti_gl_desc.lquota_desc.gl_ver       = ver;
 
+	/* let the rebalance thread send the change along with others */
+	if (!qmt_glb_notify_queue(pool->qpi_qmt, &qti->qti_fid,
+				  &qti->qti_gl_desc))
+		RETURN_EXIT;
+
 	/* look up ldlm resource associated with global index */
 	fid_build_reg_res_name(&qti->qti_fid, &qti->qti_resid);
 	res = ldlm_resource_get(pool->qpi_qmt->qmt_ns, &qti->qti_resid,
@@ -1076,7 +1355,13 @@ static int qmt_reba_thread(void *_args)
 			lqe_putref(lqe);
 			spin_lock(&qmt->qmt_reba_lock);
 		}
-		spin_unlock(&qmt->qmt_reba_lock);
+		if (!list_empty(&qmt->qmt_gl_list)) {
+			__set_current_state(TASK_RUNNING);
+			spin_unlock(&qmt->qmt_reba_lock);
+			qmt_glb_notify_flush(env, qmt);
+		} else {
+			spin_unlock(&qmt->qmt_reba_lock);
+		}
 		schedule();
 	}
 	__set_current_state(TASK_RUNNING);
@@ -1140,15 +1425,26 @@ out_env:
  */
 void qmt_stop_reba_thread(struct qmt_device *qmt)
 {
+	struct qmt_gl_notify *qgn, *tmp;
 	struct task_struct *task;
 
 	spin_lock(&qmt->qmt_reba_lock);
 	task = qmt->qmt_reba_task;
 	qmt->qmt_reba_task = NULL;
 	spin_unlock(&qmt->qmt_reba_lock);
+	/* release quotactl threads waiting for the glimpses */
+	wake_up_all(&qmt->qmt_gl_waitq);
 
 	if (task)
 		kthread_stop(task);
 
 	LASSERT(list_empty(&qmt->qmt_reba_list));
+
+	/* slaves will fetch the settings not glimpsed yet on reintegration */
+	spin_lock(&qmt->qmt_reba_lock);
+	list_for_each_entry_safe(qgn, tmp, &qmt->qmt_gl_list, qgn_link) {
+		list_del(&qgn->qgn_link);
+		OBD_FREE_PTR(qgn);
+	}
+	spin_unlock(&qmt->qmt_reba_lock);
 }
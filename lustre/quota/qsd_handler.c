@@ -955,6 +955,57 @@ EXPORT_SYMBOL(qsd_op_begin);
  * \retval 0 on success, appropriate errors on failure
  */
 int qsd_adjust(const struct lu_env *env, struct lquota_entry *lqe)
+{
+	return qsd_adjust_batch(env, lqe, NULL);
+}
+
+/**
+ * Send the space adjustments collected by qsd_adjust_batch() to the master.
+ *
+ * \param env    - the environment passed by the caller
+ * \param batch  - is the batch to send, reset to NULL on return
+ */
+void qsd_adjust_flush(const struct lu_env *env, struct qsd_dqacq_batch **batch)
+{
+	struct qsd_dqacq_batch	*b = *batch;
+	struct qsd_instance	*qsd;
+	ENTRY;
+
+	if (b == NULL)
+		RETURN_EXIT;
+
+	*batch = NULL;
+	qsd = b->qdb_qsd;
+	if (b->qdb_count == 0) {
+		OBD_FREE_LARGE(b, sizeof(*b));
+	} else if (b->qdb_count == 1) {
+		/* not worth a batch */
+		qsd_send_dqacq(env, qsd->qsd_exp, &b->qdb_bodies[0], false,
+			       qsd_req_completion, lqe2qqi(b->qdb_lqes[0]),
+			       &b->qdb_lockh[0], b->qdb_lqes[0]);
+		OBD_FREE_LARGE(b, sizeof(*b));
+	} else {
+		CDEBUG(D_QUOTA, "%s: sending %d quota requests in one batch\n",
+		       qsd->qsd_svname, b->qdb_count);
+		qsd_send_dqacq_batch(env, qsd->qsd_exp, b, qsd_req_completion);
+	}
+	EXIT;
+}
+
+/**
+ * Same as qsd_adjust(), but when \a batch is not NULL, non-intent requests are
+ * added to the batch instead of being sent right away. The batch is allocated
+ * on demand and sent by qsd_adjust_flush() once full, the caller is in charge
+ * of flushing the remaining entries.
+ *
+ * \param env    - the environment passed by the caller
+ * \param lqe    - is the qid entry to be processed
+ * \param batch  - is the batch to fill, or NULL to send the request directly
+ *
+ * \retval 0 on success, appropriate errors on failure
+ */
+int qsd_adjust_batch(const struct lu_env *env, struct lquota_entry *lqe,
+		     struct qsd_dqacq_batch **batch)
 {
 	struct qsd_thread_info	*qti = qsd_info(env);
 	struct quota_body	*qbody = &qti->qti_body;
@@ -1036,6 +1087,29 @@ int qsd_adjust(const struct lu_env *env, struct lquota_entry *lqe)
 		memset(&qti->qti_lockh, 0, sizeof(qti->qti_lockh));
 	}
 
+	if (!intent && batch != NULL && qsd->qsd_dqacq_batch > 1 &&
+	    !qsd->qsd_dqacq_batch_unsupported) {
+		struct qsd_dqacq_batch *b = *batch;
+
+		if (b == NULL) {
+			OBD_ALLOC_LARGE(b, sizeof(*b));
+			if (b == NULL)
+				goto send;
+			b->qdb_qsd = qsd;
+			*batch = b;
+		}
+		b->qdb_bodies[b->qdb_count] = *qbody;
+		lustre_handle_copy(&b->qdb_lockh[b->qdb_count],
+				   &qti->qti_lockh);
+		b->qdb_lqes[b->qdb_count] = lqe;
+		b->qdb_count++;
+
+		if (b->qdb_count >= min(qsd->qsd_dqacq_batch,
+					QUOTA_DQACQ_BATCH_MAX))
+			qsd_adjust_flush(env, batch);
+		RETURN(0);
+	}
+send:
 	if (!intent) {
 		rc = qsd_send_dqacq(env, qsd->qsd_exp, qbody, false,
 				    qsd_req_completion, qqi, &qti->qti_lockh,
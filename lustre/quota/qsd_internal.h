@@ -106,6 +106,10 @@ struct qsd_instance {
 	 * enforced here (via procfs) */
 	int			 qsd_timeout;
 
+	/* maximum number of space adjustments packed by the writeback thread
+	 * in a single QUOTA_DQACQ_BATCH request, 0 or 1 disables batching */
+	int			 qsd_dqacq_batch;
+
 	unsigned long		qsd_is_md:1,    /* managing quota for mdt */
 				qsd_started:1,  /* instance is now started */
 				qsd_prepared:1, /* qsd_prepare() successfully
@@ -114,7 +118,9 @@ struct qsd_instance {
 				qsd_stopping:1, /* qsd_instance is stopping */
 				qsd_updating:1, /* qsd is updating record */
 				qsd_exclusive:1, /* upd exclusive with reint */
-				qsd_root_prj_enable:1;
+				qsd_root_prj_enable:1,
+				qsd_dqacq_batch_unsupported:1; /* master
+						  * can't handle batches */
 
 };
 
@@ -359,6 +365,22 @@ int qsd_id_lock_cancel(const struct lu_env *, struct lquota_entry *);
 int qsd_start_reint_thread(struct qsd_qtype_info *);
 void qsd_stop_reint_thread(struct qsd_qtype_info *);
 
+/* default number of space adjustments packed in a QUOTA_DQACQ_BATCH RPC */
+#define QSD_DQACQ_BATCH_DEFAULT	32
+
+/*
+ * Space adjustment requests collected by the writeback thread and sent to the
+ * master in a single QUOTA_DQACQ_BATCH RPC. Each entry holds a reference on
+ * the lquota entry and on its per-ID lock, both dropped by the completion.
+ */
+struct qsd_dqacq_batch {
+	struct qsd_instance	*qdb_qsd;
+	int			 qdb_count;
+	struct quota_body	 qdb_bodies[QUOTA_DQACQ_BATCH_MAX];
+	struct lustre_handle	 qdb_lockh[QUOTA_DQACQ_BATCH_MAX];
+	struct lquota_entry	*qdb_lqes[QUOTA_DQACQ_BATCH_MAX];
+};
+
 /* qsd_request.c */
 typedef void (*qsd_req_completion_t) (const struct lu_env *,
 				      struct qsd_qtype_info *,
@@ -369,6 +391,8 @@ int qsd_send_dqacq(const struct lu_env *, struct obd_export *,
 		   struct quota_body *, bool, qsd_req_completion_t,
 		   struct qsd_qtype_info *, struct lustre_handle *,
 		   struct lquota_entry *);
+void qsd_send_dqacq_batch(const struct lu_env *, struct obd_export *,
+			  struct qsd_dqacq_batch *, qsd_req_completion_t);
 int qsd_intent_lock(const struct lu_env *, struct obd_export *,
 		    struct quota_body *, bool, int, qsd_req_completion_t,
 		    struct qsd_qtype_info *, struct lquota_lvb *, void *);
@@ -387,6 +411,9 @@ int qsd_process_config(struct lustre_cfg *);
 
 /* qsd_handler.c */
 int qsd_adjust(const struct lu_env *, struct lquota_entry *);
+int qsd_adjust_batch(const struct lu_env *, struct lquota_entry *,
+		     struct qsd_dqacq_batch **);
+void qsd_adjust_flush(const struct lu_env *, struct qsd_dqacq_batch **);
 
 /* qsd_writeback.c */
 void qsd_upd_schedule(struct qsd_qtype_info *, struct lquota_entry *,
@@ -296,6 +296,42 @@ qsd_root_prj_enable_seq_write(struct file *file, const char __user *buffer,
 }
 LPROC_SEQ_FOPS(qsd_root_prj_enable);
 
+static int qsd_dqacq_batch_seq_show(struct seq_file *m, void *data)
+{
+	struct qsd_instance *qsd = m->private;
+
+	LASSERT(qsd != NULL);
+	seq_printf(m, "%d\n", qsd->qsd_dqacq_batch_unsupported ? 0 :
+		   qsd->qsd_dqacq_batch);
+	return 0;
+}
+
+static ssize_t
+qsd_dqacq_batch_seq_write(struct file *file, const char __user *buffer,
+			  size_t count, loff_t *off)
+{
+	struct seq_file *m = file->private_data;
+	struct qsd_instance *qsd = m->private;
+	unsigned int batch;
+	int rc;
+
+	LASSERT(qsd != NULL);
+	rc = kstrtouint_from_user(buffer, count, 0, &batch);
+	if (rc)
+		return rc;
+
+	if (batch > QUOTA_DQACQ_BATCH_MAX)
+		return -ERANGE;
+
+	write_lock(&qsd->qsd_lock);
+	qsd->qsd_dqacq_batch = batch;
+	/* give the master another chance, it might have been upgraded */
+	qsd->qsd_dqacq_batch_unsupported = 0;
+	write_unlock(&qsd->qsd_lock);
+	return count;
+}
+LPROC_SEQ_FOPS(qsd_dqacq_batch);
+
 static struct lprocfs_vars lprocfs_quota_qsd_vars[] = {
 	{ .name	=	"info",
 	  .fops	=	&qsd_state_fops		},
@@ -307,6 +343,8 @@ static struct lprocfs_vars lprocfs_quota_qsd_vars[] = {
 	  .fops	=	&qsd_timeout_fops	},
 	{ .name	=	"root_prj_enable",
 	  .fops	=	&qsd_root_prj_enable_fops	},
+	{ .name	=	"dqacq_batch",
+	  .fops	=	&qsd_dqacq_batch_fops	},
 	{ NULL }
 };
 
@@ -711,6 +749,7 @@ struct qsd_instance *qsd_init(const struct lu_env *env, char *svname,
 	qsd->qsd_is_md = is_md;
 	qsd->qsd_updating = false;
 	qsd->qsd_exclusive = excl;
+	qsd->qsd_dqacq_batch = QSD_DQACQ_BATCH_DEFAULT;
 
 	/* copy service name */
 	if (strlcpy(qsd->qsd_svname, svname, sizeof(qsd->qsd_svname))
@@ -34,6 +34,7 @@
 #include <lustre_import.h>
 #include <lustre_dlm.h>
 #include <obd_class.h>
+#include <lustre_errno.h>
 
 #include "qsd_internal.h"
 
@@ -141,6 +142,146 @@ out:
 	return rc;
 }
 
+struct qsd_batch_async_args {
+	struct obd_export	*aba_exp;
+	struct qsd_dqacq_batch	*aba_batch;
+	qsd_req_completion_t	 aba_completion;
+};
+
+/*
+ * Complete each entry of a batched request with its own status, or resend them
+ * one by one if the master does not support QUOTA_DQACQ_BATCH.
+ *
+ * \param env    - the environment passed by the caller
+ * \param req    - the batched quota request
+ * \param arg    - qsd_batch_async_args
+ * \param rc     - request status
+ *
+ * \retval 0     - success
+ * \retval -ve   - appropriate errors
+ */
+static int qsd_dqacq_batch_interpret(const struct lu_env *env,
+				     struct ptlrpc_request *req, void *arg,
+				     int rc)
+{
+	struct qsd_batch_async_args *aa = arg;
+	struct qsd_dqacq_batch *batch = aa->aba_batch;
+	struct qsd_instance *qsd = batch->qdb_qsd;
+	struct quota_body *rep_qbody = NULL;
+	int i;
+	ENTRY;
+
+	if (rc == -EOPNOTSUPP) {
+		/* old master, fall back to one request per ID */
+		CDEBUG(D_QUOTA, "%s: master doesn't support batched DQACQ\n",
+		       qsd->qsd_svname);
+		write_lock(&qsd->qsd_lock);
+		qsd->qsd_dqacq_batch_unsupported = 1;
+		write_unlock(&qsd->qsd_lock);
+
+		for (i = 0; i < batch->qdb_count; i++)
+			qsd_send_dqacq(env, aa->aba_exp, &batch->qdb_bodies[i],
+				       false, aa->aba_completion,
+				       lqe2qqi(batch->qdb_lqes[i]),
+				       &batch->qdb_lockh[i],
+				       batch->qdb_lqes[i]);
+		GOTO(out, rc);
+	}
+
+	if (rc == 0) {
+		rep_qbody = req_capsule_server_get(&req->rq_pill,
+						   &RMF_QUOTA_BATCH);
+		if (rep_qbody == NULL ||
+		    req_capsule_get_size(&req->rq_pill, &RMF_QUOTA_BATCH,
+					 RCL_SERVER) !=
+		    batch->qdb_count * sizeof(*rep_qbody))
+			rc = -EPROTO;
+	}
+
+	for (i = 0; i < batch->qdb_count; i++) {
+		struct quota_body *repbody = NULL;
+		int ret = rc;
+
+		if (ret == 0) {
+			ret = -lustre_errno_ntoh(rep_qbody[i].qb_batch_rc);
+			if (ret == 0 || ret == -EDQUOT || ret == -EINPROGRESS)
+				repbody = &rep_qbody[i];
+		}
+		aa->aba_completion(env, lqe2qqi(batch->qdb_lqes[i]),
+				   &batch->qdb_bodies[i], repbody,
+				   &batch->qdb_lockh[i], NULL,
+				   batch->qdb_lqes[i], ret);
+	}
+out:
+	OBD_FREE_LARGE(batch, sizeof(*batch));
+	RETURN(rc);
+}
+
+/*
+ * Send the space adjustments collected in \a batch to the master in a single
+ * QUOTA_DQACQ_BATCH request. The request is always asynchronous and \a batch
+ * is released once all the entries have been completed.
+ *
+ * \param env    - the environment passed by the caller
+ * \param exp    - is the export to use to send the request
+ * \param batch  - quota bodies to be packed in request
+ * \param completion - completion callback called for each entry
+ */
+void qsd_send_dqacq_batch(const struct lu_env *env, struct obd_export *exp,
+			  struct qsd_dqacq_batch *batch,
+			  qsd_req_completion_t completion)
+{
+	struct ptlrpc_request		*req;
+	struct quota_body		*req_qbody;
+	struct qsd_batch_async_args	*aa;
+	int				 i, rc;
+	ENTRY;
+
+	LASSERT(exp);
+	LASSERT(batch->qdb_count > 0 &&
+		batch->qdb_count <= QUOTA_DQACQ_BATCH_MAX);
+
+	req = ptlrpc_request_alloc(class_exp2cliimp(exp),
+				   &RQF_QUOTA_DQACQ_BATCH);
+	if (req == NULL)
+		GOTO(out, rc = -ENOMEM);
+
+	req_capsule_set_size(&req->rq_pill, &RMF_QUOTA_BATCH, RCL_CLIENT,
+			     batch->qdb_count * sizeof(*req_qbody));
+	req->rq_no_resend = req->rq_no_delay = 1;
+	req->rq_no_retry_einprogress = 1;
+	rc = ptlrpc_request_pack(req, LUSTRE_MDS_VERSION, QUOTA_DQACQ_BATCH);
+	if (rc) {
+		ptlrpc_request_free(req);
+		GOTO(out, rc);
+	}
+
+	req->rq_request_portal = MDS_READPAGE_PORTAL;
+	req_qbody = req_capsule_client_get(&req->rq_pill, &RMF_QUOTA_BATCH);
+	memcpy(req_qbody, batch->qdb_bodies,
+	       batch->qdb_count * sizeof(*req_qbody));
+
+	req_capsule_set_size(&req->rq_pill, &RMF_QUOTA_BATCH, RCL_SERVER,
+			     batch->qdb_count * sizeof(*req_qbody));
+	ptlrpc_request_set_replen(req);
+
+	aa = ptlrpc_req_async_args(aa, req);
+	aa->aba_exp = exp;
+	aa->aba_batch = batch;
+	aa->aba_completion = completion;
+
+	req->rq_interpret_reply = qsd_dqacq_batch_interpret;
+	ptlrpcd_add_req(req);
+	RETURN_EXIT;
+out:
+	for (i = 0; i < batch->qdb_count; i++)
+		completion(env, lqe2qqi(batch->qdb_lqes[i]),
+			   &batch->qdb_bodies[i], NULL, &batch->qdb_lockh[i],
+			   NULL, batch->qdb_lqes[i], rc);
+	OBD_FREE_LARGE(batch, sizeof(*batch));
+	EXIT;
+}
+
 /*
  * intent quota request interpret callback.
  *
@@ -527,6 +527,7 @@ static int qsd_upd_thread(void *_args)
 	int			 qtype, rc = 0;
 	bool			 uptodate;
 	struct lquota_entry	*lqe;
+	struct qsd_dqacq_batch	*batch = NULL;
 	time64_t cur_time;
 	ENTRY;
 
@@ -584,13 +585,16 @@ static int qsd_upd_thread(void *_args)
 				if (lqe->lqe_adjust_time == 0)
 					qsd_id_lock_cancel(env, lqe);
 				else
-					qsd_adjust(env, lqe);
+					/* pack the adjustments of several IDs
+					 * in a single request */
+					qsd_adjust_batch(env, lqe, &batch);
 			}
 
 			lqe_putref(lqe);
 			spin_lock(&qsd->qsd_adjust_lock);
 		}
 		spin_unlock(&qsd->qsd_adjust_lock);
+		qsd_adjust_flush(env, &batch);
 
 		if (uptodate || kthread_should_stop())
 			continue;
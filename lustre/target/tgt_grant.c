@@ -73,6 +73,7 @@
 
 #define DEBUG_SUBSYSTEM S_CLASS
 
+#include <lnet/lib-lnet.h>
 #include <obd.h>
 #include <obd_class.h>
 
@@ -136,6 +137,174 @@ static inline u64 tgt_grant_chunk(struct obd_export *exp,
 	return chunk;
 }
 
+/* Don't book more than 1/TGT_GRANT_POOL_SHARE of the ungranted space in the
+ * reservoirs of all grant pools */
+#define TGT_GRANT_POOL_SHARE	4
+/* Reservoir size, in grant chunks, a pool is refilled up to */
+#define TGT_GRANT_POOL_CHUNKS	64
+/* Ungranted space, in grant chunks, a pool must keep to account a bulk write
+ * without tgd_grant_lock. Cached statfs data are refreshed and the reservoirs
+ * are given back below that threshold */
+#define TGT_GRANT_POOL_LOW	32
+
+/*
+ * Index of the grant pool and pool lock an export is hashed to. The pool
+ * lock protects the grant counters of the export, so the mapping must be
+ * stable and can't follow the CPU handling the request.
+ */
+static inline int tgt_grant_pool_idx(struct tg_grants_data *tgd,
+				     struct obd_export *exp)
+{
+	return exp->exp_handle.h_cookie % cfs_percpt_number(tgd->tgd_pools);
+}
+
+static inline struct tgt_grant_pool *tgt_grant_pool(struct tg_grants_data *tgd,
+						    int idx)
+{
+	return tgd->tgd_pools[idx];
+}
+
+/**
+ * Allocate the grant pools of a target, exports are hashed to them.
+ *
+ * \param[in] tgd	grant data of the target
+ *
+ * \retval 0		on success
+ * \retval -ENOMEM	on allocation failure
+ */
+int tgt_grant_pools_init(struct tg_grants_data *tgd)
+{
+	tgd->tgd_pools = cfs_percpt_alloc(cfs_cpt_tab,
+					  sizeof(struct tgt_grant_pool));
+	if (tgd->tgd_pools == NULL)
+		return -ENOMEM;
+
+	tgd->tgd_pool_lock = cfs_percpt_lock_alloc(cfs_cpt_tab);
+	if (tgd->tgd_pool_lock == NULL) {
+		cfs_percpt_free(tgd->tgd_pools);
+		tgd->tgd_pools = NULL;
+		return -ENOMEM;
+	}
+	return 0;
+}
+
+void tgt_grant_pools_fini(struct tg_grants_data *tgd)
+{
+	if (tgd->tgd_pool_lock != NULL) {
+		cfs_percpt_lock_free(tgd->tgd_pool_lock);
+		tgd->tgd_pool_lock = NULL;
+	}
+	if (tgd->tgd_pools != NULL) {
+		cfs_percpt_free(tgd->tgd_pools);
+		tgd->tgd_pools = NULL;
+	}
+}
+
+/**
+ * Total amount of dirty data reported by clients, summed over grant pools.
+ *
+ * The sum is computed without locking and is only a snapshot.
+ *
+ * \param[in] tgd	grant data of the target
+ *
+ * \retval		dirty data in bytes
+ */
+u64 tgt_grant_tot_dirty(struct tg_grants_data *tgd)
+{
+	struct tgt_grant_pool *tgp;
+	u64 dirty = 0;
+	int i;
+
+	if (tgd->tgd_pools == NULL)
+		return 0;
+
+	cfs_percpt_for_each(tgp, i, tgd->tgd_pools)
+		dirty += READ_ONCE(tgp->tgp_dirty);
+	return dirty;
+}
+EXPORT_SYMBOL(tgt_grant_tot_dirty);
+
+/**
+ * Total amount of grant used by I/Os in progress, summed over grant pools.
+ *
+ * The sum is computed without locking and is only a snapshot.
+ *
+ * \param[in] tgd	grant data of the target
+ *
+ * \retval		pending grant in bytes
+ */
+u64 tgt_grant_tot_pending(struct tg_grants_data *tgd)
+{
+	struct tgt_grant_pool *tgp;
+	u64 pending = 0;
+	int i;
+
+	if (tgd->tgd_pools == NULL)
+		return 0;
+
+	cfs_percpt_for_each(tgp, i, tgd->tgd_pools)
+		pending += READ_ONCE(tgp->tgp_pending);
+	return pending;
+}
+EXPORT_SYMBOL(tgt_grant_tot_pending);
+
+/*
+ * Unbook the space released by the exports of a pool.
+ * Caller must hold tgd_grant_lock and the pool lock.
+ */
+static void tgt_grant_pool_flush(struct tg_grants_data *tgd,
+				 struct tgt_grant_pool *tgp)
+{
+	assert_spin_locked(&tgd->tgd_grant_lock);
+
+	if (unlikely(tgd->tgd_tot_granted < tgp->tgp_returned)) {
+		CERROR("tot_granted %llu < pool returned %llu\n",
+		       tgd->tgd_tot_granted, tgp->tgp_returned);
+		tgp->tgp_returned = tgd->tgd_tot_granted;
+	}
+	tgd->tgd_tot_granted -= tgp->tgp_returned;
+	tgp->tgp_returned = 0;
+}
+
+/*
+ * Give back to the global pool the reservoirs of all grant pools, as well as
+ * the space released by their exports. This is done when the target runs
+ * short of ungranted space, so that tgt_grant_space_left() is as accurate as
+ * without grant pools.
+ * Caller must hold tgd_grant_lock and no pool lock.
+ */
+static void tgt_grant_pools_drain(struct tg_grants_data *tgd)
+{
+	struct tgt_grant_pool *tgp;
+	int i;
+
+	assert_spin_locked(&tgd->tgd_grant_lock);
+
+	cfs_percpt_lock(tgd->tgd_pool_lock, CFS_PERCPT_LOCK_EX);
+	cfs_percpt_for_each(tgp, i, tgd->tgd_pools) {
+		tgt_grant_pool_flush(tgd, tgp);
+		tgd->tgd_tot_granted -= tgp->tgp_avail;
+		tgp->tgp_avail = 0;
+		tgp->tgp_batch = 0;
+	}
+	cfs_percpt_unlock(tgd->tgd_pool_lock, CFS_PERCPT_LOCK_EX);
+}
+
+/*
+ * Space booked by the grant pools but not held by any export.
+ * Caller must hold tgd_grant_lock and the exclusive pool lock.
+ */
+static u64 tgt_grant_pools_booked(struct tg_grants_data *tgd)
+{
+	struct tgt_grant_pool *tgp;
+	u64 booked = 0;
+	int i;
+
+	cfs_percpt_for_each(tgp, i, tgd->tgd_pools)
+		booked += tgp->tgp_avail + tgp->tgp_returned;
+	return booked;
+}
+
 static int tgt_check_export_grants(struct obd_export *exp, u64 *dirty,
 				   u64 *pending, u64 *granted, u64 maxsize)
 {
@@ -171,10 +340,10 @@ static int tgt_check_export_grants(struct obd_export *exp, u64 *dirty,
  * Perform extra sanity checks for grant accounting.
  *
  * This function scans the export list, sanity checks per-export grant counters
- * and verifies accuracy of global grant accounting. If an inconsistency is
- * found, a CERROR is printed with the function name \func that was passed as
- * argument. LBUG is only called in case of serious counter corruption (i.e.
- * value larger than the device size).
+ * and verifies accuracy of global grant accounting, once aggregated over the
+ * grant pools. If an inconsistency is found, a CERROR is printed with
+ * the function name \func that was passed as argument. LBUG is only called in
+ * case of serious counter corruption (i.e. value larger than the device size).
  * Those sanity checks can be pretty expensive and are disabled if the OBD
  * device has more than 100 connected exports by default.
  *
@@ -197,7 +366,7 @@ void tgt_grant_sanity_check(struct obd_device *obd, const char *func)
 	u64		   fo_tot_dirty;
 	int		   error;
 
-	if (list_empty(&obd->obd_exports))
+	if (list_empty(&obd->obd_exports) || tgd->tgd_pools == NULL)
 		return;
 
 	/*
@@ -214,6 +383,7 @@ void tgt_grant_sanity_check(struct obd_device *obd, const char *func)
 
 	spin_lock(&obd->obd_dev_lock);
 	spin_lock(&tgd->tgd_grant_lock);
+	cfs_percpt_lock(tgd->tgd_pool_lock, CFS_PERCPT_LOCK_EX);
 	exp = obd->obd_self_export;
 	ted = &exp->exp_target_data;
 	CDEBUG(D_CACHE, "%s: processing self export: %ld %ld "
@@ -227,6 +397,8 @@ void tgt_grant_sanity_check(struct obd_device *obd, const char *func)
 		error = tgt_check_export_grants(exp, &tot_dirty, &tot_pending,
 						&tot_granted, maxsize);
 		if (error < 0) {
+			cfs_percpt_unlock(tgd->tgd_pool_lock,
+					  CFS_PERCPT_LOCK_EX);
 			spin_unlock(&obd->obd_dev_lock);
 			spin_unlock(&tgd->tgd_grant_lock);
 			LBUG();
@@ -240,15 +412,19 @@ void tgt_grant_sanity_check(struct obd_device *obd, const char *func)
 		error = tgt_check_export_grants(exp, &tot_dirty, &tot_pending,
 						&tot_granted, maxsize);
 		if (error < 0) {
+			cfs_percpt_unlock(tgd->tgd_pool_lock,
+					  CFS_PERCPT_LOCK_EX);
 			spin_unlock(&obd->obd_dev_lock);
 			spin_unlock(&tgd->tgd_grant_lock);
 			LBUG();
 		}
 	}
 
-	fo_tot_granted = tgd->tgd_tot_granted;
-	fo_tot_pending = tgd->tgd_tot_pending;
-	fo_tot_dirty = tgd->tgd_tot_dirty;
+	/* space booked by the grant pools isn't held by any export */
+	fo_tot_granted = tgd->tgd_tot_granted - tgt_grant_pools_booked(tgd);
+	fo_tot_pending = tgt_grant_tot_pending(tgd);
+	fo_tot_dirty = tgt_grant_tot_dirty(tgd);
+	cfs_percpt_unlock(tgd->tgd_pool_lock, CFS_PERCPT_LOCK_EX);
 	spin_unlock(&obd->obd_dev_lock);
 	spin_unlock(&tgd->tgd_grant_lock);
 
@@ -348,7 +524,7 @@ int tgt_statfs_internal(const struct lu_env *env, struct lu_target *lut,
 		}
 		/* similarly, there is some uncertainty on write requests
 		 * between prepare & commit */
-		tgd->tgd_osfs_unstable += tgd->tgd_tot_pending;
+		tgd->tgd_osfs_unstable += tgt_grant_tot_pending(tgd);
 		spin_unlock(&tgd->tgd_grant_lock);
 
 		/* finally udpate cached statfs data */
@@ -372,6 +548,8 @@ int tgt_statfs_internal(const struct lu_env *env, struct lu_target *lut,
 	GOTO(out, rc);
 
 out:
+	if (rc == 0)
+		tgt_load_statfs(lut, osfs);
 	return rc;
 }
 EXPORT_SYMBOL(tgt_statfs_internal);
@@ -441,6 +619,7 @@ static u64 tgt_grant_space_left(struct obd_export *exp)
 	struct lu_target	*lut = obd2obt(obd)->obt_lut;
 	struct tg_grants_data	*tgd = &lut->lut_tgd;
 	u64			 tot_granted;
+	u64			 tot_pending;
 	u64			 left;
 	u64			 avail;
 	u64			 unstable;
@@ -457,19 +636,18 @@ static u64 tgt_grant_space_left(struct obd_export *exp)
 
 	reserved = left * tgd->tgd_reserved_pcnt / 100;
 	tot_granted = tgd->tgd_tot_granted + reserved;
+	tot_pending = tgt_grant_tot_pending(tgd);
 
 	if (left < tot_granted) {
-		int mask = (left + unstable <
-			    tot_granted - tgd->tgd_tot_pending) ?
+		int mask = (left + unstable < tot_granted - tot_pending) ?
 			    D_ERROR : D_CACHE;
 
 		/* the below message is checked in sanityn.sh test_15 */
 		CDEBUG_LIMIT(mask,
 			     "%s: cli %s/%p left=%llu < tot_grant=%llu unstable=%llu pending=%llu dirty=%llu\n",
 			     obd->obd_name, exp->exp_client_uuid.uuid, exp,
-			     left, tot_granted, unstable,
-			     tgd->tgd_tot_pending,
-			     tgd->tgd_tot_dirty);
+			     left, tot_granted, unstable, tot_pending,
+			     tgt_grant_tot_dirty(tgd));
 		RETURN(0);
 	}
 
@@ -483,11 +661,78 @@ static u64 tgt_grant_space_left(struct obd_export *exp)
 	CDEBUG(D_CACHE,
 	       "%s: cli %s/%p avail=%llu left=%llu unstable=%llu tot_grant=%llu pending=%llu\n",
 	       obd->obd_name, exp->exp_client_uuid.uuid, exp, avail, left,
-	       unstable, tot_granted, tgd->tgd_tot_pending);
+	       unstable, tot_granted, tot_pending);
 
 	RETURN(left);
 }
 
+/**
+ * Lock grant counters for a request which needs to know how much ungranted
+ * space is left on the target.
+ *
+ * Take tgd_grant_lock and the lock of the grant pool \a idx, then lend all the
+ * ungranted space to the pool reservoir, from which space is granted for the
+ * rest of the request. When the target runs short of space, the reservoirs of
+ * all grant pools are given back first.
+ * Must be paired with tgt_grant_unlock_slow().
+ *
+ * \param[in] exp	export associated with the request
+ * \param[in] idx	grant pool the export is hashed to
+ * \param[in] chunk	grant allocation unit of the export
+ *
+ * \retval		amount of non-allocated space, in bytes
+ */
+static u64 tgt_grant_lock_slow(struct obd_export *exp, int idx, long chunk)
+{
+	struct tg_grants_data	*tgd = &obd2obt(exp->exp_obd)->obt_lut->lut_tgd;
+	struct tgt_grant_pool	*tgp = tgt_grant_pool(tgd, idx);
+	u64			 left;
+	u64			 batch;
+
+	spin_lock(&tgd->tgd_grant_lock);
+	cfs_percpt_lock(tgd->tgd_pool_lock, idx);
+	tgt_grant_pool_flush(tgd, tgp);
+	left = tgt_grant_space_left(exp);
+	if (left < TGT_GRANT_POOL_LOW * chunk) {
+		cfs_percpt_unlock(tgd->tgd_pool_lock, idx);
+		tgt_grant_pools_drain(tgd);
+		cfs_percpt_lock(tgd->tgd_pool_lock, idx);
+		left = tgt_grant_space_left(exp);
+	}
+
+	/* size of the reservoir kept by the pool once the request is done */
+	batch = div_u64(left, TGT_GRANT_POOL_SHARE *
+			      cfs_percpt_number(tgd->tgd_pools));
+	batch = min_t(u64, batch, TGT_GRANT_POOL_CHUNKS * chunk);
+	tgp->tgp_batch = batch & ~((1ULL << tgd->tgd_blockbits) - 1);
+
+	tgd->tgd_tot_granted += left;
+	tgp->tgp_avail += left;
+
+	return tgp->tgp_avail;
+}
+
+/**
+ * Companion of tgt_grant_lock_slow().
+ *
+ * Give back to the global pool the space lent to the grant pool \a idx beyond
+ * its reservoir size and release the locks.
+ *
+ * \param[in] tgd	grant data of the target
+ * \param[in] idx	grant pool locked by tgt_grant_lock_slow()
+ */
+static void tgt_grant_unlock_slow(struct tg_grants_data *tgd, int idx)
+{
+	struct tgt_grant_pool *tgp = tgt_grant_pool(tgd, idx);
+
+	if (tgp->tgp_avail > tgp->tgp_batch) {
+		tgd->tgd_tot_granted -= tgp->tgp_avail - tgp->tgp_batch;
+		tgp->tgp_avail = tgp->tgp_batch;
+	}
+	cfs_percpt_unlock(tgd->tgd_pool_lock, idx);
+	spin_unlock(&tgd->tgd_grant_lock);
+}
+
 /**
  * Process grant information from obdo structure packed in incoming BRW
  * and inflate grant counters if required.
@@ -496,14 +741,16 @@ static u64 tgt_grant_space_left(struct obd_export *exp)
  * inflate all grant counters passed in the request if the client does not
  * support the grant parameters.
  * We will later calculate the client's new grant and return it.
- * Caller must hold tgd_grant_lock spinlock.
+ * Caller must hold the lock of the grant pool \a tgp.
  *
  * \param[in] env	LU environment supplying osfs storage
  * \param[in] exp	export for which we received the request
+ * \param[in] tgp	grant pool the export is hashed to
  * \param[in,out] oa	incoming obdo sent by the client
  */
 static void tgt_grant_incoming(const struct lu_env *env, struct obd_export *exp,
-			       struct obdo *oa, long chunk)
+			       struct tgt_grant_pool *tgp, struct obdo *oa,
+			       long chunk)
 {
 	struct tg_export_data	*ted = &exp->exp_target_data;
 	struct obd_device	*obd = exp->exp_obd;
@@ -511,8 +758,6 @@ static void tgt_grant_incoming(const struct lu_env *env, struct obd_export *exp,
 	long long		 dirty, dropped;
 	ENTRY;
 
-	assert_spin_locked(&tgd->tgd_grant_lock);
-
 	if ((oa->o_valid & (OBD_MD_FLBLOCKS|OBD_MD_FLGRANT)) !=
 					(OBD_MD_FLBLOCKS|OBD_MD_FLGRANT)) {
 		oa->o_valid &= ~OBD_MD_FLGRANT;
@@ -556,7 +801,7 @@ static void tgt_grant_incoming(const struct lu_env *env, struct obd_export *exp,
 	 * on ted_dirty however, but we must check sanity to not assert. */
 	if (dirty > ted->ted_grant + 4 * chunk)
 		dirty = ted->ted_grant + 4 * chunk;
-	tgd->tgd_tot_dirty += dirty - ted->ted_dirty;
+	tgp->tgp_dirty += dirty - ted->ted_dirty;
 	if (ted->ted_grant < dropped) {
 		CDEBUG(D_CACHE,
 		       "%s: cli %s/%p reports %llu dropped > grant %lu\n",
@@ -564,13 +809,8 @@ static void tgt_grant_incoming(const struct lu_env *env, struct obd_export *exp,
 		       ted->ted_grant);
 		dropped = 0;
 	}
-	if (tgd->tgd_tot_granted < dropped) {
-		CERROR("%s: cli %s/%p reports %llu dropped > tot_grant %llu\n",
-		       obd->obd_name, exp->exp_client_uuid.uuid, exp,
-		       dropped, tgd->tgd_tot_granted);
-		dropped = 0;
-	}
-	tgd->tgd_tot_granted -= dropped;
+	/* dropped grant is unbooked from tgd_tot_granted by batches */
+	tgp->tgp_returned += dropped;
 	ted->ted_grant -= dropped;
 	ted->ted_dirty = dirty;
 
@@ -578,7 +818,6 @@ static void tgt_grant_incoming(const struct lu_env *env, struct obd_export *exp,
 		CERROR("%s: cli %s/%p dirty %ld pend %ld grant %ld\n",
 		       obd->obd_name, exp->exp_client_uuid.uuid, exp,
 		       ted->ted_dirty, ted->ted_pending, ted->ted_grant);
-		spin_unlock(&tgd->tgd_grant_lock);
 		LBUG();
 	}
 	EXIT;
@@ -591,7 +830,8 @@ static void tgt_grant_incoming(const struct lu_env *env, struct obd_export *exp,
  * shrinking). This function proceeds with the shrink request when there is
  * less ungranted space remaining than the amount all of the connected clients
  * would consume if they used their full grant.
- * Caller must hold tgd_grant_lock spinlock.
+ * Caller must hold tgd_grant_lock spinlock and the lock of the grant pool the
+ * export is hashed to.
  *
  * \param[in] exp		export releasing grant space
  * \param[in,out] oa		incoming obdo sent by the client
@@ -703,25 +943,26 @@ static inline u64 tgt_grant_rnb_size(struct obd_export *exp,
  * The OBD_BRW_GRANTED flag will be set in the rnb_flags of each network
  * buffer which has been granted enough space to proceed. Buffers without
  * this flag will fail to be written with -ENOSPC (see tgt_preprw_write().
- * Caller must hold tgd_grant_lock spinlock.
+ * Space required by buffers which did not consume grant on the client is taken
+ * from the reservoir of the grant pool.
+ * Caller must hold the lock of the grant pool \a tgp.
  *
  * \param[in] env	LU environment passed by the caller
  * \param[in] exp	export identifying the client which sent the RPC
+ * \param[in] tgp	grant pool the export is hashed to
  * \param[in] oa	incoming obdo in which we should return the pack the
  *			additional grant
  * \param[in,out] rnb	the list of network buffers
  * \param[in] niocount	the number of network buffers in the list
- * \param[in] left	the remaining free space with space already granted
- *			taken out
  */
 static void tgt_grant_check(const struct lu_env *env, struct obd_export *exp,
-			    struct obdo *oa, struct niobuf_remote *rnb,
-			    int niocount, u64 *left)
+			    struct tgt_grant_pool *tgp, struct obdo *oa,
+			    struct niobuf_remote *rnb, int niocount)
 {
 	struct tg_export_data	*ted = &exp->exp_target_data;
 	struct obd_device	*obd = exp->exp_obd;
 	struct lu_target	*lut = obd2obt(obd)->obt_lut;
-	struct tg_grants_data	*tgd = &lut->lut_tgd;
+	u64			*left = &tgp->tgp_avail;
 	unsigned long		 ungranted = 0;
 	unsigned long		 granted = 0;
 	int			 i;
@@ -729,8 +970,6 @@ static void tgt_grant_check(const struct lu_env *env, struct obd_export *exp,
 
 	ENTRY;
 
-	assert_spin_locked(&tgd->tgd_grant_lock);
-
 	if (obd->obd_recovering) {
 		/* Replaying write. Grant info have been processed already so no
 		 * need to do any enforcement here. It is worth noting that only
@@ -848,8 +1087,7 @@ static void tgt_grant_check(const struct lu_env *env, struct obd_export *exp,
 	 * happens in tgt_grant_commit() after the writes are done. */
 	ted->ted_grant -= granted;
 	ted->ted_pending += oa->o_grant_used;
-	tgd->tgd_tot_granted += ungranted;
-	tgd->tgd_tot_pending += oa->o_grant_used;
+	tgp->tgp_pending += oa->o_grant_used;
 
 	CDEBUG(D_CACHE,
 	       "%s: cli %s/%p granted: %lu ungranted: %lu grant: %lu dirty: %lu"
@@ -867,14 +1105,13 @@ static void tgt_grant_check(const struct lu_env *env, struct obd_export *exp,
 		       granted, ted->ted_dirty);
 		granted = ted->ted_dirty;
 	}
-	tgd->tgd_tot_dirty -= granted;
+	tgp->tgp_dirty -= granted;
 	ted->ted_dirty -= granted;
 
 	if (ted->ted_dirty < 0 || ted->ted_grant < 0 || ted->ted_pending < 0) {
 		CERROR("%s: cli %s/%p dirty %ld pend %ld grant %ld\n",
 		       obd->obd_name, exp->exp_client_uuid.uuid, exp,
 		       ted->ted_dirty, ted->ted_pending, ted->ted_grant);
-		spin_unlock(&tgd->tgd_grant_lock);
 		LBUG();
 	}
 	EXIT;
@@ -884,15 +1121,16 @@ static void tgt_grant_check(const struct lu_env *env, struct obd_export *exp,
  * Allocate additional grant space to a client
  *
  * Calculate how much grant space to return to client, based on how much space
- * is currently free and how much of that is already granted.
- * Caller must hold tgd_grant_lock spinlock.
+ * is currently free and how much of that is already granted. Space is taken
+ * from the reservoir of the grant pool, which holds the remaining free space
+ * with granted space taken out when called with tgd_grant_lock.
+ * Caller must hold the lock of the grant pool \a tgp.
  *
  * \param[in] exp		export of the client which sent the request
+ * \param[in] tgp		grant pool the export is hashed to
  * \param[in] curgrant		current grant claimed by the client
  * \param[in] want		how much grant space the client would like to
  *				have
- * \param[in] left		remaining free space with granted space taken
- *				out
  * \param[in] chunk		grant allocation unit
  * \param[in] conservative	if set to true, the server should be cautious
  *				and limit how much space is granted back to the
@@ -901,13 +1139,14 @@ static void tgt_grant_check(const struct lu_env *env, struct obd_export *exp,
  *
  * \retval			amount of grant space allocated
  */
-static long tgt_grant_alloc(struct obd_export *exp, u64 curgrant,
-			    u64 want, u64 left, long chunk,
+static long tgt_grant_alloc(struct obd_export *exp, struct tgt_grant_pool *tgp,
+			    u64 curgrant, u64 want, long chunk,
 			    bool conservative)
 {
 	struct obd_device	*obd = exp->exp_obd;
 	struct tg_grants_data	*tgd = &obd2obt(obd)->obt_lut->lut_tgd;
 	struct tg_export_data	*ted = &exp->exp_target_data;
+	u64			 left = tgp->tgp_avail;
 	u64			 grant;
 
 	ENTRY;
@@ -953,6 +1192,9 @@ static long tgt_grant_alloc(struct obd_export *exp, u64 curgrant,
 	/* round grant up to the next block size */
 	grant = (grant + (1 << tgd->tgd_blockbits) - 1) &
 		~((1ULL << tgd->tgd_blockbits) - 1);
+	/* but never beyond the pool reservoir */
+	if (grant > tgp->tgp_avail)
+		grant = tgp->tgp_avail & ~((1ULL << tgd->tgd_blockbits) - 1);
 
 	if (!grant)
 		RETURN(0);
@@ -971,17 +1213,15 @@ static long tgt_grant_alloc(struct obd_export *exp, u64 curgrant,
 	if (ted->ted_grant + grant > want + chunk)
 		grant = want + chunk - ted->ted_grant;
 
-	tgd->tgd_tot_granted += grant;
+	tgp->tgp_avail -= grant;
 	ted->ted_grant += grant;
 
 	if (unlikely(ted->ted_grant < 0 || ted->ted_grant > want + chunk)) {
 		CERROR("%s: cli %s/%p grant %ld want %llu current %llu\n",
 		       obd->obd_name, exp->exp_client_uuid.uuid, exp,
 		       ted->ted_grant, want, curgrant);
-		if (lbug_on_grant_miscount) {
-			spin_unlock(&tgd->tgd_grant_lock);
+		if (lbug_on_grant_miscount)
 			LBUG();
-		}
 	}
 
 	CDEBUG(D_CACHE,
@@ -991,7 +1231,7 @@ static long tgt_grant_alloc(struct obd_export *exp, u64 curgrant,
 	CDEBUG(D_CACHE,
 	       "%s: cli %s/%p tot cached:%llu granted:%llu"
 	       " num_exports: %d\n", obd->obd_name, exp->exp_client_uuid.uuid,
-	       exp, tgd->tgd_tot_dirty, tgd->tgd_tot_granted,
+	       exp, tgt_grant_tot_dirty(tgd), tgd->tgd_tot_granted,
 	       obd->obd_num_exports);
 
 	RETURN(grant);
@@ -1018,11 +1258,13 @@ void tgt_grant_connect(const struct lu_env *env, struct obd_export *exp,
 	struct lu_target	*lut = obd2obt(exp->exp_obd)->obt_lut;
 	struct tg_grants_data	*tgd = &lut->lut_tgd;
 	struct tg_export_data	*ted = &exp->exp_target_data;
+	struct tgt_grant_pool	*tgp;
 	u64			 left = 0;
 	u64			 want;
 	long			 chunk;
 	int			 from_cache;
 	int			 force = 0; /* can use cached data */
+	int			 idx;
 
 	/* don't grant space to client with read-only access */
 	if (OCD_HAS_FLAG(data, RDONLY) ||
@@ -1039,24 +1281,24 @@ void tgt_grant_connect(const struct lu_env *env, struct obd_export *exp,
 	else
 		want = tgt_grant_inflate(tgd, data->ocd_grant);
 	chunk = tgt_grant_chunk(exp, lut, data);
+	idx = tgt_grant_pool_idx(tgd, exp);
+	tgp = tgt_grant_pool(tgd, idx);
 refresh:
 	tgt_grant_statfs(env, exp, force, &from_cache);
 
-	spin_lock(&tgd->tgd_grant_lock);
-
 	/* Grab free space from cached info and take out space already granted
 	 * to clients as well as reserved space */
-	left = tgt_grant_space_left(exp);
+	left = tgt_grant_lock_slow(exp, idx, chunk);
 
 	/* get fresh statfs data if we are short in ungranted space */
-	if (from_cache && left < 32 * chunk) {
-		spin_unlock(&tgd->tgd_grant_lock);
+	if (from_cache && left < TGT_GRANT_POOL_LOW * chunk) {
+		tgt_grant_unlock_slow(tgd, idx);
 		CDEBUG(D_CACHE, "fs has no space left and statfs too old\n");
 		force = 1;
 		goto refresh;
 	}
 
-	tgt_grant_alloc(exp, (u64)ted->ted_grant, want, left, chunk, new_conn);
+	tgt_grant_alloc(exp, tgp, (u64)ted->ted_grant, want, chunk, new_conn);
 
 	/* return to client its current grant */
 	if (OCD_HAS_FLAG(data, GRANT_PARAM))
@@ -1066,13 +1308,13 @@ refresh:
 		data->ocd_grant = tgt_grant_deflate(tgd, (u64)ted->ted_grant);
 
 	/* reset dirty accounting */
-	tgd->tgd_tot_dirty -= ted->ted_dirty;
+	tgp->tgp_dirty -= ted->ted_dirty;
 	ted->ted_dirty = 0;
 
 	if (new_conn && OCD_HAS_FLAG(data, GRANT))
 		tgd->tgd_tot_granted_clients++;
 
-	spin_unlock(&tgd->tgd_grant_lock);
+	tgt_grant_unlock_slow(tgd, idx);
 
 	CDEBUG(D_CACHE, "%s: cli %s/%p ocd_grant: %d want: %llu left: %llu\n",
 	       exp->exp_obd->obd_name, exp->exp_client_uuid.uuid,
@@ -1098,48 +1340,62 @@ void tgt_grant_discard(struct obd_export *exp)
 	struct lu_target        *lut = class_exp2tgt(exp);
 	struct tg_export_data	*ted = &exp->exp_target_data;
 	struct tg_grants_data	*tgd;
+	struct tgt_grant_pool	*tgp;
+	u64			 booked;
+	u64			 dirty;
+	int			 i;
 
-	if (!lut)
+	if (!lut || !lut->lut_tgd.tgd_pools)
 		return;
 
 	tgd = &lut->lut_tgd;
+	tgp = tgt_grant_pool(tgd, tgt_grant_pool_idx(tgd, exp));
 	spin_lock(&tgd->tgd_grant_lock);
-	if (unlikely(tgd->tgd_tot_granted < ted->ted_grant ||
-		     tgd->tgd_tot_dirty < ted->ted_dirty)) {
+	cfs_percpt_lock(tgd->tgd_pool_lock, CFS_PERCPT_LOCK_EX);
+	booked = tgt_grant_pools_booked(tgd);
+	dirty = tgp->tgp_dirty;
+	if (unlikely(tgd->tgd_tot_granted < booked + ted->ted_grant ||
+		     dirty < ted->ted_dirty)) {
+		struct tgt_grant_pool *p;
 		struct obd_export *e;
 		u64 ttg = 0;
 		u64 ttd = 0;
 
+		cfs_percpt_for_each(p, i, tgd->tgd_pools)
+			p->tgp_dirty = 0;
 		list_for_each_entry(e, &obd->obd_exports, exp_obd_chain) {
 			LASSERT(exp != e);
+			p = tgt_grant_pool(tgd, tgt_grant_pool_idx(tgd, e));
 			ttg += e->exp_target_data.ted_grant;
 			ttg += e->exp_target_data.ted_pending;
 			ttd += e->exp_target_data.ted_dirty;
+			p->tgp_dirty += e->exp_target_data.ted_dirty;
 		}
-		if (tgd->tgd_tot_granted < ted->ted_grant)
+		if (tgd->tgd_tot_granted < booked + ted->ted_grant)
 			CERROR("%s: cli %s/%p: tot_granted %llu < ted_grant %ld, corrected to %llu",
 			       obd->obd_name,  exp->exp_client_uuid.uuid, exp,
-			       tgd->tgd_tot_granted, ted->ted_grant, ttg);
-		if (tgd->tgd_tot_dirty < ted->ted_dirty)
+			       tgd->tgd_tot_granted - booked, ted->ted_grant,
+			       ttg);
+		if (dirty < ted->ted_dirty)
 			CERROR("%s: cli %s/%p: tot_dirty %llu < ted_dirty %ld, corrected to %llu",
 			       obd->obd_name, exp->exp_client_uuid.uuid, exp,
-			       tgd->tgd_tot_dirty, ted->ted_dirty, ttd);
-		tgd->tgd_tot_granted = ttg;
-		tgd->tgd_tot_dirty = ttd;
+			       dirty, ted->ted_dirty, ttd);
+		tgd->tgd_tot_granted = ttg + booked;
 	} else {
 		tgd->tgd_tot_granted -= ted->ted_grant;
-		tgd->tgd_tot_dirty -= ted->ted_dirty;
+		tgp->tgp_dirty -= ted->ted_dirty;
 	}
 	ted->ted_grant = 0;
 	ted->ted_dirty = 0;
 
-	if (tgd->tgd_tot_pending < ted->ted_pending) {
+	if (tgp->tgp_pending < ted->ted_pending) {
 		CERROR("%s: tot_pending %llu < cli %s/%p ted_pending %ld\n",
-		       obd->obd_name, tgd->tgd_tot_pending,
+		       obd->obd_name, tgt_grant_tot_pending(tgd),
 		       exp->exp_client_uuid.uuid, exp, ted->ted_pending);
 	}
-	/* tgd_tot_pending is handled in tgt_grant_commit as bulk
+	/* tgp_pending is handled in tgt_grant_commit as bulk
 	 * commmits */
+	cfs_percpt_unlock(tgd->tgd_pool_lock, CFS_PERCPT_LOCK_EX);
 	spin_unlock(&tgd->tgd_grant_lock);
 }
 EXPORT_SYMBOL(tgt_grant_discard);
@@ -1162,7 +1418,9 @@ void tgt_grant_prepare_read(const struct lu_env *env,
 {
 	struct lu_target	*lut = obd2obt(exp->exp_obd)->obt_lut;
 	struct tg_grants_data	*tgd = &lut->lut_tgd;
+	long			 chunk = tgt_grant_chunk(exp, lut, NULL);
 	int			 do_shrink;
+	int			 idx;
 	u64			 left = 0;
 
 	ENTRY;
@@ -1175,6 +1433,7 @@ void tgt_grant_prepare_read(const struct lu_env *env,
 		 * information */
 		RETURN_EXIT;
 
+	idx = tgt_grant_pool_idx(tgd, exp);
 	if ((oa->o_valid & OBD_MD_FLFLAGS) &&
 	    (oa->o_flags & OBD_FL_SHRINK_GRANT)) {
 		/* To process grant shrink request, we need to know how much
@@ -1183,12 +1442,9 @@ void tgt_grant_prepare_read(const struct lu_env *env,
 		 * statfs information. */
 		tgt_grant_statfs(env, exp, 1, NULL);
 
-		/* protect all grant counters */
-		spin_lock(&tgd->tgd_grant_lock);
-
 		/* Grab free space from cached statfs data and take out space
 		 * already granted to clients as well as reserved space */
-		left = tgt_grant_space_left(exp);
+		left = tgt_grant_lock_slow(exp, idx, chunk);
 
 		/* all set now to proceed with shrinking */
 		do_shrink = 1;
@@ -1196,14 +1452,14 @@ void tgt_grant_prepare_read(const struct lu_env *env,
 		/* no grant shrinking request packed in the obdo and
 		 * since we don't grant space back on reads, no point
 		 * in running statfs, so just skip it and process
-		 * incoming grant data directly. */
-		spin_lock(&tgd->tgd_grant_lock);
+		 * incoming grant data directly under the pool lock. */
+		cfs_percpt_lock(tgd->tgd_pool_lock, idx);
 		do_shrink = 0;
 	}
 
 	/* extract incoming grant information provided by the client and
 	 * inflate grant counters if required */
-	tgt_grant_incoming(env, exp, oa, tgt_grant_chunk(exp, lut, NULL));
+	tgt_grant_incoming(env, exp, tgt_grant_pool(tgd, idx), oa, chunk);
 
 	/* unlike writes, we don't return grants back on reads unless a grant
 	 * shrink request was packed and we decided to turn it down. */
@@ -1214,11 +1470,80 @@ void tgt_grant_prepare_read(const struct lu_env *env,
 
 	if (!exp_grant_param_supp(exp))
 		oa->o_grant = tgt_grant_deflate(tgd, oa->o_grant);
-	spin_unlock(&tgd->tgd_grant_lock);
+	if (do_shrink)
+		tgt_grant_unlock_slow(tgd, idx);
+	else
+		cfs_percpt_unlock(tgd->tgd_pool_lock, idx);
 	EXIT;
 }
 EXPORT_SYMBOL(tgt_grant_prepare_read);
 
+/**
+ * Process grant information from incoming bulk write request without taking
+ * tgd_grant_lock.
+ *
+ * When the reservoir of the grant pool the export is hashed to holds enough
+ * space for the buffers which did not consume grant on the client, plus the
+ * margin under which tgt_grant_prepare_write() would refresh statfs data,
+ * the request can be fully accounted under the pool lock. Otherwise, or for
+ * requests which need to know the ungranted space left on the target (grant
+ * shrink, recovery), the caller has to go through the slow path.
+ *
+ * \param[in] env	LU environment provided by the caller
+ * \param[in] exp	export of the client which sent the request
+ * \param[in] idx	grant pool the export is hashed to
+ * \param[in] oa	incoming obdo sent by the client
+ * \param[in] rnb	list of network buffers
+ * \param[in] niocount	number of network buffers in the list
+ * \param[in] chunk	grant allocation unit of the export
+ *
+ * \retval true		if grant accounting was done
+ * \retval false	if the slow path must be used
+ */
+static bool tgt_grant_prepare_write_fast(const struct lu_env *env,
+					 struct obd_export *exp, int idx,
+					 struct obdo *oa,
+					 struct niobuf_remote *rnb,
+					 int niocount, long chunk)
+{
+	struct lu_target	*lut = obd2obt(exp->exp_obd)->obt_lut;
+	struct tg_grants_data	*tgd = &lut->lut_tgd;
+	struct tgt_grant_pool	*tgp = tgt_grant_pool(tgd, idx);
+	u64			 need = TGT_GRANT_POOL_LOW * chunk;
+	int			 i;
+
+	if (exp->exp_obd->obd_recovering ||
+	    ((oa->o_valid & OBD_MD_FLFLAGS) &&
+	     (oa->o_flags & OBD_FL_SHRINK_GRANT)))
+		return false;
+
+	for (i = 0; i < niocount; i++)
+		if (!(rnb[i].rnb_flags & OBD_BRW_FROM_GRANT))
+			need += tgt_grant_rnb_size(NULL, lut, &rnb[i]);
+
+	/* unlocked check, the reservoir is only refilled by the slow path */
+	if (READ_ONCE(tgp->tgp_avail) < need)
+		return false;
+
+	cfs_percpt_lock(tgd->tgd_pool_lock, idx);
+	if (tgp->tgp_avail < need) {
+		cfs_percpt_unlock(tgd->tgd_pool_lock, idx);
+		return false;
+	}
+
+	tgt_grant_incoming(env, exp, tgp, oa, chunk);
+	tgt_grant_check(env, exp, tgp, oa, rnb, niocount);
+	if (oa->o_valid & OBD_MD_FLGRANT) {
+		oa->o_grant = tgt_grant_alloc(exp, tgp, oa->o_grant,
+					      oa->o_undirty, chunk, true);
+		if (!exp_grant_param_supp(exp))
+			oa->o_grant = tgt_grant_deflate(tgd, oa->o_grant);
+	}
+	cfs_percpt_unlock(tgd->tgd_pool_lock, idx);
+
+	return true;
+}
+
 /**
  * Process grant information from incoming bulk write request.
  *
@@ -1233,6 +1558,8 @@ EXPORT_SYMBOL(tgt_grant_prepare_read);
  * the backend storage. This function works in pair with tgt_grant_commit()
  * which must be invoked once all buffers have been written to disk in order
  * to release space from the pending grant counter.
+ * Most requests are accounted under the lock of the grant pool the export is
+ * hashed to only, see tgt_grant_prepare_write_fast().
  *
  * \param[in] env	LU environment provided by the caller
  * \param[in] exp	export of the client which sent the request
@@ -1247,26 +1574,31 @@ void tgt_grant_prepare_write(const struct lu_env *env,
 	struct obd_device	*obd = exp->exp_obd;
 	struct lu_target	*lut = obd2obt(obd)->obt_lut;
 	struct tg_grants_data	*tgd = &lut->lut_tgd;
+	struct tgt_grant_pool	*tgp;
 	u64			 left;
 	int			 from_cache;
 	int			 force = 0; /* can use cached data intially */
 	long			 chunk = tgt_grant_chunk(exp, lut, NULL);
+	int			 idx = tgt_grant_pool_idx(tgd, exp);
 
 	ENTRY;
 
+	if (tgt_grant_prepare_write_fast(env, exp, idx, oa, rnb, niocount,
+					 chunk))
+		RETURN_EXIT;
+
+	tgp = tgt_grant_pool(tgd, idx);
 refresh:
 	/* get statfs information from OSD layer */
 	tgt_grant_statfs(env, exp, force, &from_cache);
 
-	spin_lock(&tgd->tgd_grant_lock); /* protect all grant counters */
-
 	/* Grab free space from cached statfs data and take out space already
 	 * granted to clients as well as reserved space */
-	left = tgt_grant_space_left(exp);
+	left = tgt_grant_lock_slow(exp, idx, chunk);
 
 	/* Get fresh statfs data if we are short in ungranted space */
-	if (from_cache && left < 32 * chunk) {
-		spin_unlock(&tgd->tgd_grant_lock);
+	if (from_cache && left < TGT_GRANT_POOL_LOW * chunk) {
+		tgt_grant_unlock_slow(tgd, idx);
 		CDEBUG(D_CACHE, "%s: fs has no space left and statfs too old\n",
 		       obd->obd_name);
 		force = 1;
@@ -1290,7 +1622,7 @@ refresh:
 		if (!from_grant) {
 			/* at least one network buffer requires acquiring grant
 			 * space on the server */
-			spin_unlock(&tgd->tgd_grant_lock);
+			tgt_grant_unlock_slow(tgd, idx);
 			/* discard errors, at least we tried ... */
 			dt_sync(env, lut->lut_bottom);
 			force = 2;
@@ -1300,13 +1632,13 @@ refresh:
 
 	/* extract incoming grant information provided by the client,
 	 * and inflate grant counters if required */
-	tgt_grant_incoming(env, exp, oa, chunk);
+	tgt_grant_incoming(env, exp, tgp, oa, chunk);
 
 	/* check limit */
-	tgt_grant_check(env, exp, oa, rnb, niocount, &left);
+	tgt_grant_check(env, exp, tgp, oa, rnb, niocount);
 
 	if (!(oa->o_valid & OBD_MD_FLGRANT)) {
-		spin_unlock(&tgd->tgd_grant_lock);
+		tgt_grant_unlock_slow(tgd, idx);
 		RETURN_EXIT;
 	}
 
@@ -1314,15 +1646,15 @@ refresh:
 	 * grant space. */
 	if ((oa->o_valid & OBD_MD_FLFLAGS) &&
 	    (oa->o_flags & OBD_FL_SHRINK_GRANT))
-		tgt_grant_shrink(exp, oa, left);
+		tgt_grant_shrink(exp, oa, tgp->tgp_avail);
 	else
 		/* grant more space back to the client if possible */
-		oa->o_grant = tgt_grant_alloc(exp, oa->o_grant, oa->o_undirty,
-					      left, chunk, true);
+		oa->o_grant = tgt_grant_alloc(exp, tgp, oa->o_grant,
+					      oa->o_undirty, chunk, true);
 
 	if (!exp_grant_param_supp(exp))
 		oa->o_grant = tgt_grant_deflate(tgd, oa->o_grant);
-	spin_unlock(&tgd->tgd_grant_lock);
+	tgt_grant_unlock_slow(tgd, idx);
 	EXIT;
 }
 EXPORT_SYMBOL(tgt_grant_prepare_write);
@@ -1350,9 +1682,12 @@ long tgt_grant_create(const struct lu_env *env, struct obd_export *exp, s64 *nr)
 	struct lu_target	*lut = obd2obt(exp->exp_obd)->obt_lut;
 	struct tg_grants_data	*tgd = &lut->lut_tgd;
 	struct tg_export_data	*ted = &exp->exp_target_data;
+	struct tgt_grant_pool	*tgp;
 	u64			 left = 0;
 	unsigned long		 wanted;
 	unsigned long		 granted;
+	long			 chunk;
+	int			 idx;
 	ENTRY;
 
 	if (exp->exp_obd->obd_recovering ||
@@ -1363,24 +1698,24 @@ long tgt_grant_create(const struct lu_env *env, struct obd_export *exp, s64 *nr)
 	/* Update statfs data if required */
 	tgt_grant_statfs(env, exp, 1, NULL);
 
-	/* protect all grant counters */
-	spin_lock(&tgd->tgd_grant_lock);
+	/* Grab free space from cached statfs data and take out space
+	 * already granted to clients as well as reserved space */
+	chunk = tgt_grant_chunk(exp, lut, NULL);
+	idx = tgt_grant_pool_idx(tgd, exp);
+	tgp = tgt_grant_pool(tgd, idx);
+	left = tgt_grant_lock_slow(exp, idx, chunk);
 
 	/* fail precreate request if there is not enough blocks available for
 	 * writing */
 	if (tgd->tgd_osfs.os_bavail - (ted->ted_grant >> tgd->tgd_blockbits) <
 	    (tgd->tgd_osfs.os_blocks >> 10)) {
-		spin_unlock(&tgd->tgd_grant_lock);
+		tgt_grant_unlock_slow(tgd, idx);
 		CDEBUG(D_RPCTRACE, "%s: not enough space for create %llu\n",
 		       exp->exp_obd->obd_name,
 		       tgd->tgd_osfs.os_bavail * tgd->tgd_osfs.os_blocks);
 		RETURN(-ENOSPC);
 	}
 
-	/* Grab free space from cached statfs data and take out space
-	 * already granted to clients as well as reserved space */
-	left = tgt_grant_space_left(exp);
-
 	/* compute how much space is required to handle the precreation
 	 * request */
 	wanted = *nr * lut->lut_dt_conf.ddp_inodespace;
@@ -1392,7 +1727,7 @@ long tgt_grant_create(const struct lu_env *env, struct obd_export *exp, s64 *nr)
 		if (*nr == 0) {
 			/* we really have no space any more for precreation,
 			 * fail the precreate request with ENOSPC */
-			spin_unlock(&tgd->tgd_grant_lock);
+			tgt_grant_unlock_slow(tgd, idx);
 			RETURN(-ENOSPC);
 		}
 		/* compute space needed for the new number of creations */
@@ -1405,27 +1740,22 @@ long tgt_grant_create(const struct lu_env *env, struct obd_export *exp, s64 *nr)
 		ted->ted_grant -= wanted;
 	} else {
 		/* we need to take some space from the ungranted pool */
-		tgd->tgd_tot_granted += wanted - ted->ted_grant;
-		left -= wanted - ted->ted_grant;
+		tgp->tgp_avail -= wanted - ted->ted_grant;
 		ted->ted_grant = 0;
 	}
 	granted = wanted;
 	ted->ted_pending += granted;
-	tgd->tgd_tot_pending += granted;
+	tgp->tgp_pending += granted;
 
 	/* grant more space for precreate purpose if possible. */
 	wanted = OST_MAX_PRECREATE * lut->lut_dt_conf.ddp_inodespace / 2;
 	if (wanted > ted->ted_grant) {
-		long chunk;
-
 		/* always try to book enough space to handle a large precreate
 		 * request */
-		chunk = tgt_grant_chunk(exp, lut, NULL);
 		wanted -= ted->ted_grant;
-		tgt_grant_alloc(exp, ted->ted_grant, wanted, left, chunk,
-				false);
+		tgt_grant_alloc(exp, tgp, ted->ted_grant, wanted, chunk, false);
 	}
-	spin_unlock(&tgd->tgd_grant_lock);
+	tgt_grant_unlock_slow(tgd, idx);
 	RETURN(granted);
 }
 EXPORT_SYMBOL(tgt_grant_create);
@@ -1434,6 +1764,9 @@ EXPORT_SYMBOL(tgt_grant_create);
  * Release grant space added to the pending counter by tgt_grant_prepare_write()
  *
  * Update pending grant counter once buffers have been written to the disk.
+ * Only the lock of the grant pool the export is hashed to is taken, released
+ * space is unbooked from tgd_tot_granted once the pool has accumulated more
+ * than its reservoir size.
  *
  * \param[in] exp	export of the client which sent the request
  * \param[in] pending	amount of reserved space to be released
@@ -1443,6 +1776,9 @@ void tgt_grant_commit(struct obd_export *exp, unsigned long pending,
 		      int rc)
 {
 	struct tg_grants_data *tgd = &obd2obt(exp->exp_obd)->obt_lut->lut_tgd;
+	struct tgt_grant_pool *tgp;
+	bool flush;
+	int idx;
 
 	ENTRY;
 
@@ -1451,7 +1787,9 @@ void tgt_grant_commit(struct obd_export *exp, unsigned long pending,
 	if (pending == 0)
 		RETURN_EXIT;
 
-	spin_lock(&tgd->tgd_grant_lock);
+	idx = tgt_grant_pool_idx(tgd, exp);
+	tgp = tgt_grant_pool(tgd, idx);
+	cfs_percpt_lock(tgd->tgd_pool_lock, idx);
 	/* Don't update statfs data for errors raised before commit (e.g.
 	 * bulk transfer failed, ...) since we know those writes have not been
 	 * processed. For other errors hit during commit, we cannot really tell
@@ -1475,29 +1813,30 @@ void tgt_grant_commit(struct obd_export *exp, unsigned long pending,
 		CERROR("%s: cli %s/%p ted_pending(%lu) < grant_used(%lu)\n",
 		       exp->exp_obd->obd_name, exp->exp_client_uuid.uuid, exp,
 		       exp->exp_target_data.ted_pending, pending);
-		spin_unlock(&tgd->tgd_grant_lock);
+		cfs_percpt_unlock(tgd->tgd_pool_lock, idx);
 		LBUG();
 	}
 	exp->exp_target_data.ted_pending -= pending;
 
-	if (tgd->tgd_tot_granted < pending) {
-		CERROR("%s: cli %s/%p tot_granted(%llu) < grant_used(%lu)\n",
+	if (tgp->tgp_pending < pending) {
+		CERROR("%s: cli %s/%p tot_pending(%llu) < grant_used(%lu)\n",
 		       exp->exp_obd->obd_name, exp->exp_client_uuid.uuid, exp,
-		       tgd->tgd_tot_granted, pending);
-		spin_unlock(&tgd->tgd_grant_lock);
+		       tgt_grant_tot_pending(tgd), pending);
+		cfs_percpt_unlock(tgd->tgd_pool_lock, idx);
 		LBUG();
 	}
-	tgd->tgd_tot_granted -= pending;
+	tgp->tgp_pending -= pending;
+	tgp->tgp_returned += pending;
+	flush = tgp->tgp_returned > tgp->tgp_batch;
+	cfs_percpt_unlock(tgd->tgd_pool_lock, idx);
 
-	if (tgd->tgd_tot_pending < pending) {
-		CERROR("%s: cli %s/%p tot_pending(%llu) < grant_used(%lu)\n",
-		       exp->exp_obd->obd_name, exp->exp_client_uuid.uuid, exp,
-		       tgd->tgd_tot_pending, pending);
+	if (flush) {
+		spin_lock(&tgd->tgd_grant_lock);
+		cfs_percpt_lock(tgd->tgd_pool_lock, idx);
+		tgt_grant_pool_flush(tgd, tgp);
+		cfs_percpt_unlock(tgd->tgd_pool_lock, idx);
 		spin_unlock(&tgd->tgd_grant_lock);
-		LBUG();
 	}
-	tgd->tgd_tot_pending -= pending;
-	spin_unlock(&tgd->tgd_grant_lock);
 	EXIT;
 }
 EXPORT_SYMBOL(tgt_grant_commit);
@@ -1593,7 +1932,7 @@ ssize_t tot_dirty_show(struct kobject *kobj, struct attribute *attr,
 	struct tg_grants_data *tgd;
 
 	tgd = &obd2obt(obd)->obt_lut->lut_tgd;
-	return scnprintf(buf, PAGE_SIZE, "%llu\n", tgd->tgd_tot_dirty);
+	return scnprintf(buf, PAGE_SIZE, "%llu\n", tgt_grant_tot_dirty(tgd));
 }
 EXPORT_SYMBOL(tot_dirty_show);
 
@@ -1613,9 +1952,17 @@ ssize_t tot_granted_show(struct kobject *kobj, struct attribute *attr,
 	struct obd_device *obd = container_of(kobj, struct obd_device,
 					      obd_kset.kobj);
 	struct tg_grants_data *tgd;
+	u64 granted;
 
 	tgd = &obd2obt(obd)->obt_lut->lut_tgd;
-	return scnprintf(buf, PAGE_SIZE, "%llu\n", tgd->tgd_tot_granted);
+	/* space booked by the grant pools isn't held by any client */
+	spin_lock(&tgd->tgd_grant_lock);
+	cfs_percpt_lock(tgd->tgd_pool_lock, CFS_PERCPT_LOCK_EX);
+	granted = tgd->tgd_tot_granted - tgt_grant_pools_booked(tgd);
+	cfs_percpt_unlock(tgd->tgd_pool_lock, CFS_PERCPT_LOCK_EX);
+	spin_unlock(&tgd->tgd_grant_lock);
+
+	return scnprintf(buf, PAGE_SIZE, "%llu\n", granted);
 }
 EXPORT_SYMBOL(tot_granted_show);
 
@@ -1637,7 +1984,7 @@ ssize_t tot_pending_show(struct kobject *kobj, struct attribute *attr,
 	struct tg_grants_data *tgd;
 
 	tgd = &obd2obt(obd)->obt_lut->lut_tgd;
-	return scnprintf(buf, PAGE_SIZE, "%llu\n", tgd->tgd_tot_pending);
+	return scnprintf(buf, PAGE_SIZE, "%llu\n", tgt_grant_tot_pending(tgd));
 }
 EXPORT_SYMBOL(tot_pending_show);
 
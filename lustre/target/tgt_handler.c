@@ -372,6 +372,100 @@ static int tgt_request_preprocess(struct tgt_session_info *tsi,
 	RETURN(rc);
 }
 
+/*
+ * Requests which make up the load of a target, as reported to the allocators
+ * in statfs through obd_statfs::os_load_*: bulk I/O on OSTs, namespace and
+ * attribute operations (including intent locks) on MDTs.
+ */
+static inline bool tgt_load_opc(struct lu_target *lut, __u32 opc)
+{
+	if (!lut->lut_is_mdt)
+		return opc == OST_WRITE || opc == OST_READ;
+
+	switch (opc) {
+	case MDS_GETATTR:
+	case MDS_GETATTR_NAME:
+	case MDS_CLOSE:
+	case MDS_REINT:
+	case MDS_READPAGE:
+	case MDS_GETXATTR:
+	case MDS_BATCH:
+	case LDLM_ENQUEUE:
+		return true;
+	default:
+		return false;
+	}
+}
+
+/*
+ * Fold the service time of \a req into the target load average.
+ *
+ * The time is measured from the request arrival, so it includes the time
+ * spent in the incoming queue waiting for a service thread. The average is
+ * an EWMA with a weight of 1/8 for the new sample, updated without locking
+ * as a lost update is harmless. The request is also counted for the request
+ * rate, which is recalculated once per second.
+ */
+static void tgt_load_update(struct lu_target *lut, struct ptlrpc_request *req)
+{
+	time64_t now = ktime_get_seconds();
+	s64 usec;
+	s64 avg;
+
+	if (now > READ_ONCE(lut->lut_load_start) &&
+	    spin_trylock(&lut->lut_load_lock)) {
+		if (now > lut->lut_load_start) {
+			lut->lut_load_rate =
+				atomic_xchg(&lut->lut_load_count, 0) /
+				(u32)(now - lut->lut_load_start);
+			lut->lut_load_start = now;
+		}
+		spin_unlock(&lut->lut_load_lock);
+	}
+	atomic_inc(&lut->lut_load_count);
+
+	usec = ktime_us_delta(ktime_get_real(),
+			      timespec64_to_ktime(req->rq_arrival_time));
+	if (usec < 0)
+		return;
+	usec = min_t(s64, usec, U32_MAX);
+
+	avg = READ_ONCE(lut->lut_load_usec);
+	avg += (usec - avg) / 8;
+	WRITE_ONCE(lut->lut_load_usec, avg);
+}
+
+/**
+ * Report the current target load in statfs data.
+ *
+ * The load is not part of the cached statfs data, it is always reported
+ * as of now.
+ *
+ * \param[in] lut	target
+ * \param[out] osfs	statfs data to fill
+ */
+void tgt_load_statfs(struct lu_target *lut, struct obd_statfs *osfs)
+{
+	time64_t now = ktime_get_seconds();
+	time64_t start;
+
+	osfs->os_load_usec = READ_ONCE(lut->lut_load_usec);
+	osfs->os_load_depth = atomic_read(&lut->lut_load_depth);
+
+	/* nothing recalculated the rate for a while, the target is idle */
+	spin_lock(&lut->lut_load_lock);
+	start = lut->lut_load_start;
+	if (now > start + 1)
+		osfs->os_load_rate = atomic_read(&lut->lut_load_count) /
+				     (u32)(now - start);
+	else
+		osfs->os_load_rate = lut->lut_load_rate;
+	spin_unlock(&lut->lut_load_lock);
+}
+EXPORT_SYMBOL(tgt_load_statfs);
+
+static void tgt_brw_async_put(struct tgt_session_info *tsi);
+
 /*
  * Invoke handler for this request opc. Also do necessary preprocessing
  * (according to handler ->th_flags), and post-processing (setting of
@@ -464,6 +558,9 @@ static int tgt_handle_request0(struct tgt_session_info *tsi,
 	}
 
 	if (likely(rc == 0)) {
+		bool load = tsi->tsi_tgt != NULL &&
+			    tgt_load_opc(tsi->tsi_tgt, opc);
+
 		/*
 		 * Process request, there can be two types of rc:
 		 * 1) errors with msg unpack/pack, other failures outside the
@@ -471,7 +568,13 @@ static int tgt_handle_request0(struct tgt_session_info *tsi,
 		 * 2) errors during fs operation, should be placed in rq_status
 		 * only
 		 */
+		if (load)
+			atomic_inc(&tsi->tsi_tgt->lut_load_depth);
 		rc = h->th_act(tsi);
+		if (load) {
+			atomic_dec(&tsi->tsi_tgt->lut_load_depth);
+			tgt_load_update(tsi->tsi_tgt, req);
+		}
 		if (!is_serious(rc) &&
 		    !req->rq_no_reply && req->rq_reply_state == NULL) {
 			DEBUG_REQ(D_ERROR, req,
@@ -496,6 +599,12 @@ static int tgt_handle_request0(struct tgt_session_info *tsi,
 
 	LASSERT(current->journal_info == NULL);
 
+	if (req->rq_reply_deferred) {
+		/* tgt_brw_write() replies once the data I/O completes */
+		tgt_brw_async_put(tsi);
+		RETURN(0);
+	}
+
 	if (likely(rc == 0 && req->rq_export))
 		target_committed_to_req(req);
 
@@ -525,8 +634,10 @@ static int tgt_filter_recovery_request(struct ptlrpc_request *req,
 	case LDLM_ENQUEUE:
 	case OST_CREATE:
 	case OST_DESTROY:
+	case OST_DESTROY_BATCH:
 	case OST_PUNCH:
 	case OST_SETATTR:
+	case OST_SETATTR_BATCH:
 	case OST_SYNC:
 	case OST_WRITE:
 	case MDS_HSM_PROGRESS:
@@ -2640,9 +2751,78 @@ static void tgt_warn_on_cksum(struct ptlrpc_request *req,
 			   client_cksum, server_cksum);
 }
 
+/*
+ * Reply to a BRW write once both tgt_brw_write() and its data I/O are
+ * done with it, see tgt_brw_async_cb_add().
+ */
+static void tgt_brw_async_put(struct tgt_session_info *tsi)
+{
+	struct tgt_brw_async *tba = &tsi->tsi_brw_async;
+	struct ptlrpc_request *req = tgt_ses_req(tsi);
+
+	if (!atomic_dec_and_test(&tba->tba_refs))
+		return;
+
+	if (lustre_handle_is_used(&tba->tba_lockh))
+		tgt_data_unlock(&tba->tba_lockh, LCK_PW);
+	if (req->rq_status == 0)
+		req->rq_status = tba->tba_rc;
+	if (req->rq_export != NULL)
+		target_committed_to_req(req);
+	target_send_reply(req, 0, tsi->tsi_reply_fail_id);
+	/* drops the session, and \a tsi with it, on the last reference */
+	ptlrpc_server_drop_request(req);
+}
+
+static void tgt_brw_async_io_done(struct lu_env *env, struct thandle *th,
+				  struct dt_txn_commit_cb *cb, int err)
+{
+	struct tgt_session_info *tsi;
+
+	tsi = container_of(cb, struct tgt_session_info, tsi_brw_async.tba_cb);
+	tsi->tsi_brw_async.tba_rc = err;
+	tgt_brw_async_put(tsi);
+}
+
+/**
+ * Let the BRW write in progress reply once its data I/O completes.
+ *
+ * Called by the target right before it stops the transaction writing the
+ * data, so that dt_trans_stop() does not wait for the I/O, see DCB_IO_DONE.
+ * Does nothing unless tgt_brw_write() enabled it for the current request.
+ * The callback goes to the first transaction only, if the write has to be
+ * retried the next transactions wait for their I/O as usual.
+ *
+ * \param[in] env	execution environment
+ * \param[in] th	transaction writing the data
+ */
+void tgt_brw_async_cb_add(const struct lu_env *env, struct thandle *th)
+{
+	struct tgt_brw_async *tba;
+	struct dt_txn_commit_cb *dcb;
+
+	if (env->le_ses == NULL)
+		return;
+
+	tba = &tgt_ses_info(env)->tsi_brw_async;
+	if (!tba->tba_enabled || tba->tba_armed)
+		return;
+
+	dcb = &tba->tba_cb;
+	dcb->dcb_func = tgt_brw_async_io_done;
+	dcb->dcb_flags = DCB_IO_DONE;
+	INIT_LIST_HEAD(&dcb->dcb_linkage);
+	strlcpy(dcb->dcb_name, "tgt_brw_async_io_done", sizeof(dcb->dcb_name));
+
+	if (dt_trans_cb_add(th, dcb) == 0)
+		tba->tba_armed = 1;
+}
+EXPORT_SYMBOL(tgt_brw_async_cb_add);
+
 int tgt_brw_write(struct tgt_session_info *tsi)
 {
 	struct ptlrpc_request	*req = tgt_ses_req(tsi);
+	struct tgt_brw_async	*tba = &tsi->tsi_brw_async;
 	struct ptlrpc_bulk_desc	*desc = NULL;
 	struct obd_export	*exp = req->rq_export;
 	struct niobuf_remote	*remote_nb;
@@ -2887,10 +3067,26 @@ out_commitrw:
 	/* multiple transactions can be assigned during write commit */
 	tsi->tsi_mult_trans = 1;
 
+	/* let the target reply once the data I/O completes rather than
+	 * wait for it, see tgt_brw_async_cb_add()
+	 */
+	if (tsi->tsi_tgt->lut_brw_async_commit && rc == 0) {
+		atomic_set(&tba->tba_refs, 2);
+		tba->tba_rc = 0;
+		tba->tba_enabled = 1;
+	}
+
 	/* Must commit after prep above in all cases */
 	rc = obd_commitrw(tsi->tsi_env, OBD_BRW_WRITE, exp, &repbody->oa,
 			  objcount, ioo, remote_nb, npages, local_nb, rc, nob,
 			  kstart);
+	tba->tba_enabled = 0;
+	/* the callback may have run already, then the I/O is done */
+	if (tba->tba_armed && atomic_read(&tba->tba_refs) == 1) {
+		tba->tba_armed = 0;
+		if (rc == 0)
+			rc = tba->tba_rc;
+	}
 	if (rc == -ENOTCONN)
 		/* quota acquire process has been given up because
 		 * either the client has been evicted or the client
@@ -2930,7 +3126,11 @@ out_commitrw:
 		ptlrpc_lprocfs_brw(req, nob);
 	}
 out_lock:
-	tgt_brw_unlock(exp, ioo, remote_nb, &lockh, LCK_PW);
+	/* the lock covers the data I/O until tgt_brw_async_put() */
+	if (tba->tba_armed)
+		tba->tba_lockh = lockh;
+	else
+		tgt_brw_unlock(exp, ioo, remote_nb, &lockh, LCK_PW);
 	if (desc)
 		ptlrpc_free_bulk(desc);
 out:
@@ -2946,6 +3146,16 @@ out:
 				      obd_export_nid2str(exp), rc);
 	}
 
+	if (tba->tba_armed) {
+		/* the data I/O is still in flight, tgt_handle_request0()
+		 * leaves the reply to tgt_brw_async_put()
+		 */
+		ptlrpc_request_addref(req);
+		spin_lock(&req->rq_lock);
+		req->rq_reply_deferred = 1;
+		spin_unlock(&req->rq_lock);
+	}
+
 	if (mpflags)
 		memalloc_noreclaim_restore(mpflags);
 
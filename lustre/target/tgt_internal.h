@@ -299,4 +299,27 @@ extern struct kmem_cache *tgt_fmd_kmem;
 void tgt_fmd_expire(struct obd_export *exp);
 void tgt_fmd_cleanup(struct obd_export *exp);
 
+/* Grant pool.
+ * Exports are hashed to one pool whose lock protects their ted_grant,
+ * ted_pending and ted_dirty counters, so that most bulk I/Os update grant
+ * accounting without taking the target-wide tgd_grant_lock. Space handed out
+ * by a pool comes from a reservoir which is booked in tgd_tot_granted by
+ * batches, and space given back by exports is unbooked by batches too. */
+struct tgt_grant_pool {
+	/* grant used by I/Os in progress for the exports of this pool */
+	u64		tgp_pending;
+	/* dirty data reported by the exports of this pool */
+	u64		tgp_dirty;
+	/* space booked in tgd_tot_granted not handed out to any export */
+	u64		tgp_avail;
+	/* space released by exports still booked in tgd_tot_granted */
+	u64		tgp_returned;
+	/* size of the reservoir to keep after a refill */
+	u64		tgp_batch;
+};
+
+/* tgt_grant.c */
+int tgt_grant_pools_init(struct tg_grants_data *tgd);
+void tgt_grant_pools_fini(struct tg_grants_data *tgd);
+
 #endif /* _TG_INTERNAL_H */
@@ -238,6 +238,64 @@ static ssize_t tgt_fmd_seconds_store(struct kobject *kobj,
 }
 LUSTRE_RW_ATTR(tgt_fmd_seconds);
 
+/**
+ * Show whether BRW writes are replied to from the I/O completion.
+ *
+ * \param[in] kobj	kobject
+ * \param[in] attr	attribute to show
+ * \param[in] buf	buffer for data
+ *
+ * \retval		number of characters printed
+ */
+static ssize_t brw_async_commit_show(struct kobject *kobj,
+				     struct attribute *attr, char *buf)
+{
+	struct obd_device *obd = container_of(kobj, struct obd_device,
+					      obd_kset.kobj);
+	struct lu_target *lut = obd2obt(obd)->obt_lut;
+
+	return sprintf(buf, "%u\n", lut->lut_brw_async_commit);
+}
+
+/**
+ * Enable or disable replying to BRW writes from the I/O completion.
+ *
+ * When enabled, the service thread does not wait for the data of a write
+ * to reach the disk. It stops the transaction and moves on to the next
+ * request, the reply is sent once the data I/O completes. The reply still
+ * follows the I/O, so a write is as durable as before when the client
+ * sees it done. Backends without background I/O completion ignore it.
+ *
+ * \param[in] kobj	kobject
+ * \param[in] attr	attribute to store
+ * \param[in] buffer	string which represents boolean value
+ * \param[in] count	\a buffer size
+ *
+ * \retval		\a count on success
+ * \retval		negative number on error
+ */
+static ssize_t brw_async_commit_store(struct kobject *kobj,
+				      struct attribute *attr,
+				      const char *buffer, size_t count)
+{
+	struct obd_device *obd = container_of(kobj, struct obd_device,
+					      obd_kset.kobj);
+	struct lu_target *lut = obd2obt(obd)->obt_lut;
+	bool val;
+	int rc;
+
+	rc = kstrtobool(buffer, &val);
+	if (rc)
+		return rc;
+
+	spin_lock(&lut->lut_flags_lock);
+	lut->lut_brw_async_commit = val;
+	spin_unlock(&lut->lut_flags_lock);
+
+	return count;
+}
+LUSTRE_RW_ATTR(brw_async_commit);
+
 /* These two aliases are old names and kept for compatibility, they were
  * changed to 'tgt_fmd_count' and 'tgt_fmd_seconds'.
  * This change was made in Lustre 2.13, so these aliases can be removed
@@ -252,6 +310,7 @@ static const struct attribute *tgt_attrs[] = {
 	&lustre_attr_sync_lock_cancel.attr,
 	&lustre_attr_tgt_fmd_count.attr,
 	&lustre_attr_tgt_fmd_seconds.attr,
+	&lustre_attr_brw_async_commit.attr,
 	&tgt_fmd_count_compat.attr,
 	&tgt_fmd_seconds_compat.attr,
 	NULL,
@@ -533,10 +592,11 @@ int tgt_init(const struct lu_env *env, struct lu_target *lut,
 
 	/* grant data */
 	spin_lock_init(&tgd->tgd_grant_lock);
-	tgd->tgd_tot_dirty = 0;
 	tgd->tgd_tot_granted = 0;
-	tgd->tgd_tot_pending = 0;
 	tgd->tgd_grant_compat_disable = 0;
+	rc = tgt_grant_pools_init(tgd);
+	if (rc != 0)
+		GOTO(out_put, rc);
 
 	/* populate cached statfs data */
 	osfs = &tgt_th_info(env)->tti_u.osfs;
@@ -558,7 +618,7 @@ int tgt_init(const struct lu_env *env, struct lu_target *lut,
 
 	OBD_ALLOC(lut->lut_client_bitmap, LR_MAX_CLIENTS >> 3);
 	if (lut->lut_client_bitmap == NULL)
-		RETURN(-ENOMEM);
+		GOTO(out_put, rc = -ENOMEM);
 
 	memset(&attr, 0, sizeof(attr));
 	attr.la_valid = LA_MODE;
@@ -594,9 +654,17 @@ int tgt_init(const struct lu_env *env, struct lu_target *lut,
 	lut->lut_fmd_max_age = LUT_FMD_MAX_AGE_DEFAULT;
 
 	atomic_set(&lut->lut_sync_count, 0);
-
+	atomic_set(&lut->lut_load_depth, 0);
+	lut->lut_load_usec = 0;
+	spin_lock_init(&lut->lut_load_lock);
+	lut->lut_load_start = ktime_get_seconds();
+	atomic_set(&lut->lut_load_count, 0);
+	lut->lut_load_rate = 0;
+
+	lut->lut_is_mdt = strncmp(obd->obd_type->typ_name,
+				  LUSTRE_MDT_NAME, 3) == 0;
 	/* reply_data is supported by MDT targets only for now */
-	if (strncmp(obd->obd_type->typ_name, LUSTRE_MDT_NAME, 3) != 0)
+	if (!lut->lut_is_mdt)
 		RETURN(0);
 
 	OBD_ALLOC(lut->lut_reply_bitmap,
@@ -638,6 +706,7 @@ out_put:
 	if (lut->lut_client_bitmap != NULL)
 		OBD_FREE(lut->lut_client_bitmap, LR_MAX_CLIENTS >> 3);
 	lut->lut_client_bitmap = NULL;
+	tgt_grant_pools_fini(&lut->lut_tgd);
 	if (lut->lut_reply_data != NULL)
 		dt_object_put(env, lut->lut_reply_data);
 	lut->lut_reply_data = NULL;
@@ -701,6 +770,7 @@ void tgt_fini(const struct lu_env *env, struct lu_target *lut)
 		dt_object_put(env, lut->lut_last_rcvd);
 		lut->lut_last_rcvd = NULL;
 	}
+	tgt_grant_pools_fini(&lut->lut_tgd);
 	EXIT;
 }
 EXPORT_SYMBOL(tgt_fini);
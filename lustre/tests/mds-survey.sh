@@ -124,6 +124,30 @@ test_2() {
 }
 run_test 2 "Metadata survey with stripe_count = 1"
 
+test_3() {
+	local mdscount=$(get_node_count "$(mdts_nodes)")
+	local param="osp.*.precreate_stats"
+	local stalls
+
+	[ $mdscount -gt 1 ] && skip_env "Only run this test on single MDS"
+	[ $ost_count -eq 0 ] && skip_env "Need to mount OST to test"
+	do_facet mds1 $LCTL get_param -n $param > /dev/null 2>&1 ||
+		skip "MDS does not have precreate_stats"
+
+	do_facet mds1 $LCTL set_param -n $param=clear
+	mds_survey_run "mdd" "1"
+	do_facet mds1 $LCTL get_param $param
+
+	stalls=$(do_facet mds1 $LCTL get_param -n $param |
+		 awk '/^[0-9]+:/ { sum += $2 } END { print sum + 0 }')
+	echo "$stalls creates waited for precreated objects"
+	# each thread count creates $file_count files, a few of them may
+	# wait while the create rate is learnt at the start of a run
+	(( stalls * 20 <= file_count )) ||
+		error "$stalls precreate stalls for $file_count creates"
+}
+run_test 3 "Measure precreate stalls with stripe_count = 1"
+
 # remount the clients
 restore_mount $MOUNT
 
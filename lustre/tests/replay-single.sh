@@ -5066,6 +5066,52 @@ test_136() {
 }
 run_test 136 "MDS to disconnect all OSPs first, then cleanup ldlm"
 
+test_137() {
+	local threads=$(do_facet mds1 $LCTL get_param -n \
+			mdd.$FSNAME-MDT0000.orphan_cleanup_threads 2>/dev/null)
+	local nr=500
+	local destroyed
+	local pid
+
+	[[ -n "$threads" ]] || skip "no orphan_cleanup_threads"
+
+	stack_trap "do_facet mds1 $LCTL set_param \
+		    mdd.$FSNAME-MDT0000.orphan_cleanup_threads=$threads"
+	do_facet mds1 $LCTL set_param mdd.$FSNAME-MDT0000.orphan_cleanup_threads=8
+
+	mkdir_on_mdt0 $DIR/$tdir || error "mkdir $tdir failed"
+	createmany -o $DIR/$tdir/f $nr || error "createmany failed"
+	# hold all files open, and unlink them to make orphans
+	(
+		for ((i = 0; i < nr; i++)); do
+			exec {fd}<$DIR/$tdir/f$i
+		done
+		unlinkmany $DIR/$tdir/f $nr
+		touch $DIR/$tdir/unlinked
+		sleep 3600
+	) &
+	pid=$!
+	stack_trap "kill $pid 2>/dev/null"
+	wait_update $HOSTNAME "ls $DIR/$tdir" "unlinked" 60 ||
+		error "orphans not created"
+
+	replay_barrier mds1
+	fail_abort mds1
+	kill $pid 2>/dev/null
+	wait $pid
+
+	wait_update_facet mds1 "$LCTL get_param -n \
+		mdd.$FSNAME-MDT0000.orphan_stats | awk '/^status:/ {print \\\$2}'" \
+		"completed" 60 || error "orphan cleanup not completed"
+	do_facet mds1 $LCTL get_param mdd.$FSNAME-MDT0000.orphan_stats
+	destroyed=$(do_facet mds1 $LCTL get_param -n \
+		    mdd.$FSNAME-MDT0000.orphan_stats |
+		    awk '/^destroyed:/ {print $2}')
+	(( destroyed >= nr )) ||
+		error "only $destroyed of $nr orphans destroyed"
+}
+run_test 137 "orphans are destroyed by parallel cleanup threads"
+
 test_200() {
 	[[ -z $RCLIENTS ]] && skip "Need remote client"
 
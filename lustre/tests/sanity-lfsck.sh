@@ -6260,6 +6260,108 @@ test_42() {
 }
 run_test 42 "LFSCK can repair inconsistent MDT-object/OST-object encryption flags"
 
+test_43() {
+	local saved=$(do_facet mds1 $LCTL get_param -n \
+		      mdd.${MDT_DEV}.lfsck_assistant_threads)
+
+	[[ -n "$saved" ]] || skip "MDS does not support lfsck_assistant_threads"
+
+	echo "#####"
+	echo "The layout LFSCK assistant handles the OST-objects of different"
+	echo "MDT-objects with multiple threads, and still repairs all of the"
+	echo "unmatched pairs."
+	echo "#####"
+
+	check_mount_and_prep
+	$LFS setstripe -c 1 -i 0 $DIR/$tdir
+
+	echo "Inject failure stub to make the OST-object to back point to"
+	echo "non-exist MDT-object."
+	#define OBD_FAIL_LFSCK_UNMATCHED_PAIR1	0x1611
+	do_nodes $(comma_list $(osts_nodes)) $LCTL set_param fail_loc=0x1611
+	for i in {1..32}; do
+		dd if=/dev/zero of=$DIR/$tdir/f$i bs=4K count=1 ||
+			error "(0) Fail to write $DIR/$tdir/f$i"
+	done
+	cancel_lru_locks osc
+	do_nodes $(comma_list $(osts_nodes)) $LCTL set_param fail_loc=0
+
+	do_facet mds1 $LCTL set_param mdd.${MDT_DEV}.lfsck_assistant_threads=4
+	stack_trap "do_facet mds1 $LCTL set_param \
+		mdd.${MDT_DEV}.lfsck_assistant_threads=$saved" EXIT
+
+	echo "Trigger layout LFSCK to find out unmatched pairs and fix them"
+	$START_LAYOUT -r || error "(1) Fail to start LFSCK for layout!"
+
+	wait_update_facet $SINGLEMDS "$LCTL get_param -n \
+		mdd.${MDT_DEV}.lfsck_layout |
+		awk '/^status/ { print \\\$2 }'" "completed" 32 || {
+		$SHOW_LAYOUT
+		error "(2) unexpected status"
+	}
+
+	local repaired=$($SHOW_LAYOUT |
+			 awk '/^repaired_unmatched_pair/ { print $2 }')
+	[ $repaired -ge 32 ] ||
+		error "(3) Fail to repair unmatched pair: $repaired"
+}
+run_test 43 "layout LFSCK assistant handles requests with multiple threads"
+
+test_44() {
+	local saved=$(do_facet mds1 $LCTL get_param -n \
+		      mdd.${MDT_DEV}.lfsck_assistant_threads)
+
+	[[ -n "$saved" ]] || skip "MDS does not support lfsck_assistant_threads"
+
+	echo "#####"
+	echo "The namespace LFSCK assistant checks the name entries of"
+	echo "different directories with multiple threads, and still repairs"
+	echo "all of the crashed linkEA entries."
+	echo "#####"
+
+	check_mount_and_prep
+	for d in {1..4}; do
+		mkdir $DIR/$tdir/d$d || error "(0) Fail to mkdir d$d"
+		createmany -o $DIR/$tdir/d$d/g 16 > /dev/null ||
+			error "(1) Fail to create good files under d$d"
+	done
+
+	#define OBD_FAIL_LFSCK_LINKEA_CRASH	0x1603
+	do_facet $SINGLEMDS $LCTL set_param fail_loc=0x1603
+	for d in {1..4}; do
+		createmany -o $DIR/$tdir/d$d/b 8 > /dev/null ||
+			error "(2) Fail to create bad files under d$d"
+	done
+	do_facet $SINGLEMDS $LCTL set_param fail_loc=0
+
+	do_facet mds1 $LCTL set_param mdd.${MDT_DEV}.lfsck_assistant_threads=4
+	stack_trap "do_facet mds1 $LCTL set_param \
+		mdd.${MDT_DEV}.lfsck_assistant_threads=$saved" EXIT
+
+	echo "Trigger namespace LFSCK to repair the crashed linkEA entries"
+	$START_NAMESPACE -r || error "(3) Fail to start LFSCK for namespace!"
+
+	wait_update_facet $SINGLEMDS "$LCTL get_param -n \
+		mdd.${MDT_DEV}.lfsck_namespace |
+		awk '/^status/ { print \\\$2 }'" "completed" 32 || {
+		$SHOW_NAMESPACE
+		error "(4) unexpected status"
+	}
+
+	local repaired=$($SHOW_NAMESPACE |
+			 awk '/^linkea_repaired/ { print $2 }')
+	[ $repaired -eq 32 ] ||
+		error "(5) Fail to repair crashed linkEA: $repaired"
+
+	for d in {1..4}; do
+		local fid=$($LFS path2fid $DIR/$tdir/d$d/b0)
+
+		[ "$($LFS fid2path $DIR $fid)" == "$DIR/$tdir/d$d/b0" ] ||
+			error "(6) Fail to repair linkEA of $DIR/$tdir/d$d/b0"
+	done
+}
+run_test 44 "namespace LFSCK assistant checks entries with multiple threads"
+
 # restore MDS/OST size
 MDSSIZE=${SAVED_MDSSIZE}
 OSTSIZE=${SAVED_OSTSIZE}
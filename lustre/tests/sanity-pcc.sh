@@ -1491,6 +1491,109 @@ test_20() {
 }
 run_test 20 "Auto attach works after the inode was once evicted from cache"
 
+test_21() {
+	local loopfile="$TMP/$tfile"
+	local mntpt="/mnt/pcc.$tdir"
+	local hsm_root="$mntpt/$tdir"
+	local file=$DIR/$tfile
+	local heat_sav
+	local i
+
+	heat_sav=$(do_facet $SINGLEAGT $LCTL get_param -n llite.*.file_heat |
+		   head -n1)
+	[ -n "$heat_sav" ] || skip "no file heat support"
+	do_facet $SINGLEAGT $LCTL set_param -n llite.*.file_heat=1
+	stack_trap "do_facet $SINGLEAGT $LCTL set_param -n \
+		llite.*.file_heat=$heat_sav" EXIT
+
+	setup_loopdev $SINGLEAGT $loopfile $mntpt 50
+	copytool setup -m "$MOUNT" -a "$HSM_ARCHIVE_NUMBER"
+	setup_pcc_mapping $SINGLEAGT \
+		"projid={100}\ rwid=$HSM_ARCHIVE_NUMBER\ auto_attach=0\ tier=1\ heat_thresh=1"
+	do_facet $SINGLEAGT $LCTL pcc list $MOUNT
+	do_facet $SINGLEAGT $LCTL pcc list $MOUNT | grep -q "tier: 1" ||
+		error "tier of the PCC dataset not shown"
+
+	# RW-PCC promotion must be enabled explicitly with rw_promote
+	do_facet $SINGLEAGT dd if=/dev/zero of=$file bs=1M count=1 ||
+		error "dd write $file failed"
+	do_facet $SINGLEAGT dd if=$file of=/dev/null bs=1M ||
+		error "dd read $file failed"
+	sleep 5
+	check_lpcc_state $file "none"
+
+	do_facet $SINGLEAGT $LCTL pcc clear $MOUNT ||
+		error "failed to clear the PCC datasets"
+	setup_pcc_mapping $SINGLEAGT \
+		"projid={100}\ rwid=$HSM_ARCHIVE_NUMBER\ auto_attach=0\ tier=1\ heat_thresh=1\ rw_promote=1"
+
+	# only read heat counts, a written only file is not promoted
+	do_facet $SINGLEAGT dd if=/dev/zero of=$file.w bs=1M count=1 ||
+		error "dd write $file.w failed"
+	sleep 5
+	check_lpcc_state $file.w "none"
+
+	do_facet $SINGLEAGT dd if=$file of=/dev/null bs=1M ||
+		error "dd read $file failed"
+	# promotion is done in background after the last close
+	for ((i = 0; i < 30; i++)); do
+		do_facet $SINGLEAGT $LFS pcc state $file |
+			grep -q "type: readwrite" && break
+		sleep 1
+	done
+	check_lpcc_state $file "readwrite"
+	do_facet $SINGLEAGT $LCTL pcc list $MOUNT | grep -q "promote: 1" ||
+		error "promotion not accounted"
+	do_facet $SINGLEAGT $LFS pcc detach $file ||
+		error "failed to detach $file"
+}
+run_test 21 "Promote hot files into PCC by file heat"
+
+test_22() {
+	local loopfile="$TMP/$tfile"
+	local mntpt="/mnt/pcc.$tdir"
+	local hsm_root="$mntpt/$tdir"
+	local file=$DIR/$tfile
+	local threads_sav
+	local sum1
+	local sum2
+
+	threads_sav=$(do_facet $SINGLEAGT $LCTL get_param -n \
+		      llite.*.pcc_copy_threads | head -n1)
+	[ -n "$threads_sav" ] || skip "no parallel PCC attach support"
+	do_facet $SINGLEAGT $LCTL set_param llite.*.pcc_copy_threads=4
+	stack_trap "do_facet $SINGLEAGT $LCTL set_param \
+		llite.*.pcc_copy_threads=$threads_sav" EXIT
+
+	setup_loopdev $SINGLEAGT $loopfile $mntpt 200
+	copytool setup -m "$MOUNT" -a "$HSM_ARCHIVE_NUMBER"
+	setup_pcc_mapping $SINGLEAGT \
+		"projid={100}\ rwid=$HSM_ARCHIVE_NUMBER\ auto_attach=0"
+
+	# not a multiple of the copy chunk size to check the last chunk
+	do_facet $SINGLEAGT dd if=/dev/urandom of=$file bs=1M count=100 \
+		seek=1 conv=notrunc || error "dd write $file failed"
+	do_facet $SINGLEAGT "echo -n tail >> $file" ||
+		error "append $file failed"
+	sum1=$(do_facet $SINGLEAGT md5sum $file | awk '{ print $1 }')
+
+	do_facet $SINGLEAGT $LFS pcc attach -i $HSM_ARCHIVE_NUMBER $file ||
+		error "failed to attach $file"
+	check_lpcc_state $file "readwrite"
+	check_lpcc_sizes $SINGLEAGT $file \
+		$(lpcc_fid2path $hsm_root $file) $((101 * 1048576 + 4))
+	sum2=$(do_facet $SINGLEAGT md5sum $file | awk '{ print $1 }')
+	[ "$sum1" == "$sum2" ] ||
+		error "data mismatch after attach: $sum1 != $sum2"
+
+	do_facet $SINGLEAGT $LFS pcc detach $file ||
+		error "failed to detach $file"
+	sum2=$(do_facet $SINGLEAGT md5sum $file | awk '{ print $1 }')
+	[ "$sum1" == "$sum2" ] ||
+		error "data mismatch after detach: $sum1 != $sum2"
+}
+run_test 22 "Attach a large file into PCC with parallel copy"
+
 #test 101: containers and PCC
 #LU-15170: Test mount namespaces with PCC
 #This tests the cases where the PCC mount is not present in the container by
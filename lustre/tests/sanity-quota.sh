@@ -6181,6 +6181,118 @@ test_86()
 }
 run_test 86 "Pre-acquired quota should be released if quota is over limit"
 
+test_87()
+{
+	local procf=osd-$ost1_FSTYPE.$FSNAME-OST0000.quota_slave.dqacq_batch
+	local stats="mds.MDS.mdt_readpage.stats"
+	local nr=16
+	local first=60100
+	local id
+	local batched
+
+	setup_quota_test || error "setup quota failed with $?"
+	set_ost_qtype $QTYPE || error "enable ost quota failed"
+
+	do_facet ost1 $LCTL get_param $procf || skip "no dqacq_batch support"
+	local old=$(do_facet ost1 $LCTL get_param -n $procf)
+	stack_trap "do_facet ost1 $LCTL set_param $procf=$old"
+	do_facet ost1 $LCTL set_param $procf=32
+
+	$LFS setstripe -c 1 -i 0 $DIR/$tdir || error "setstripe $tdir failed"
+	chmod 777 $DIR/$tdir
+	for ((id = first; id < first + nr; id++)); do
+		$LFS setquota -u $id -b 0 -B 100M -i 0 -I 0 $DIR ||
+			error "set quota for $id failed"
+		stack_trap "$LFS setquota -u $id -b 0 -B 0 -i 0 -I 0 $DIR"
+		runas -u $id -g $id $DD of=$DIR/$tdir/$tfile-$id count=4 ||
+			error "write as $id failed"
+	done
+
+	do_facet mds1 $LCTL set_param $stats=clear
+	# releasing the space of all IDs at once lets the writeback thread
+	# of the OST pack the adjustments in batched requests
+	rm -f $DIR/$tdir/$tfile-*
+	wait_delete_completed
+
+	wait_update_facet_cond mds1 "$LCTL get_param -n $stats |
+		awk '/quota_acquire_batch/ { n = \$2 } END { print n + 0 }'" \
+		"-gt" 0 60 || error "no batched quota request sent"
+	batched=$(do_facet mds1 $LCTL get_param -n $stats |
+		awk '/quota_acquire_batch/ { print $2 }')
+	echo "batched quota requests: $batched"
+
+	for ((id = first; id < first + nr; id++)); do
+		(( $(getquota -u $id global curspace) == 0 )) ||
+			quota_error u $id "space not released"
+	done
+}
+run_test 87 "quota adjustments of several IDs are sent in one batch"
+
+test_88()
+{
+	local qmt_param="qmt.$FSNAME-QMT0000"
+	local nr=200
+	local first=60200
+	local last=$((first + nr - 1))
+	local queued
+	local rounds
+	local value
+	local pids
+	local pid
+	local id
+	local i
+
+	do_facet mds1 $LCTL get_param $qmt_param.glimpse_stats ||
+		skip "no glimpse batching support"
+
+	setup_quota_test || error "setup quota failed with $?"
+	set_mdt_qtype $QTYPE || error "enable mdt quota failed"
+
+	local old_batch=$(do_facet mds1 $LCTL get_param -n \
+			  $qmt_param.glimpse_batch)
+	stack_trap "do_facet mds1 $LCTL set_param \
+		    $qmt_param.glimpse_batch=$old_batch"
+	do_facet mds1 $LCTL set_param $qmt_param.glimpse_batch=64
+
+	queued=$(do_facet mds1 $LCTL get_param -n $qmt_param.glimpse_stats |
+		 awk '/queued:/ { print $2 }')
+	rounds=$(do_facet mds1 $LCTL get_param -n $qmt_param.glimpse_stats |
+		 awk '/rounds:/ { print $2 }')
+
+	# concurrent setquota calls share rounds of glimpses
+	for ((i = 0; i < 4; i++)); do
+		for ((id = first + i; id <= last; id += 4)); do
+			$LFS setquota -u $id -i 0 -I $((id - first + 1000)) \
+				$DIR || return 1
+		done &
+		pids+=" $!"
+	done
+	for pid in $pids; do
+		wait $pid || error "set quota failed"
+	done
+	stack_trap "for ((i = $first; i <= $last; i++)); do
+		$LFS setquota -u \$i -i 0 -I 0 $DIR; done"
+
+	# setquota returns once the slaves got the new limits
+	for id in $first $last; do
+		value=$(get_quota_on_qsd mds1 MDT0000 usr $id hardlimit)
+		[[ $value == $((id - first + 1000)) ]] ||
+			error "limit of $id not glimpsed, got $value"
+	done
+
+	do_facet mds1 $LCTL get_param $qmt_param.glimpse_stats
+	queued=$(( $(do_facet mds1 $LCTL get_param -n \
+		     $qmt_param.glimpse_stats |
+		     awk '/queued:/ { print $2 }') - queued ))
+	rounds=$(( $(do_facet mds1 $LCTL get_param -n \
+		     $qmt_param.glimpse_stats |
+		     awk '/rounds:/ { print $2 }') - rounds ))
+	echo "$queued setting changes glimpsed in $rounds rounds"
+	(( queued >= nr )) || error "only $queued changes queued, expect $nr"
+	(( rounds <= queued )) || error "$rounds rounds for $queued changes"
+}
+run_test 88 "quota setting changes are glimpsed to slaves in batches"
+
 quota_fini()
 {
 	do_nodes $(comma_list $(nodes_list)) \
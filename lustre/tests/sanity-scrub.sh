@@ -1483,6 +1483,35 @@ test_21() {
 }
 run_test 21 "don't hang MDS recovery when failed to get update log"
 
+test_22() {
+	[ "$mds1_FSTYPE" != "ldiskfs" ] && skip_env "ldiskfs only test"
+
+	formatall > /dev/null
+	setupall > /dev/null
+
+	scrub_prep 100 1
+	echo "starting MDTs with OI scrub disabled"
+	scrub_start_mds 2 "$MOUNT_OPTS_NOSCRUB"
+	scrub_check_status 3 init
+	scrub_check_flags 4 recreated,inconsistent
+
+	do_nodes $(comma_list $(mdts_nodes)) $LCTL set_param -n \
+		osd-ldiskfs.*.scrub_threads=4
+	stack_trap "do_nodes $(comma_list $(mdts_nodes)) $LCTL set_param -n \
+		osd-ldiskfs.*.scrub_threads=1" EXIT
+
+	scrub_start 5
+	scrub_check_status 6 completed
+	scrub_check_flags 7 ""
+	scrub_check_repaired 8 100 0
+
+	# the inode table is fine now, nothing to repair
+	scrub_start 9
+	scrub_check_status 10 completed
+	scrub_check_repaired 11 0 0
+}
+run_test 22 "OI scrub scans the inode table with multiple threads"
+
 
 # restore MDS/OST size
 MDSSIZE=${SAVED_MDSSIZE}
@@ -1506,6 +1506,37 @@ test_24H() {
 }
 run_test 24H "repeat FLD_QUERY rpc"
 
+test_24I() {
+	local nrfiles=20000
+	local nproc=8
+	local single
+	local parallel
+	local i
+
+	test_mkdir -c 1 $DIR/$tdir
+	stack_trap "simple_cleanup_common $nrfiles"
+	createmany -m $DIR/$tdir/$tfile $nrfiles > /dev/null ||
+		error "create $nrfiles files failed"
+
+	cancel_lru_locks mdc
+	lctl set_param -n mdc.*.stats clear
+	ls $DIR/$tdir > /dev/null || error "ls $tdir failed"
+	single=$(calc_stats mdc.*.stats mds_readpage)
+
+	cancel_lru_locks mdc
+	lctl set_param -n mdc.*.stats clear
+	for ((i = 0; i < nproc; i++)); do
+		ls $DIR/$tdir > /dev/null &
+	done
+	wait
+	parallel=$(calc_stats mdc.*.stats mds_readpage)
+
+	echo "readpage RPCs: $single by one ls, $parallel by $nproc ls"
+	(( parallel <= single * 2 )) ||
+		error "$nproc ls sent $parallel readpage RPCs, one sent $single"
+}
+run_test 24I "parallel readdir shares the dir page cache"
+
 test_25a() {
 	echo '== symlink sanity ============================================='
 
@@ -9918,6 +9949,52 @@ test_64i() {
 }
 run_test 64i "shrink on reconnect"
 
+test_64j() {
+	[ $PARALLEL == "yes" ] && skip "skip parallel run"
+	remote_ost_nodsh && skip "remote OSTs with nodsh"
+
+	local avail=$($LCTL get_param -n osc.*OST0000-osc-[^mM]*.kbytesavail)
+	local p="$TMP/$TESTSUITE-$TESTNAME.parameters"
+
+	# the OST is filled up to drain the grant pools
+	(( avail < 2 * 1024 * 1024 )) ||
+		skip "need less than 2GiB on ost1, have $((avail / 1024))MiB"
+
+	save_lustre_params ost1 "obdfilter.*OST0000*.grant_check_threshold" > $p
+	stack_trap "restore_lustre_params < $p; rm -f $p" EXIT
+	# verify the grant accounting on every statfs and disconnect
+	do_facet ost1 $LCTL set_param obdfilter.*OST0000*.grant_check_threshold=0
+
+	$LFS setstripe -c 1 -i 0 $DIR/$tfile
+	stack_trap "rm -f $DIR/$tfile"
+
+	# fill the reservoir of the pool this client is hashed to
+	dd if=/dev/zero of=$DIR/$tfile bs=1M count=16 ||
+		error "dd $tfile failed"
+	# then run ost1 out of space, which drains the reservoir
+	dd if=/dev/zero of=$DIR/$tfile bs=1M oflag=append conv=notrunc \
+		2>/dev/null
+	sync
+	$LFS df $DIR
+
+	rm -f $DIR/$tfile
+	wait_delete_completed
+	$LFS setstripe -c 1 -i 0 $DIR/$tfile
+	dd if=/dev/zero of=$DIR/$tfile bs=1M count=16 ||
+		error "dd $tfile after drain failed"
+	sync
+
+	# tgt_grant_sanity_check() runs on disconnect
+	remount_client $MOUNT || error "remount $MOUNT failed"
+
+	local testid=$(echo $TESTNAME | tr '_' ' ')
+
+	do_facet ost1 dmesg | tac | sed "/$testid/,$ d" |
+		grep -E "tot_(granted|pending|dirty) [0-9]+ (!=|>)" &&
+		error "grant accounting mismatch over the grant pools" || true
+}
+run_test 64j "grant accounting after draining a grant pool"
+
 # bug 1414 - set/get directories' stripe info
 test_65a() {
 	[ $PARALLEL == "yes" ] && skip "skip parallel run"
@@ -13121,6 +13198,105 @@ test_116b() { # LU-2093
 }
 run_test 116b "QoS shouldn't LBUG if not enough OSTs found on the 2nd pass"
 
+test_116c() {
+	[[ $OSTCOUNT -lt 2 ]] && skip_env "needs >= 2 OSTs"
+	remote_mds_nodsh && skip "remote MDS with nodsh"
+
+	local mdts=$(comma_list $(mdts_nodes))
+	local nfiles=${QOS_CREATE_FILES:-2000}
+	local qos_old=$(do_facet mds1 \
+		"$LCTL get_param -n lod.$FSNAME-*.qos_threshold_rr" | head -n 1)
+	local rr_rate
+	local qos_rate
+	local start
+	local elapsed
+	local f
+
+	[ -z "$qos_old" ] && skip "no QOS"
+	stack_trap "do_nodes $mdts \
+		'$LCTL set_param lod.$FSNAME-*.qos_threshold_rr=${qos_old%%%}'"
+
+	test_mkdir $DIR/$tdir
+	$LFS setstripe -c -1 $DIR/$tdir || error "setstripe failed"
+
+	# create rate with round-robin allocation, for reference
+	do_nodes $mdts "$LCTL set_param lod.$FSNAME-*.qos_threshold_rr=100"
+	start=$(date +%s.%N)
+	createmany -o $DIR/$tdir/rr- $nfiles || error "create rr failed"
+	elapsed=$(echo "$(date +%s.%N) - $start" | bc)
+	rr_rate=$(echo "$nfiles / $elapsed" | bc)
+	unlinkmany $DIR/$tdir/rr- $nfiles || error "unlink rr failed"
+	wait_delete_completed
+
+	# same with weighted allocation forced for every file
+	do_nodes $mdts "$LCTL set_param lod.$FSNAME-*.qos_threshold_rr=0"
+	sleep_maxage
+	start=$(date +%s.%N)
+	createmany -o $DIR/$tdir/qos- $nfiles || error "create qos failed"
+	elapsed=$(echo "$(date +%s.%N) - $start" | bc)
+	qos_rate=$(echo "$nfiles / $elapsed" | bc)
+	echo "create rate, $OSTCOUNT stripes: rr $rr_rate/s, qos $qos_rate/s"
+
+	# weighted selection must still produce a full, duplicate-free layout
+	for f in $DIR/$tdir/qos-{0..9}; do
+		local osts=$($LFS getstripe -y $f |
+			     awk '/l_ost_idx:/ { print $NF }')
+
+		(( $(echo "$osts" | wc -l) == OSTCOUNT )) ||
+			error "$f: stripe count $(echo $osts | wc -w)"
+		(( $(echo "$osts" | sort -u | wc -l) == OSTCOUNT )) ||
+			error "$f: OST used twice: $osts"
+	done
+	unlinkmany $DIR/$tdir/qos- $nfiles || error "unlink qos failed"
+}
+run_test 116c "QoS create rate with wide striping"
+
+test_116d() {
+	[[ $OSTCOUNT -lt 2 ]] && skip_env "needs >= 2 OSTs"
+	remote_mds_nodsh && skip "remote MDS with nodsh"
+	[[ "$ost1_HOST" != "$ost2_HOST" ]] ||
+		skip "needs OST0000 and OST0001 on different OSS"
+
+	local mdts=$(comma_list $(mdts_nodes))
+	local nfiles=200
+	local prio_old=$(do_facet mds1 \
+		"$LCTL get_param -n lod.$FSNAME-MDT0000*.qos_prio_load")
+	local qos_old=$(do_facet mds1 \
+		"$LCTL get_param -n lod.$FSNAME-MDT0000*.qos_threshold_rr")
+	local pid
+	local cnt0
+
+	[ -z "$prio_old" ] && skip "no qos_prio_load"
+	stack_trap "do_nodes $mdts '$LCTL set_param \
+		lod.$FSNAME-*.qos_prio_load=${prio_old%%%} \
+		lod.$FSNAME-*.qos_threshold_rr=${qos_old%%%}'"
+	do_nodes $mdts "$LCTL set_param lod.$FSNAME-*.qos_prio_load=100 \
+		lod.$FSNAME-*.qos_threshold_rr=0"
+
+	test_mkdir $DIR/$tdir
+	$LFS setstripe -i 0 -c 1 $DIR/$tdir/slow || error "setstripe failed"
+
+	# make OST0000 slow to service writes, and keep it busy
+	#define OBD_FAIL_OST_BRW_PAUSE_BULK	0x214
+	do_facet ost1 $LCTL set_param fail_loc=0x214 fail_val=1
+	stack_trap "do_facet ost1 $LCTL set_param fail_loc=0 fail_val=0"
+	dd if=/dev/zero of=$DIR/$tdir/slow bs=1M count=1000 oflag=direct &
+	pid=$!
+	stack_trap "kill $pid 2>/dev/null; wait $pid"
+	# let the MDT refresh the OST statfs data, which carry the load
+	sleep_maxage
+	sleep_maxage
+
+	test_mkdir $DIR/$tdir/qos
+	$LFS setstripe -c 1 $DIR/$tdir/qos || error "setstripe qos failed"
+	createmany -o $DIR/$tdir/qos/f $nfiles || error "create failed"
+	cnt0=$($LFS find $DIR/$tdir/qos -type f -i 0 | wc -l)
+	echo "$cnt0 of $nfiles files on loaded OST0000"
+	(( cnt0 < nfiles / OSTCOUNT )) ||
+		error "loaded OST0000 got $cnt0/$nfiles files"
+}
+run_test 116d "QoS steers new stripes away from loaded OSTs"
+
 test_117() # bug 10891
 {
 	[ $PARALLEL == "yes" ] && skip "skip parallel run"
@@ -14672,6 +14848,57 @@ test_123i() {
 }
 run_test 123i "Verify statahead work with the fname indexing pattern"
 
+test_123j() {
+	local dir=$DIR/$tdir
+	local cnt=200
+	local total
+	local xattr
+	local rpcs
+
+	xattr=$($LCTL get_param -n llite.*.statahead_xattr 2>/dev/null |
+		head -n 1)
+	[ -n "$xattr" ] || skip "no statahead xattr prefetch support"
+	stack_trap "$LCTL set_param llite.*.statahead_xattr=$xattr"
+	$LCTL set_param llite.*.statahead_xattr=1
+
+	mkdir -p $dir || error "mkdir $dir failed"
+	createmany -o $dir/$tfile $cnt || error "createmany failed"
+	for ((i = 0; i < cnt; i++)); do
+		setfattr -n user.sa -v $i $dir/$tfile$i ||
+			error "setfattr $dir/$tfile$i failed"
+	done
+
+	cancel_lru_locks mdc
+	$LCTL set_param llite.*.statahead_stats=clear
+	ls -l $dir > /dev/null || error "ls -l $dir failed"
+	if $LCTL get_param -n mdc.*.connect_flags | grep -q batch_getxattr &&
+	   (( $($LCTL get_param -n llite.*.statahead_batch_max |
+		head -n 1) > 0 )); then
+		# getxattr is batched with getattr, wait for all the replies
+		wait_update_facet client "pgrep ll_sa" "" 35 ||
+			error "ll_sa thread is still running"
+	else
+		# give the AGL thread some time to catch up with statahead
+		sleep 2
+	fi
+	total=$($LCTL get_param -n llite.*.statahead_stats |
+		awk '/xattr.prefetch.total:/ { sum += $NF } END { print sum }')
+	echo "xattr caches prefetched: $total"
+	(( total > 0 )) || error "no xattr cache prefetched by statahead"
+
+	# the xattrs are served from the cache, not one getxattr RPC per file
+	$LCTL set_param mdc.*.stats=clear
+	for ((i = 0; i < cnt; i++)); do
+		[[ $(getfattr --only-values -n user.sa $dir/$tfile$i) == $i ]] ||
+			error "wrong user.sa of $dir/$tfile$i"
+	done
+	rpcs=$(calc_stats mdc.*.stats ldlm_ibits_enqueue)
+	echo "enqueue RPCs to get xattrs of $cnt files: $rpcs"
+	(( rpcs < cnt / 10 )) ||
+		error "$rpcs enqueue RPCs, xattrs not prefetched for $cnt files"
+}
+run_test 123j "Verify statahead prefetches the xattr cache"
+
 test_124a() {
 	[ $PARALLEL == "yes" ] && skip "skip parallel run"
 	$LCTL get_param -n mdc.*.connect_flags | grep -q lru_resize ||
@@ -17525,6 +17752,59 @@ test_156() {
 }
 run_test 156 "Verification of tunables"
 
+test_157() {
+	[ $PARALLEL == "yes" ] && skip "skip parallel run"
+	[[ "$ost1_FSTYPE" == "ldiskfs" ]] || skip "ldiskfs only test"
+	remote_ost_nodsh && skip "remote OST with nodsh"
+
+	local osd="osd-ldiskfs.$FSNAME-OST0000"
+	local p="$TMP/$TESTSUITE-$TESTNAME.parameters"
+	local file=$DIR/$tfile
+	local pages=256
+	local before
+	local after
+
+	do_facet ost1 $LCTL get_param -n $osd.readcache_budget_mb ||
+		skip "OST does not support readcache_budget_mb"
+
+	save_writethrough $p
+	save_lustre_params ost1 "$osd.readcache_*" >> $p
+	stack_trap "restore_lustre_params < $p; rm -f $p"
+
+	set_cache read on
+	set_cache writethrough off
+	do_facet ost1 $LCTL set_param $osd.readcache_budget_mb=64 \
+		$osd.readcache_admit_reads=2 $osd.readcache_stats=clear
+
+	$LFS setstripe -c 1 -i 0 $file || error "setstripe $file failed"
+	dd if=/dev/urandom of=$file bs=4k count=$pages || error "dd failed"
+
+	log "First read bypasses the cache"
+	before=$(roc_hit)
+	cancel_lru_locks osc
+	cat $file > /dev/null
+	after=$(roc_hit)
+	(( after == before )) ||
+		error "first read hit the cache: before $before, after $after"
+
+	log "Second read admits the object"
+	cancel_lru_locks osc
+	cat $file > /dev/null
+
+	log "Third read is served from the cache"
+	before=$(roc_hit)
+	cancel_lru_locks osc
+	cat $file > /dev/null
+	after=$(roc_hit)
+	do_facet ost1 $LCTL get_param $osd.readcache_stats
+	(( after - before == pages )) ||
+		error "object not cached: before $before, after $after"
+
+	do_facet ost1 $LCTL get_param -n obdfilter.$FSNAME-OST0000.stats |
+		grep -q cache_hit || error "no cache_hit in OFD stats"
+}
+run_test 157 "OSS read cache admits objects by read frequency"
+
 test_160a() {
 	[ $PARALLEL == "yes" ] && skip "skip parallel run"
 	remote_mds_nodsh && skip "remote MDS with nodsh"
@@ -22947,6 +23227,65 @@ test_230z() {
 }
 run_test 230z "resume dir migration with bad hash type"
 
+test_230aa() {
+	(( MDSCOUNT > 1 )) || skip "needs >= 2 MDTs"
+
+	local mdts=$(comma_list $(mdts_nodes))
+	local saved_threads=$(do_facet mds1 $LCTL get_param -n \
+			      mdt.*-MDT0000.dir_restripe_threads 2>/dev/null)
+	local saved_threshold=$(do_facet mds1 \
+			$LCTL get_param -n mdt.*-MDT0000.dir_split_count)
+	local saved_delta=$(do_facet mds1 \
+			$LCTL get_param -n mdt.*-MDT0000.dir_split_delta)
+	local threshold=2000
+	local migrated
+	local running
+	local nr_files
+
+	[[ -n "$saved_threads" ]] || skip "no dir_restripe_threads"
+	[[ "$mds1_FSTYPE" == "zfs" ]] && threshold=500
+
+	stack_trap "do_nodes $mdts $LCTL set_param \
+		    mdt.*.dir_split_count=$saved_threshold"
+	stack_trap "do_nodes $mdts $LCTL set_param \
+		    mdt.*.dir_restripe_threads=$saved_threads"
+	stack_trap "do_nodes $mdts $LCTL set_param \
+		    mdt.*.dir_split_delta=$saved_delta"
+	stack_trap "do_nodes $mdts $LCTL set_param mdt.*.dir_restripe_nsonly=1"
+	do_nodes $mdts "$LCTL set_param mdt.*.enable_dir_auto_split=1"
+	do_nodes $mdts "$LCTL set_param mdt.*.dir_restripe_threads=4"
+	do_nodes $mdts "$LCTL set_param mdt.*.dir_restripe_nsonly=0"
+	do_nodes $mdts "$LCTL set_param mdt.*.dir_split_count=$threshold"
+	do_nodes $mdts "$LCTL set_param mdt.*.dir_split_delta=4"
+	do_nodes $mdts "$LCTL set_param lod.*.mdt_hash=crush"
+
+	$LFS mkdir -i 0 -c 1 $DIR/$tdir || error "mkdir $tdir failed"
+	createmany -m $DIR/$tdir/f $((threshold * 2)) ||
+		error "create sub files failed"
+	stat $DIR/$tdir > /dev/null
+
+	wait_update $HOSTNAME "$LFS getdirstripe -c $DIR/$tdir" \
+		"$(( MDSCOUNT < 4 ? MDSCOUNT : 4 ))" 100 ||
+		error "$tdir not split: $($LFS getdirstripe $DIR/$tdir)"
+	wait_update $HOSTNAME "$LFS getdirstripe -H $DIR/$tdir" "crush" 200 ||
+		error "$tdir split not finished: $($LFS getdirstripe $DIR/$tdir)"
+
+	do_facet mds1 $LCTL get_param mdt.*-MDT0000.dir_restripe_status
+	migrated=$(do_facet mds1 $LCTL get_param -n \
+		   mdt.*-MDT0000.dir_restripe_status |
+		   awk '/^migrated:/ {print $2}')
+	running=$(do_facet mds1 $LCTL get_param -n \
+		  mdt.*-MDT0000.dir_restripe_status |
+		  awk '/^threads_running:/ {print $2}')
+	(( migrated > 0 )) || error "no sub file migrated by restriper"
+	(( running > 1 )) || error "$running migration threads running"
+
+	nr_files=$($LFS find -type f $DIR/$tdir | wc -l)
+	(( nr_files == threshold * 2 )) ||
+		error "total sub files $nr_files != $((threshold * 2))"
+}
+run_test 230aa "dir auto split migrates with parallel threads"
+
 test_231a()
 {
 	# For simplicity this test assumes that max_pages_per_rpc
@@ -25438,6 +25777,80 @@ test_273c() {
 }
 run_test 273c "race writeback and object destroy"
 
+# number of OST_DESTROY/OST_SETATTR RPCs handled by ost1, batches included
+ost_sync_rpcs() {
+	do_facet ost1 $LCTL get_param -n ost.OSS.ost.stats |
+		awk '/^'$1'/ { n += $2 } END { print n + 0 }'
+}
+
+test_274a() {
+	remote_ost_nodsh && skip "remote OST with nodsh"
+	remote_mds_nodsh && skip "remote MDS with nodsh"
+
+	local mdtosc=$(get_mdtosc_proc_path $SINGLEMDS $FSNAME-OST0000)
+	local param="osp.$mdtosc.max_sync_batch"
+	local nr=256
+	local before
+	local after
+
+	do_facet $SINGLEMDS $LCTL get_param -n $param ||
+		skip "MDS does not support max_sync_batch"
+
+	test_mkdir -i 0 -c 1 $DIR/$tdir
+	$LFS setstripe -i 0 -c 1 $DIR/$tdir || error "setstripe failed"
+	createmany -o $DIR/$tdir/f $nr || error "createmany failed"
+	sync
+	wait_delete_completed
+
+	before=$(ost_sync_rpcs ost_destroy)
+	# unlink in random order, like rm -rf does in readdir hash order
+	for f in $(ls $DIR/$tdir | shuf); do
+		rm $DIR/$tdir/$f || error "rm $f failed"
+	done
+	wait_delete_completed
+	after=$(ost_sync_rpcs ost_destroy)
+
+	echo "$nr objects destroyed by $((after - before)) RPCs"
+	(( after - before < nr / 4 )) ||
+		error "destroys were not batched: $((after - before)) RPCs"
+}
+run_test 274a "OSP sends destroys of many objects in one RPC"
+
+test_274b() {
+	remote_ost_nodsh && skip "remote OST with nodsh"
+	remote_mds_nodsh && skip "remote MDS with nodsh"
+
+	local mdtosc=$(get_mdtosc_proc_path $SINGLEMDS $FSNAME-OST0000)
+	local nr=256
+	local before
+	local after
+
+	do_facet $SINGLEMDS $LCTL get_param -n \
+		osp.$mdtosc.import | grep -q sync_batch ||
+		skip "OST does not support OST_SETATTR_BATCH"
+
+	test_mkdir -i 0 -c 1 $DIR/$tdir
+	$LFS setstripe -i 0 -c 1 $DIR/$tdir || error "setstripe failed"
+	createmany -o $DIR/$tdir/f $nr || error "createmany failed"
+	sync
+	wait_delete_completed
+
+	before=$(ost_sync_rpcs ost_setattr)
+	chown -R $RUNAS_ID:$RUNAS_GID $DIR/$tdir || error "chown failed"
+	wait_delete_completed
+	after=$(ost_sync_rpcs ost_setattr)
+
+	echo "$nr objects changed by $((after - before)) RPCs"
+	(( after - before < nr / 4 )) ||
+		error "setattrs were not batched: $((after - before)) RPCs"
+
+	$CHECKSTAT -u \#$RUNAS_ID -g \#$RUNAS_GID $DIR/$tdir/f0 ||
+		error "wrong owner"
+	do_facet ost1 $LCTL get_param -n ost.OSS.ost.stats |
+		grep -q ost_setattr_batch || error "no OST_SETATTR_BATCH sent"
+}
+run_test 274b "OSP sends setattrs of many objects in one RPC"
+
 test_275() {
 	remote_ost_nodsh && skip "remote OST with nodsh"
 	[ $OST1_VERSION -lt $(version_code 2.10.57) ] &&
@@ -25533,6 +25946,87 @@ test_278() {
 }
 run_test 278 "Race starting MDS between MDTs stop/start"
 
+test_279a() {
+	[[ "$ost1_FSTYPE" == "ldiskfs" ]] || skip "ldiskfs only test"
+	remote_ost_nodsh && skip "remote OST with nodsh"
+
+	local param="osd-ldiskfs.$FSNAME-OST0000.write_prealloc_max"
+	local stats="osd-ldiskfs.$FSNAME-OST0000.extent_stats"
+	local old
+	local sum1
+	local sum2
+	local pa
+
+	old=$(do_facet ost1 $LCTL get_param -n $param) ||
+		skip "OST does not support write_prealloc_max"
+	stack_trap "do_facet ost1 $LCTL set_param $param=$old"
+	do_facet ost1 $LCTL set_param $param=16M ||
+		error "can't set write_prealloc_max"
+
+	$LFS setstripe -i 0 -c 1 $DIR/$tfile || error "setstripe failed"
+	do_facet ost1 $LCTL set_param $stats=clear
+
+	dd if=/dev/urandom of=$TMP/$tfile bs=1M count=6 ||
+		error "dd to $TMP/$tfile failed"
+	stack_trap "rm -f $TMP/$tfile"
+	dd if=$TMP/$tfile of=$DIR/$tfile bs=1M oflag=direct ||
+		error "dd to $DIR/$tfile failed"
+
+	do_facet ost1 $LCTL get_param $stats
+	pa=$(do_facet ost1 $LCTL get_param -n $stats |
+	     awk '/prealloc_blocks:/ { print $2 }')
+	(( pa > 0 )) || error "no blocks reserved ahead of the write stream"
+
+	(( $(stat -c %s $DIR/$tfile) == 6 * 1048576 )) ||
+		error "file size changed by preallocation"
+	cancel_lru_locks osc
+	sum1=$(md5sum < $TMP/$tfile)
+	sum2=$(md5sum < $DIR/$tfile)
+	[[ "$sum1" == "$sum2" ]] || error "data mismatch after preallocation"
+	filefrag -v $DIR/$tfile
+}
+run_test 279a "OSD reserves blocks ahead of sequential writers"
+
+test_279b() {
+	[[ "$ost1_FSTYPE" == "ldiskfs" ]] || skip "ldiskfs only test"
+	remote_ost_nodsh && skip "remote OST with nodsh"
+	check_set_fallocate_or_skip
+
+	local param="osd-ldiskfs.$FSNAME-OST0000.write_prealloc_max"
+	local old
+	local bytes
+	local want
+
+	old=$(do_facet ost1 $LCTL get_param -n $param) ||
+		skip "OST does not support write_prealloc_max"
+	stack_trap "do_facet ost1 $LCTL set_param $param=$old"
+	do_facet ost1 $LCTL set_param $param=16M ||
+		error "can't set write_prealloc_max"
+
+	$LFS setstripe -i 0 -c 1 $DIR/$tfile || error "setstripe failed"
+	stack_trap "rm -f $DIR/$tfile"
+	# space of the user in the window reserved ahead of the writes
+	fallocate -n -o 8M -l 8M $DIR/$tfile || error "fallocate failed"
+	dd if=/dev/zero of=$DIR/$tfile bs=1M count=6 oflag=direct ||
+		error "dd to $DIR/$tfile failed"
+
+	# a write after the stream went idle (OSD_WR_STREAM_IDLE) releases
+	# the blocks reserved for it
+	sleep 35
+	dd if=/dev/zero of=$DIR/$tfile bs=1M count=1 seek=40 oflag=direct \
+		conv=notrunc || error "dd to $DIR/$tfile failed"
+	cancel_lru_locks osc
+
+	# 6MiB and 1MiB written, 8MiB fallocated, nothing reserved left
+	bytes=$(($(stat -c '%b * %B' $DIR/$tfile)))
+	want=$((15 * 1048576))
+	filefrag -v $DIR/$tfile
+	(( bytes >= want )) || error "fallocated space released, $bytes < $want"
+	(( bytes < want + 1048576 )) ||
+		error "reserved space not released, $bytes >= $want + 1MiB"
+}
+run_test 279b "OSD releases only the blocks it reserved"
+
 test_280() {
 	[ $MGS_VERSION -lt $(version_code 2.13.52) ] &&
 		skip "Need MGS version at least 2.13.52"
@@ -25555,6 +26049,87 @@ test_280() {
 }
 run_test 280 "Race between MGS umount and client llog processing"
 
+test_281() {
+	remote_mds_nodsh && skip "remote MDS with nodsh"
+
+	local mdtosc=$(get_mdtosc_proc_path $SINGLEMDS $FSNAME-OST0000)
+	local param="osp.$mdtosc.max_sync_threads"
+	local old
+	local nr=1000
+
+	old=$(do_facet $SINGLEMDS $LCTL get_param -n $param) ||
+		skip "MDS does not support max_sync_threads"
+	stack_trap "do_facet $SINGLEMDS $LCTL set_param $param=$old"
+
+	do_facet $SINGLEMDS $LCTL set_param $param=0 &&
+		error "max_sync_threads=0 should be rejected"
+	do_facet $SINGLEMDS $LCTL set_param $param=8 ||
+		error "can't set max_sync_threads"
+
+	test_mkdir -i 0 -c 1 $DIR/$tdir
+	$LFS setstripe -i 0 -c 1 $DIR/$tdir || error "setstripe failed"
+	createmany -o $DIR/$tdir/f $nr || error "createmany failed"
+	sync
+	unlinkmany $DIR/$tdir/f $nr || error "unlinkmany failed"
+	wait_delete_completed || error "destroys were not synced"
+
+	do_facet $SINGLEMDS $LCTL get_param osp.$mdtosc.sync_*
+	(( $(do_facet $SINGLEMDS $LCTL get_param -n \
+	     osp.$mdtosc.sync_in_progress) == 0 )) ||
+		error "llog records are not cancelled"
+}
+run_test 281 "OSP cancels synced llog records with several workers"
+
+test_282() {
+	[[ "$ost1_FSTYPE" == "ldiskfs" ]] || skip "ldiskfs only test"
+	remote_ost_nodsh && skip "remote OST with nodsh"
+
+	local param="obdfilter.$FSNAME-OST0000.brw_async_commit"
+	local old
+	local sum1
+	local sum2
+	local pids=()
+	local pid
+	local i
+
+	old=$(do_facet ost1 $LCTL get_param -n $param) ||
+		skip "OST does not support brw_async_commit"
+	stack_trap "do_facet ost1 $LCTL set_param $param=$old"
+	do_facet ost1 $LCTL set_param $param=1 ||
+		error "can't set brw_async_commit"
+
+	$LFS setstripe -i 0 -c 1 $DIR/$tfile || error "setstripe failed"
+	stack_trap "rm -f $DIR/$tfile $TMP/$tfile"
+	dd if=/dev/urandom of=$TMP/$tfile bs=1M count=16 ||
+		error "can't create source file"
+
+	# concurrent writers, each one waiting for its replies
+	for ((i = 0; i < 4; i++)); do
+		dd if=$TMP/$tfile of=$DIR/$tfile bs=1M count=4 seek=$((i * 4)) \
+			skip=$((i * 4)) oflag=direct conv=notrunc &
+		pids+=($!)
+	done
+	for pid in ${pids[@]}; do
+		wait $pid || error "direct write failed"
+	done
+	dd if=$TMP/$tfile of=$DIR/$tfile bs=64k count=16 seek=8 skip=8 \
+		conv=notrunc,fsync || error "buffered write failed"
+
+	cancel_lru_locks osc
+	sum1=$(md5sum < $TMP/$tfile)
+	sum2=$(md5sum < $DIR/$tfile)
+	[[ "$sum1" == "$sum2" ]] || error "data mismatch after async commit"
+
+	# the server still blocks on the writes with the tunable disabled
+	do_facet ost1 $LCTL set_param $param=0
+	dd if=$TMP/$tfile of=$DIR/$tfile bs=1M count=16 oflag=direct \
+		conv=notrunc || error "write failed"
+	cancel_lru_locks osc
+	sum2=$(md5sum < $DIR/$tfile)
+	[[ "$sum1" == "$sum2" ]] || error "data mismatch after sync commit"
+}
+run_test 282 "OST replies to writes once the data I/O completes"
+
 cleanup_test_300() {
 	trap 0
 	umask $SAVE_UMASK
@@ -26382,6 +26957,58 @@ test_300t() {
 }
 run_test 300t "test max_mdt_stripecount"
 
+test_300u() {
+	(( MDSCOUNT >= 2 )) || skip "needs >= 2 MDTs"
+	$LCTL get_param -n lmv.*.readdir_threads &> /dev/null ||
+		skip "client does not support parallel stripe readdir"
+
+	local nrfiles=10000
+	local threads=$($LCTL get_param -n lmv.*.readdir_threads | head -n1)
+	local serial
+	local parallel
+	local serial_rpcs
+	local parallel_rpcs
+	local helpers
+
+	$LFS mkdir -c $MDSCOUNT $DIR/$tdir || error "mkdir $tdir failed"
+	createmany -m $DIR/$tdir/$tfile $nrfiles > /dev/null ||
+		error "create $nrfiles files failed"
+	stack_trap "$LCTL set_param lmv.*.readdir_threads=$threads"
+	debugsave
+	stack_trap debugrestore
+	$LCTL set_param debug=+inode
+
+	$LCTL set_param lmv.*.readdir_threads=1
+	cancel_lru_locks mdc
+	$LCTL set_param -n mdc.*.stats clear
+	serial=$(ls -af $DIR/$tdir | md5sum)
+	serial_rpcs=$(calc_stats mdc.*.stats mds_readpage)
+
+	$LCTL set_param lmv.*.readdir_threads=$MDSCOUNT
+	cancel_lru_locks mdc
+	$LCTL set_param -n mdc.*.stats clear
+	$LCTL clear
+	parallel=$(ls -af $DIR/$tdir | md5sum)
+	parallel_rpcs=$(calc_stats mdc.*.stats mds_readpage)
+	helpers=$($LCTL dk | grep -c "stripe pages with [1-9][0-9]* helpers")
+
+	# the merged listing is in hash order, which must not depend on
+	# the order the stripe pages were read in
+	[[ "$serial" == "$parallel" ]] ||
+		error "parallel readdir returned different listing"
+	(( $(ls -af $DIR/$tdir | wc -l) == nrfiles + 2 )) ||
+		error "expect $nrfiles entries and . .."
+	(( $(ls -af $DIR/$tdir | sort -u | wc -l) == nrfiles + 2 )) ||
+		error "duplicate entries returned"
+
+	echo "readpage RPCs: $serial_rpcs serial, $parallel_rpcs parallel"
+	echo "$helpers batches read with helper threads"
+	(( helpers > 0 )) || error "no stripe pages were read in parallel"
+	(( parallel_rpcs <= serial_rpcs + MDSCOUNT )) ||
+		error "parallel readdir sent $parallel_rpcs readpage RPCs, serial sent $serial_rpcs"
+}
+run_test 300u "readdir of striped directory reads stripes in parallel"
+
 prepare_remote_file() {
 	mkdir $DIR/$tdir/src_dir ||
 		error "create remote source failed"
@@ -28857,6 +29484,50 @@ test_413j()
 }
 run_test 413j "set default LMV by setxattr"
 
+test_413k() {
+	(( $MDSCOUNT > 1 )) || skip_env "needs >= 2 MDTs"
+
+	local prio_old=$($LCTL get_param -n lmv.*.qos_prio_load | head -n1)
+	local ndirs=100
+	local pids=""
+	local cnt0
+	local pid
+	local i
+
+	[ -n "$prio_old" ] || skip "no lmv qos_prio_load"
+	stack_trap "$LCTL set_param lmv.*.qos_prio_load=${prio_old%%%}"
+	$LCTL set_param lmv.*.qos_prio_load=100
+
+	# metadata storm on MDT0000
+	$LFS mkdir -i 0 $DIR/$tdir || error "mkdir $tdir failed"
+	for ((i = 0; i < 8; i++)); do
+		mkdir $DIR/$tdir/storm$i
+		createmany -o -t 600 $DIR/$tdir/storm$i/f 1000000 \
+			> /dev/null &
+		pids="$pids $!"
+	done
+	stack_trap "kill $pids 2>/dev/null; wait"
+	# let statfs carry the MDT load to this client
+	sleep_maxage_lmv
+	sleep_maxage_lmv
+	$LFS df -i $MOUNT > /dev/null
+
+	$LFS mkdir -i 0 $DIR/$tdir-qos || error "mkdir $tdir-qos failed"
+	for ((i = 0; i < ndirs; i++)); do
+		$LFS mkdir -i -1 $DIR/$tdir-qos/d$i ||
+			error "mkdir d$i failed"
+	done
+	cnt0=$($LFS getdirstripe -i $DIR/$tdir-qos/d* | grep -c "^0$")
+	echo "$cnt0 of $ndirs directories on busy MDT0000"
+
+	kill $pids 2>/dev/null
+	wait
+	(( cnt0 < ndirs / MDSCOUNT )) ||
+		error "busy MDT0000 got $cnt0/$ndirs directories"
+	rm -rf $DIR/$tdir $DIR/$tdir-qos
+}
+run_test 413k "QoS mkdir avoids MDT busy with a metadata storm"
+
 test_413z() {
 	local pids=""
 	local subdir
@@ -30696,6 +31367,44 @@ test_807() {
 }
 run_test 807 "verify LSOM syncing tool"
 
+test_807a() {
+	local mdt=mdt.$FSNAME-MDT0000
+	local stats=$mdt.lsom_refresh_stats
+	local bs=1048576
+	local done
+	local old
+
+	do_facet mds1 $LCTL get_param -n $mdt.enable_lsom_refresh \
+		&> /dev/null || skip "MDS does not support LSOM refresh"
+
+	old=$(do_facet mds1 $LCTL get_param -n $mdt.enable_lsom_refresh)
+	do_facet mds1 $LCTL set_param $mdt.enable_lsom_refresh=1
+	stack_trap "do_facet mds1 $LCTL set_param $mdt.enable_lsom_refresh=$old"
+	old=$(do_facet mds1 $LCTL get_param -n $mdt.lsom_refresh_delay)
+	do_facet mds1 $LCTL set_param $mdt.lsom_refresh_delay=1
+	stack_trap "do_facet mds1 $LCTL set_param $mdt.lsom_refresh_delay=$old"
+
+	mkdir_on_mdt0 $DIR/$tdir || error "mkdir $tdir failed"
+	$LFS setstripe -c -1 $DIR/$tdir/$tfile || error "setstripe failed"
+	dd if=/dev/zero of=$DIR/$tdir/$tfile bs=$bs count=4 conv=fsync ||
+		error "write $tfile failed"
+	# LSOM from truncate has placeholder blocks, and the following close
+	# only grows it, the refresh thread fixes it from OST objects
+	$TRUNCATE $DIR/$tdir/$tfile 1234 || error "truncate $tfile failed"
+	done=$(do_facet mds1 $LCTL get_param -n $stats |
+	       awk '/refreshed|unchanged/ { n += $2 } END { print n + 0 }')
+	$MULTIOP $DIR/$tdir/$tfile oO_WRONLY:w1024Yc ||
+		error "write $tfile failed"
+
+	wait_update_facet_cond mds1 "$LCTL get_param -n $stats |
+		awk '/refreshed|unchanged/ { n += \$2 } END { print n + 0 }'" \
+		"-gt" $done 30 || error "LSOM of $tfile is not refreshed"
+	do_facet mds1 $LCTL get_param $stats
+
+	check_lsom_data $DIR/$tdir/$tfile
+}
+run_test 807a "LSOM is refreshed from OSTs by the MDT after close"
+
 check_som_nologged()
 {
 	local lines=$($LFS changelog $FSNAME-MDT0000 |
@@ -31564,6 +32273,76 @@ test_907() {
 }
 run_test 907 "write rpc error during unlink"
 
+test_908() {
+	grep -q io_uring_setup /proc/kallsyms ||
+		skip "Client OS does not support io_uring I/O engine"
+	io_uring_probe || skip "kernel does not support io_uring fully"
+	which fio || skip_env "no fio installed"
+	fio --enghelp | grep -q io_uring ||
+		skip_env "fio does not support io_uring I/O engine"
+
+	local file=$DIR/$tfile
+	local size=32M
+
+	$LCTL set_param -n llite.*.fast_read=1
+	dd if=/dev/urandom of=$file bs=1M count=32 || error "dd $file failed"
+	# populate page cache so IOCB_NOWAIT reads can be served inline
+	cat $file > /dev/null || error "read $file failed"
+
+	fio --name=nowaitread --ioengine=io_uring --bs=$PAGE_SIZE \
+		--direct=0 --iodepth=32 --size=$size --filename=$file \
+		--rw=randread || error "fio buffered read failed"
+
+	fio --name=nowaitwrite --ioengine=io_uring --bs=$PAGE_SIZE \
+		--direct=0 --iodepth=32 --size=$size --filename=$file \
+		--rw=randwrite --verify=crc32c ||
+		error "fio buffered write failed"
+
+	rm -f $file || error "rm -f $file failed"
+}
+run_test 908 "io_uring buffered I/O with IOCB_NOWAIT fast path"
+
+test_909() {
+	local osc=$($LCTL dl | awk '/osc.*-OST0000-/ { print $4; exit }')
+
+	$LCTL get_param -n osc.$osc.compr_cache_max_mb ||
+		skip "client does not support compressed page cache"
+
+	local old=$($LCTL get_param -n osc.$osc.compr_cache_max_mb)
+
+	$LCTL set_param osc.$osc.compr_cache_max_mb=64 ||
+		skip "kernel does not provide LZ4"
+	stack_trap "$LCTL set_param osc.$osc.compr_cache_max_mb=$old"
+
+	$LFS setstripe -i 0 -c 1 $DIR/$tfile
+	# compressible content
+	yes "compressed osc page cache" | head -c 8M > $DIR/$tfile ||
+		error "write $DIR/$tfile failed"
+	sync
+	local sum1=$(md5sum < $DIR/$tfile)
+
+	$LCTL set_param osc.$osc.compr_cache_stats=clear
+	# push the clean pages out of the osc LRU into the compressed tier
+	$LCTL set_param osc.$osc.osc_cached_mb=0
+	$LCTL get_param osc.$osc.compr_cache_stats
+
+	local sum2=$(md5sum < $DIR/$tfile)
+	local hits=$($LCTL get_param -n osc.$osc.compr_cache_stats |
+		     awk '/^hits:/ { print $2 }')
+
+	[[ "$sum1" == "$sum2" ]] || error "data mismatch after compressed read"
+	(( hits > 0 )) || error "no hit from compressed page cache"
+
+	# lock cancellation must drop the compressed copies
+	$LCTL set_param osc.$osc.osc_cached_mb=0
+	cancel_lru_locks osc
+	$LCTL get_param osc.$osc.compr_cache_stats
+	local cached=$($LCTL get_param -n osc.$osc.compr_cache_stats |
+		       awk '/^cached_pages:/ { print $2 }')
+	(( cached == 0 )) || error "$cached pages left after lock cancel"
+}
+run_test 909 "compressed page cache tier for osc"
+
 
 complete_test $SECONDS
 [ -f $EXT2_DEV ] && rm $EXT2_DEV || true
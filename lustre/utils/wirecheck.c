@@ -683,6 +683,8 @@ check_obd_connect_data(void)
 	CHECK_DEFINE_64X(OBD_CONNECT2_LARGE_NID);
 	CHECK_DEFINE_64X(OBD_CONNECT2_COMPRESS);
 	CHECK_DEFINE_64X(OBD_CONNECT2_UNALIGNED_DIO);
+	CHECK_DEFINE_64X(OBD_CONNECT2_BATCH_GETXATTR);
+	CHECK_DEFINE_64X(OBD_CONNECT2_SYNC_BATCH);
 
 	BLANK_LINE();
 	CHECK_VALUE_X(OBD_CKSUM_CRC32);
@@ -1017,9 +1019,9 @@ check_obd_statfs(void)
 	CHECK_MEMBER(obd_statfs, os_state);
 	CHECK_MEMBER(obd_statfs, os_fprecreated);
 	CHECK_MEMBER(obd_statfs, os_granted);
-	CHECK_MEMBER(obd_statfs, os_spare3);
-	CHECK_MEMBER(obd_statfs, os_spare4);
-	CHECK_MEMBER(obd_statfs, os_spare5);
+	CHECK_MEMBER(obd_statfs, os_load_usec);
+	CHECK_MEMBER(obd_statfs, os_load_depth);
+	CHECK_MEMBER(obd_statfs, os_load_rate);
 	CHECK_MEMBER(obd_statfs, os_spare6);
 	CHECK_MEMBER(obd_statfs, os_spare7);
 	CHECK_MEMBER(obd_statfs, os_spare8);
@@ -3327,6 +3329,8 @@ main(int argc, char **argv)
 	CHECK_VALUE(OST_LADVISE);
 	CHECK_VALUE(OST_FALLOCATE);
 	CHECK_VALUE(OST_SEEK);
+	CHECK_VALUE(OST_DESTROY_BATCH);
+	CHECK_VALUE(OST_SETATTR_BATCH);
 	CHECK_VALUE(OST_LAST_OPC);
 
 	CHECK_DEFINE_64X(OBD_OBJECT_EOF);
@@ -3489,6 +3493,7 @@ main(int argc, char **argv)
 
 	CHECK_VALUE(QUOTA_DQACQ);
 	CHECK_VALUE(QUOTA_DQREL);
+	CHECK_VALUE(QUOTA_DQACQ_BATCH);
 	CHECK_VALUE(QUOTA_LAST_OPC);
 
 	CHECK_VALUE(MGS_CONNECT);
@@ -134,7 +134,11 @@ void lustre_assert_wire_constants(void)
 		 (long long)OST_FALLOCATE);
 	LASSERTF(OST_SEEK == 23, "found %lld\n",
 		 (long long)OST_SEEK);
-	LASSERTF(OST_LAST_OPC == 24, "found %lld\n",
+	LASSERTF(OST_DESTROY_BATCH == 24, "found %lld\n",
+		 (long long)OST_DESTROY_BATCH);
+	LASSERTF(OST_SETATTR_BATCH == 25, "found %lld\n",
+		 (long long)OST_SETATTR_BATCH);
+	LASSERTF(OST_LAST_OPC == 26, "found %lld\n",
 		 (long long)OST_LAST_OPC);
 	LASSERTF(OBD_OBJECT_EOF == 0xffffffffffffffffULL, "found 0x%.16llxULL\n",
 		 OBD_OBJECT_EOF);
@@ -394,7 +398,9 @@ void lustre_assert_wire_constants(void)
 		 (long long)QUOTA_DQACQ);
 	LASSERTF(QUOTA_DQREL == 602, "found %lld\n",
 		 (long long)QUOTA_DQREL);
-	LASSERTF(QUOTA_LAST_OPC == 603, "found %lld\n",
+	LASSERTF(QUOTA_DQACQ_BATCH == 603, "found %lld\n",
+		 (long long)QUOTA_DQACQ_BATCH);
+	LASSERTF(QUOTA_LAST_OPC == 604, "found %lld\n",
 		 (long long)QUOTA_LAST_OPC);
 	LASSERTF(MGS_CONNECT == 250, "found %lld\n",
 		 (long long)MGS_CONNECT);
@@ -1483,6 +1489,10 @@ void lustre_assert_wire_constants(void)
 		 OBD_CONNECT2_COMPRESS);
 	LASSERTF(OBD_CONNECT2_UNALIGNED_DIO == 0x400000000ULL, "found 0x%.16llxULL\n",
 		 OBD_CONNECT2_UNALIGNED_DIO);
+	LASSERTF(OBD_CONNECT2_BATCH_GETXATTR == 0x800000000ULL, "found 0x%.16llxULL\n",
+		 OBD_CONNECT2_BATCH_GETXATTR);
+	LASSERTF(OBD_CONNECT2_SYNC_BATCH == 0x1000000000ULL, "found 0x%.16llxULL\n",
+		 OBD_CONNECT2_SYNC_BATCH);
 
 	LASSERTF(OBD_CKSUM_CRC32 == 0x00000001UL, "found 0x%.8xUL\n",
 		(unsigned)OBD_CKSUM_CRC32);
@@ -2115,18 +2125,18 @@ void lustre_assert_wire_constants(void)
 		 (long long)(int)offsetof(struct obd_statfs, os_granted));
 	LASSERTF((int)sizeof(((struct obd_statfs *)0)->os_granted) == 4, "found %lld\n",
 		 (long long)(int)sizeof(((struct obd_statfs *)0)->os_granted));
-	LASSERTF((int)offsetof(struct obd_statfs, os_spare3) == 116, "found %lld\n",
-		 (long long)(int)offsetof(struct obd_statfs, os_spare3));
-	LASSERTF((int)sizeof(((struct obd_statfs *)0)->os_spare3) == 4, "found %lld\n",
-		 (long long)(int)sizeof(((struct obd_statfs *)0)->os_spare3));
-	LASSERTF((int)offsetof(struct obd_statfs, os_spare4) == 120, "found %lld\n",
-		 (long long)(int)offsetof(struct obd_statfs, os_spare4));
-	LASSERTF((int)sizeof(((struct obd_statfs *)0)->os_spare4) == 4, "found %lld\n",
-		 (long long)(int)sizeof(((struct obd_statfs *)0)->os_spare4));
-	LASSERTF((int)offsetof(struct obd_statfs, os_spare5) == 124, "found %lld\n",
-		 (long long)(int)offsetof(struct obd_statfs, os_spare5));
-	LASSERTF((int)sizeof(((struct obd_statfs *)0)->os_spare5) == 4, "found %lld\n",
-		 (long long)(int)sizeof(((struct obd_statfs *)0)->os_spare5));
+	LASSERTF((int)offsetof(struct obd_statfs, os_load_usec) == 116, "found %lld\n",
+		 (long long)(int)offsetof(struct obd_statfs, os_load_usec));
+	LASSERTF((int)sizeof(((struct obd_statfs *)0)->os_load_usec) == 4, "found %lld\n",
+		 (long long)(int)sizeof(((struct obd_statfs *)0)->os_load_usec));
+	LASSERTF((int)offsetof(struct obd_statfs, os_load_depth) == 120, "found %lld\n",
+		 (long long)(int)offsetof(struct obd_statfs, os_load_depth));
+	LASSERTF((int)sizeof(((struct obd_statfs *)0)->os_load_depth) == 4, "found %lld\n",
+		 (long long)(int)sizeof(((struct obd_statfs *)0)->os_load_depth));
+	LASSERTF((int)offsetof(struct obd_statfs, os_load_rate) == 124, "found %lld\n",
+		 (long long)(int)offsetof(struct obd_statfs, os_load_rate));
+	LASSERTF((int)sizeof(((struct obd_statfs *)0)->os_load_rate) == 4, "found %lld\n",
+		 (long long)(int)sizeof(((struct obd_statfs *)0)->os_load_rate));
 	LASSERTF((int)offsetof(struct obd_statfs, os_spare6) == 128, "found %lld\n",
 		 (long long)(int)offsetof(struct obd_statfs, os_spare6));
 	LASSERTF((int)sizeof(((struct obd_statfs *)0)->os_spare6) == 4, "found %lld\n",